@@ -0,0 +1,455 @@
+/**
+ * rainc_bench.c - Banc de mesure de Rain-C (make bench)
+ *  - Génère un dictionnaire synthétique reproductible (graine, nombre de mots, distribution
+ *    des longueurs) puis mesure, avec les fonctions de Rain-C elles-mêmes :
+ *      - -G par algo : hachages par seconde et Mo/s de la table texte écrite en flux
+ *      - écriture seule d'une table en mémoire : Mo/s en texte et en binaire (create_t3c)
+ *      - chargement t3c_load, projection t3c_bin_open, construction de chaque index
+ *      - latence de recherche (p50 / p99 / p999) par index, sur un flux riche en trouvés et
+ *        un flux riche en absents
+ *  - Les résultats sont écrits en JSON pour être suivis d'une version à l'autre
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "control_T3C.h"
+#include "control_dict.h"
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "hash.h"
+
+#define BENCH_MOTS      1000000      // mots du dictionnaire par défaut
+#define BENCH_REQUETES  200000       // requêtes par flux de recherche
+#define BENCH_LEN_MIN   6
+#define BENCH_LEN_MAX   14
+#define BENCH_SEED      42
+#define BENCH_ALGOS     4
+#define BENCH_HIT_RICHE 0.9          // part de trouvés du flux riche en trouvés
+#define BENCH_HIT_PAUVRE 0.1         // part de trouvés du flux riche en absents
+
+static const char *algos_defaut[BENCH_ALGOS] = {"sha256", "sha512", "blake2b512", "sha3-256"};
+static const char charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+// Paramètres du banc (options de la ligne de commande)
+typedef struct {
+    size_t nbmots;
+    size_t nbrequetes;
+    unsigned int len_min;
+    unsigned int len_max;
+    int normale;                 // 0 = longueurs uniformes, 1 = en cloche autour du milieu
+    uint64_t graine;
+    int nbthreads;
+    char *algos[BENCH_ALGOS];
+    int nbalgo;
+    char *dossier;
+    char *sortie;
+    int garder;                  // 1 = fichiers de travail conservés
+} bench_params;
+
+// Générateur xorshift64* : la même graine redonne le même dictionnaire et les mêmes requêtes
+static uint64_t aleatoire(uint64_t *etat){
+    *etat ^= *etat >> 12;
+    *etat ^= *etat << 25;
+    *etat ^= *etat >> 27;
+    return *etat * 0x2545F4914F6CDD1DULL;
+}
+
+// Horloge monotone en nanosecondes
+static uint64_t horloge_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double secondes_depuis(uint64_t debut){
+    return (double)(horloge_ns() - debut) / 1e9;
+}
+
+static uint64_t taille_fichier(const char *path){
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+// Longueur d'un mot : uniforme sur [min, max], ou moyenne de 4 tirages (cloche centrée)
+static unsigned int longueur_mot(const bench_params *params, uint64_t *etat){
+    unsigned int etendue = params->len_max - params->len_min + 1;
+    if (!params->normale)
+        return params->len_min + (unsigned int)(aleatoire(etat) % etendue);
+    unsigned int somme = 0;
+    for (int k = 0; k < 4; ++k)
+        somme += (unsigned int)(aleatoire(etat) % etendue);
+    return params->len_min + somme / 4;
+}
+
+// Écrit le dictionnaire synthétique : nbmots lignes de caractères alphanumériques
+static int generer_dictionnaire(const bench_params *params, const char *path, uint64_t *octets){
+    FILE *fichier = fopen(path, "w");
+    if (!fichier){
+        printf("rainc_bench.c : ERREUR > Impossible de créer le dictionnaire '%s'\n", path);
+        return -1;
+    }
+    setvbuf(fichier, NULL, _IOFBF, 1 << 20);
+    uint64_t etat = params->graine;
+    char mot[256];
+    *octets = 0;
+    for (size_t i = 0; i < params->nbmots; ++i){
+        unsigned int taille = longueur_mot(params, &etat);
+        for (unsigned int c = 0; c < taille; ++c)
+            mot[c] = charset[aleatoire(&etat) % (sizeof charset - 1)];
+        mot[taille] = '\n';
+        fwrite(mot, 1, taille + 1, fichier);
+        *octets += taille + 1;
+    }
+    if (fclose(fichier) != 0){
+        printf("rainc_bench.c : ERREUR > L'écriture du dictionnaire '%s' à échoué\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int compare_u64(const void *a, const void *b){
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Flux de requêtes : condensats de la table (trouvés) mêlés à des condensats aléatoires (absents)
+   - part_hit : proportion de trouvés, tirés au hasard dans la table
+*/
+static unsigned char *flux_requetes(const t3c_table *table, size_t nbrequetes, double part_hit, uint64_t graine){
+    size_t dt = table->digest_taille;
+    unsigned char *requetes = malloc(nbrequetes * dt);
+    if (!requetes){
+        printf("rainc_bench.c : ERREUR > malloc des requêtes (%zu)\n", nbrequetes);
+        return NULL;
+    }
+    uint64_t etat = graine;
+    uint64_t seuil = (uint64_t)(part_hit * (double)UINT32_MAX);
+    for (size_t i = 0; i < nbrequetes; ++i){
+        unsigned char *digest = requetes + i * dt;
+        if ((aleatoire(&etat) & UINT32_MAX) < seuil && table->nbobj > 0){
+            memcpy(digest, table->digests + (aleatoire(&etat) % table->nbobj) * dt, dt);
+        } else {
+            for (size_t k = 0; k < dt; k += 8){
+                uint64_t v = aleatoire(&etat);
+                memcpy(digest + k, &v, dt - k < 8 ? dt - k : 8);
+            }
+        }
+    }
+    return requetes;
+}
+
+/* Mesure la latence de chaque requête et écrit ses percentiles en JSON
+   - index NULL : recherche dans la colonne projetée de la table binaire
+   - surcout : coût d'une paire de lectures de l'horloge, déjà retiré de chaque mesure
+*/
+static int mesurer_recherches(FILE *json, const char *nom, const char *flux, double part_hit, const t3c_index *index, const t3c_table *table, const t3c_bin *bin,
+                              const unsigned char *requetes, size_t nbrequetes, uint64_t surcout, int premier){
+    uint64_t *latences = malloc((nbrequetes ? nbrequetes : 1) * sizeof *latences);
+    if (!latences){
+        printf("rainc_bench.c : ERREUR > malloc des latences (%zu)\n", nbrequetes);
+        return -1;
+    }
+    size_t dt = table->digest_taille;
+    size_t trouves = 0, somme = 0;
+    uint64_t debut_total = horloge_ns();
+    for (size_t i = 0; i < nbrequetes; ++i){
+        const unsigned char *digest = requetes + i * dt;
+        uint64_t debut = horloge_ns();
+        const char *mdp = NULL;
+        if (index){
+            ssize_t id = t3c_index_find(index, digest, (unsigned int)dt);
+            mdp = id < 0 ? NULL : t3c_mdp(table, (size_t)id);
+        } else {
+            mdp = t3c_bin_lookup(bin, 0, digest, (unsigned int)dt);
+        }
+        uint64_t duree = horloge_ns() - debut;
+        latences[i] = duree > surcout ? duree - surcout : 0;
+        if (mdp){
+            trouves++;
+            somme += (unsigned char)mdp[0];
+        }
+    }
+    double total = secondes_depuis(debut_total);
+
+    qsort(latences, nbrequetes, sizeof *latences, compare_u64);
+    uint64_t cumul = 0;
+    for (size_t i = 0; i < nbrequetes; ++i)
+        cumul += latences[i];
+    size_t n = nbrequetes ? nbrequetes - 1 : 0;
+    fprintf(json, "%s\n    {\"index\": \"%s\", \"flux\": \"%s\", \"part_hit\": %.2f, \"requetes\": %zu, \"trouves\": %zu, "
+                  "\"requetes_par_s\": %.0f, \"moyenne_ns\": %.1f, \"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu, \"controle\": %zu}",
+            premier ? "" : ",", nom, flux, part_hit, nbrequetes, trouves,
+            total > 0 ? (double)nbrequetes / total : 0.0, nbrequetes ? (double)cumul / (double)nbrequetes : 0.0,
+            (unsigned long long)(nbrequetes ? latences[(size_t)(0.5 * n)] : 0),
+            (unsigned long long)(nbrequetes ? latences[(size_t)(0.99 * n)] : 0),
+            (unsigned long long)(nbrequetes ? latences[(size_t)(0.999 * n)] : 0),
+            (unsigned long long)(nbrequetes ? latences[n] : 0), somme);
+    free(latences);
+    return 0;
+}
+
+// Coût médian d'une paire de lectures de l'horloge, retiré des latences mesurées
+static uint64_t surcout_horloge(void){
+    uint64_t mesures[1001];
+    for (size_t i = 0; i < sizeof mesures / sizeof *mesures; ++i){
+        uint64_t debut = horloge_ns();
+        mesures[i] = horloge_ns() - debut;
+    }
+    qsort(mesures, sizeof mesures / sizeof *mesures, sizeof *mesures, compare_u64);
+    return mesures[500];
+}
+
+// Chemin d'un fichier de travail du banc
+static void chemin_travail(const bench_params *params, const char *nom, char *chemin, size_t taille){
+    snprintf(chemin, taille, "%s/%s", params->dossier, nom);
+}
+
+/* Déroule le banc et écrit le JSON dans json
+   - les fichiers de travail sont dans params->dossier
+*/
+static int bench_executer(const bench_params *params, FILE *json){
+    char dict[4096], texte[4096], binaire[4096];
+    char nom[T3C_ALGO_MAX + 16];
+    chemin_travail(params, "dict.txt", dict, sizeof dict);
+    chemin_travail(params, "ecriture.t3c", texte, sizeof texte);
+    chemin_travail(params, "ecriture_bin.t3c", binaire, sizeof binaire);
+
+    fprintf(json, "{\n  \"banc\": \"rainc_bench\",\n  \"date\": %lld,\n  \"processeurs\": %ld,\n  \"threads\": %d,\n",
+            (long long)time(NULL), sysconf(_SC_NPROCESSORS_ONLN), params->nbthreads);
+
+    // Dictionnaire synthétique
+    uint64_t octets_dict = 0;
+    uint64_t debut = horloge_ns();
+    if (generer_dictionnaire(params, dict, &octets_dict) != 0)
+        return -1;
+    fprintf(json, "  \"dictionnaire\": {\"mots\": %zu, \"octets\": %llu, \"len_min\": %u, \"len_max\": %u, \"distribution\": \"%s\", \"graine\": %llu, \"secondes\": %.3f},\n",
+            params->nbmots, (unsigned long long)octets_dict, params->len_min, params->len_max, params->normale ? "normale" : "uniforme",
+            (unsigned long long)params->graine, secondes_depuis(debut));
+
+    // -G par algo : lecture, hachage et écriture texte en flux
+    fprintf(json, "  \"generation\": [");
+    for (int a = 0; a < params->nbalgo; ++a){
+        char *algo = params->algos[a];
+        char sortie[4096];
+        snprintf(nom, sizeof nom, "gen_%s.t3c", algo);
+        chemin_travail(params, nom, sortie, sizeof sortie);
+        size_t nbobj = 0, nbdoublons = 0;
+        debut = horloge_ns();
+        if (dict_to_t3c_flux(dict, &algo, 1, sortie, params->nbthreads, 1, &nbobj, &nbdoublons) != 0){
+            printf("rainc_bench.c : ERREUR > La fonction dict_to_t3c_flux a échoué (%s)\n", algo);
+            return -1;
+        }
+        double duree = secondes_depuis(debut);
+        uint64_t octets = taille_fichier(sortie);
+        fprintf(json, "%s\n    {\"algo\": \"%s\", \"entrees\": %zu, \"secondes\": %.3f, \"hachages_par_s\": %.0f, \"octets\": %llu, \"mo_par_s\": %.1f}",
+                a ? "," : "", algo, nbobj, duree, duree > 0 ? (double)nbobj / duree : 0.0,
+                (unsigned long long)octets, duree > 0 ? (double)octets / duree / 1e6 : 0.0);
+        if (a > 0 && !params->garder)
+            unlink(sortie);
+    }
+    fprintf(json, "\n  ],\n");
+
+    // Chargement de la table texte du premier algo, puis écriture seule dans les deux formats
+    char premiere[4096];
+    snprintf(nom, sizeof nom, "gen_%s.t3c", params->algos[0]);
+    chemin_travail(params, nom, premiere, sizeof premiere);
+    t3c_table tables[T3C_SECTIONS_MAX];
+    size_t nbsection = 0;
+    debut = horloge_ns();
+    if (t3c_load(premiere, tables, &nbsection) != 0 || nbsection != 1){
+        printf("rainc_bench.c : ERREUR > La fonction t3c_load a échoué\n");
+        return -1;
+    }
+    double duree_load = secondes_depuis(debut);
+    t3c_table *table = &tables[0];
+
+    fprintf(json, "  \"ecriture\": [");
+    const char *formats[2] = {"txt", "bin"};
+    char *chemins[2] = {texte, binaire};
+    for (int f = 0; f < 2; ++f){
+        debut = horloge_ns();
+        if (create_t3c(table, 1, chemins[f], f == 0 ? T3C_FORMAT_TXT : T3C_FORMAT_BIN) != 0){
+            printf("rainc_bench.c : ERREUR > La fonction create_t3c a échoué (%s)\n", formats[f]);
+            t3c_free(table);
+            return -1;
+        }
+        double duree = secondes_depuis(debut);
+        uint64_t octets = taille_fichier(chemins[f]);
+        fprintf(json, "%s\n    {\"format\": \"%s\", \"algo\": \"%s\", \"entrees\": %zu, \"secondes\": %.3f, \"octets\": %llu, \"mo_par_s\": %.1f}",
+                f ? "," : "", formats[f], table->algo, table->nbobj, duree, (unsigned long long)octets,
+                duree > 0 ? (double)octets / duree / 1e6 : 0.0);
+    }
+    fprintf(json, "\n  ],\n");
+
+    t3c_bin bin;
+    debut = horloge_ns();
+    if (t3c_bin_open(binaire, &bin) != 0){
+        t3c_free(table);
+        return -1;
+    }
+    double duree_bin = secondes_depuis(debut);
+    fprintf(json, "  \"chargement\": {\"algo\": \"%s\", \"entrees\": %zu, \"t3c_load_s\": %.3f, \"t3c_bin_open_s\": %.6f},\n",
+            table->algo, table->nbobj, duree_load, duree_bin);
+
+    // Construction des index de la table chargée
+    const int types[3] = {T3C_INDEX_SORTED, T3C_INDEX_INTERP, T3C_INDEX_HASH};
+    const char *noms[3] = {"sorted", "interp", "hash"};
+    t3c_index *index[3] = {NULL, NULL, NULL};
+    int retour = 0;
+    fprintf(json, "  \"index\": [");
+    for (int k = 0; k < 3; ++k){
+        debut = horloge_ns();
+        index[k] = t3c_index_build(table, types[k]);
+        double duree = secondes_depuis(debut);
+        if (!index[k]){
+            printf("rainc_bench.c : ERREUR > La fonction t3c_index_build a échoué (%s)\n", noms[k]);
+            retour = -1;
+            break;
+        }
+        fprintf(json, "%s\n    {\"type\": \"%s\", \"entrees\": %zu, \"secondes\": %.3f}", k ? "," : "", noms[k], index[k]->nbobj, duree);
+    }
+    fprintf(json, "\n  ],\n");
+
+    // Latences : flux riche en trouvés puis riche en absents, sur chaque index et la colonne projetée
+    uint64_t surcout = surcout_horloge();
+    const double parts[2] = {BENCH_HIT_RICHE, BENCH_HIT_PAUVRE};
+    const char *flux[2] = {"trouves", "absents"};
+    fprintf(json, "  \"surcout_horloge_ns\": %llu,\n  \"recherche\": [", (unsigned long long)surcout);
+    int premier = 1;
+    for (int f = 0; retour == 0 && f < 2; ++f){
+        unsigned char *requetes = flux_requetes(table, params->nbrequetes, parts[f], params->graine + 1 + (uint64_t)f);
+        if (!requetes){
+            retour = -1;
+            break;
+        }
+        for (int k = 0; retour == 0 && k < 4; ++k){
+            retour = mesurer_recherches(json, k < 3 ? noms[k] : "bin", flux[f], parts[f], k < 3 ? index[k] : NULL, table, &bin,
+                                        requetes, params->nbrequetes, surcout, premier);
+            premier = 0;
+        }
+        free(requetes);
+    }
+    fprintf(json, "\n  ]\n}\n");
+
+    for (int k = 0; k < 3; ++k)
+        t3c_index_free(index[k]);
+    t3c_bin_close(&bin);
+    t3c_free(table);
+    if (!params->garder){
+        unlink(dict);
+        unlink(premiere);
+        unlink(texte);
+        unlink(binaire);
+    }
+    return retour;
+}
+
+static void bench_aide(const char *nom){
+    printf("Usage : %s [-h|--help] [--mots=<n>] [--requetes=<n>] [--len=<min-max>] [--dist=uniforme|normale]\n"
+           "          [--seed=<n>] [-j <N>] [-a <algo>]... [--dir=<dossier>] [-o <resultats.json>] [--garder]\n"
+           "  --mots : mots du dictionnaire synthétique [%d] (ex : 1000000, 10000000, 100000000)\n"
+           "  --requetes : requêtes par flux de recherche [%d]\n"
+           "  --len : longueurs des mots [%d-%d], --dist : leur distribution [uniforme]\n"
+           "  -a : algo mesuré en -G, répétable [sha256 sha512 blake2b512 sha3-256] ;\n"
+           "       le premier sert au chargement, aux index et aux recherches\n"
+           "  --dir : fichiers de travail [lab/bench], -o : JSON des résultats [<dir>/bench.json, - = stdout]\n"
+           "  --garder : conserve le dictionnaire et les tables générés\n",
+           nom, BENCH_MOTS, BENCH_REQUETES, BENCH_LEN_MIN, BENCH_LEN_MAX);
+}
+
+// Lit un entier décimal de [min, max] ; -1 si le texte n'en est pas un
+static int lire_nombre(const char *texte, uint64_t min, uint64_t max, uint64_t *valeur){
+    char *fin = NULL;
+    if (texte[0] < '0' || texte[0] > '9')
+        return -1;
+    unsigned long long nb = strtoull(texte, &fin, 10);
+    if (*fin != '\0' || nb < min || nb > max)
+        return -1;
+    *valeur = nb;
+    return 0;
+}
+
+int main(int argc, char **argv){
+    bench_params params = {
+        .nbmots = BENCH_MOTS, .nbrequetes = BENCH_REQUETES, .len_min = BENCH_LEN_MIN, .len_max = BENCH_LEN_MAX,
+        .graine = BENCH_SEED, .nbthreads = 1, .dossier = "lab/bench",
+    };
+    uint64_t valeur = 0;
+    for (int i = 1; i < argc; ++i){
+        if (strncmp(argv[i], "--mots=", 7) == 0 && lire_nombre(argv[i] + 7, 1, (uint64_t)1 << 40, &valeur) == 0)
+            params.nbmots = (size_t)valeur;
+        else if (strncmp(argv[i], "--requetes=", 11) == 0 && lire_nombre(argv[i] + 11, 1, (uint64_t)1 << 32, &valeur) == 0)
+            params.nbrequetes = (size_t)valeur;
+        else if (strncmp(argv[i], "--len=", 6) == 0){
+            unsigned int min = 0, max = 0;
+            if (sscanf(argv[i] + 6, "%u-%u", &min, &max) != 2 || min == 0 || min > max || max > 255){
+                printf("rainc_bench.c : ERREUR > Longueurs invalides '%s' (1 à 255)\n", argv[i] + 6);
+                return -1;
+            }
+            params.len_min = min;
+            params.len_max = max;
+        }
+        else if (strcmp(argv[i], "--dist=uniforme") == 0)
+            params.normale = 0;
+        else if (strcmp(argv[i], "--dist=normale") == 0)
+            params.normale = 1;
+        else if (strncmp(argv[i], "--seed=", 7) == 0 && lire_nombre(argv[i] + 7, 1, UINT64_MAX, &valeur) == 0)
+            params.graine = valeur;
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc && lire_nombre(argv[i + 1], 1, 1024, &valeur) == 0){
+            params.nbthreads = (int)valeur;
+            i++;
+        }
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc && params.nbalgo < BENCH_ALGOS && EVP_get_digestbyname(argv[i + 1])){
+            params.algos[params.nbalgo++] = argv[i + 1];
+            i++;
+        }
+        else if (strncmp(argv[i], "--dir=", 6) == 0 && argv[i][6] != '\0')
+            params.dossier = argv[i] + 6;
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+            params.sortie = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--garder") == 0)
+            params.garder = 1;
+        else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0){
+            bench_aide(argv[0]);
+            return 0;
+        }
+        else {
+            printf("rainc_bench.c : ERREUR > Option invalide : %s\n", argv[i]);
+            bench_aide(argv[0]);
+            return -1;
+        }
+    }
+    if (params.nbalgo == 0){
+        for (int a = 0; a < BENCH_ALGOS; ++a)
+            params.algos[a] = (char*)algos_defaut[a];
+        params.nbalgo = BENCH_ALGOS;
+    }
+    if (mkdir(params.dossier, 0755) != 0 && access(params.dossier, W_OK) != 0){
+        printf("rainc_bench.c : ERREUR > Le dossier de travail '%s' est inaccessible\n", params.dossier);
+        return -1;
+    }
+
+    char sortie[4096];
+    if (params.sortie == NULL){
+        chemin_travail(&params, "bench.json", sortie, sizeof sortie);
+        params.sortie = sortie;
+    }
+    FILE *json = strcmp(params.sortie, "-") == 0 ? stdout : fopen(params.sortie, "w");
+    if (!json){
+        printf("rainc_bench.c : ERREUR > Impossible de créer '%s'\n", params.sortie);
+        return -1;
+    }
+    int retour = bench_executer(&params, json);
+    if (json != stdout && fclose(json) != 0)
+        retour = -1;
+    if (retour == 0 && json != stdout)
+        printf("Banc terminé : résultats dans %s\n", params.sortie);
+    return retour;
+}
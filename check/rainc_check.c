@@ -0,0 +1,270 @@
+/**
+ * rainc_check.c - Vérification des noyaux de hachage de Rain-C (make check)
+ *  - Hache les mots d'un dictionnaire (lab/rockyou_1000.txt par défaut) et des messages
+ *    aléatoires de longueurs autour des limites d'un seul bloc (55 octets en sha256, 111 en
+ *    sha512) avec hasher_batch, en forçant tour à tour chaque noyau multi-buffer supporté par
+ *    le processeur (AVX-512, AVX2, SHA-NI), puis sans noyau (OpenSSL seul, tous les algos)
+ *  - Les lots ont des tailles variées pour passer aussi par les voies factices du dernier groupe
+ *  - Compare chaque condensat à EVP_Digest : chaque écart est affiché et le programme échoue
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <openssl/evp.h>
+
+#include "hash.h"
+
+#define CHECK_MESSAGES   20000      // messages aléatoires par défaut
+#define CHECK_SEED       42
+#define CHECK_AUTOUR     8          // écart maximal à une limite d'un bloc des messages aléatoires
+#define CHECK_TAILLE_MAX 130        // toutes les tailles de 0 à CHECK_TAILLE_MAX sont hachées une fois
+#define CHECK_LOT_MAX    37         // messages par lot : 1, 2, ... CHECK_LOT_MAX puis de nouveau 1
+#define CHECK_ECARTS_MAX 10         // écarts affichés par noyau
+
+static const char *algos_scalaires[] = {"sha256", "sha512", "blake2b512", "sha3-256"};
+static const uint32_t limites[] = {55, 111};
+
+// Messages à hacher, rangés à la suite dans octets
+typedef struct {
+    unsigned char *octets;
+    size_t taille;
+    size_t capacite;
+    size_t *debuts;
+    uint32_t *tailles;
+    size_t nb;
+    size_t capacite_nb;
+} check_messages;
+
+// Générateur xorshift64* : la même graine redonne les mêmes messages
+static uint64_t aleatoire(uint64_t *etat){
+    *etat ^= *etat >> 12;
+    *etat ^= *etat << 25;
+    *etat ^= *etat >> 27;
+    return *etat * 0x2545F4914F6CDD1DULL;
+}
+
+static int messages_ajouter(check_messages *m, const void *data, uint32_t taille){
+    if (m->nb == m->capacite_nb){
+        size_t capacite = m->capacite_nb ? m->capacite_nb * 2 : 1024;
+        size_t *debuts = realloc(m->debuts, capacite * sizeof *debuts);
+        if (debuts)
+            m->debuts = debuts;
+        uint32_t *tailles = realloc(m->tailles, capacite * sizeof *tailles);
+        if (tailles)
+            m->tailles = tailles;
+        if (!debuts || !tailles){
+            printf("rainc_check.c : ERREUR > realloc des messages (%zu)\n", capacite);
+            return -1;
+        }
+        m->capacite_nb = capacite;
+    }
+    if (m->taille + taille > m->capacite){
+        size_t capacite = m->capacite ? m->capacite * 2 : 65536;
+        while (capacite < m->taille + taille)
+            capacite *= 2;
+        unsigned char *octets = realloc(m->octets, capacite);
+        if (!octets){
+            printf("rainc_check.c : ERREUR > realloc des messages (%zu octets)\n", capacite);
+            return -1;
+        }
+        m->octets = octets;
+        m->capacite = capacite;
+    }
+    memcpy(m->octets + m->taille, data, taille);
+    m->debuts[m->nb] = m->taille;
+    m->tailles[m->nb++] = taille;
+    m->taille += taille;
+    return 0;
+}
+
+// Ajoute les mots non vides du dictionnaire path, sans les \r et \n de fin de ligne
+static int messages_dictionnaire(check_messages *m, const char *path){
+    FILE *f = fopen(path, "r");
+    if (!f){
+        printf("rainc_check.c : ERREUR > Impossible d'ouvrir le dictionnaire '%s'\n", path);
+        return -1;
+    }
+    char *ligne = NULL;
+    size_t capacite = 0;
+    ssize_t lu;
+    int retour = 0;
+    while (retour == 0 && (lu = getline(&ligne, &capacite, f)) != -1){
+        size_t taille = (size_t)lu;
+        while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r'))
+            taille--;
+        if (taille > 0)
+            retour = messages_ajouter(m, ligne, (uint32_t)taille);
+    }
+    free(ligne);
+    fclose(f);
+    return retour;
+}
+
+/* Ajoute un message aléatoire de chaque taille de 0 à CHECK_TAILLE_MAX, puis nb messages dont
+   la taille est tirée à CHECK_AUTOUR octets au plus d'une limite d'un bloc (55 ou 111)
+*/
+static int messages_aleatoires(check_messages *m, size_t nb, uint64_t graine){
+    unsigned char message[CHECK_TAILLE_MAX + CHECK_AUTOUR + 1];
+    uint64_t etat = graine;
+    for (size_t i = 0; i <= CHECK_TAILLE_MAX + nb; ++i){
+        uint32_t taille = (uint32_t)i;
+        if (i > CHECK_TAILLE_MAX){
+            uint32_t limite = limites[aleatoire(&etat) % 2];
+            taille = limite - CHECK_AUTOUR + (uint32_t)(aleatoire(&etat) % (2 * CHECK_AUTOUR + 1));
+        }
+        for (uint32_t k = 0; k < taille; ++k)
+            message[k] = (unsigned char)aleatoire(&etat);
+        if (messages_ajouter(m, message, taille) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Hache tous les messages avec hasher_batch et le noyau simd forcé (NULL : OpenSSL seul) puis
+   compare chaque condensat à EVP_Digest
+   - Renvoie le nombre d'écarts, -1 en cas d'erreur
+*/
+static long verifier(const check_messages *m, const char *algo, const hash_simd *simd){
+    hasher *h = hasher_new(algo);
+    const EVP_MD *md = EVP_get_digestbyname(algo);
+    unsigned char *lot = malloc(m->taille + CHECK_LOT_MAX * sizeof(uint32_t));
+    unsigned char *digests = malloc((size_t)CHECK_LOT_MAX * EVP_MAX_MD_SIZE);
+    if (!h || !md || !lot || !digests){
+        printf("rainc_check.c : ERREUR > Initialisation du hachage %s à échoué\n", algo);
+        hasher_free(h);
+        free(lot);
+        free(digests);
+        return -1;
+    }
+    h->simd = simd;
+
+    long ecarts = 0;
+    size_t nblot = 1;
+    for (size_t i = 0; i < m->nb; i += nblot, nblot = nblot % CHECK_LOT_MAX + 1){
+        size_t nb = m->nb - i < nblot ? m->nb - i : nblot;
+        size_t remplissage = 0;
+        for (size_t j = 0; j < nb; ++j)
+            remplissage += hasher_lot_ajouter(lot + remplissage, m->octets + m->debuts[i + j], m->tailles[i + j]);
+        if (hasher_batch(h, lot, nb, digests) != 0){
+            ecarts = -1;
+            break;
+        }
+        for (size_t j = 0; j < nb; ++j){
+            unsigned char attendu[EVP_MAX_MD_SIZE];
+            unsigned int taille = 0;
+            if (!EVP_Digest(m->octets + m->debuts[i + j], m->tailles[i + j], attendu, &taille, md, NULL)){
+                printf("rainc_check.c : ERREUR > EVP_Digest %s à échoué\n", algo);
+                ecarts = -1;
+                break;
+            }
+            if (memcmp(attendu, digests + j * h->digest_taille, taille) == 0)
+                continue;
+            if (++ecarts <= CHECK_ECARTS_MAX){
+                char hex_attendu[EVP_MAX_MD_SIZE * 2 + 1];
+                char hex_obtenu[EVP_MAX_MD_SIZE * 2 + 1];
+                bin_to_hex(attendu, taille, hex_attendu);
+                bin_to_hex(digests + j * h->digest_taille, taille, hex_obtenu);
+                printf("rainc_check.c : ERREUR > %s / %s : message %zu (%u octets) : %s au lieu de %s\n",
+                       algo, simd ? simd->nom : "openssl", i + j, m->tailles[i + j], hex_obtenu, hex_attendu);
+            }
+        }
+        if (ecarts < 0)
+            break;
+    }
+    hasher_free(h);
+    free(lot);
+    free(digests);
+    return ecarts;
+}
+
+static void check_aide(const char *nom){
+    printf("Usage : %s [-h|--help] [<dictionnaire>] [--messages=<n>] [--seed=<n>]\n"
+           "  <dictionnaire> : mots hachés en plus des messages aléatoires [lab/rockyou_1000.txt]\n"
+           "  --messages : messages aléatoires autour des limites de 55 et 111 octets [%d]\n"
+           "  --seed : graine des messages aléatoires [%d]\n",
+           nom, CHECK_MESSAGES, CHECK_SEED);
+}
+
+// Lit un entier décimal de [min, max] ; -1 si le texte n'en est pas un
+static int lire_nombre(const char *texte, uint64_t min, uint64_t max, uint64_t *valeur){
+    char *fin = NULL;
+    if (texte[0] < '0' || texte[0] > '9')
+        return -1;
+    unsigned long long nb = strtoull(texte, &fin, 10);
+    if (*fin != '\0' || nb < min || nb > max)
+        return -1;
+    *valeur = nb;
+    return 0;
+}
+
+int main(int argc, char **argv){
+    const char *dict = "lab/rockyou_1000.txt";
+    size_t nbaleatoire = CHECK_MESSAGES;
+    uint64_t graine = CHECK_SEED;
+    uint64_t valeur = 0;
+    for (int i = 1; i < argc; ++i){
+        if (strncmp(argv[i], "--messages=", 11) == 0 && lire_nombre(argv[i] + 11, 0, (uint64_t)1 << 32, &valeur) == 0)
+            nbaleatoire = (size_t)valeur;
+        else if (strncmp(argv[i], "--seed=", 7) == 0 && lire_nombre(argv[i] + 7, 1, UINT64_MAX, &valeur) == 0)
+            graine = valeur;
+        else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0){
+            check_aide(argv[0]);
+            return 0;
+        }
+        else if (argv[i][0] != '-')
+            dict = argv[i];
+        else {
+            printf("rainc_check.c : ERREUR > Option invalide : %s\n", argv[i]);
+            check_aide(argv[0]);
+            return -1;
+        }
+    }
+
+    check_messages m = {0};
+    int retour = messages_dictionnaire(&m, dict);
+    if (retour == 0)
+        retour = messages_aleatoires(&m, nbaleatoire, graine);
+    if (retour == 0)
+        printf("Vérification de hasher_batch sur %zu messages (%s + %zu aléatoires autour de 55 et 111 octets)\n", m.nb, dict, nbaleatoire);
+
+    // Chaque noyau multi-buffer supporté, forcé sans la vérification de hash_simd_get
+    long total = 0;
+    int disponible = 0;
+    const hash_simd *noyau;
+    for (size_t n = 0; retour == 0 && (noyau = hash_simd_noyau(n, &disponible)) != NULL; ++n){
+        if (!disponible){
+            printf("  %-10s %-7s : ignoré, non supporté par le processeur\n", noyau->algo, noyau->nom);
+            continue;
+        }
+        long ecarts = verifier(&m, noyau->algo, noyau);
+        if (ecarts < 0)
+            retour = -1;
+        else {
+            printf("  %-10s %-7s : %s (%u voies, %ld écarts)\n", noyau->algo, noyau->nom, ecarts ? "ECHEC" : "ok", noyau->lanes, ecarts);
+            total += ecarts;
+        }
+    }
+    // Sans noyau : OpenSSL seul, pour tous les algos
+    for (size_t a = 0; retour == 0 && a < sizeof algos_scalaires / sizeof algos_scalaires[0]; ++a){
+        long ecarts = verifier(&m, algos_scalaires[a], NULL);
+        if (ecarts < 0)
+            retour = -1;
+        else {
+            printf("  %-10s %-7s : %s (%ld écarts)\n", algos_scalaires[a], "openssl", ecarts ? "ECHEC" : "ok", ecarts);
+            total += ecarts;
+        }
+    }
+
+    if (retour == 0 && total > 0){
+        printf("rainc_check.c : ERREUR > %ld condensats diffèrent d'EVP_Digest\n", total);
+        retour = -1;
+    }
+    if (retour == 0)
+        printf("Vérification terminée : tous les condensats sont conformes\n");
+    free(m.octets);
+    free(m.debuts);
+    free(m.tailles);
+    return retour;
+}
@@ -1,9 +1,13 @@
 /**
  * control_T3C.c - Gestion de la table T3C et de la recherche
- *  - Lecture/écriture d'une table T3C
- *  - Stockage en mémoire dans une structure t3c_table
- *  - Construction d'un index de recherche sur le champ hash
+ *  - Lecture/écriture d'une table T3C (texte écrit par t3c_ecrivain.c, ou binaire via t3c_bin.c)
+ *  - Stockage en mémoire dans une structure t3c_table en colonnes (condensats bruts, offsets, blob des mdp)
+ *  - Construction d'un index de recherche sur le champ hash (t3c_index.c)
+ *  - Table ouverte pour la recherche (t3c_source), partagée par le mode -L et le serveur --serve
  *  - Recherche d'un hash (mode -L), éventuellement en lisant des hashes depuis stdin.
+ *  - Filtre de Bloom optionnel (<table>.bf, t3c_bloom.c) consulté avant l'index
+ *  - Table découpée par préfixe (t3c_shard.c) : seuls les shards touchés sont ouverts
+ *  - Conversion texte <-> binaire (mode -C)
  *
  */
 
@@ -12,20 +16,48 @@
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "control_T3C.h"
-
-/* Duplique une chaîne de caractere pour récuperer sa valeur et non l'adresse de la table
-    - Alloue un nouveau buffer de taille strlen(str)+1
-    - Copie le contenu, renvoie le pointeur alloué (ou NULL en cas d'échec)
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "t3c_bloom.h"
+#include "t3c_shard.h"
+#include "t3c_runs.h"
+#include "t3c_stats.h"
+#include "hash.h"
+
+/* Copie taille octets de mdp à la fin du blob, terminés par '\0'
+    - la capacité double quand le blob est plein : O(log n) allocations pour toute la table
+    - offset reçoit la position de la copie dans le blob
 */
-char *keepStr(char *str){
-    size_t taille = strlen(str);
-    char *str_cp = (char*)malloc(taille + 1);
-    if (!str_cp) 
-        return NULL;
-    memcpy(str_cp, str, taille + 1);
-    return str_cp;
+int t3c_blob_ajouter(t3c_blob *blob, const char *mdp, size_t taille, uint64_t *offset){
+    if (blob->capacite - blob->taille < taille + 1){
+        size_t capacite = blob->capacite ? blob->capacite : T3C_BLOB_INITIAL;
+        while (capacite - blob->taille < taille + 1)
+            capacite *= 2;
+        char *data = realloc(blob->data, capacite);
+        if (!data){
+            printf("control_t3c.c : ERREUR > realloc du blob des mdp (%zu)\n", capacite);
+            return -1;
+        }
+        blob->data = data;
+        blob->capacite = capacite;
+    }
+    memcpy(blob->data + blob->taille, mdp, taille);
+    blob->data[blob->taille + taille] = '\0';
+    *offset = blob->taille;
+    blob->taille += taille + 1;
+    return 0;
+}
+
+// Libère le blob et le remet à vide
+void t3c_blob_free(t3c_blob *blob){
+    free(blob->data);
+    blob->data = NULL;
+    blob->taille = 0;
+    blob->capacite = 0;
 }
 
 /* Découpe une ligne T3C en place et renvoie un pointeur vers le mdp
@@ -45,7 +77,7 @@ char *parse_t3c(char *ligne){
     
     size_t taille_password = strlen(password);
     while (taille_password > 0 && (password[taille_password-1] == '\n' || password[taille_password-1] == '\r')) 
-        password[taille_password--] = '\0';
+        password[--taille_password] = '\0';
     while (*password == ' ' || *password == '\t') 
         password++;
 
@@ -55,170 +87,352 @@ char *parse_t3c(char *ligne){
     return password;
 }
 
-/* Affiche une barre de progression sur une seule ligne
+/* Affiche une barre de progression sur une seule ligne de stderr
    - nbligneDone / nbligneMax -> pourcentage calculé.
    - Si printText non vide il sera affiché à droite des compteurs 
+   - Rendu limité en fréquence et coupé hors terminal (t3c_progression_afficher)
 */
 void progress_bar(size_t nbligneDone, size_t nbligneMax, char *printText){
     if (!nbligneMax){
         printf("control_t3c.c : ERREUR > Le dictionnaire transmis est vide ou une erreur est arrivé au calcul du nombre de ligne du dictionnaire\n");
         return;
     }
-    unsigned int larg = 50;
-    unsigned int loading = nbligneDone * larg / nbligneMax;
-    int pourcentage = nbligneDone * 100  / nbligneMax;
-    char *space = "";
-    char *text  = "";
-
-    printf("\r{");
-    for (unsigned int i = 0; i < loading; ++i) 
-        printf("=");
-    for (unsigned int i = loading; i < larg; ++i) 
-        printf("-");
-    if (printText && printText[0] != '\0') {
-        space = " ";
-        text  = printText;
-    }
-    printf("} %3d%% [%zu / %zu]%s%s", pourcentage, nbligneDone, nbligneMax, space, text);
-    if (nbligneDone >= nbligneMax) 
-        printf("\n");
+    t3c_progression_afficher(nbligneDone, nbligneMax, printText);
+}
+
+/* Lit l'algo d'un en-tête "# T3C<TAB>algo=..." (chaîne vide si l'en-tête n'en donne pas) */
+static void entete_algo(const char *ligne, char algo[T3C_ALGO_MAX]){
+    const char *debut = strstr(ligne, "algo=");
+    size_t taille_algo = 0;
+    if (debut){
+        debut += strlen("algo=");
+        taille_algo = strcspn(debut, "\t ");
+        if (taille_algo >= T3C_ALGO_MAX)
+            taille_algo = T3C_ALGO_MAX - 1;
+        memcpy(algo, debut, taille_algo);
+    }
+    algo[taille_algo] = '\0';
 }
 
-/* Compte les lignes dans un fichier T3C pour estimer la progression et pré-allouer la table
+/* Renvoie la section de l'algo dans tables, créée vide si elle n'existe pas encore
+   - Renvoie -1 si la table a déjà T3C_SECTIONS_MAX sections
+*/
+static int t3c_section(t3c_table *tables, size_t *nbsection, const char *algo){
+    for (size_t s = 0; s < *nbsection; ++s){
+        if (strcmp(tables[s].algo, algo) == 0)
+            return (int)s;
+    }
+    if (*nbsection == T3C_SECTIONS_MAX){
+        printf("control_t3c.c : ERREUR > La table contient plus de %d sections (une par algo)\n", T3C_SECTIONS_MAX);
+        return -1;
+    }
+    t3c_init(&tables[*nbsection]);
+    snprintf(tables[*nbsection].algo, sizeof tables[*nbsection].algo, "%s", algo);
+    return (int)(*nbsection)++;
+}
+
+/* Compte les lignes de chaque section d'un fichier T3C pour pré-allouer les tables
+   - Un en-tête "# T3C<TAB>algo=..." ouvre la section de cet algo ; un en-tête répété du même
+     algo la complète, les lignes placées avant tout en-tête forment une section sans algo
    - Une ligne valide est non vide et contient au moins une tabulation \t
+   - Le compte de chaque section est rangé dans son maxSize, le total dans nbligneMax
    - rewind() le fichier avant de retourner.
-   - Retourne le nombre de lignes valides. 
 */
-size_t count_lignes(FILE *fichier){
+int count_lignes(FILE *fichier, t3c_table *tables, size_t *nbsection, size_t *nbligneMax){
     char *ligne = NULL;
     size_t taille_buf  = 0; //gestion du malloc automatique avec get ligne, gere le malloc de ligne
     ssize_t taille =0;
-    size_t nbligneMax = 0;
+    int courante = -1;
+    int retour = 0;
+    *nbligneMax = 0;
 
     while ((taille = getline(&ligne, &taille_buf, fichier)) != -1){
         while (taille > 0 && (ligne[taille-1] == '\n' || ligne[taille-1] == '\r')) 
-            ligne[taille--] = '\0';
+            ligne[--taille] = '\0';
         if (taille == 0) 
             continue; 
+        if (ligne[0] == '#'){
+            char algo[T3C_ALGO_MAX];
+            entete_algo(ligne, algo);
+            if ((courante = t3c_section(tables, nbsection, algo)) < 0){
+                retour = -1;
+                break;
+            }
+            continue;
+        }
         if (strchr(ligne, '\t') == NULL)
             continue;
-        nbligneMax++;
-
+        if (courante < 0 && (courante = t3c_section(tables, nbsection, "")) < 0){
+            retour = -1;
+            break;
+        }
+        tables[courante].maxSize++;
+        (*nbligneMax)++;
     }
     free(ligne);
     rewind(fichier);
-    return nbligneMax;
+    return retour;
 }
 
 // Initialise une table T3C vide
 void t3c_init(t3c_table *table){
-    table->items  = NULL;
+    table->digests = NULL;
+    table->offsets = NULL;
+    table->blob.data = NULL;
+    table->blob.taille = 0;
+    table->blob.capacite = 0;
     table->nbobj  = 0;
     table->maxSize= 0;
+    table->digest_taille = 0;
+    table->algo[0]= '\0';
+}
+
+/* Réserve maxSize entrées
+   - digest_taille = 0 si la taille des condensats n'est pas encore connue (lecture d'un
+     fichier texte) : la colonne est alors allouée au premier t3c_add
+*/
+int t3c_alloc(t3c_table *table, size_t maxSize, unsigned int digest_taille){
+    table->offsets = (uint64_t*)malloc((maxSize ? maxSize : 1) * sizeof *table->offsets);
+    if (digest_taille)
+        table->digests = (unsigned char*)malloc((maxSize ? maxSize : 1) * digest_taille);
+    if (!table->offsets || (digest_taille && !table->digests)){
+        printf("control_t3c.c : ERREUR > malloc table (%zu)\n", maxSize);
+        t3c_free(table);
+        return -1;
+    }
+    table->maxSize = maxSize;
+    table->digest_taille = digest_taille;
+    return 0;
 }
 
 /* Libère toutes les allocations liées à la table :
-   - Libère pour chaque entrée les champs mdp et hash_hex 
-   - Libère le tableau items
+   - Libère la colonne des condensats, les offsets et le blob des mdp
    - Ré-initialise la structure à l'état vide.
 */
 void t3c_free(t3c_table *table){
-    for (size_t i = 0; i < table->nbobj; ++i){
-        free(table->items[i].mdp);
-        free(table->items[i].hash_hex);
-    }
-    free(table->items);
+    free(table->digests);
+    free(table->offsets);
+    t3c_blob_free(&table->blob);
     t3c_init(table);
 }
 
-/* Ajoute une entrée du couple hash et mdp dans la table
-   - Duplique mdp et hash_hex (pour ne pas dépendre de tampons temporaires) 
+/* Ajoute une entrée du couple condensat et mdp à la suite de la table
+   - Copie le condensat brut dans la colonne et le mdp dans le blob (pour ne pas dépendre de tampons temporaires) 
+   - Tous les condensats d'une table ont la même taille
 */
-int t3c_add(t3c_table *table, char *mdp, char *hash_hex){
+int t3c_add(t3c_table *table, const char *mdp, size_t taille_mdp, const unsigned char *digest, unsigned int digest_taille){
     /* 1) Vérifie la capacité : plus de réalloc ici */
     if (table->nbobj >= table->maxSize){
         printf("control_t3c.c : ERREUR > capacité insuffisante (nbobj=%zu, maxSize=%zu)\n",table->nbobj, table->maxSize);
         return -1;
     }
-
-    char *password = keepStr(mdp);
-    char *hash = keepStr(hash_hex);
-    if (!password || !hash){
-        free(password);
-        free(hash);
-        return -1; 
+    if (table->digests == NULL){
+        table->digests = (unsigned char*)malloc(table->maxSize * digest_taille);
+        if (!table->digests){
+            printf("control_t3c.c : ERREUR > malloc des condensats (%zu)\n", table->maxSize);
+            return -1;
+        }
+        table->digest_taille = digest_taille;
+    }
+    if (digest_taille != table->digest_taille){
+        printf("control_t3c.c : ERREUR > Condensat de %u octets dans une table de condensats de %u octets\n", digest_taille, table->digest_taille);
+        return -1;
     }
 
-    table->items[table->nbobj].mdp = password;
-    table->items[table->nbobj].hash_hex = hash;
+    if (t3c_blob_ajouter(&table->blob, mdp, taille_mdp, &table->offsets[table->nbobj]) != 0)
+        return -1; 
+    memcpy(table->digests + table->nbobj * digest_taille, digest, digest_taille);
     table->nbobj++;
     return 0;
 }
 
-/* Écrit la table T3C dans un fichier texte
-   - Ajoute un en-tête avec le nom d'algorithme
+/* Range une entrée à la position pos d'une table pré-allouée (t3c_alloc avec la taille des condensats)
+   - Utilisé par les threads de hachage : chacun remplit ses propres cases, sans verrou,
+     et copie les mdp dans son propre blob ; l'offset est relatif à ce blob jusqu'à t3c_joindre
+   - mdp n'a pas besoin d'être terminé par '\0' : taille_mdp octets sont copiés
+*/
+int t3c_set(t3c_table *table, t3c_blob *blob, size_t pos, const char *mdp, size_t taille_mdp, const unsigned char *digest){
+    if (pos >= table->maxSize){
+        printf("control_t3c.c : ERREUR > case hors de la table (pos=%zu, maxSize=%zu)\n", pos, table->maxSize);
+        return -1;
+    }
+    if (t3c_blob_ajouter(blob, mdp, taille_mdp, &table->offsets[pos]) != 0)
+        return -1; 
+    memcpy(table->digests + pos * table->digest_taille, digest, table->digest_taille);
+    return 0;
+}
+
+/* Rattache à la table le blob d'un thread qui a rempli les cases [debut, debut + nb)
+   - le premier blob est repris tel quel, les suivants sont recopiés à la fin
+     et les offsets de leurs cases décalés d'autant
+   - blob est libéré dans tous les cas
+*/
+int t3c_joindre(t3c_table *table, t3c_blob *blob, size_t debut, size_t nb){
+    if (table->blob.data == NULL){
+        table->blob = *blob;
+        blob->data = NULL;
+        t3c_blob_free(blob);
+        return 0;
+    }
+
+    uint64_t base = table->blob.taille;
+    int retour = 0;
+    if (blob->taille > 0){
+        uint64_t offset = 0;
+        // Le dernier octet copié par t3c_blob_ajouter est le '\0' final du blob source
+        if (t3c_blob_ajouter(&table->blob, blob->data, blob->taille - 1, &offset) != 0)
+            retour = -1;
+        for (size_t i = debut; retour == 0 && i < debut + nb; ++i)
+            table->offsets[i] += base;
+    }
+    t3c_blob_free(blob);
+    return retour;
+}
+
+// --stats : écriture d'une table de nbobj entrées commencée à debut, taille lue sur le disque
+static void create_t3c_stats(const char *path, size_t nbobj, uint64_t debut){
+    struct stat st;
+    if (!t3c_stats_actives)
+        return;
+    t3c_stats_phase(T3C_STATS_ECRITURE, debut);
+    t3c_stats_compter(T3C_STATS_ENTREES_ECRITES, nbobj);
+    if (stat(path, &st) == 0)
+        t3c_stats_compter(T3C_STATS_OCTETS_ECRITS, (uint64_t)st.st_size);
+}
+
+// Écrit l'en-tête d'une T3C texte (nom d'algorithme et colonnes)
+int t3c_txt_entete(t3c_ecrivain *ecr, const char *algo_name){
+    char entete[T3C_ALGO_MAX + 64];
+    int taille = snprintf(entete, sizeof entete, "# T3C\talgo=%s\tCols: hash\tdisplay\n", algo_name);
+    return t3c_ecrivain_ajouter(ecr, entete, (size_t)taille);
+}
+
+/* Écrit la ligne "hash<TAB>mdp" de l'entrée i, formatée directement dans le tampon de l'écrivain
+   - un mdp trop long pour un tampon est recopié morceau par morceau
+*/
+static int create_t3c_ligne(t3c_ecrivain *ecr, const t3c_table *table, size_t i){
+    const char *mdp = t3c_mdp(table, i);
+    size_t taille_mdp = strlen(mdp);
+    size_t taille_hex = 2 * (size_t)table->digest_taille;
+    char *ligne = t3c_ecrivain_reserver(ecr, taille_hex + taille_mdp + 2);
+    if (ligne){
+        // bin_to_hex termine par '\0', remplacé aussitôt par la tabulation
+        bin_to_hex((unsigned char*)t3c_digest(table, i), table->digest_taille, ligne);
+        ligne[taille_hex] = '\t';
+        memcpy(ligne + taille_hex + 1, mdp, taille_mdp);
+        ligne[taille_hex + 1 + taille_mdp] = '\n';
+        t3c_ecrivain_avancer(ecr, taille_hex + taille_mdp + 2);
+        return 0;
+    }
+    if (ecr->erreur)
+        return -1;
+    char h[EVP_MAX_MD_SIZE * 2 + 2];
+    bin_to_hex((unsigned char*)t3c_digest(table, i), table->digest_taille, h);
+    h[taille_hex] = '\t';
+    if (t3c_ecrivain_ajouter(ecr, h, taille_hex + 1) != 0 || t3c_ecrivain_ajouter(ecr, mdp, taille_mdp) != 0)
+        return -1;
+    return t3c_ecrivain_ajouter(ecr, "\n", 1);
+}
+
+/* Écrit les sections de la table T3C dans un fichier texte ou binaire selon format
+   - En texte, chaque section commence par son en-tête (nom d'algorithme), suivi de ses lignes
+   - Texte : lignes formatées à la main dans les tampons de t3c_ecrivain, fichier réservé
+     d'avance à sa taille maximale (blob des mdp compris)
    - Affiche une barre de progression pendant l'écriture
 */
-int create_t3c(const t3c_table *table, char *path, char *algo_name){
-    FILE *fichier = fopen(path, "w");
-    if (!fichier){
+int create_t3c(const t3c_table *tables, size_t nbsection, char *path, int format){
+    uint64_t debut = t3c_stats_debut();
+    size_t nbLigneMax = 0;
+    uint64_t prevue = 0;
+    for (size_t s = 0; s < nbsection; ++s){
+        nbLigneMax += tables[s].nbobj;
+        prevue += T3C_ALGO_MAX + 64 + tables[s].nbobj * (2 * (uint64_t)tables[s].digest_taille + 1) + tables[s].blob.taille;
+    }
+    if (format == T3C_FORMAT_BIN){
+        int retour = t3c_bin_write(tables, nbsection, path);
+        if (retour == 0)
+            create_t3c_stats(path, nbLigneMax, debut);
+        return retour;
+    }
+
+    t3c_ecrivain ecr;
+    if (t3c_ecrivain_ouvrir(&ecr, path, prevue) != 0){
         printf("control_t3c.c : ERREUR > La Table t3c est vide ou l'ouverture du fichier t3c à eu un probleme\n");
         return -1;
     }
-    fprintf(fichier, "# T3C\talgo=%s\tCols: hash\tdisplay\n",algo_name);
 
-    size_t nbLigneMax = table->nbobj;
-    int pourcentage;
-    if(nbLigneMax >= 100){
-            pourcentage = nbLigneMax / 100;
-        }else{
-            pourcentage = 1;
+    size_t pourcentage = nbLigneMax >= 100 ? nbLigneMax / 100 : 1;
+    size_t prochain = pourcentage;
+    size_t nbLigneDone = 0;
+    int retour = 0;
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        const t3c_table *table = &tables[s];
+        if (t3c_txt_entete(&ecr, table->algo) != 0)
+            retour = -1;
+        for (size_t i = 0; retour == 0 && i < table->nbobj; ++i){
+            if (create_t3c_ligne(&ecr, table, i) != 0)
+                retour = -1;
+            if (++nbLigneDone >= prochain || nbLigneDone == nbLigneMax){
+                progress_bar(nbLigneDone, nbLigneMax, "( Ecriture Table )");
+                prochain += pourcentage;
+            }
         }
-
-    for (size_t i = 0; i < nbLigneMax; ++i){
-        char *h = table->items[i].hash_hex;
-        char *p = table->items[i].mdp;
-        fprintf(fichier, "%s\t%s\n", h, p);
-
-        size_t nbLigneDone = i + 1;
-        if ((nbLigneDone % pourcentage) == 0 || nbLigneDone == nbLigneMax)
-            progress_bar(nbLigneDone, nbLigneMax, "( Ecriture Table )");
     }
 
-    fclose(fichier);
+    if (t3c_ecrivain_fermer(&ecr) != 0)
+        retour = -1;
+    if (retour != 0){
+        printf("control_t3c.c : ERREUR > L'écriture de la table t3c à échoué\n");
+        unlink(path);
+        return -1;
+    }
+    create_t3c_stats(path, nbLigneMax, debut);
     return 0;
 }
 
-/* Charge un fichier T3C en mémoire :
-   - Compte les lignes valides puis pré-alloue la table
-   - Lit ligne par ligne, découpe en place avec parse_t3c() et ajoute via t3c_add()
+/* Charge un fichier T3C en mémoire, une t3c_table par section (algo) :
+   - tables doit pouvoir recevoir T3C_SECTIONS_MAX sections, nbsection reçoit leur nombre
+   - Compte les lignes de chaque section puis pré-alloue chaque table
+   - Lit ligne par ligne, découpe en place avec parse_t3c(), décode le condensat hex
+     une seule fois et ajoute le condensat brut via t3c_add() dans la section courante
+   - Ignore (et compte) les lignes dont le condensat est invalide ou de la mauvaise taille
    - Affiche la progression.
 */
-int t3c_load(char *path, t3c_table *table){
+int t3c_load(char *path, t3c_table *tables, size_t *nbsection){
+    uint64_t debut = t3c_stats_debut();
+    *nbsection = 0;
     FILE *fichier = fopen(path, "r");
     if (!fichier){
         printf("control_t3c.c : ERREUR > La table est vide ou l'ouverture de la table t3C à eu un probleme\n");
         return -1;
     }
-    t3c_init(table);
 
-    size_t nbLigneMax = count_lignes(fichier);
-    if (nbLigneMax == 0){
+    size_t nbLigneMax = 0;
+    int retour = count_lignes(fichier, tables, nbsection, &nbLigneMax);
+    if (retour == 0 && nbLigneMax == 0){
         printf("control_t3c.c : ERREUR > Le fichier t3c est vide\n");
-        fclose(fichier);
-        return -1;
+        retour = -1;
     }
-    
-    table->items = (t3c_entry*)malloc(nbLigneMax * sizeof *table->items);
-    if (table->items == NULL){
-        printf("control_t3c.c : ERREUR > malloc table (%zu)\n", nbLigneMax);
+
+    // Condensats de la taille de l'algo de la section, ou de la première ligne si l'algo est inconnu
+    for (size_t s = 0; retour == 0 && s < *nbsection; ++s){
+        const EVP_MD *md = EVP_get_digestbyname(tables[s].algo);
+        char algo[T3C_ALGO_MAX];
+        memcpy(algo, tables[s].algo, sizeof algo);
+        if (t3c_alloc(&tables[s], tables[s].maxSize, md ? (unsigned int)EVP_MD_get_size(md) : 0) != 0)
+            retour = -1;
+        memcpy(tables[s].algo, algo, sizeof algo);
+    }
+    if (retour != 0){
+        for (size_t s = 0; s < *nbsection; ++s)
+            t3c_free(&tables[s]);
+        *nbsection = 0;
         fclose(fichier);
         return -1;
     }
-    table->maxSize = nbLigneMax;
-    table->nbobj   = 0;
 
     size_t nbLigneDone = 0;
+    size_t nbInvalides = 0;
     int pourcentage;
     if (nbLigneMax >= 100){
         pourcentage = (int)(nbLigneMax / 100);
@@ -229,167 +443,332 @@ int t3c_load(char *path, t3c_table *table){
     char *ligne = NULL;
     size_t taille_buf  = 0;
     ssize_t taille = 0;
-    int retour =0;
+    t3c_table *table = NULL;
     while ((taille = getline(&ligne, &taille_buf, fichier)) > 0){
         while (taille > 0 && (ligne[taille-1] == '\n' || ligne[taille-1] == '\r')) 
-            ligne[taille--] = '\0';
+            ligne[--taille] = '\0';
 
-        if (ligne[0] == '#' || ligne[0] == '\0') 
+        // L'en-tête "# T3C<TAB>algo=..." ouvre la section de son algorithme
+        if (ligne[0] == '#'){
+            char algo[T3C_ALGO_MAX];
+            entete_algo(ligne, algo);
+            table = &tables[t3c_section(tables, nbsection, algo)];
+            continue;
+        }
+        if (ligne[0] == '\0') 
             continue;
 
         char *password = parse_t3c(ligne);
         if (!password) 
             continue;
+        if (table == NULL)
+            table = &tables[t3c_section(tables, nbsection, "")];
         
-        char *hash = ligne;
-        if (t3c_add(table, password, hash) != 0) {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_taille = 0;
+        // Condensat illisible ou de la mauvaise taille : la ligne est ignorée et comptée
+        if (hex_to_bin(ligne, digest, &digest_taille) != 0
+            || (table->digest_taille != 0 && digest_taille != table->digest_taille)){
+            nbInvalides++;
+            continue;
+        }
+        if (t3c_add(table, password, strlen(password), digest, digest_taille) != 0) {
             retour = -1;
             break;
         }
         nbLigneDone++;
         if ((nbLigneDone % (size_t)pourcentage) == 0 || nbLigneDone == nbLigneMax){
-            progress_bar(nbLigneDone, nbLigneMax-1, "( Chargement T3C )");
+            progress_bar(nbLigneDone, nbLigneMax, "( Chargement T3C )");
         }
     }
-    printf("\n");
 
     free(ligne);
     fclose(fichier);
 
     if (retour != 0){
-        t3c_free(table); 
+        for (size_t s = 0; s < *nbsection; ++s)
+            t3c_free(&tables[s]);
+        *nbsection = 0;
         return -1;
     }
 
+    if (nbInvalides > 0)
+        printf("control_t3c.c : ATTENTION > %zu ligne(s) au condensat invalide ignorée(s)\n", nbInvalides);
+
+    t3c_stats_phase(T3C_STATS_CHARGEMENT, debut);
+    t3c_stats_compter(T3C_STATS_ENTREES_CHARGEES, nbLigneDone);
+    t3c_stats_compter(T3C_STATS_LIGNES_INVALIDES, nbInvalides);
     return 0;
 }
 
-/* Insertion dans l'arbre de recherche d'index :
-   - Si l'arbre est vide alloue la racine
-   - Sinon, parcourt jusqu'à trouver le noeud vide où mettre le nouveau noeud
-   - Ignore les doublons
+/* Découpe une requête "[algo:]condensat-hex" en place et décode le condensat une fois
+   - algo reçoit le préfixe (NULL sans préfixe : toutes les sections de la bonne taille)
+   - Renvoie -1 si le condensat est invalide (la requête est alors laissée intacte)
 */
-static t3c_node *t3c_index_insert(t3c_node *node, t3c_entry *table){
-    t3c_node *copy_node;
-    t3c_node *parent;
-    int comp;
-
-    if (node == NULL){
-        t3c_node *newNode = (t3c_node*)malloc(sizeof *newNode);
-        if (newNode == NULL)
-            return NULL;
+int t3c_requete_decoder(char *texte, char **algo, unsigned char *digest, unsigned int *digest_taille){
+    char *deux_points = strchr(texte, ':');
+    *algo = NULL;
+    if (deux_points == NULL)
+        return hex_to_bin(texte, digest, digest_taille);
+    *deux_points = '\0';
+    if (hex_to_bin(deux_points + 1, digest, digest_taille) != 0){
+        *deux_points = ':';
+        return -1;
+    }
+    *algo = texte;
+    return 0;
+}
+
+/* Affiche le mdp trouvé ou le message d'absence */
+static void print_result(const char *mdp){
+    if (mdp) 
+        puts(mdp);
+    else
+        printf("Le hash donnée est introuvable dans la table T3C\n");
+}
+
+/* Table ouverte pour la recherche (mode -L, serveur --serve)
+   - binaire : fichier projeté avec mmap, index optionnel construit sur chaque colonne projetée
+   - texte : sections chargées en mémoire et indexées (Eytzinger par défaut)
+   - une section par algo, chacune avec son index ; le nom d'algo route les requêtes préfixées
+   - bloom : filtre <table>.bf s'il existe et correspond encore à la table
+   - table découpée : manifeste lu à l'ouverture, chaque shard ouvert comme une table à la
+     première requête qui le touche
+*/
+struct t3c_source {
+    int binaire;
+    t3c_bin bin;
+    t3c_table tables[T3C_SECTIONS_MAX];
+    t3c_index *index[T3C_SECTIONS_MAX];
+    size_t nbsection;
+    t3c_bloom filtre;
+    const t3c_bloom *bloom;
+    t3c_manifeste *manifeste;
+    t3c_source **shards;
+    char *path;
+    int index_type;
+    t3c_source *runs[T3C_RUNS_MAX];   // runs de --append, du plus ancien au plus récent
+    unsigned int nbrun;
+};
+
+// Nom d'algo de la section s
+static const char *source_algo(const t3c_source *source, size_t s){
+    return source->binaire ? source->bin.sections[s].algo : source->tables[s].algo;
+}
+
+// Taille des condensats de la section s (0 pour une section texte vide sans algo connu)
+static unsigned int source_digest_taille(const t3c_source *source, size_t s){
+    return source->binaire ? source->bin.sections[s].digest_taille : source->tables[s].digest_taille;
+}
 
-        newNode->items = table;
-        newNode->left  = NULL;
-        newNode->right = NULL;
-        return newNode;
-    }
-
-    copy_node = node;
-    parent = NULL;
-    comp = 0;
-
-    while (copy_node != NULL){
-        parent = copy_node;
-        comp = strcmp(table->hash_hex, copy_node->items->hash_hex);
-        if (comp < 0){
-            copy_node = copy_node->left;
-        } else if (comp > 0){
-            copy_node = copy_node->right;
-        } else {
-            return node;
+// Ouvre les runs de la table, chacun comme une table ordinaire ; -1 si l'un d'eux ne s'ouvre pas
+static int source_runs(t3c_source *source, const char *t3c_path, int index_type){
+    unsigned int nbrun = t3c_runs_nb(t3c_path);
+    for (unsigned int run = 1; run <= nbrun; ++run){
+        char chemin[4096];
+        if (t3c_run_chemin(t3c_path, run, chemin, sizeof chemin) != 0)
+            return -1;
+        source->runs[source->nbrun] = t3c_source_open(chemin, index_type);
+        if (source->runs[source->nbrun] == NULL){
+            printf("control_t3c.c : ERREUR > Le run '%s' ne peut pas être ouvert\n", chemin);
+            return -1;
         }
+        source->nbrun++;
     }
+    return 0;
+}
 
-    t3c_node *newNode = (t3c_node*)malloc(sizeof *newNode);
-    if (newNode == NULL){
-        return node;
+/* Ouvre une table pour la recherche
+   - Une table binaire est projetée en mémoire, aucune analyse du fichier
+   - Par défaut aucun index n'est construit sur une table binaire : les colonnes sont déjà triées
+   - Une table texte est chargée (t3c_load) puis chaque section est indexée
+   - Une table découpée : seul le manifeste est lu, aucun shard n'est encore ouvert
+   - Les runs ajoutés par --append (t3c_runs.h) sont ouverts avec la table
+   - Renvoie NULL si la table ne peut pas être ouverte
+*/
+t3c_source *t3c_source_open(char *t3c_path, int index_type){
+    t3c_source *source = calloc(1, sizeof *source);
+    if (source == NULL){
+        printf("control_t3c.c : ERREUR > calloc de la table ouverte\n");
+        return NULL;
     }
 
-    newNode->items = table;
-    newNode->left  = NULL;
-    newNode->right = NULL;
-
-    if (comp < 0){
-        parent->left = newNode;
-    } else {
-        parent->right = newNode;
+    if (t3c_shard_is(t3c_path)){
+        source->manifeste = malloc(sizeof *source->manifeste);
+        source->path = strdup(t3c_path);
+        source->index_type = index_type;
+        if (!source->manifeste || !source->path || t3c_manifeste_lire(t3c_path, source->manifeste) != 0){
+            printf("control_t3c.c : ERREUR > La lecture du manifeste '%s' a échoué\n", t3c_path);
+            t3c_source_close(source);
+            return NULL;
+        }
+        source->shards = calloc(t3c_shard_nb(source->manifeste), sizeof *source->shards);
+        if (source->shards == NULL){
+            printf("control_t3c.c : ERREUR > calloc des shards\n");
+            t3c_source_close(source);
+            return NULL;
+        }
+        return source;
+    }
+    source->bloom = t3c_bloom_open(t3c_path, &source->filtre) == 0 ? &source->filtre : NULL;
+
+    if (t3c_bin_is(t3c_path)){
+        source->binaire = 1;
+        if (t3c_bin_open(t3c_path, &source->bin) != 0){
+            printf("control_t3c.c : ERREUR > La fonction t3c_bin_open a échoué\n");
+            source->binaire = 0;
+            t3c_source_close(source);
+            return NULL;
+        }
+        source->nbsection = source->bin.header->nbsection;
+        for (size_t s = 0; index_type != -1 && s < source->nbsection; ++s){
+            const t3c_bin_section *section = &source->bin.sections[s];
+            source->index[s] = t3c_index_new((const unsigned char*)source->bin.map + section->off_digests, section->digest_taille, section->nbobj, index_type);
+            if (source->index[s] == NULL){
+                printf("control_t3c.c : ERREUR > La fonction t3c_index_new a échoué\n");
+                t3c_source_close(source);
+                return NULL;
+            }
+        }
+        if (source_runs(source, t3c_path, index_type) != 0){
+            t3c_source_close(source);
+            return NULL;
+        }
+        return source;
     }
 
-    return node;
+    if (t3c_load(t3c_path, source->tables, &source->nbsection) != 0){
+        printf("control_t3c.c : ERREUR > La fonction t3c_load a échoué\n");
+        t3c_source_close(source);
+        return NULL;
+    }
+    for (size_t s = 0; s < source->nbsection; ++s){
+        source->index[s] = t3c_index_build(&source->tables[s], index_type == -1 ? T3C_INDEX_SORTED : index_type);
+        if (source->index[s] == NULL){
+            printf("control_t3c.c : ERREUR > La fonction t3c_index_build a échoué\n");
+            t3c_source_close(source);
+            return NULL;
+        }
+        // L'index garde sa propre copie triée des condensats : la colonne d'origine n'est plus lue
+        free(source->tables[s].digests);
+        source->tables[s].digests = NULL;
+    }
+    if (source_runs(source, t3c_path, index_type) != 0){
+        t3c_source_close(source);
+        return NULL;
+    }
+    return source;
 }
 
-/* Construit l'index BST complet à partir de la table :
-   - Insère chaque entrée du tableau
-   - Si une allocation échoue on libère ce qui a été construit et renvoie NULL
+/* Shard d'une table découpée qui peut contenir le condensat, ouvert à la première requête
+   - NULL pour un shard vide ; un shard qui ne s'ouvre pas est marqué vide (un seul message)
 */
-t3c_node *t3c_index_build(t3c_table *table){
-    t3c_node *node = NULL;
-    for (size_t i = 0; i < table->nbobj; ++i){
-        node = t3c_index_insert(node, &table->items[i]);
-        if (node == NULL){
-            t3c_index_free(node);
-            return NULL;
+static const t3c_source *source_shard(const t3c_source *source, const unsigned char *digest){
+    unsigned int shard = t3c_shard_de(source->manifeste, digest);
+    if (source->manifeste->nbobj[shard] == 0)
+        return NULL;
+    if (source->shards[shard] == NULL){
+        char chemin[4096];
+        if (t3c_shard_chemin(source->path, shard, chemin, sizeof chemin) == 0)
+            source->shards[shard] = t3c_source_open(chemin, source->index_type);
+        if (source->shards[shard] == NULL){
+            printf("control_t3c.c : ERREUR > Le shard %02x de '%s' ne peut pas être ouvert\n", shard, source->path);
+            source->manifeste->nbobj[shard] = 0;
         }
     }
-    return node;
+    return source->shards[shard];
 }
 
-/* Recherche d'un hash dans l'arbe
-   - Compare le hash recherché au hash du noeud courant et descend à gauche/droite
-   - Renvoie le pointeur vers l'entrée si trouvée sinon NULL
+/* Cherche un condensat brut dans une table ouverte
+   - runs interrogés d'abord, du plus récent au plus ancien : le mdp ajouté le plus tard l'emporte
+   - filtre présent : un condensat rejeté est absent sans lire les colonnes ni les index
+   - seules les sections de la taille du condensat sont interrogées (sha256 et sha3-256 partagent
+     la leur), et seulement celle de l'algo s'il est donné
+   - table binaire sans index : interpolation directement dans la colonne triée du fichier
+   - avec index : l'id renvoyé est la ligne de la colonne ou de la table
+   - renvoie le mdp de la première section qui contient le condensat, ou NULL
 */
-t3c_entry *t3c_lookup(t3c_node *node, char *hash_hex){
-    while (node){
-        int comp = strcmp(hash_hex, node->items->hash_hex);
-        if (comp < 0)      
-            node = node->left;
-        else if (comp > 0) 
-            node = node->right;
-        else              
-            return node->items;
+const char *t3c_source_find(const t3c_source *source, const char *algo, const unsigned char *digest, unsigned int digest_taille){
+    if (source->manifeste){
+        const t3c_source *shard = digest_taille > 0 ? source_shard(source, digest) : NULL;
+        return shard ? t3c_source_find(shard, algo, digest, digest_taille) : NULL;
+    }
+    for (unsigned int run = source->nbrun; run-- > 0; ){
+        const char *mdp = t3c_source_find(source->runs[run], algo, digest, digest_taille);
+        if (mdp)
+            return mdp;
+    }
+    if (source->bloom && !t3c_bloom_test(source->bloom, digest, digest_taille))
+        return NULL;
+    for (size_t s = 0; s < source->nbsection; ++s){
+        if (digest_taille != source_digest_taille(source, s) || (algo && strcmp(algo, source_algo(source, s)) != 0))
+            continue;
+        const char *mdp = NULL;
+        if (source->binaire && source->index[s] == NULL)
+            mdp = t3c_bin_lookup(&source->bin, s, digest, digest_taille);
+        else {
+            ssize_t id = t3c_index_find(source->index[s], digest, digest_taille);
+            if (id >= 0)
+                mdp = source->binaire ? t3c_bin_mdp(&source->bin, s, (size_t)id) : t3c_mdp(&source->tables[s], (size_t)id);
+        }
+        if (mdp)
+            return mdp;
     }
     return NULL;
 }
 
-/* Libère récursivement un arbre :
-   - Libère d'abord les sous-arbres gauche et droit, puis le noeud courant
-*/
-void t3c_index_free(t3c_node *node){
-    if (node == NULL) return;
-    t3c_index_free(node->left);
-    t3c_index_free(node->right);
-    free(node);
+// Libère les index, les sections ou la projection et le filtre
+void t3c_source_close(t3c_source *source){
+    if (source == NULL)
+        return;
+    for (unsigned int shard = 0; source->shards && shard < t3c_shard_nb(source->manifeste); ++shard)
+        t3c_source_close(source->shards[shard]);
+    free(source->shards);
+    for (unsigned int run = 0; run < source->nbrun; ++run)
+        t3c_source_close(source->runs[run]);
+    free(source->manifeste);
+    free(source->path);
+    for (size_t s = 0; s < T3C_SECTIONS_MAX; ++s)
+        t3c_index_free(source->index[s]);
+    if (source->binaire)
+        t3c_bin_close(&source->bin);
+    else
+        for (size_t s = 0; s < source->nbsection; ++s)
+            t3c_free(&source->tables[s]);
+    t3c_bloom_close(&source->filtre);
+    free(source);
+}
+
+/* Décode une requête "[algo:]hex" une fois, la cherche en binaire et affiche le résultat */
+static void lookup_hex(const t3c_source *source, char *requete){
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_taille = 0;
+    char *algo = NULL;
+    const char *mdp = NULL;
+    if (t3c_requete_decoder(requete, &algo, digest, &digest_taille) == 0){
+        uint64_t debut = t3c_stats_debut();
+        mdp = t3c_source_find(source, algo, digest, digest_taille);
+        t3c_stats_recherche(debut, mdp != NULL);
+    }
+    print_result(mdp);
 }
 
 /* Mode -L :
-   - Charge la table T3C en mémoire (t3c_load)
-   - Construit l'index BST
+   - Ouvre la table (t3c_source_open) : projetée si binaire, chargée et indexée si texte
+   - Le filtre <table>.bf, s'il existe et correspond à la table, écarte d'abord les absents
+   - Un condensat "algo:hex" n'est cherché que dans la section de cet algo
+   - Table découpée : seul le shard du condensat est ouvert
    - Si un hash est fourni on effectue une recherche et affiche le mdp trouvé
    - Sinon on lit des hashes depuis stdin et affiche les mdp trouvés
    - Nettoie la mémoire avant de quitter 
 */
-int t3c_mode_lookup(char *t3c_path, char *hash_search){
-    t3c_table table;
-    t3c_node *node = NULL;
-    if (t3c_load(t3c_path, &table) != 0){
-        printf("control_t3c.c : ERREUR > La fonction t3c_load a échoué\n");
+int t3c_mode_lookup(char *t3c_path, char *hash_search, int index_type){
+    t3c_source *source = t3c_source_open(t3c_path, index_type);
+    if (source == NULL)
         return -1;
-    }
-
-    node = t3c_index_build(&table);
-    if (node == NULL && table.nbobj > 0){
-        printf("control_t3c.c : ERREUR > La fonction t3c_index_build a échoué\n");
-        t3c_free(&table);
-        return -1;
-    }
 
     if (hash_search && hash_search[0]){
-        t3c_entry *items = t3c_lookup(node, hash_search);
-        if (items) 
-            puts(items->mdp);
-        else
-            printf("Le hash donnée est introuvable dans la table T3C\n");
+        lookup_hex(source, hash_search);
 
     } else {
         char *ligne = NULL;
@@ -398,20 +777,66 @@ int t3c_mode_lookup(char *t3c_path, char *hash_search){
 
         while ((taille = getline(&ligne, &taille_buf, stdin)) != -1){
             while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r')) 
-                ligne[taille--] = '\0';
+                ligne[--taille] = '\0';
 
             if (!ligne[0]) 
                 continue;
-            t3c_entry *items = t3c_lookup(node, ligne);
-            if (items) 
-                puts(items->mdp);
-            else
-                printf("Le hash donnée est introuvable dans la table T3C\n");
+            lookup_hex(source, ligne);
         }
         free(ligne);
     }
 
-    t3c_index_free(node);
-    t3c_free(&table);
+    t3c_source_close(source);
     return 0;
 }
+
+/* Mode -C : import/export entre les formats texte et binaire
+   - Charge toutes les sections de la table source quel que soit son format
+   - Les réécrit dans out_path au format demandé, chacune avec l'algo lu dans la source
+*/
+int t3c_mode_convert(char *in_path, char *out_path, int format){
+    t3c_table tables[T3C_SECTIONS_MAX];
+    size_t nbsection = 0;
+    int retour = 0;
+
+    if (t3c_bin_is(in_path)){
+        t3c_bin bin;
+        if (t3c_bin_open(in_path, &bin) != 0){
+            printf("control_t3c.c : ERREUR > La fonction t3c_bin_open a échoué\n");
+            return -1;
+        }
+        if (bin.header->nbsection > T3C_SECTIONS_MAX){
+            printf("control_t3c.c : ERREUR > La table binaire '%s' contient plus de %d sections\n", in_path, T3C_SECTIONS_MAX);
+            retour = -1;
+        }
+        for (uint32_t s = 0; retour == 0 && s < bin.header->nbsection; ++s){
+            if (t3c_bin_to_table(&bin, s, &tables[s]) != 0)
+                retour = -1;
+            else
+                nbsection++;
+        }
+        t3c_bin_close(&bin);
+    } else {
+        retour = t3c_load(in_path, tables, &nbsection);
+    }
+
+    size_t nbobj = 0;
+    for (size_t s = 0; s < nbsection; ++s){
+        if (tables[s].algo[0] == '\0')
+            snprintf(tables[s].algo, sizeof tables[s].algo, "sha256");   // anciennes tables sans en-tête
+        nbobj += tables[s].nbobj;
+    }
+    if (retour != 0)
+        printf("control_t3c.c : ERREUR > Le chargement de la table '%s' a échoué\n", in_path);
+    else {
+        retour = create_t3c(tables, nbsection, out_path, format);
+        if (retour != 0)
+            printf("control_t3c.c : ERREUR > La fonction create_t3c a échoué\n");
+        else
+            printf("Conversion terminée : %zu entrées de %s écrites dans %s (%s, %zu section%s)\n", nbobj, in_path, out_path, format == T3C_FORMAT_BIN ? "binaire" : "texte", nbsection, nbsection > 1 ? "s" : "");
+    }
+
+    for (size_t s = 0; s < nbsection; ++s)
+        t3c_free(&tables[s]);
+    return retour;
+}
@@ -1,141 +1,1741 @@
 /**
  * control_dict.c - Conversion dictionnaire en T3C
- * - Lit un dictionnaire ligne par ligne et ignore les lignes vides
- * - Calcule les condensats via string_to_hash(algo) + bin_to_hex()
- * - Alimente la table t3c avec t3c_table (mdp, hash) et affiche une barre de progression
+ * - Projette le dictionnaire avec mmap et le découpe en tranches alignées sur les lignes
+ * - Chaque tranche est traitée par un thread (-j N) : comptage des mots puis hachage
+ *   avec son propre hasher, dans les cases pré-allouées de la table
+ * - Ignore les lignes vides, retire les \r et \n de fin de ligne
+ * - Calcule les condensats par lots (hasher_batch) + bin_to_hex() et affiche une barre de progression
+ * - Mode flux (T3C texte) : lit, hache et écrit le dictionnaire en une passe, par un pipeline
+ *   lecteur -> threads de hachage -> écrivain relié par des files bornées (t3c_file.h) ; les
+ *   paquets en vol bornent la mémoire quelle que soit la taille du dictionnaire
+ * - Mode tri externe (T3C binaire) : même lecture en flux, les couples sont confiés à
+ *   t3c_extsort qui trie par runs sur disque puis fusionne (--mem-limit, --tmp-dir)
+ * - Plusieurs algos (-a répété) : chaque mot lu est haché par tous les algos, une table
+ *   (section) par algo
+ * - Mode découpé (--shards=<k>) : même lecture en flux, les couples sont répartis par préfixe
+ *   dans des fichiers temporaires, puis chaque shard est écrit seul (t3c_shard.h)
+ * - Mots en double : les mots sont d'abord insérés dans un ensemble concurrent (dict_dedup.h),
+ *   seule leur première occurrence est hachée et écrite (--no-dedup pour tout garder)
+ * - Règles (--rules, dict_regles.h) : chaque mot gardé donne un candidat par règle, produit
+ *   en mémoire par le thread qui le hache ; la liste étendue n'est jamais écrite ; avec le
+ *   dedup, les candidats sont d'abord développés dans une zone et insérés dans un second
+ *   ensemble, seuls les premiers de chaque candidat sont hachés
+ * - Masque (-M, dict_masque.h) : les candidats d'un intervalle d'indices remplacent le
+ *   dictionnaire ; chaque thread (ou paquet du pipeline) reçoit un intervalle d'indices et
+ *   avance son compteur d'un candidat à l'autre, sans rien lire sur disque
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "control_dict.h"
 #include "hash.h"
+#include "t3c_bin.h"
+#include "t3c_extsort.h"
+#include "t3c_shard.h"
+#include "dict_dedup.h"
+#include "t3c_stats.h"
+#include "t3c_file.h"
 
-// Affiche une barre de progression sur stdout pour le hachage du dictionnaire
+#define DICT_PAS_PROGRESSION 1024   // mots hachés entre deux mises à jour du compteur partagé
+#define DICT_LOT_MOTS        256    // mots par lot transmis à hasher_batch
+#define DICT_LOT_OCTETS      65536  // taille du tampon d'un lot (tailles + mots)
+#define DICT_FLUX_OCTETS     (1u << 20) // octets du dictionnaire lus par paquet en mode flux (--batch-size)
+#define DICT_REGLES_BLOC_MIN 4096       // paquet du mode flux avec règles : DICT_FLUX_OCTETS / règles, au moins
+
+// Tranche du dictionnaire traitée par un thread
+typedef struct {
+    const char *debut;          // premier octet de la tranche (toujours un début de ligne)
+    const char *fin;            // fin exclue de la tranche
+    size_t nbmot;               // mots non vides de la tranche
+    size_t base;                // première case des tables réservée à la tranche
+    char *sortie[T3C_SECTIONS_MAX];     // mode flux (tables == NULL) : couples produits par la tranche, par algo
+    int format;                 // T3C_FORMAT_TXT : lignes "hash<TAB>mdp", T3C_FORMAT_BIN : [condensat][taille uint32][mdp]
+    size_t taille_sortie[T3C_SECTIONS_MAX];
+    size_t capacite_sortie[T3C_SECTIONS_MAX];
+    int retour;                 // 0 = succès, -1 = erreur
+    int afficher;               // seule la tranche 0 (thread appelant) affiche la progression
+    char **algos;               // chaque mot est haché par les nbalgo algos
+    int nbalgo;
+    t3c_table *tables;          // une table par algo
+    t3c_blob blobs[T3C_SECTIONS_MAX];   // mdp rangés par la tranche, rattachés à chaque table à la fin (t3c_joindre)
+    atomic_size_t *nbDone;      // mots hachés par l'ensemble des threads
+    size_t nbMax;
+    dict_dedup *dedup;          // NULL = chaque mot est gardé, sinon seule sa première occurrence
+    uint32_t *cases;            // case de l'ensemble de chaque mot non vide de la tranche (dict_marquer)
+    size_t nbcases;
+    size_t capacite_cases;
+    int garder;                 // pipeline : cases[k] vaut 1 si le k-ième mot est une première occurrence, 0 sinon,
+                                // et l'en-tête de chaque entrée de la zone porte ce drapeau au lieu de la case
+    size_t nbdoublons;          // mots (et candidats) en double ignorés par la tranche
+    const dict_regles *regles;  // NULL = chaque mot tel quel, sinon un candidat par règle (comptés et hachés)
+    dict_dedup *candidats;      // règles avec dedup : ensemble des candidats, NULL sinon
+    char *zone;                 // candidats développés de la tranche (dict_developper), NULL = mots lus
+    size_t taille_zone;         // octets de ses candidats dans la zone (comptés par dict_compter)
+    const dict_masque *masque;  // NULL = mots lus entre debut et fin, sinon candidats du masque
+    uint64_t premier;           // masque : indice du premier candidat de la tranche
+    uint64_t nbindice;          // masque : candidats de la tranche
+} dict_tranche;
+
+// Entrée de la zone des candidats : [case uint32][taille uint32][candidat]
+#define DICT_ZONE_ENTETE (2 * sizeof(uint32_t))
+
+static const dict_regles *regles_actives = NULL;
+static const dict_masque *masque_actif = NULL;
+static uint64_t masque_premier = 0;
+static uint64_t masque_nb = 0;
+
+/* Règles appliquées aux mots par les générations suivantes (NULL : aucune)
+   - les règles doivent rester valides jusqu'à la fin de la génération
+*/
+void dict_utiliser_regles(const dict_regles *regles){
+    regles_actives = regles;
+}
+
+/* Masque dont les candidats d'indices [premier, premier + nb) remplacent le dictionnaire dans
+   les générations suivantes : leur path est ignoré (NULL : retour au dictionnaire)
+   - le masque doit rester valide jusqu'à la fin de la génération
+*/
+void dict_utiliser_masque(const dict_masque *masque, uint64_t premier, uint64_t nb){
+    masque_actif = masque;
+    masque_premier = premier;
+    masque_nb = nb;
+}
+
+// Affiche une barre de progression sur stderr pour le hachage du dictionnaire (t3c_progression_afficher)
 void progress_bar_dict(size_t nbligneDone, size_t nbligneMax, char *printText){
     if (!nbligneMax){
         printf("control_dict.c : ERREUR > Le dictionnaire transmis est vide ou une erreur est arrivé au calcul du nombre de ligne du dictionnaire\n");
         return;
     }
-    unsigned int larg = 50;                                      // largeur visuelle de la barre
-    unsigned int loading = nbligneDone * larg / nbligneMax;      // nombre de segments remplis
-    int pourcentage = nbligneDone * 100  / nbligneMax;           // % accompli
-    char *space = "";
-    char *text  = "";
-
-    printf("\r{");
-    for (unsigned int i = 0; i < loading; ++i) 
-        printf("=");
-    for (unsigned int i = loading; i < larg; ++i) 
-        printf("-");
-    if (printText && printText[0] != '\0') {
-        space = " ";
-        text  = printText;
-    }
-    printf("} %3d%% [%zu / %zu]%s%s", pourcentage, nbligneDone, nbligneMax, space, text);
-    if (nbligneDone >= nbligneMax) 
-        printf("\n");
-}
-
-//Compte les lignes du dictionnaire 
-size_t count_lignes_dict(FILE *fichier){
-    char *ligne = NULL;
-    size_t taille_buf  = 0;   // buffer auto-géré par getline
-    ssize_t taille =0;
-    size_t nbligneMax = 0;
-
-    while ((taille = getline(&ligne, &taille_buf, fichier)) != -1){
-        // Enleve les caracteres inutiles \n \r et place \0 a la fin 
-        while (taille > 0 && (ligne[taille-1] == '\n' || ligne[taille-1] == '\r')) 
-            ligne[taille--] = '\0';
-        if (taille == 0)      // ligne vide ignorée
-            continue; 
-        nbligneMax++;         // compte les lignes non vide
-    }
-    free(ligne);              // libère le buffer alloué par getline
-    rewind(fichier);          // remet le curseur au début pour la vraie lecture
-    return nbligneMax;
-}
-
-// Convertit un fichier dictionnaire en table T3C selon algo_name
-int dict_to_Table(char *path,char *algo_name, t3c_table *table){
-    FILE *fichier = fopen(path, "r");
-    if (!fichier) {
-        printf("control_dict.c : ERREUR > Le dictionnaire est vide ou l'ouverture du dictionnaire à eu un probleme\n");
+    t3c_progression_afficher(nbligneDone, nbligneMax, printText);
+}
+
+/* Délimite le mot d'une ligne de taille octets (sans le \n séparateur)
+   - Retire les \r et \n de fin de ligne
+   - Coupe au premier '\0' comme le faisait la lecture en chaîne C
+   - Renvoie la taille du mot, 0 pour une ligne vide
+*/
+static size_t dict_mot(const char *ligne, size_t taille){
+    while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r'))
+        taille--;
+    const char *nul = memchr(ligne, '\0', taille);
+    if (nul)
+        taille = (size_t)(nul - ligne);
+    return taille;
+}
+
+/* Renvoie 1 si le k-ième mot non vide de la tranche est la première occurrence de son mot
+   - la case du mot situé un lot plus loin est préchargée
+   - garder : la réponse a déjà été notée par l'étage de l'ensemble des mots du pipeline
+*/
+static int dict_premier(const dict_tranche *tranche, size_t k, const char *mot){
+    if (tranche->garder)
+        return tranche->cases[k] != 0;
+    if (k + DICT_DEDUP_LOT < tranche->nbcases)
+        dict_dedup_precharger(tranche->dedup, tranche->cases[k + DICT_DEDUP_LOT]);
+    return dict_dedup_premier(tranche->dedup, tranche->cases[k], mot);
+}
+
+/* Nombre de candidats non rejetés que les règles tirent du mot (taille > 0)
+   - candidat : tampon de DICT_REGLES_MOT_MAX octets
+   - ajoute à octets la place de ces candidats dans une zone (DICT_ZONE_ENTETE + taille chacun)
+*/
+static size_t dict_candidats(const dict_regles *regles, const char *mot, size_t taille, char *candidat, size_t *octets){
+    size_t nb = 0;
+    for (size_t r = 0; r < regles->nbregle; ++r){
+        size_t taille_candidat = dict_regles_appliquer(regles, r, mot, taille, candidat);
+        if (taille_candidat > 0){
+            nb++;
+            *octets += DICT_ZONE_ENTETE + taille_candidat;
+        }
+    }
+    return nb;
+}
+
+// Lit l'entrée de la zone qui commence à entree ; renvoie l'entrée suivante
+static const char *dict_zone_lire(const char *entree, uint32_t *c, const char **mot, size_t *taille){
+    uint32_t taille32;
+    memcpy(c, entree, sizeof *c);
+    memcpy(&taille32, entree + sizeof *c, sizeof taille32);
+    *mot = entree + DICT_ZONE_ENTETE;
+    *taille = taille32;
+    return *mot + taille32;
+}
+
+/* Phase 1 : compte les mots non vides de la tranche pour réserver ses cases dans la table
+   - avec l'ensemble des mots rempli (dict_marquer), seules les premières occurrences comptent
+   - avec des règles, chaque mot compte pour ses candidats non rejetés (et leurs octets dans
+     taille_zone)
+   - zone développée : seuls les candidats à leur première occurrence comptent
+   - masque : chaque indice compte pour un mot, ou pour ses candidats non rejetés avec des règles
+*/
+static void *dict_compter(void *arg){
+    dict_tranche *tranche = arg;
+    char candidat[DICT_REGLES_MOT_MAX];
+    if (tranche->zone){
+        for (const char *entree = tranche->zone; entree < tranche->zone + tranche->taille_zone; ){
+            uint32_t c;
+            const char *mot;
+            size_t taille;
+            entree = dict_zone_lire(entree, &c, &mot, &taille);
+            tranche->nbmot += (size_t)dict_dedup_premier(tranche->candidats, c, mot);
+        }
+        return NULL;
+    }
+    if (tranche->masque){
+        unsigned int chiffres[DICT_MASQUE_POSITIONS];
+        char mot[DICT_MASQUE_POSITIONS];
+        if (!tranche->regles){
+            tranche->nbmot += tranche->nbindice;
+            return NULL;
+        }
+        if (tranche->nbindice > 0)
+            dict_masque_placer(tranche->masque, tranche->premier, chiffres, mot);
+        for (uint64_t i = 0; i < tranche->nbindice; ++i){
+            if (i > 0)
+                dict_masque_suivant(tranche->masque, chiffres, mot);
+            tranche->nbmot += dict_candidats(tranche->regles, mot, tranche->masque->longueur, candidat, &tranche->taille_zone);
+        }
+        return NULL;
+    }
+    const char *ligne = tranche->debut;
+    size_t k = 0;
+    while (ligne < tranche->fin){
+        const char *nl = memchr(ligne, '\n', (size_t)(tranche->fin - ligne));
+        const char *fin_ligne = nl ? nl : tranche->fin;
+        size_t taille = dict_mot(ligne, (size_t)(fin_ligne - ligne));
+        if (taille > 0 && ((!tranche->dedup && !tranche->garder) || dict_premier(tranche, k++, ligne)))
+            tranche->nbmot += tranche->regles ? dict_candidats(tranche->regles, ligne, taille, candidat, &tranche->taille_zone) : 1;
+        ligne = nl ? nl + 1 : tranche->fin;
+    }
+    return NULL;
+}
+
+/* Insère les nbmot mots non vides de la tranche dans l'ensemble des mots, avant le hachage,
+   par lots de DICT_DEDUP_LOT ; la case de chacun est gardée dans tranche->cases
+*/
+static void *dict_marquer(void *arg){
+    dict_tranche *tranche = arg;
+    if (tranche->nbmot > tranche->capacite_cases){
+        uint32_t *cases = realloc(tranche->cases, tranche->nbmot * sizeof *cases);
+        if (!cases){
+            printf("control_dict.c : ERREUR > realloc des cases de la tranche (%zu)\n", tranche->nbmot);
+            tranche->retour = -1;
+            return NULL;
+        }
+        tranche->cases = cases;
+        tranche->capacite_cases = tranche->nbmot;
+    }
+
+    const char *mots[DICT_DEDUP_LOT];
+    size_t tailles[DICT_DEDUP_LOT];
+    size_t nb = 0;
+    size_t k = 0;
+    const char *ligne = tranche->debut;
+    while (ligne < tranche->fin){
+        const char *nl = memchr(ligne, '\n', (size_t)(tranche->fin - ligne));
+        const char *fin_ligne = nl ? nl : tranche->fin;
+        size_t taille = dict_mot(ligne, (size_t)(fin_ligne - ligne));
+        if (taille > 0){
+            mots[nb] = ligne;
+            tailles[nb++] = taille;
+        }
+        ligne = nl ? nl + 1 : tranche->fin;
+        if (nb == DICT_DEDUP_LOT || (nb > 0 && ligne >= tranche->fin)){
+            dict_dedup_inserer(tranche->dedup, mots, tailles, nb, tranche->cases + k);
+            k += nb;
+            nb = 0;
+        }
+    }
+    tranche->nbcases = k;
+    return NULL;
+}
+
+// Candidats développés par une tranche, en attente d'insertion dans l'ensemble des candidats
+typedef struct {
+    const char *mots[DICT_DEDUP_LOT];
+    size_t tailles[DICT_DEDUP_LOT];
+    char *entrees[DICT_DEDUP_LOT];
+    uint32_t cases[DICT_DEDUP_LOT];
+    size_t nb;
+    char *ecriture;             // prochaine entrée de la zone
+} dict_developpement;
+
+// Insère les candidats en attente et écrit la case de chacun dans l'en-tête de son entrée
+static void dict_developpement_vider(dict_tranche *tranche, dict_developpement *d){
+    if (d->nb == 0)
+        return;
+    dict_dedup_inserer(tranche->candidats, d->mots, d->tailles, d->nb, d->cases);
+    for (size_t j = 0; j < d->nb; ++j)
+        memcpy(d->entrees[j], &d->cases[j], sizeof d->cases[j]);
+    d->nb = 0;
+}
+
+// Écrit à la suite de la zone les candidats que les règles de la tranche tirent du mot
+static void dict_developper_mot(dict_tranche *tranche, dict_developpement *d, const char *mot, size_t taille){
+    char candidat[DICT_REGLES_MOT_MAX];
+    for (size_t r = 0; r < tranche->regles->nbregle; ++r){
+        size_t taille_candidat = dict_regles_appliquer(tranche->regles, r, mot, taille, candidat);
+        if (taille_candidat == 0)
+            continue;
+        uint32_t taille32 = (uint32_t)taille_candidat;
+        memcpy(d->ecriture + sizeof(uint32_t), &taille32, sizeof taille32);
+        memcpy(d->ecriture + DICT_ZONE_ENTETE, candidat, taille_candidat);
+        d->entrees[d->nb] = d->ecriture;
+        d->mots[d->nb] = d->ecriture + DICT_ZONE_ENTETE;
+        d->tailles[d->nb++] = taille_candidat;
+        d->ecriture += DICT_ZONE_ENTETE + taille_candidat;
+        if (d->nb == DICT_DEDUP_LOT)
+            dict_developpement_vider(tranche, d);
+    }
+}
+
+/* Règles avec dedup : écrit les candidats des premières occurrences de la tranche (ou de ses
+   indices du masque) dans sa zone et les insère dans l'ensemble des candidats par lots de
+   DICT_DEDUP_LOT, avant tout hachage
+   - les zones des tranches se suivent dans un même bloc : pour un même candidat, la plus petite
+     position l'emporte, la première occurrence ne dépend pas du nombre de threads
+   - la case de chaque candidat est gardée dans l'en-tête de son entrée
+   - les mots en double sont comptés ici, les candidats en double par dict_hacher
+*/
+static void *dict_developper(void *arg){
+    dict_tranche *tranche = arg;
+    dict_developpement d = { .nb = 0, .ecriture = tranche->zone };
+    if (tranche->masque){
+        unsigned int chiffres[DICT_MASQUE_POSITIONS];
+        char mot[DICT_MASQUE_POSITIONS];
+        if (tranche->nbindice > 0)
+            dict_masque_placer(tranche->masque, tranche->premier, chiffres, mot);
+        for (uint64_t i = 0; i < tranche->nbindice; ++i){
+            if (i > 0)
+                dict_masque_suivant(tranche->masque, chiffres, mot);
+            dict_developper_mot(tranche, &d, mot, tranche->masque->longueur);
+        }
+    }
+    else {
+        size_t k = 0;
+        const char *ligne = tranche->debut;
+        while (ligne < tranche->fin){
+            const char *nl = memchr(ligne, '\n', (size_t)(tranche->fin - ligne));
+            const char *fin_ligne = nl ? nl : tranche->fin;
+            size_t taille = dict_mot(ligne, (size_t)(fin_ligne - ligne));
+            const char *mot = ligne;
+            ligne = nl ? nl + 1 : tranche->fin;
+            if (taille == 0)
+                continue;
+            if ((tranche->dedup || tranche->garder) && !dict_premier(tranche, k++, mot)){
+                tranche->nbdoublons++;
+                continue;
+            }
+            dict_developper_mot(tranche, &d, mot, taille);
+        }
+    }
+    dict_developpement_vider(tranche, &d);
+    return NULL;
+}
+
+/* Range un couple condensat / mdp de l'algo a produit par la tranche
+   - dans la case pos de sa table, ou à la suite de son tampon de sortie en mode flux
+*/
+static int dict_ranger(dict_tranche *tranche, int a, size_t pos, const char *mot, size_t taille, const unsigned char *digest, unsigned int digest_taille){
+    char hex[EVP_MAX_MD_SIZE * 2 + 1];
+    if (tranche->tables)
+        return t3c_set(&tranche->tables[a], &tranche->blobs[a], pos, mot, taille, digest);
+    if (tranche->format == T3C_FORMAT_TXT)
+        bin_to_hex((unsigned char*)digest, digest_taille, hex);
+
+    size_t taille_entree = tranche->format == T3C_FORMAT_TXT ? 2 * digest_taille + taille + 2 : digest_taille + sizeof(uint32_t) + taille;
+    size_t besoin = tranche->taille_sortie[a] + taille_entree;
+    if (besoin > tranche->capacite_sortie[a]){
+        size_t capacite = tranche->capacite_sortie[a] ? tranche->capacite_sortie[a] * 2 : DICT_LOT_OCTETS;
+        while (capacite < besoin)
+            capacite *= 2;
+        char *sortie = realloc(tranche->sortie[a], capacite);
+        if (!sortie){
+            printf("control_dict.c : ERREUR > realloc du tampon de sortie (%zu)\n", capacite);
+            return -1;
+        }
+        tranche->sortie[a] = sortie;
+        tranche->capacite_sortie[a] = capacite;
+    }
+    char *ecriture = tranche->sortie[a] + tranche->taille_sortie[a];
+    if (tranche->format == T3C_FORMAT_TXT){
+        memcpy(ecriture, hex, 2 * digest_taille);
+        ecriture[2 * digest_taille] = '\t';
+        memcpy(ecriture + 2 * digest_taille + 1, mot, taille);
+        ecriture[2 * digest_taille + 1 + taille] = '\n';
+    }
+    else {
+        uint32_t taille32 = (uint32_t)taille;
+        memcpy(ecriture, digest, digest_taille);
+        memcpy(ecriture + digest_taille, &taille32, sizeof taille32);
+        memcpy(ecriture + digest_taille + sizeof taille32, mot, taille);
+    }
+    tranche->taille_sortie[a] = besoin;
+    return 0;
+}
+
+// Lot de mots en attente de hachage pour un thread
+typedef struct {
+    unsigned char octets[DICT_LOT_OCTETS];      // messages préfixés par leur taille
+    unsigned char digests[DICT_LOT_MOTS * EVP_MAX_MD_SIZE];
+    const char *mots[DICT_LOT_MOTS];            // mots dans leur copie de octets
+    size_t tailles[DICT_LOT_MOTS];
+    size_t nbmot;
+    size_t remplissage;
+} dict_lot;
+
+/* Hache le lot avec chaque algo (un appel par algo) et range chaque couple dans les cases
+   suivantes de la tranche, les mêmes pour tous les algos
+   - Renvoie 0 si tout le lot a été rangé, -1 sinon
+*/
+static int dict_vider_lot(dict_tranche *tranche, hasher **h, dict_lot *lot, size_t *pos){
+    if (lot->nbmot == 0)
+        return 0;
+    for (int a = 0; a < tranche->nbalgo; ++a){
+        if (hasher_batch(h[a], lot->octets, lot->nbmot, lot->digests) != 0){
+            printf("control_dict.c : ERREUR > Le hachage du lot commençant par '%.*s' à rencontré un probleme\n", (int)lot->tailles[0], lot->mots[0]);
+            return -1;
+        }
+        for (size_t i = 0; i < lot->nbmot; ++i){
+            // Ajout du couple hash mdp dans la case réservée de la table T3C (ou dans la sortie du flux)
+            if (dict_ranger(tranche, a, *pos + i, lot->mots[i], lot->tailles[i], lot->digests + i * h[a]->digest_taille, h[a]->digest_taille) != 0){
+                printf("control_dict.c : ERREUR > L'ajout d'un couple condensat et mdp dans la table à échoué\n");
+                return -1;
+            }
+        }
+    }
+    *pos += lot->nbmot;
+    lot->nbmot = 0;
+    lot->remplissage = 0;
+    return 0;
+}
+
+/* Ajoute un mot au lot, en vidant le lot d'abord s'il est plein
+   - un mot plus grand que le tampon d'un lot est haché seul
+   - le lot garde sa propre copie du mot : le candidat d'une règle peut être réécrit ensuite
+*/
+static int dict_ajouter_mot(dict_tranche *tranche, hasher **h, dict_lot *lot, size_t *pos, const char *mot, size_t taille){
+    if (lot->nbmot == DICT_LOT_MOTS || lot->remplissage + sizeof(uint32_t) + taille > DICT_LOT_OCTETS){
+        if (dict_vider_lot(tranche, h, lot, pos) != 0)
+            return -1;
+    }
+    if (sizeof(uint32_t) + taille > DICT_LOT_OCTETS){
+        for (int a = 0; a < tranche->nbalgo; ++a){
+            unsigned char digest[EVP_MAX_MD_SIZE];
+            if (hasher_digest(h[a], mot, taille, digest) != 0 || dict_ranger(tranche, a, *pos, mot, taille, digest, h[a]->digest_taille) != 0)
+                return -1;
+        }
+        (*pos)++;
+        return 0;
+    }
+    lot->mots[lot->nbmot] = (const char*)lot->octets + lot->remplissage + sizeof(uint32_t);
+    lot->tailles[lot->nbmot] = taille;
+    lot->remplissage += hasher_lot_ajouter(lot->octets + lot->remplissage, mot, (uint32_t)taille);
+    lot->nbmot++;
+    return 0;
+}
+
+/* Range le mot, ou chacun des candidats que les règles de la tranche en tirent, dans les
+   cases suivantes de la tranche
+*/
+static int dict_hacher_mot(dict_tranche *tranche, hasher **h, dict_lot *lot, size_t *pos, const char *mot, size_t taille){
+    if (tranche->regles == NULL)
+        return dict_ajouter_mot(tranche, h, lot, pos, mot, taille);
+    char candidat[DICT_REGLES_MOT_MAX];
+    for (size_t r = 0; r < tranche->regles->nbregle; ++r){
+        size_t taille_candidat = dict_regles_appliquer(tranche->regles, r, mot, taille, candidat);
+        if (taille_candidat > 0 && dict_ajouter_mot(tranche, h, lot, pos, candidat, taille_candidat) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Ajoute fait mots hachés à la progression
+   - compteur partagé mis à jour par paquets pour limiter le trafic entre les threads
+   - seule la tranche 0 affiche la barre, à chaque pourcentage franchi
+*/
+static void dict_progresser(dict_tranche *tranche, size_t fait, size_t *local, size_t *prochain, size_t pourcentage){
+    *local += fait;
+    if (*local >= DICT_PAS_PROGRESSION){
+        atomic_fetch_add_explicit(tranche->nbDone, *local, memory_order_relaxed);
+        *local = 0;
+    }
+    if (tranche->afficher){
+        size_t nbDone = atomic_load_explicit(tranche->nbDone, memory_order_relaxed) + *local;
+        if (nbDone >= *prochain && nbDone < tranche->nbMax){
+            progress_bar_dict(nbDone, tranche->nbMax, "( Hachage )");
+            *prochain = nbDone - nbDone % pourcentage + pourcentage;
+        }
+    }
+}
+
+/* Phase 2 : hache chaque mot de la tranche et le range dans les cases [base, base + nbmot)
+   - Un hasher par algo et par thread, créé une fois ; les mots sont hachés par lots de DICT_LOT_MOTS
+   - L'ordre des entrées est celui du dictionnaire, quel que soit le nombre de threads
+   - Un mot qui n'est pas sa première occurrence (dedup) n'est ni haché ni rangé
+   - Règles : les candidats du mot sont produits l'un après l'autre et rangés à sa place
+   - Zone développée (règles avec dedup) : ses candidats sont relus dans l'ordre, seules leurs
+     premières occurrences sont hachées et rangées
+   - Masque : le compteur est placé sur le premier indice de la tranche puis avance d'un
+     candidat à l'autre dans un tampon fixe, dans l'ordre des indices
+*/
+static void *dict_hacher(void *arg){
+    dict_tranche *tranche = arg;
+    hasher *h[T3C_SECTIONS_MAX] = {0};
+    dict_lot *lot = malloc(sizeof *lot);
+    int pret = lot != NULL;
+    for (int a = 0; a < tranche->nbalgo; ++a){
+        h[a] = hasher_new(tranche->algos[a]);
+        if (!h[a])
+            pret = 0;
+    }
+    if (!pret){
+        printf("control_dict.c : ERREUR > L'initialisation du hachage de la tranche à échoué\n");
+        for (int a = 0; a < tranche->nbalgo; ++a)
+            hasher_free(h[a]);
+        free(lot);
+        tranche->retour = -1;
+        return NULL;
+    }
+    lot->nbmot = 0;
+    lot->remplissage = 0;
+
+    size_t pourcentage = tranche->nbMax >= 100 ? tranche->nbMax / 100 : 1;
+    size_t prochain = pourcentage;
+    size_t pos = tranche->base;
+    size_t local = 0;
+
+    if (tranche->zone){
+        const char *fin_zone = tranche->zone + tranche->taille_zone;
+        for (const char *entree = tranche->zone; entree < fin_zone; ){
+            uint32_t c;
+            const char *mot;
+            size_t taille;
+            entree = dict_zone_lire(entree, &c, &mot, &taille);
+            if (tranche->garder ? c == 0 : !dict_dedup_premier(tranche->candidats, c, mot)){
+                tranche->nbdoublons++;
+                continue;
+            }
+            size_t avant = pos + lot->nbmot;
+            if (dict_ajouter_mot(tranche, h, lot, &pos, mot, taille) != 0){
+                tranche->retour = -1;
+                break;
+            }
+            dict_progresser(tranche, pos + lot->nbmot - avant, &local, &prochain, pourcentage);
+        }
+    }
+    else if (tranche->masque){
+        unsigned int chiffres[DICT_MASQUE_POSITIONS];
+        char candidat[DICT_MASQUE_POSITIONS];
+        if (tranche->nbindice > 0)
+            dict_masque_placer(tranche->masque, tranche->premier, chiffres, candidat);
+        for (uint64_t i = 0; i < tranche->nbindice; ++i){
+            if (i > 0)
+                dict_masque_suivant(tranche->masque, chiffres, candidat);
+            size_t avant = pos + lot->nbmot;
+            if (dict_hacher_mot(tranche, h, lot, &pos, candidat, tranche->masque->longueur) != 0){
+                tranche->retour = -1;
+                break;
+            }
+            dict_progresser(tranche, pos + lot->nbmot - avant, &local, &prochain, pourcentage);
+        }
+    }
+    else {
+        size_t k = 0;
+        const char *ligne = tranche->debut;
+        while (ligne < tranche->fin){
+            const char *nl = memchr(ligne, '\n', (size_t)(tranche->fin - ligne));
+            const char *fin_ligne = nl ? nl : tranche->fin;
+            const char *mot = ligne;
+            size_t taille = dict_mot(mot, (size_t)(fin_ligne - mot));
+            ligne = nl ? nl + 1 : tranche->fin;
+            if (taille == 0)
+                continue;        // ignore les lignes vides
+            if ((tranche->dedup || tranche->garder) && !dict_premier(tranche, k++, mot)){
+                tranche->nbdoublons++;
+                continue;
+            }
+            size_t avant = pos + lot->nbmot;
+            if (dict_hacher_mot(tranche, h, lot, &pos, mot, taille) != 0){
+                tranche->retour = -1;
+                break;
+            }
+            dict_progresser(tranche, pos + lot->nbmot - avant, &local, &prochain, pourcentage);
+        }
+    }
+    if (tranche->retour == 0 && dict_vider_lot(tranche, h, lot, &pos) != 0)
+        tranche->retour = -1;
+    tranche->nbmot = pos - tranche->base;
+    atomic_fetch_add_explicit(tranche->nbDone, local, memory_order_relaxed);
+
+    free(lot);
+    for (int a = 0; a < tranche->nbalgo; ++a)
+        hasher_free(h[a]);
+    return NULL;
+}
+
+/* Exécute fonction sur chaque tranche : les tranches 1..nb-1 dans des threads,
+   la tranche 0 dans le thread appelant
+*/
+static int dict_lancer(dict_tranche *tranches, int nbthreads, void *(*fonction)(void *)){
+    pthread_t *threads = malloc((size_t)nbthreads * sizeof *threads);
+    if (!threads){
+        printf("control_dict.c : ERREUR > malloc des threads (%d)\n", nbthreads);
         return -1;
     }
+    int lances = 1;
+    for (int i = 1; i < nbthreads; ++i){
+        if (pthread_create(&threads[i], NULL, fonction, &tranches[i]) != 0){
+            printf("control_dict.c : ERREUR > pthread_create a échoué pour la tranche %d\n", i);
+            break;
+        }
+        lances++;
+    }
+    // En cas d'échec de création, les tranches restantes sont traitées par le thread appelant
+    for (int i = lances; i < nbthreads; ++i)
+        fonction(&tranches[i]);
+    fonction(&tranches[0]);
+    for (int i = 1; i < lances; ++i)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    return 0;
+}
+
+// Découpe data en nbthreads tranches d'octets, chaque début est repoussé après le prochain \n
+static void dict_decouper(const char *data, size_t taille, dict_tranche *tranches, int nbthreads){
+    const char *fin = data + taille;
+    const char *debut = data;
+    for (int i = 0; i < nbthreads; ++i){
+        const char *limite = (i == nbthreads - 1) ? fin : data + taille / (size_t)nbthreads * (size_t)(i + 1);
+        if (limite < debut)
+            limite = debut;
+        if (limite < fin && limite > data && limite[-1] != '\n'){
+            const char *nl = memchr(limite, '\n', (size_t)(fin - limite));
+            limite = nl ? nl + 1 : fin;
+        }
+        tranches[i].debut = debut;
+        tranches[i].fin = limite;
+        debut = limite;
+    }
+}
 
-    // Pré-compte pour la barre de progession
-    size_t nbLigneMax = count_lignes_dict(fichier);
+// Répartit les nb candidats du masque actif à partir de l'indice premier en nbthreads parts égales (à un près)
+static void dict_masque_decouper(dict_tranche *tranches, int nbthreads, uint64_t premier, uint64_t nb){
+    uint64_t part = nb / (uint64_t)nbthreads;
+    uint64_t reste = nb % (uint64_t)nbthreads;
+    for (int i = 0; i < nbthreads; ++i){
+        tranches[i].masque = masque_actif;
+        tranches[i].premier = premier;
+        tranches[i].nbindice = part + ((uint64_t)i < reste ? 1 : 0);
+        premier += tranches[i].nbindice;
+    }
+}
+
+// Vérifie que les nbalgo algos demandés existent
+static int dict_algos_valides(char **algos, int nbalgo){
+    if (nbalgo < 1 || nbalgo > T3C_SECTIONS_MAX){
+        printf("control_dict.c : ERREUR > Nombre d'algorithmes invalide (%d, 1 à %d)\n", nbalgo, T3C_SECTIONS_MAX);
+        return -1;
+    }
+    for (int a = 0; a < nbalgo; ++a){
+        if (!EVP_get_digestbyname(algos[a])){
+            printf("control_dict.c : ERREUR > L'algorithme '%s' est inconnu\n", algos[a]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Remplit l'ensemble des mots avec les tranches du bloc (position : position de son premier octet)
+   puis le rattache aux tranches : dict_compter et dict_hacher ne gardent plus que les premières
+   occurrences
+   - les mots non vides de chaque tranche ont été comptés par dict_compter sans ensemble
+*/
+static int dict_dedoublonner(dict_dedup *dedup, const char *bloc, uint64_t position, dict_tranche *tranches, int nbthreads){
+    size_t nbmot = 0;
+    for (int i = 0; i < nbthreads; ++i)
+        nbmot += tranches[i].nbmot;
+    if (dict_dedup_reserver(dedup, nbmot, bloc, position) != 0)
+        return -1;
+    for (int i = 0; i < nbthreads; ++i)
+        tranches[i].dedup = dedup;
+    if (dict_lancer(tranches, nbthreads, dict_marquer) != 0)
+        return -1;
+    int retour = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        if (tranches[i].retour != 0)
+            retour = -1;
+        tranches[i].nbmot = 0;
+    }
+    return retour;
+}
+
+/* Règles avec dedup : développe les candidats des tranches (comptés par dict_compter) dans zone,
+   agrandie si besoin, et les insère dans l'ensemble des candidats (position : position de son
+   premier octet parmi les zones successives)
+   - les tranches relisent ensuite leur zone (dict_compter, dict_hacher) au lieu de leurs lignes
+   - Met la taille des candidats développés dans taille_zone
+*/
+static int dict_developper_tranches(dict_dedup *candidats, uint64_t position, char **zone, size_t *capacite, size_t *taille_zone, dict_tranche *tranches, int nbthreads){
+    size_t nbcandidat = 0;
+    *taille_zone = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        nbcandidat += tranches[i].nbmot;
+        *taille_zone += tranches[i].taille_zone;
+    }
+    if (*taille_zone > *capacite){
+        char *plus = realloc(*zone, *taille_zone);
+        if (!plus){
+            printf("control_dict.c : ERREUR > realloc de la zone des candidats (%zu)\n", *taille_zone);
+            return -1;
+        }
+        *zone = plus;
+        *capacite = *taille_zone;
+    }
+    if (dict_dedup_reserver(candidats, nbcandidat, *zone, position) != 0)
+        return -1;
+    size_t offset = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        tranches[i].candidats = candidats;
+        tranches[i].zone = *zone + offset;
+        offset += tranches[i].taille_zone;
+        tranches[i].nbmot = 0;
+    }
+    return dict_lancer(tranches, nbthreads, dict_developper);
+}
+
+/* Réserve les cases de chaque tranche (somme préfixe des mots comptés), alloue les tables
+   exactement puis hache les tranches en parallèle, chacune dans ses propres cases
+   - Ajoute le nombre de mots en double ignorés par les tranches à nbdoublons
+*/
+static int dict_remplir(dict_tranche *tranches, int nbthreads, char **algos, int nbalgo, t3c_table *tables, size_t *nbdoublons){
+    size_t nbLigneMax = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        tranches[i].base = nbLigneMax;
+        nbLigneMax += tranches[i].nbmot;
+    }
+    int retour = 0;
     if (nbLigneMax == 0){
-        printf("control_t3c.c : ERREUR > Le fichier t3c est vide\n");
-        fclose(fichier);
+        printf("control_dict.c : ERREUR > Le dictionnaire ne contient aucun mot\n");
+        retour = -1;
+    }
+
+    // Allocation mémoire parfaite en fonction des mots du fichier et de la taille des condensats
+    for (int a = 0; retour == 0 && a < nbalgo; ++a){
+        const EVP_MD *md = EVP_get_digestbyname(algos[a]);
+        if (t3c_alloc(&tables[a], nbLigneMax, (unsigned int)EVP_MD_get_size(md)) != 0){
+            printf("control_dict.c : ERREUR > malloc table (%zu)\n", nbLigneMax);
+            retour = -1;
+        }
+    }
+
+    // Phase 2 : hachage parallèle, chaque tranche écrit dans ses propres cases
+    if (retour == 0){
+        for (int a = 0; a < nbalgo; ++a){
+            tables[a].maxSize = nbLigneMax;
+            tables[a].nbobj   = nbLigneMax;
+            snprintf(tables[a].algo, sizeof tables[a].algo, "%s", algos[a]);
+        }
+
+        atomic_size_t nbDone = 0;
+        for (int i = 0; i < nbthreads; ++i){
+            tranches[i].algos = algos;
+            tranches[i].nbalgo = nbalgo;
+            tranches[i].tables = tables;
+            tranches[i].nbDone = &nbDone;
+            tranches[i].nbMax = nbLigneMax;
+            tranches[i].afficher = (i == 0);
+        }
+        uint64_t debut = t3c_stats_debut();
+        retour = dict_lancer(tranches, nbthreads, dict_hacher);
+        for (int i = 0; i < nbthreads; ++i){
+            if (tranches[i].retour != 0)
+                retour = -1;
+            for (int a = 0; a < nbalgo; ++a){
+                if (t3c_joindre(&tables[a], &tranches[i].blobs[a], tranches[i].base, tranches[i].nbmot) != 0)
+                    retour = -1;
+            }
+            *nbdoublons += tranches[i].nbdoublons;
+        }
+        t3c_stats_phase(T3C_STATS_HACHAGE, debut);
+        t3c_stats_compter(T3C_STATS_MOTS, nbLigneMax);
+        t3c_stats_compter(T3C_STATS_CONDENSATS, (uint64_t)nbLigneMax * (uint64_t)nbalgo);
+        t3c_stats_compter(T3C_STATS_DOUBLONS, *nbdoublons);
+        if (retour == 0)
+            progress_bar_dict(nbLigneMax, nbLigneMax, "( Hachage )");
+    }
+    return retour;
+}
+
+/* Remplit les tables avec les candidats du masque actif (dict_utiliser_masque)
+   - les indices sont répartis également entre les threads, sans fichier à projeter
+   - avec des règles, les candidats de chaque indice sont d'abord comptés pour réserver les cases
+   - règles avec dedup : les candidats sont développés en mémoire (dict_developper_tranches),
+     seules leurs premières occurrences sont gardées, les autres sont mises dans nbdoublons
+*/
+static int dict_masque_tables(char **algos, int nbalgo, t3c_table *tables, int nbthreads, int dedup, size_t *nbdoublons){
+    *nbdoublons = 0;
+    if (masque_nb > SIZE_MAX / EVP_MAX_MD_SIZE){
+        printf("control_dict.c : ERREUR > Trop de candidats (%llu) pour une table en mémoire : --format=txt, --mem-limit ou --shards\n", (unsigned long long)masque_nb);
         return -1;
     }
+    dict_tranche *tranches = calloc((size_t)nbthreads, sizeof *tranches);
+    if (!tranches){
+        printf("control_dict.c : ERREUR > malloc des tranches (%d)\n", nbthreads);
+        return -1;
+    }
+    dict_dedup candidats;
+    dict_dedup_init(&candidats, 0);
+    char *zone = NULL;
+    size_t capacite_zone = 0;
+    size_t taille_zone = 0;
+    dict_masque_decouper(tranches, nbthreads, masque_premier, masque_nb);
+    for (int i = 0; i < nbthreads; ++i)
+        tranches[i].regles = regles_actives;
+    int retour = dict_lancer(tranches, nbthreads, dict_compter);
+    if (retour == 0 && dedup && regles_actives){
+        uint64_t debut = t3c_stats_debut();
+        retour = dict_developper_tranches(&candidats, 0, &zone, &capacite_zone, &taille_zone, tranches, nbthreads);
+        if (retour == 0)
+            retour = dict_lancer(tranches, nbthreads, dict_compter);
+        t3c_stats_phase(T3C_STATS_DEDOUBLONNAGE, debut);
+    }
+    if (retour == 0)
+        retour = dict_remplir(tranches, nbthreads, algos, nbalgo, tables, nbdoublons);
+    dict_dedup_free(&candidats);
+    free(zone);
+    free(tranches);
+    return retour;
+}
 
-    // Allocation mémoire parfaite en fonction des lignes du fichier 
-    table->items = (t3c_entry*)malloc(nbLigneMax * sizeof *table->items);
-    if (table->items == NULL){
-        printf("control_t3c.c : ERREUR > malloc table (%zu)\n", nbLigneMax);
-        fclose(fichier);
+/* Convertit un fichier dictionnaire en tables T3C, une par algo de algos, avec nbthreads threads
+   - Découpe le fichier projeté en tranches d'octets alignées sur les fins de ligne
+   - Compte les mots de chaque tranche en parallèle puis réserve leurs cases (somme préfixe)
+   - dedup : les mots en double sont écartés avant le comptage des cases, leur nombre est mis
+     dans nbdoublons ; les mots de l'ensemble sont relus dans le fichier projeté, sans copie ;
+     avec des règles, les candidats sont développés en mémoire (dict_developper_tranches) et
+     seules leurs premières occurrences comptent, les autres sont ajoutés à nbdoublons
+   - Hache chaque tranche en parallèle : les tables obtenues sont identiques à celles d'un seul thread
+   - Masque actif : ses candidats remplacent le fichier (dict_masque_tables)
+*/
+int dict_to_Table(char *path, char **algos, int nbalgo, t3c_table *tables, int nbthreads, int dedup, size_t *nbdoublons){
+    if (dict_algos_valides(algos, nbalgo) != 0)
+        return -1;
+    if (nbthreads < 1)
+        nbthreads = 1;
+    if (masque_actif)
+        return dict_masque_tables(algos, nbalgo, tables, nbthreads, dedup, nbdoublons);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("control_dict.c : ERREUR > Le dictionnaire est vide ou l'ouverture du dictionnaire à eu un probleme\n");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0){
+        printf("control_dict.c : ERREUR > Le dictionnaire est vide ou l'ouverture du dictionnaire à eu un probleme\n");
+        close(fd);
+        return -1;
+    }
+    size_t taille_fichier = (size_t)st.st_size;
+    const char *data = mmap(NULL, taille_fichier, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED){
+        printf("control_dict.c : ERREUR > mmap du dictionnaire à échoué\n");
         return -1;
     }
-    table->maxSize = nbLigneMax;
-    table->nbobj   = 0;
+    madvise((void*)data, taille_fichier, MADV_SEQUENTIAL);
 
-    size_t nbligneDone = 0;
-    int pourcentage;
-    if(nbLigneMax >= 100){
-        pourcentage = nbLigneMax / 100;
-    }else{
-        pourcentage = 1;
+    dict_tranche *tranches = calloc((size_t)nbthreads, sizeof *tranches);
+    if (!tranches){
+        printf("control_dict.c : ERREUR > malloc des tranches (%d)\n", nbthreads);
+        munmap((void*)data, taille_fichier);
+        return -1;
     }
 
-    char *ligne = NULL;
-    size_t taille_buf  = 0;  // taille dédié a l'allocation de la memoire de la ligne géré par getline
-    ssize_t taille =0;
+    dict_decouper(data, taille_fichier, tranches, nbthreads);
+    dict_dedup ensemble;
+    dict_dedup_init(&ensemble, 0);
+    dict_dedup candidats;
+    dict_dedup_init(&candidats, 0);
+    char *zone = NULL;
+    size_t capacite_zone = 0;
+    size_t taille_zone = 0;
+    *nbdoublons = 0;
 
-    // Lecture de chaque mot du dictionnaire
-    while ((taille = getline(&ligne, &taille_buf, fichier)) != -1){
-        // Enleve les caracteres inutiles \n \r et place \0 a la fin 
-        while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r')) 
-            ligne[taille--] = '\0';
-        if (taille == 0) 
-            continue;        // ignore les lignes vides
+    // Phase 1 : comptage parallèle des mots pour une allocation exacte de la table
+    // (première lecture des pages projetées : durée comptée en lecture)
+    // Avec l'ensemble des mots, le premier comptage ne sert qu'à le dimensionner : les règles
+    // ne s'appliquent qu'au second, sur les premières occurrences
+    for (int i = 0; i < nbthreads; ++i)
+        tranches[i].regles = dedup ? NULL : regles_actives;
+    uint64_t debut = t3c_stats_debut();
+    int retour = dict_lancer(tranches, nbthreads, dict_compter);
+    t3c_stats_phase(T3C_STATS_LECTURE, debut);
+    t3c_stats_compter(T3C_STATS_OCTETS_LUS, taille_fichier);
+    if (retour == 0 && dedup){
+        debut = t3c_stats_debut();
+        retour = dict_dedoublonner(&ensemble, data, 0, tranches, nbthreads);
+        for (int i = 0; i < nbthreads; ++i)
+            tranches[i].regles = regles_actives;
+        if (retour == 0)
+            retour = dict_lancer(tranches, nbthreads, dict_compter);
+        if (retour == 0 && regles_actives)
+            retour = dict_developper_tranches(&candidats, 0, &zone, &capacite_zone, &taille_zone, tranches, nbthreads);
+        if (retour == 0 && regles_actives)
+            retour = dict_lancer(tranches, nbthreads, dict_compter);
+        t3c_stats_phase(T3C_STATS_DEDOUBLONNAGE, debut);
+    }
+    if (retour == 0)
+        retour = dict_remplir(tranches, nbthreads, algos, nbalgo, tables, nbdoublons);
 
-        unsigned char digest[EVP_MAX_MD_SIZE];  // buffer du digest binaire
-        unsigned int digest_taille = 0;         // longueur effective du digest
+    dict_dedup_free(&ensemble);
+    dict_dedup_free(&candidats);
+    free(zone);
+    for (int i = 0; i < nbthreads; ++i)
+        free(tranches[i].cases);
+    free(tranches);
+    munmap((void*)data, taille_fichier);
+    return retour;
+}
 
-        // Hachage du mot courant avec l'algo choisi
-        int retour = string_to_hash(ligne, algo_name, digest, &digest_taille);
-        if (retour){
-            printf("control_dict.c : ERREUR > Le hachage sur '%s' à rencontré un probleme (code de retour : %d)\n", ligne, retour);
-            free(ligne);
-            fclose(fichier);
+/* Lit jusqu'à taille octets dans buf, s'arrête seulement en fin de fichier
+   - Renvoie le nombre d'octets lus, -1 en cas d'erreur
+*/
+static ssize_t dict_lire(int fd, char *buf, size_t taille){
+    size_t lu = 0;
+    while (lu < taille){
+        ssize_t n = read(fd, buf + lu, taille - lu);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        lu += (size_t)n;
+    }
+    return (ssize_t)lu;
+}
+
+// Reçoit, dans l'ordre du dictionnaire, la sortie d'une tranche du mode flux pour l'algo a
+typedef int (*dict_puits)(void *ctx, int a, const char *sortie, size_t taille, size_t nbmot);
+
+// Zone des candidats développés du mode flux (règles avec dedup), une par paquet
+typedef struct {
+    dict_dedup ensemble;        // candidats distincts, recopiés après chaque paquet
+    uint64_t position;          // octets des zones des paquets précédents
+} dict_zone;
+
+/* Paquet du pipeline de génération en flux (dict_flux)
+   - lecteur : lignes complètes du dictionnaire (coupées sur la dernière fin de ligne lue),
+     ou intervalle d'indices du masque actif
+   - étage de l'ensemble des mots (dedup) : drapeaux des premières occurrences dans tranche.cases,
+     et avec des règles ceux des candidats développés dans zone
+   - hachage : un thread hache tout le paquet dans les sorties de sa tranche
+   - écrivain : remet les paquets dans l'ordre de numero, les transmet au puits puis les recycle
+*/
+typedef struct {
+    dict_tranche tranche;
+    uint64_t numero;            // rang du paquet dans la source
+    char *octets;               // tampon de lecture (NULL pour le masque)
+    size_t capacite;
+    uint64_t position;          // position de son premier octet dans le dictionnaire
+    uint64_t avancee;           // octets du dictionnaire (ou candidats du masque) traités jusqu'à sa fin
+    char *zone;                 // règles avec dedup : candidats développés du paquet
+    size_t capacite_zone;
+} dict_paquet;
+
+/* État partagé par les étages du pipeline
+   - nbpaquet paquets circulent en boucle : libres -> (lus) -> a_hacher -> haches -> libres,
+     la mémoire est bornée par leur nombre et leur taille
+   - seule la file des paquets libres peut être vide faute de paquet : les autres ont une
+     place par paquet, un dépôt n'y attend jamais
+   - erreur : les étages suivants laissent passer les paquets sans les traiter, le pipeline se vide
+*/
+typedef struct {
+    dict_paquet *paquets;
+    unsigned int nbpaquet;
+    t3c_file libres;            // écrivain -> lecteur
+    t3c_file lus;               // lecteur -> ensemble des mots (dedup)
+    t3c_file a_hacher;          // lecteur ou ensemble des mots -> threads de hachage
+    t3c_file haches;            // threads de hachage -> écrivain
+    int nbhacheur;
+    int fd;                     // dictionnaire, -1 pour le masque
+    size_t par_paquet;          // octets lus (ou candidats du masque) par paquet
+    dict_dedup *dedup;          // NULL : pas d'ensemble des mots
+    dict_zone *zone;            // NULL : pas d'ensemble des candidats ; sans l'un ni l'autre, pas d'étage
+    atomic_int erreur;
+    _Atomic uint64_t nbproduit; // paquets produits par le lecteur, connu à la fin de la lecture
+    atomic_int lecture_finie;
+    atomic_size_t nbDone;       // compteur des tranches (progression affichée par l'écrivain)
+} dict_pipeline;
+
+static size_t paquet_octets = 0;        // 0 : DICT_FLUX_OCTETS
+static unsigned int paquets_nb = 0;     // 0 : deux paquets par thread de hachage, plus deux
+
+/* Taille des paquets (octets du dictionnaire) et nombre de paquets en vol du pipeline des
+   générations suivantes (--batch-size, --queue-depth) ; 0 : valeur par défaut
+*/
+void dict_regler_pipeline(size_t octets, unsigned int profondeur){
+    paquet_octets = octets;
+    paquets_nb = profondeur;
+}
+
+/* Dimensions du pipeline pour nbthreads threads de hachage
+   - règles : le paquet est divisé par le nombre de règles (DICT_REGLES_BLOC_MIN au moins) pour
+     que les sorties, un couple par candidat, restent de la taille de celles d'un paquet sans règle
+*/
+static void dict_pipeline_dimensions(int nbthreads, size_t *octets, unsigned int *nbpaquet){
+    *octets = paquet_octets ? paquet_octets : DICT_FLUX_OCTETS;
+    if (regles_actives)
+        *octets = *octets / regles_actives->nbregle > DICT_REGLES_BLOC_MIN ? *octets / regles_actives->nbregle : DICT_REGLES_BLOC_MIN;
+    *nbpaquet = paquets_nb ? paquets_nb : 2 * (unsigned int)nbthreads + 2;
+}
+
+/* Fin de la source : fixe le nombre de paquets produits, arrête l'étage suivant (paquets NULL)
+   et réveille l'écrivain s'il attend
+*/
+static void dict_pipeline_clore(dict_pipeline *pipe, uint64_t nbproduit){
+    atomic_store(&pipe->nbproduit, nbproduit);
+    atomic_store(&pipe->lecture_finie, 1);
+    if (pipe->dedup || pipe->zone)
+        t3c_file_deposer(&pipe->lus, NULL, T3C_STATS_ATTENTE_LECTURE);
+    else
+        for (int i = 0; i < pipe->nbhacheur; ++i)
+            t3c_file_deposer(&pipe->a_hacher, NULL, T3C_STATS_ATTENTE_LECTURE);
+    t3c_file_deposer(&pipe->haches, NULL, T3C_STATS_ATTENTE_LECTURE);
+}
+
+// Remet à zéro la tranche d'un paquet avant de le remplir
+static void dict_paquet_vider(dict_paquet *paquet){
+    dict_tranche *tranche = &paquet->tranche;
+    tranche->nbmot = 0;
+    memset(tranche->taille_sortie, 0, sizeof tranche->taille_sortie);
+    tranche->retour = 0;
+    tranche->dedup = NULL;
+    tranche->garder = 0;
+    tranche->nbdoublons = 0;
+    tranche->regles = regles_actives;
+    tranche->candidats = NULL;
+    tranche->zone = NULL;
+    tranche->taille_zone = 0;
+}
+
+/* Remplit le paquet : report (fin de ligne incomplète du paquet précédent) puis octets lus
+   - Met dans coupe la taille des lignes complètes, dans remplissage celle des octets du tampon,
+     et 1 dans eof en fin de fichier (tout est alors gardé) ; -1 en cas d'erreur
+   - ligne plus longue que le paquet : le tampon est agrandi pour la lire en entier
+*/
+static int dict_paquet_lire(dict_pipeline *pipe, dict_paquet *paquet, const char *report, size_t taille_report, size_t *coupe, size_t *remplissage, int *eof){
+    if (paquet->capacite < taille_report + pipe->par_paquet){
+        char *plus = realloc(paquet->octets, taille_report + pipe->par_paquet);
+        if (!plus){
+            printf("control_dict.c : ERREUR > realloc du tampon de lecture (%zu)\n", taille_report + pipe->par_paquet);
             return -1;
         }
+        paquet->octets = plus;
+        paquet->capacite = taille_report + pipe->par_paquet;
+    }
+    if (taille_report > 0)
+        memcpy(paquet->octets, report, taille_report);
+    *remplissage = taille_report;
+    for (;;){
+        uint64_t debut = t3c_stats_debut();
+        ssize_t lu = dict_lire(pipe->fd, paquet->octets + *remplissage, paquet->capacite - *remplissage);
+        t3c_stats_phase(T3C_STATS_LECTURE, debut);
+        if (lu < 0){
+            printf("control_dict.c : ERREUR > La lecture du dictionnaire à échoué\n");
+            return -1;
+        }
+        t3c_stats_compter(T3C_STATS_OCTETS_LUS, (uint64_t)lu);
+        *remplissage += (size_t)lu;
+        *eof = *remplissage < paquet->capacite;
+        const char *nl = *eof ? NULL : memrchr(paquet->octets, '\n', *remplissage);
+        if (*eof || nl){
+            *coupe = *eof ? *remplissage : (size_t)(nl - paquet->octets) + 1;
+            return 0;
+        }
+        char *plus = realloc(paquet->octets, paquet->capacite * 2);
+        if (!plus){
+            printf("control_dict.c : ERREUR > realloc du tampon de lecture (%zu)\n", paquet->capacite * 2);
+            return -1;
+        }
+        paquet->octets = plus;
+        paquet->capacite *= 2;
+    }
+}
 
-        // Conversion du digest binaire en hex
-        char hex[EVP_MAX_MD_SIZE * 2 + 1];
-        bin_to_hex(digest, digest_taille, hex);
+/* Étage de lecture : remplit les paquets libres dans l'ordre de la source et les numérote
+   - dictionnaire : lignes complètes, la fin de ligne incomplète est reportée au paquet suivant
+   - masque : par_paquet candidats consécutifs, aucun octet lu
+*/
+static void *dict_lecteur(void *arg){
+    dict_pipeline *pipe = arg;
+    char *report = NULL;
+    size_t taille_report = 0;
+    uint64_t numero = 0;
+    uint64_t position = 0;
+    int eof = 0;
+    while (!eof && !atomic_load(&pipe->erreur)){
+        dict_paquet *paquet = t3c_file_prendre(&pipe->libres, T3C_STATS_ATTENTE_LECTURE);
+        dict_tranche *tranche = &paquet->tranche;
+        dict_paquet_vider(paquet);
+        if (masque_actif){
+            tranche->nbindice = masque_nb - position < pipe->par_paquet ? masque_nb - position : pipe->par_paquet;
+            tranche->premier = masque_premier + position;
+            position += tranche->nbindice;
+            eof = position == masque_nb;
+        }
+        else {
+            size_t coupe = 0;
+            size_t remplissage = 0;
+            char *suite = NULL;
+            if (dict_paquet_lire(pipe, paquet, report, taille_report, &coupe, &remplissage, &eof) != 0
+                || (remplissage > coupe && !(suite = realloc(report, remplissage - coupe)))){
+                if (remplissage > coupe && !suite)
+                    printf("control_dict.c : ERREUR > realloc de la fin de ligne reportée (%zu)\n", remplissage - coupe);
+                atomic_store(&pipe->erreur, 1);
+                t3c_file_deposer(&pipe->libres, paquet, T3C_STATS_ATTENTE_LECTURE);
+                break;
+            }
+            if (suite){
+                report = suite;
+                memcpy(report, paquet->octets + coupe, remplissage - coupe);
+            }
+            taille_report = remplissage - coupe;
+            tranche->debut = paquet->octets;
+            tranche->fin = paquet->octets + coupe;
+            paquet->position = position;
+            position += coupe;
+        }
+        paquet->avancee = position;
+        paquet->numero = numero++;
+        t3c_file_deposer(pipe->dedup || pipe->zone ? &pipe->lus : &pipe->a_hacher, paquet, T3C_STATS_ATTENTE_LECTURE);
+    }
+    free(report);
+    dict_pipeline_clore(pipe, numero);
+    return NULL;
+}
+
+/* Passe le paquet par l'ensemble des mots et note la première occurrence de chacun de ses mots
+   - les paquets arrivent dans l'ordre : les mots d'un paquet sont insérés, marqués puis
+     recopiés avant ceux du suivant, comme en lecture par blocs
+   - les threads de hachage ne lisent plus que les drapeaux (tranche->garder), pas l'ensemble
+*/
+static int dict_paquet_dedoublonner(dict_dedup *dedup, dict_paquet *paquet){
+    dict_tranche *tranche = &paquet->tranche;
+    tranche->regles = NULL;
+    dict_compter(tranche);
+    tranche->regles = regles_actives;
+    if (dict_dedoublonner(dedup, paquet->octets, paquet->position, tranche, 1) != 0)
+        return -1;
+    size_t k = 0;
+    const char *ligne = tranche->debut;
+    while (ligne < tranche->fin){
+        const char *nl = memchr(ligne, '\n', (size_t)(tranche->fin - ligne));
+        const char *fin_ligne = nl ? nl : tranche->fin;
+        if (dict_mot(ligne, (size_t)(fin_ligne - ligne)) > 0){
+            tranche->cases[k] = (uint32_t)dict_premier(tranche, k, ligne);
+            k++;
+        }
+        ligne = nl ? nl + 1 : tranche->fin;
+    }
+    tranche->dedup = NULL;
+    tranche->garder = 1;
+    return dict_dedup_copier(dedup);
+}
+
+/* Règles avec dedup : développe les candidats des premières occurrences du paquet (ou de ses
+   indices du masque) dans sa zone, les passe par l'ensemble des candidats et écrit dans l'en-tête
+   de chaque entrée, à la place de sa case, le drapeau de sa première occurrence
+   - même ordre que les mots : les candidats d'un paquet sont recopiés avant ceux du suivant
+*/
+static int dict_paquet_developper(dict_zone *zone, dict_paquet *paquet){
+    dict_tranche *tranche = &paquet->tranche;
+    tranche->nbmot = 0;
+    tranche->taille_zone = 0;
+    dict_compter(tranche);
+    size_t taille_zone = 0;
+    if (dict_developper_tranches(&zone->ensemble, zone->position, &paquet->zone, &paquet->capacite_zone, &taille_zone, tranche, 1) != 0)
+        return -1;
+    for (char *entree = tranche->zone; entree < tranche->zone + taille_zone; ){
+        uint32_t c;
+        const char *mot;
+        size_t taille;
+        dict_zone_lire(entree, &c, &mot, &taille);
+        uint32_t premier = (uint32_t)dict_dedup_premier(&zone->ensemble, c, mot);
+        memcpy(entree, &premier, sizeof premier);
+        entree += DICT_ZONE_ENTETE + taille;
+    }
+    tranche->candidats = NULL;
+    tranche->garder = 1;
+    if (dict_dedup_copier(&zone->ensemble) != 0)
+        return -1;
+    zone->position += taille_zone;
+    return 0;
+}
+
+// Étage de l'ensemble des mots (dedup) et des candidats : un seul thread, les paquets dans l'ordre de lecture
+static void *dict_dedoublonneur(void *arg){
+    dict_pipeline *pipe = arg;
+    dict_paquet *paquet;
+    while ((paquet = t3c_file_prendre(&pipe->lus, T3C_STATS_ATTENTE_DEDOUBLONNAGE)) != NULL){
+        if (!atomic_load(&pipe->erreur)){
+            uint64_t debut = t3c_stats_debut();
+            if ((pipe->dedup && dict_paquet_dedoublonner(pipe->dedup, paquet) != 0)
+                || (pipe->zone && dict_paquet_developper(pipe->zone, paquet) != 0))
+                atomic_store(&pipe->erreur, 1);
+            t3c_stats_phase(T3C_STATS_DEDOUBLONNAGE, debut);
+        }
+        t3c_file_deposer(&pipe->a_hacher, paquet, T3C_STATS_ATTENTE_DEDOUBLONNAGE);
+    }
+    for (int i = 0; i < pipe->nbhacheur; ++i)
+        t3c_file_deposer(&pipe->a_hacher, NULL, T3C_STATS_ATTENTE_DEDOUBLONNAGE);
+    return NULL;
+}
 
-        // Ajout du couple hash mdp dans la table T3C en mémoire
-        if (t3c_add(table, ligne, hex) != 0){
-            printf("control_dict.c : ERREUR > L'ajout d'un couple condensat et mdp dans la table à échoué\n");
-            free(ligne);
-            fclose(fichier);
+// Étage de hachage : chaque thread prend le prochain paquet et le hache en entier (dict_hacher)
+static void *dict_hacheur(void *arg){
+    dict_pipeline *pipe = arg;
+    dict_paquet *paquet;
+    while ((paquet = t3c_file_prendre(&pipe->a_hacher, T3C_STATS_ATTENTE_HACHAGE)) != NULL){
+        if (!atomic_load(&pipe->erreur)){
+            uint64_t debut = t3c_stats_debut();
+            dict_hacher(&paquet->tranche);
+            t3c_stats_phase(T3C_STATS_HACHAGE, debut);
+        }
+        t3c_file_deposer(&pipe->haches, paquet, T3C_STATS_ATTENTE_HACHAGE);
+    }
+    return NULL;
+}
+
+/* Étage d'écriture (thread appelant) : remet les paquets hachés dans l'ordre de la source,
+   transmet la sortie de chacun au puits puis le rend au lecteur
+   - un paquet arrivé en avance attend dans attente[numero % nbpaquet] : au plus nbpaquet
+     paquets sont en vol, leurs numéros tiennent dans nbpaquet cases consécutives
+   - total : octets du dictionnaire ou candidats du masque, pour la progression
+*/
+static int dict_ecrivain(dict_pipeline *pipe, dict_puits puits, void *ctx, uint64_t total, size_t *nbobj, size_t *nbdoublons){
+    dict_paquet **attente = calloc(pipe->nbpaquet, sizeof *attente);
+    if (!attente){
+        printf("control_dict.c : ERREUR > calloc des paquets en attente (%u)\n", pipe->nbpaquet);
+        atomic_store(&pipe->erreur, 1);
+    }
+    const char *texte = masque_actif ? "( Hachage, candidats )" : "( Hachage, octets )";
+    int prochain_pourcent = 1;
+    uint64_t prochain = 0;
+    while (!atomic_load(&pipe->lecture_finie) || prochain < atomic_load(&pipe->nbproduit)){
+        dict_paquet *paquet = t3c_file_prendre(&pipe->haches, T3C_STATS_ATTENTE_ECRITURE);
+        if (!paquet)
+            continue;        // fin de la lecture : le nombre de paquets est connu
+        if (!attente){
+            t3c_file_deposer(&pipe->libres, paquet, T3C_STATS_ATTENTE_ECRITURE);
+            prochain++;
+            continue;
+        }
+        attente[paquet->numero % pipe->nbpaquet] = paquet;
+        while ((paquet = attente[prochain % pipe->nbpaquet]) != NULL){
+            attente[prochain % pipe->nbpaquet] = NULL;
+            dict_tranche *tranche = &paquet->tranche;
+            if (tranche->retour != 0)
+                atomic_store(&pipe->erreur, 1);
+            uint64_t debut = t3c_stats_debut();
+            for (int a = 0; !atomic_load(&pipe->erreur) && a < tranche->nbalgo; ++a){
+                if (puits(ctx, a, tranche->sortie[a], tranche->taille_sortie[a], tranche->nbmot) != 0)
+                    atomic_store(&pipe->erreur, 1);
+            }
+            t3c_stats_phase(T3C_STATS_ECRITURE, debut);
+            *nbobj += tranche->nbmot;
+            *nbdoublons += tranche->nbdoublons;
+            int pourcent = (int)((double)paquet->avancee * 100 / (double)total);
+            if (!atomic_load(&pipe->erreur) && paquet->avancee < total && pourcent >= prochain_pourcent){
+                progress_bar_dict(paquet->avancee, total, (char*)texte);
+                prochain_pourcent = pourcent + 1;
+            }
+            t3c_file_deposer(&pipe->libres, paquet, T3C_STATS_ATTENTE_ECRITURE);
+            prochain++;
+        }
+    }
+    free(attente);
+    return atomic_load(&pipe->erreur) ? -1 : 0;
+}
+
+/* Lit, hache et transmet à puits le dictionnaire path, en une seule passe, par un pipeline
+   - lecteur (un thread) -> ensemble des mots (un thread, dedup) -> nbthreads threads de
+     hachage -> écrivain (thread appelant), reliés par des files bornées (t3c_file.h) : la
+     lecture, le hachage et l'écriture se recouvrent
+   - Le dictionnaire est lu par paquets de lignes complètes (--batch-size), dont au plus
+     --queue-depth sont en vol : la mémoire est bornée par leur taille et celle de leurs sorties
+   - L'écrivain remet les paquets dans l'ordre : la sortie est celle d'un seul thread
+   - Chaque mot est haché par les nbalgo algos, le puits reçoit la sortie de chacun
+   - dedup : seule la première occurrence de chaque mot est hachée ; l'ensemble garde une copie
+     des mots distincts, la mémoire n'est alors plus bornée par la taille des paquets ; avec des
+     règles, de même pour les candidats, développés par l'étage de l'ensemble (dict_zone)
+   - masque actif : path est ignoré, le lecteur découpe les indices du masque en paquets de
+     candidats (autant que de lignes du masque dans un paquet d'octets) ; pas d'ensemble des
+     mots, deux indices ne donnant jamais le même candidat (mais celui des candidats des règles)
+   - Les attentes de chaque étage sont comptées dans les phases attente_* de --stats
+   - Met le nombre de mots hachés dans nbobj, celui des mots en double ignorés dans nbdoublons
+*/
+static int dict_flux(char *path, char **algos, int nbalgo, int nbthreads, int format, int dedup, dict_puits puits, void *ctx, size_t *nbobj, size_t *nbdoublons){
+    if (dict_algos_valides(algos, nbalgo) != 0)
+        return -1;
+    if (nbthreads < 1)
+        nbthreads = 1;
+    *nbobj = 0;
+    *nbdoublons = 0;
+
+    dict_pipeline pipe;
+    memset(&pipe, 0, sizeof pipe);
+    pipe.fd = -1;
+    uint64_t total = masque_nb;
+    if (!masque_actif){
+        struct stat st;
+        pipe.fd = open(path, O_RDONLY);
+        if (pipe.fd < 0 || fstat(pipe.fd, &st) != 0 || st.st_size == 0){
+            printf("control_dict.c : ERREUR > Le dictionnaire est vide ou l'ouverture du dictionnaire à eu un probleme\n");
+            if (pipe.fd >= 0)
+                close(pipe.fd);
             return -1;
         }
+        posix_fadvise(pipe.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        total = (uint64_t)st.st_size;
+    }
+    dict_pipeline_dimensions(nbthreads, &pipe.par_paquet, &pipe.nbpaquet);
+    if (masque_actif){
+        pipe.par_paquet /= masque_actif->longueur + 1;
+        if (pipe.par_paquet < DICT_LOT_MOTS)
+            pipe.par_paquet = DICT_LOT_MOTS;
+    }
+    dict_dedup ensemble;
+    dict_dedup_init(&ensemble, 1);
+    if (dedup && !masque_actif)
+        pipe.dedup = &ensemble;
+    dict_zone zone = { .position = 0 };
+    dict_dedup_init(&zone.ensemble, 1);
+    if (dedup && regles_actives)
+        pipe.zone = &zone;
 
-        // Mise à jour de la progression
-        nbligneDone++;
-        if ((nbligneDone % pourcentage) == 0 || nbligneDone == nbLigneMax)
-            progress_bar_dict(nbligneDone, nbLigneMax, "( Hachage )");
+    int retour = 0;
+    pipe.paquets = calloc(pipe.nbpaquet, sizeof *pipe.paquets);
+    if (!pipe.paquets){
+        printf("control_dict.c : ERREUR > calloc des paquets du pipeline (%u)\n", pipe.nbpaquet);
+        retour = -1;
+    }
+    // Une place par paquet dans chaque file, plus celles des paquets NULL de fin
+    t3c_file *files[] = { &pipe.libres, &pipe.lus, &pipe.a_hacher, &pipe.haches };
+    size_t capacites[] = { pipe.nbpaquet, pipe.nbpaquet + 1, pipe.nbpaquet + (size_t)nbthreads, pipe.nbpaquet + 1 };
+    int nbfile = 0;
+    while (retour == 0 && nbfile < 4){
+        if (t3c_file_init(files[nbfile], capacites[nbfile]) != 0)
+            retour = -1;
+        else
+            nbfile++;
+    }
+    for (unsigned int i = 0; retour == 0 && i < pipe.nbpaquet; ++i){
+        dict_tranche *tranche = &pipe.paquets[i].tranche;
+        tranche->algos = algos;
+        tranche->nbalgo = nbalgo;
+        tranche->format = format;
+        tranche->nbDone = &pipe.nbDone;
+        tranche->masque = masque_actif;
+        t3c_file_deposer(&pipe.libres, &pipe.paquets[i], T3C_STATS_ATTENTE_LECTURE);
     }
 
-    // Nettoyage pour valgrind
-    free(ligne);
-    fclose(fichier);
+    // Étages : threads de hachage, ensemble des mots puis lecteur ; l'écrivain est le thread appelant
+    pthread_t *hacheurs = malloc((size_t)nbthreads * sizeof *hacheurs);
+    pthread_t dedoublonneur;
+    pthread_t lecteur;
+    int lecteur_lance = 0;
+    int dedoublonneur_lance = 0;
+    if (retour == 0 && !hacheurs){
+        printf("control_dict.c : ERREUR > malloc des threads (%d)\n", nbthreads);
+        retour = -1;
+    }
+    for (int i = 0; retour == 0 && i < nbthreads; ++i){
+        if (pthread_create(&hacheurs[pipe.nbhacheur], NULL, dict_hacheur, &pipe) != 0)
+            break;
+        pipe.nbhacheur++;
+    }
+    if (retour == 0 && pipe.nbhacheur == 0){
+        printf("control_dict.c : ERREUR > pthread_create a échoué pour les threads de hachage\n");
+        retour = -1;
+    }
+    if (retour == 0 && (pipe.dedup || pipe.zone)){
+        dedoublonneur_lance = pthread_create(&dedoublonneur, NULL, dict_dedoublonneur, &pipe) == 0;
+        if (!dedoublonneur_lance){
+            printf("control_dict.c : ERREUR > pthread_create a échoué pour l'ensemble des mots\n");
+            retour = -1;
+        }
+    }
+    if (retour == 0){
+        lecteur_lance = pthread_create(&lecteur, NULL, dict_lecteur, &pipe) == 0;
+        if (!lecteur_lance){
+            printf("control_dict.c : ERREUR > pthread_create a échoué pour le lecteur\n");
+            retour = -1;
+        }
+    }
+    if (lecteur_lance){
+        retour = dict_ecrivain(&pipe, puits, ctx, total, nbobj, nbdoublons);
+        pthread_join(lecteur, NULL);
+    }
+    else if (pipe.nbhacheur > 0 && (!(pipe.dedup || pipe.zone) || dedoublonneur_lance))
+        dict_pipeline_clore(&pipe, 0);      // arrête les étages lancés
+    else if (pipe.nbhacheur > 0)
+        for (int i = 0; i < pipe.nbhacheur; ++i)
+            t3c_file_deposer(&pipe.a_hacher, NULL, T3C_STATS_ATTENTE_LECTURE);
+    if (dedoublonneur_lance)
+        pthread_join(dedoublonneur, NULL);
+    for (int i = 0; i < pipe.nbhacheur; ++i)
+        pthread_join(hacheurs[i], NULL);
+
+    if (retour == 0 && *nbobj == 0){
+        printf("control_dict.c : ERREUR > Le dictionnaire ne contient aucun mot\n");
+        retour = -1;
+    }
+    if (retour == 0){
+        progress_bar_dict(total, total, masque_actif ? "( Hachage, candidats )" : "( Hachage, octets )");
+        t3c_stats_compter(T3C_STATS_MOTS, *nbobj);
+        t3c_stats_compter(T3C_STATS_CONDENSATS, (uint64_t)*nbobj * (uint64_t)nbalgo);
+        t3c_stats_compter(T3C_STATS_DOUBLONS, *nbdoublons);
+    }
+
+    for (unsigned int i = 0; pipe.paquets && i < pipe.nbpaquet; ++i){
+        for (int a = 0; a < T3C_SECTIONS_MAX; ++a)
+            free(pipe.paquets[i].tranche.sortie[a]);
+        free(pipe.paquets[i].tranche.cases);
+        free(pipe.paquets[i].octets);
+        free(pipe.paquets[i].zone);
+    }
+    for (int f = 0; f < nbfile; ++f)
+        t3c_file_free(files[f]);
+    dict_dedup_free(&ensemble);
+    dict_dedup_free(&zone.ensemble);
+    free(hacheurs);
+    free(pipe.paquets);
+    if (pipe.fd >= 0)
+        close(pipe.fd);
+    return retour;
+}
+
+/* Sorties du mode texte
+   - table : la T3C, écrite par grands tampons (t3c_ecrivain.h), reçoit la section du premier algo
+   - fichiers[a] : section de l'algo a > 0, dans un fichier temporaire recopié à la fin
+*/
+typedef struct {
+    t3c_ecrivain table;
+    FILE *fichiers[T3C_SECTIONS_MAX];
+} dict_sorties;
+
+// Puits du mode texte : les lignes sont écrites telles quelles, celles de l'algo a dans sa sortie
+static int dict_puits_fichier(void *ctx, int a, const char *sortie, size_t taille, size_t nbmot){
+    (void)nbmot;
+    dict_sorties *sorties = ctx;
+    if (taille == 0)
+        return 0;
+    if (a == 0 ? t3c_ecrivain_ajouter(&sorties->table, sortie, taille) != 0 : fwrite(sortie, 1, taille, sorties->fichiers[a]) != taille){
+        printf("control_dict.c : ERREUR > L'écriture de la table t3c à échoué\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Génère directement la T3C texte out_path depuis le dictionnaire path, en une seule passe
+   - Chaque bloc est haché en parallèle puis écrit dans l'ordre du dictionnaire : le fichier
+     est identique à celui de dict_to_Table + create_t3c
+   - La section du premier algo est écrite directement par grands tampons (t3c_ecrivain.h),
+     celles des autres dans des fichiers temporaires (dossier de la sortie) recopiés ensuite
+     derrière leur en-tête
+   - Met le nombre de mots hachés dans nbobj, celui des mots en double ignorés (dedup) dans nbdoublons
+*/
+int dict_to_t3c_flux(char *path, char **algos, int nbalgo, char *out_path, int nbthreads, int dedup, size_t *nbobj, size_t *nbdoublons){
+    if (dict_algos_valides(algos, nbalgo) != 0)
+        return -1;
+    dict_sorties sorties;
+    memset(sorties.fichiers, 0, sizeof sorties.fichiers);
+    if (t3c_ecrivain_ouvrir(&sorties.table, out_path, 0) != 0){
+        printf("control_dict.c : ERREUR > L'ouverture du fichier t3c à eu un probleme\n");
+        return -1;
+    }
+    int retour = t3c_txt_entete(&sorties.table, algos[0]);
+
+    char dossier[4096];
+    t3c_dossier(out_path, dossier, sizeof dossier);
+    for (int a = 1; retour == 0 && a < nbalgo; ++a){
+        sorties.fichiers[a] = t3c_fichier_temp(dossier);
+        if (!sorties.fichiers[a])
+            retour = -1;
+    }
+
+    if (retour == 0)
+        retour = dict_flux(path, algos, nbalgo, nbthreads, T3C_FORMAT_TXT, dedup, dict_puits_fichier, &sorties, nbobj, nbdoublons);
+    uint64_t debut = t3c_stats_debut();
+    for (int a = 1; retour == 0 && a < nbalgo; ++a){
+        if (t3c_txt_entete(&sorties.table, algos[a]) != 0 || t3c_ecrivain_recopier(&sorties.table, sorties.fichiers[a]) != 0){
+            printf("control_dict.c : ERREUR > La recopie de la section %s à échoué\n", algos[a]);
+            retour = -1;
+        }
+    }
+    for (int a = 1; a < nbalgo; ++a){
+        if (sorties.fichiers[a])
+            fclose(sorties.fichiers[a]);
+    }
+    if (t3c_ecrivain_fermer(&sorties.table) != 0 && retour == 0){
+        printf("control_dict.c : ERREUR > L'écriture de la table t3c à échoué\n");
+        retour = -1;
+    }
+    // Pas de table partielle laissée sur le disque
+    if (retour != 0)
+        unlink(out_path);
+    else if (t3c_stats_actives){
+        struct stat st;
+        t3c_stats_phase(T3C_STATS_ECRITURE, debut);
+        t3c_stats_compter(T3C_STATS_ENTREES_ECRITES, (uint64_t)*nbobj * (uint64_t)nbalgo);
+        if (stat(out_path, &st) == 0)
+            t3c_stats_compter(T3C_STATS_OCTETS_ECRITS, (uint64_t)st.st_size);
+    }
+    return retour;
+}
+
+// Puits du tri externe : chaque enregistrement [condensat][taille][mdp] est confié à t3c_extsort
+static int dict_puits_tri(void *ctx, int a, const char *sortie, size_t taille, size_t nbmot){
+    (void)a;
+    t3c_extsort *tri = ctx;
+    const char *fin = sortie + taille;
+    for (size_t i = 0; i < nbmot && sortie < fin; ++i){
+        uint32_t taille_mdp;
+        memcpy(&taille_mdp, sortie + tri->digest_taille, sizeof taille_mdp);
+        const char *mdp = sortie + tri->digest_taille + sizeof taille_mdp;
+        if (t3c_extsort_add(tri, (const unsigned char*)sortie, mdp, taille_mdp) != 0)
+            return -1;
+        sortie = mdp + taille_mdp;
+    }
+    return 0;
+}
+
+/* Génère la T3C binaire triée out_path sans dépasser mem_limit octets pour le tri
+   - Hachage en flux (dict_flux), runs triées écrites dans tmp_dir, fusion k-voies finale
+   - Pas d'ensemble des mots, dont la mémoire ne serait pas bornée : les doublons sont éliminés
+     sur les condensats, pendant le tri des runs et la fusion
+   - Met le nombre d'entrées écrites (sans doublon) dans nbobj, celui des doublons dans nbdoublons
+*/
+int dict_to_t3c_tri(char *path, char *algo_name, char *out_path, int nbthreads, size_t mem_limit, char *tmp_dir, size_t *nbobj, size_t *nbdoublons){
+    if (nbthreads < 1)
+        nbthreads = 1;
+    // Les paquets en vol du pipeline (lecture et sorties) sont pris sur le budget du tri
+    size_t octets;
+    unsigned int nbpaquet;
+    dict_pipeline_dimensions(nbthreads, &octets, &nbpaquet);
+    size_t flux = 2 * octets * nbpaquet;
+    size_t budget = mem_limit > flux ? mem_limit - flux : 0;
+
+    t3c_extsort tri;
+    if (t3c_extsort_init(&tri, algo_name, budget, tmp_dir) != 0){
+        t3c_extsort_free(&tri);
+        return -1;
+    }
+    size_t nbmot = 0;
+    size_t ignores = 0;
+    int retour = dict_flux(path, &algo_name, 1, nbthreads, T3C_FORMAT_BIN, 0, dict_puits_tri, &tri, &nbmot, &ignores);
+    if (retour == 0)
+        retour = t3c_extsort_write(&tri, out_path);
+    *nbobj = tri.nbentrees - tri.nbdoublons;
+    *nbdoublons = tri.nbdoublons;
+    t3c_stats_compter(T3C_STATS_DOUBLONS, tri.nbdoublons);
+    t3c_extsort_free(&tri);
+    return retour;
+}
+
+/* Shards en cours de génération
+   - fichiers[s] : enregistrements [algo uint8][condensat][taille uint32][mdp] du shard s,
+     NULL pour un shard qui n'est pas reconstruit
+*/
+typedef struct {
+    t3c_manifeste *manifeste;
+    FILE *fichiers[T3C_SHARD_MAX];
+    uint64_t nbentrees[T3C_SHARD_MAX][T3C_SECTIONS_MAX];
+    unsigned int digest_tailles[T3C_SECTIONS_MAX];
+} dict_shards;
+
+// Puits du mode découpé : chaque enregistrement de l'algo a part dans le fichier de son shard
+static int dict_puits_shards(void *ctx, int a, const char *sortie, size_t taille, size_t nbmot){
+    dict_shards *shards = ctx;
+    unsigned int digest_taille = shards->digest_tailles[a];
+    unsigned char algo = (unsigned char)a;
+    const char *fin = sortie + taille;
+    for (size_t i = 0; i < nbmot && sortie < fin; ++i){
+        uint32_t taille_mdp;
+        memcpy(&taille_mdp, sortie + digest_taille, sizeof taille_mdp);
+        size_t taille_entree = digest_taille + sizeof taille_mdp + taille_mdp;
+        unsigned int shard = t3c_shard_de(shards->manifeste, (const unsigned char*)sortie);
+        FILE *fichier = shards->fichiers[shard];
+        if (fichier){
+            if (fwrite(&algo, 1, 1, fichier) != 1 || fwrite(sortie, 1, taille_entree, fichier) != taille_entree){
+                printf("control_dict.c : ERREUR > L'écriture du shard %02x à échoué\n", shard);
+                return -1;
+            }
+            shards->nbentrees[shard][a]++;
+        }
+        sortie += taille_entree;
+    }
     return 0;
 }
+
+/* Relit les enregistrements du shard dans une table par algo puis l'écrit dans chemin
+   - les tables sont allouées exactement (entrées comptées par le puits) : la mémoire est
+     bornée par le plus gros shard et non par la table entière
+*/
+static int dict_shard_ecrire(dict_shards *shards, unsigned int shard, char *chemin){
+    const t3c_manifeste *manifeste = shards->manifeste;
+    FILE *fichier = shards->fichiers[shard];
+    t3c_table tables[T3C_SECTIONS_MAX];
+    int retour = 0;
+    for (size_t a = 0; a < manifeste->nbsection; ++a){
+        t3c_init(&tables[a]);
+        if (retour == 0 && t3c_alloc(&tables[a], shards->nbentrees[shard][a], shards->digest_tailles[a]) != 0)
+            retour = -1;
+        snprintf(tables[a].algo, sizeof tables[a].algo, "%s", manifeste->algos[a]);
+    }
+    if (retour == 0 && (fflush(fichier) != 0 || fseeko(fichier, 0, SEEK_SET) != 0))
+        retour = -1;
+
+    char *mdp = NULL;
+    size_t capacite = 0;
+    int algo;
+    while (retour == 0 && (algo = fgetc(fichier)) != EOF){
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        uint32_t taille_mdp = 0;
+        unsigned int digest_taille = (size_t)algo < manifeste->nbsection ? shards->digest_tailles[algo] : 0;
+        if (digest_taille == 0 || fread(digest, 1, digest_taille, fichier) != digest_taille || fread(&taille_mdp, sizeof taille_mdp, 1, fichier) != 1){
+            retour = -1;
+            break;
+        }
+        if ((size_t)taille_mdp + 1 > capacite){
+            char *plus = realloc(mdp, (size_t)taille_mdp + 1);
+            if (!plus){
+                retour = -1;
+                break;
+            }
+            mdp = plus;
+            capacite = (size_t)taille_mdp + 1;
+        }
+        if (fread(mdp, 1, taille_mdp, fichier) != taille_mdp || t3c_add(&tables[algo], mdp, taille_mdp, digest, digest_taille) != 0)
+            retour = -1;
+    }
+    if (retour == 0 && ferror(fichier))
+        retour = -1;
+    if (retour != 0)
+        printf("control_dict.c : ERREUR > La relecture du shard %02x à échoué\n", shard);
+
+    if (retour == 0 && create_t3c(tables, manifeste->nbsection, chemin, manifeste->format) != 0)
+        retour = -1;
+    free(mdp);
+    for (size_t a = 0; a < manifeste->nbsection; ++a)
+        t3c_free(&tables[a]);
+    return retour;
+}
+
+/* Génère la table découpée out_path (manifeste) et ses shards out_path.d/XX en une passe
+   - le dictionnaire est haché en flux par tous les algos, chaque couple rangé dans le fichier
+     temporaire de son shard (dossier des shards), puis les shards sont écrits un par un
+   - shard_seul >= 0 : seul ce shard est reconstruit ; le manifeste existant doit avoir les mêmes
+     bits, format et algos, et seule sa ligne est mise à jour
+   - dedup : seule la première occurrence de chaque mot est hachée (dict_flux)
+   - Met le nombre de couples écrits dans nbobj, celui des mots en double ignorés dans nbdoublons
+*/
+int dict_to_t3c_shards(char *path, char **algos, int nbalgo, char *out_path, unsigned int bits, int format, int shard_seul, int nbthreads, int dedup, size_t *nbobj, size_t *nbdoublons){
+    if (dict_algos_valides(algos, nbalgo) != 0)
+        return -1;
+    dict_shards *shards = calloc(1, sizeof *shards);
+    t3c_manifeste *manifeste = calloc(1, sizeof *manifeste);
+    if (!shards || !manifeste){
+        printf("control_dict.c : ERREUR > calloc des shards\n");
+        free(shards);
+        free(manifeste);
+        return -1;
+    }
+    shards->manifeste = manifeste;
+
+    int retour = 0;
+    if (shard_seul >= 0){
+        // Reconstruction d'un shard : le reste de la table ne change pas
+        if (t3c_manifeste_lire(out_path, manifeste) != 0)
+            retour = -1;
+        int identique = retour == 0 && manifeste->bits == bits && manifeste->format == format && manifeste->nbsection == (size_t)nbalgo;
+        for (int a = 0; identique && a < nbalgo; ++a)
+            identique = strcmp(manifeste->algos[a], algos[a]) == 0;
+        if (retour == 0 && !identique){
+            printf("control_dict.c : ERREUR > Le shard %02x ne peut être reconstruit qu'avec les bits, le format et les algos du manifeste '%s'\n", shard_seul, out_path);
+            retour = -1;
+        }
+        if (retour == 0 && (unsigned int)shard_seul >= t3c_shard_nb(manifeste)){
+            printf("control_dict.c : ERREUR > Le shard %02x n'existe pas dans une table de %u shards\n", shard_seul, t3c_shard_nb(manifeste));
+            retour = -1;
+        }
+    } else {
+        manifeste->bits = bits;
+        manifeste->format = format;
+        manifeste->nbsection = (size_t)nbalgo;
+        for (int a = 0; a < nbalgo; ++a)
+            snprintf(manifeste->algos[a], T3C_ALGO_MAX, "%s", algos[a]);
+    }
+    for (int a = 0; a < nbalgo; ++a)
+        shards->digest_tailles[a] = (unsigned int)EVP_MD_get_size(EVP_get_digestbyname(algos[a]));
+
+    // Dossier des shards, qui reçoit aussi les fichiers temporaires
+    char dossier[4096];
+    if (retour == 0 && snprintf(dossier, sizeof dossier, "%s%s", out_path, T3C_SHARD_SUFFIXE) >= (int)sizeof dossier){
+        printf("control_dict.c : ERREUR > Le chemin des shards de '%s' est trop long\n", out_path);
+        retour = -1;
+    }
+    if (retour == 0 && mkdir(dossier, 0755) != 0 && errno != EEXIST){
+        printf("control_dict.c : ERREUR > La création du dossier des shards '%s' à échoué\n", dossier);
+        retour = -1;
+    }
+    for (unsigned int shard = 0; retour == 0 && shard < t3c_shard_nb(manifeste); ++shard){
+        if (shard_seul >= 0 && shard != (unsigned int)shard_seul)
+            continue;
+        shards->fichiers[shard] = t3c_fichier_temp(dossier);
+        if (!shards->fichiers[shard])
+            retour = -1;
+    }
+
+    if (retour == 0)
+        retour = dict_flux(path, algos, nbalgo, nbthreads, T3C_FORMAT_BIN, dedup, dict_puits_shards, shards, nbobj, nbdoublons);
+
+    // Écriture des shards un par un
+    *nbobj = 0;
+    for (unsigned int shard = 0; retour == 0 && shard < t3c_shard_nb(manifeste); ++shard){
+        char chemin[4096];
+        if (!shards->fichiers[shard])
+            continue;
+        if (t3c_shard_chemin(out_path, shard, chemin, sizeof chemin) != 0 || dict_shard_ecrire(shards, shard, chemin) != 0){
+            retour = -1;
+            break;
+        }
+        manifeste->nbobj[shard] = 0;
+        for (int a = 0; a < nbalgo; ++a)
+            manifeste->nbobj[shard] += shards->nbentrees[shard][a];
+        *nbobj += manifeste->nbobj[shard];
+    }
+    if (retour == 0)
+        retour = t3c_manifeste_ecrire(out_path, manifeste);
+
+    for (unsigned int shard = 0; shard < T3C_SHARD_MAX; ++shard){
+        if (shards->fichiers[shard])
+            fclose(shards->fichiers[shard]);
+    }
+    free(shards);
+    free(manifeste);
+    return retour;
+}
@@ -0,0 +1,196 @@
+/**
+ * dict_dedup.c - Élimination des mots en double du dictionnaire avant le hachage (-G)
+ *  - Ensemble concurrent sur les octets des mots : chaque thread y insère les mots de sa
+ *    tranche sans verrou, puis seuls les mots à leur première occurrence sont hachés et écrits
+ *  - La première occurrence est celle de plus petite position dans le fichier : la table
+ *    produite ne dépend pas du nombre de threads
+ *  - Le mot n'est pas copié dans la case : il est relu dans le dictionnaire projeté, ou, en mode
+ *    flux, recopié dans un blob à la fin de chaque bloc (la mémoire suit alors les mots distincts)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dict_dedup.h"
+
+// Hachage 64 bits des octets du mot, 8 octets à la fois (finaliseur de splitmix64)
+static uint64_t dedup_hachage(const char *mot, size_t taille){
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)taille;
+    uint64_t v;
+    while (taille >= 8){
+        memcpy(&v, mot, 8);
+        h = (h ^ v) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+        mot += 8;
+        taille -= 8;
+    }
+    v = 0;
+    memcpy(&v, mot, taille);
+    h = (h ^ v) * 0x94D049BB133111EBULL;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return h ^ (h >> 32);
+}
+
+// Case de départ du sondage : multiplication de Fibonacci de l'empreinte ramenée à la capacité
+static size_t dedup_depart(const dict_dedup *ens, uint32_t empreinte){
+    size_t i = (size_t)(((uint64_t)empreinte * 0x9E3779B97F4A7C15ULL) >> 32);
+    return i & (ens->capacite - 1);
+}
+
+// Mot rangé à la position de la case : dans le blob s'il a été recopié, sinon dans le bloc en cours
+static const char *dedup_mot(const dict_dedup *ens, uint64_t position){
+    if (position & DICT_DEDUP_COPIE)
+        return ens->blob.data + (position & ~DICT_DEDUP_COPIE);
+    return ens->bloc + (position - 1 - ens->bloc_position);
+}
+
+// Initialise un ensemble vide ; copie = 1 en mode flux (les blocs du dictionnaire sont remplacés)
+void dict_dedup_init(dict_dedup *ens, int copie){
+    memset(ens, 0, sizeof *ens);
+    atomic_init(&ens->nbnouveaux, 0);
+    ens->copie = copie;
+}
+
+/* Prépare l'ensemble pour nbmot nouveaux mots du bloc, dont le premier octet est à bloc_position
+   - la capacité reste au moins le double des mots rangés : les cases sont redistribuées si besoin
+   - à appeler par un seul thread, avant les insertions du bloc (et après dict_dedup_copier)
+*/
+int dict_dedup_reserver(dict_dedup *ens, size_t nbmot, const char *bloc, uint64_t bloc_position){
+    ens->nbmot += atomic_load(&ens->nbnouveaux);
+    atomic_store(&ens->nbnouveaux, 0);
+    ens->bloc = bloc;
+    ens->bloc_position = bloc_position;
+
+    size_t besoin = 2 * (ens->nbmot + nbmot);
+    if (besoin > ens->capacite){
+        size_t capacite = ens->capacite ? ens->capacite : DICT_DEDUP_CAPACITE_MIN;
+        while (capacite < besoin)
+            capacite *= 2;
+        if (capacite > DICT_DEDUP_CASES_MAX){
+            printf("dict_dedup.c : ERREUR > Trop de mots distincts pour l'ensemble (%zu), utiliser --no-dedup\n", ens->nbmot + nbmot);
+            return -1;
+        }
+        dict_dedup_case *cases = calloc(capacite, sizeof *cases);
+        if (!cases){
+            printf("dict_dedup.c : ERREUR > calloc de l'ensemble des mots (%zu cases)\n", capacite);
+            return -1;
+        }
+        dict_dedup_case *anciennes = ens->cases;
+        size_t nbancienne = ens->capacite;
+        ens->cases = cases;
+        ens->capacite = capacite;
+        for (size_t j = 0; j < nbancienne; ++j){
+            const dict_dedup_case *c = &anciennes[j];
+            uint64_t position = atomic_load_explicit(&c->position, memory_order_relaxed);
+            if (position == 0)
+                continue;
+            size_t i = dedup_depart(ens, c->empreinte);
+            while (atomic_load_explicit(&cases[i].position, memory_order_relaxed) != 0)
+                i = (i + 1) & (capacite - 1);
+            cases[i].taille = c->taille;
+            cases[i].empreinte = c->empreinte;
+            atomic_store_explicit(&cases[i].position, position, memory_order_relaxed);
+        }
+        free(anciennes);
+    }
+
+    if (ens->copie && nbmot > ens->capacite_nouveaux){
+        size_t *nouveaux = realloc(ens->nouveaux, nbmot * sizeof *nouveaux);
+        if (!nouveaux){
+            printf("dict_dedup.c : ERREUR > realloc des mots nouveaux du bloc (%zu)\n", nbmot);
+            return -1;
+        }
+        ens->nouveaux = nouveaux;
+        ens->capacite_nouveaux = nbmot;
+    }
+    return 0;
+}
+
+/* Insère un mot du bloc en cours et renvoie sa case
+   - case libre : réservée par CAS (DICT_DEDUP_PRISE) le temps d'écrire taille et empreinte
+   - mot déjà présent plus loin dans le bloc : sa position est ramenée à celle-ci
+*/
+static uint32_t dedup_inserer(dict_dedup *ens, const char *mot, size_t taille, uint32_t empreinte, size_t depart){
+    uint64_t position = ens->bloc_position + (uint64_t)(mot - ens->bloc) + 1;
+    for (size_t i = depart; ; i = (i + 1) & (ens->capacite - 1)){
+        dict_dedup_case *c = &ens->cases[i];
+        uint64_t actuelle = atomic_load_explicit(&c->position, memory_order_acquire);
+        if (actuelle == 0){
+            if (atomic_compare_exchange_strong_explicit(&c->position, &actuelle, DICT_DEDUP_PRISE, memory_order_acquire, memory_order_acquire)){
+                c->taille = (uint32_t)taille;
+                c->empreinte = empreinte;
+                size_t rang = atomic_fetch_add_explicit(&ens->nbnouveaux, 1, memory_order_relaxed);
+                if (ens->copie)
+                    ens->nouveaux[rang] = i;
+                atomic_store_explicit(&c->position, position, memory_order_release);
+                return (uint32_t)i;
+            }
+        }
+        while (actuelle == DICT_DEDUP_PRISE)
+            actuelle = atomic_load_explicit(&c->position, memory_order_acquire);
+        if (c->empreinte != empreinte || c->taille != taille || memcmp(dedup_mot(ens, actuelle), mot, taille) != 0)
+            continue;
+
+        // Même mot : la plus petite position l'emporte (un mot recopié vient d'un bloc précédent)
+        while (!(actuelle & DICT_DEDUP_COPIE) && actuelle > position
+               && !atomic_compare_exchange_weak_explicit(&c->position, &actuelle, position, memory_order_acq_rel, memory_order_acquire))
+            ;
+        return (uint32_t)i;
+    }
+}
+
+/* Insère nb mots (au plus DICT_DEDUP_LOT) du bloc en cours ; appelé en parallèle par les threads
+   - les cases de départ sont calculées et préchargées pour tout le lot avant les insertions :
+     les défauts de cache de l'ensemble se recouvrent au lieu de s'enchaîner
+   - cases[k] reçoit la case du mot k, à redonner à dict_dedup_premier
+   - un mot de plus de 4 Gio n'est jamais dédoublonné (DICT_DEDUP_AUCUNE)
+*/
+void dict_dedup_inserer(dict_dedup *ens, const char **mots, const size_t *tailles, size_t nb, uint32_t *cases){
+    uint32_t empreintes[DICT_DEDUP_LOT];
+    size_t departs[DICT_DEDUP_LOT];
+    for (size_t k = 0; k < nb; ++k){
+        empreintes[k] = (uint32_t)(dedup_hachage(mots[k], tailles[k]) >> 32);
+        departs[k] = dedup_depart(ens, empreintes[k]);
+        __builtin_prefetch(&ens->cases[departs[k]], 1);
+    }
+    for (size_t k = 0; k < nb; ++k)
+        cases[k] = tailles[k] > UINT32_MAX ? DICT_DEDUP_AUCUNE : dedup_inserer(ens, mots[k], tailles[k], empreintes[k], departs[k]);
+}
+
+/* Renvoie 1 si le mot du bloc en cours, rangé dans la case c, est la première occurrence de son mot
+   - à appeler une fois toutes les insertions du bloc terminées
+*/
+int dict_dedup_premier(const dict_dedup *ens, uint32_t c, const char *mot){
+    if (c == DICT_DEDUP_AUCUNE)
+        return 1;
+    uint64_t position = ens->bloc_position + (uint64_t)(mot - ens->bloc) + 1;
+    return atomic_load_explicit(&ens->cases[c].position, memory_order_relaxed) == position;
+}
+
+/* Mode flux : recopie dans le blob les mots ajoutés par le bloc en cours, avant qu'il soit remplacé
+   - la position de leur case devient leur offset dans le blob
+*/
+int dict_dedup_copier(dict_dedup *ens){
+    size_t nb = atomic_load(&ens->nbnouveaux);
+    for (size_t j = 0; ens->copie && j < nb; ++j){
+        if (j + DICT_DEDUP_LOT < nb)
+            dict_dedup_precharger(ens, (uint32_t)ens->nouveaux[j + DICT_DEDUP_LOT]);
+        dict_dedup_case *c = &ens->cases[ens->nouveaux[j]];
+        uint64_t position = atomic_load_explicit(&c->position, memory_order_relaxed);
+        uint64_t offset = 0;
+        if (t3c_blob_ajouter(&ens->blob, dedup_mot(ens, position), c->taille, &offset) != 0)
+            return -1;
+        atomic_store_explicit(&c->position, offset | DICT_DEDUP_COPIE, memory_order_relaxed);
+    }
+    return 0;
+}
+
+// Libère l'ensemble et le remet à vide
+void dict_dedup_free(dict_dedup *ens){
+    free(ens->cases);
+    free(ens->nouveaux);
+    t3c_blob_free(&ens->blob);
+    dict_dedup_init(ens, 0);
+}
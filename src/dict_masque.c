@@ -0,0 +1,140 @@
+/**
+ * dict_masque.c - Masques de génération (-M <masque>)
+ *  - Compile un masque hashcat (?l?u?d?s?a?h?H, ?1 .. ?4, caractères littéraux) en un jeu
+ *    de caractères par position, une fois avant la génération
+ *  - L'espace des candidats est numéroté : chaque thread reçoit un intervalle d'indices,
+ *    place son compteur sur le premier (dict_masque_placer) puis avance d'un candidat à
+ *    l'autre sans allocation (dict_masque_suivant)
+ *  - Les candidats ne passent jamais par un fichier : ils partent directement au hachage
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dict_masque.h"
+
+#define DICT_MASQUE_MINUSCULES "abcdefghijklmnopqrstuvwxyz"
+#define DICT_MASQUE_MAJUSCULES "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+#define DICT_MASQUE_CHIFFRES   "0123456789"
+#define DICT_MASQUE_SPECIAUX   " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"
+
+// Caractères de la classe ?c (hors jeux personnalisés), NULL si la classe est inconnue
+static const char *dict_masque_classe(char c){
+    switch (c){
+        case 'l': return DICT_MASQUE_MINUSCULES;
+        case 'u': return DICT_MASQUE_MAJUSCULES;
+        case 'd': return DICT_MASQUE_CHIFFRES;
+        case 's': return DICT_MASQUE_SPECIAUX;
+        case 'a': return DICT_MASQUE_MINUSCULES DICT_MASQUE_MAJUSCULES DICT_MASQUE_CHIFFRES DICT_MASQUE_SPECIAUX;
+        case 'h': return "0123456789abcdef";
+        case 'H': return "0123456789ABCDEF";
+        case '?': return "?";
+        default:  return NULL;
+    }
+}
+
+/* Ajoute au jeu les caractères de texte qu'il ne contient pas encore (vu : caractères déjà rangés)
+   - les fins de ligne sont refusées : elles couperaient la ligne du candidat dans une table texte
+*/
+static int dict_masque_ajouter(char *jeu, unsigned int *taille, unsigned char *vu, const char *texte, size_t longueur){
+    for (size_t i = 0; i < longueur; ++i){
+        unsigned char c = (unsigned char)texte[i];
+        if (c == '\n' || c == '\r'){
+            printf("dict_masque.c : ERREUR > Un jeu de caractères ne peut pas contenir de fin de ligne\n");
+            return -1;
+        }
+        if (!vu[c]){
+            vu[c] = 1;
+            jeu[(*taille)++] = (char)c;
+        }
+    }
+    return 0;
+}
+
+/* Développe texte (classes ?x et caractères littéraux) en un jeu de caractères distincts
+   - perso : jeux ?1 .. ?4 (NULL pour ceux qui ne sont pas définis) ; NULL dans un jeu
+     personnalisé, qui ne peut pas en utiliser un autre
+*/
+static int dict_masque_jeu(const char *texte, size_t longueur, char *const *perso, char *jeu, unsigned int *taille){
+    unsigned char vu[256] = {0};
+    *taille = 0;
+    for (size_t i = 0; i < longueur; ++i){
+        if (texte[i] != '?'){
+            if (dict_masque_ajouter(jeu, taille, vu, texte + i, 1) != 0)
+                return -1;
+            continue;
+        }
+        if (i + 1 == longueur){
+            printf("dict_masque.c : ERREUR > '?' doit être suivi d'une classe (l u d s a h H 1-4 ?)\n");
+            return -1;
+        }
+        char c = texte[++i];
+        if (c >= '1' && c < '1' + DICT_MASQUE_PERSO){
+            const char *jeu_perso = perso ? perso[c - '1'] : NULL;
+            char sous_jeu[DICT_MASQUE_JEU_MAX];
+            unsigned int sous_taille = 0;
+            if (!jeu_perso){
+                printf("dict_masque.c : ERREUR > Le jeu ?%c n'est pas défini (--charset%c=<cs> dans un masque)\n", c, c);
+                return -1;
+            }
+            if (dict_masque_jeu(jeu_perso, strlen(jeu_perso), NULL, sous_jeu, &sous_taille) != 0 || dict_masque_ajouter(jeu, taille, vu, sous_jeu, sous_taille) != 0)
+                return -1;
+            continue;
+        }
+        const char *classe = dict_masque_classe(c);
+        if (!classe){
+            printf("dict_masque.c : ERREUR > Classe inconnue '?%c' (l u d s a h H 1-4 ?)\n", c);
+            return -1;
+        }
+        if (dict_masque_ajouter(jeu, taille, vu, classe, strlen(classe)) != 0)
+            return -1;
+    }
+    if (*taille == 0){
+        printf("dict_masque.c : ERREUR > Un jeu de caractères est vide\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Compile le masque texte : une position par caractère littéral ou par classe ?x
+   - perso : DICT_MASQUE_PERSO jeux personnalisés (NULL si non définis), qui peuvent eux-mêmes
+     utiliser les classes ?l ?u ?d ?s ?a ?h ?H
+   - Renvoie -1 si le masque est invalide ou si son espace dépasse 2^64 - 1 candidats
+*/
+int dict_masque_lire(const char *texte, char *const *perso, dict_masque *masque){
+    masque->longueur = 0;
+    masque->nbcandidat = 1;
+    size_t longueur = strlen(texte);
+    for (size_t i = 0; i < longueur; ){
+        size_t taille_position = (texte[i] == '?' && i + 1 < longueur) ? 2 : 1;
+        if (masque->longueur == DICT_MASQUE_POSITIONS){
+            printf("dict_masque.c : ERREUR > Le masque a plus de %d positions\n", DICT_MASQUE_POSITIONS);
+            return -1;
+        }
+        unsigned int p = masque->longueur;
+        if (dict_masque_jeu(texte + i, taille_position, perso, masque->jeux[p], &masque->tailles[p]) != 0)
+            return -1;
+        if (__builtin_mul_overflow(masque->nbcandidat, (uint64_t)masque->tailles[p], &masque->nbcandidat)){
+            printf("dict_masque.c : ERREUR > Le masque '%s' dépasse 2^64 - 1 candidats\n", texte);
+            return -1;
+        }
+        masque->longueur++;
+        i += taille_position;
+    }
+    if (masque->longueur == 0){
+        printf("dict_masque.c : ERREUR > Le masque est vide\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Place le compteur (chiffres) et le candidat (longueur octets, sans '\0') sur l'indice donné
+   - indice < nbcandidat ; les candidats suivants s'obtiennent avec dict_masque_suivant
+*/
+void dict_masque_placer(const dict_masque *masque, uint64_t indice, unsigned int *chiffres, char *candidat){
+    for (unsigned int p = masque->longueur; p-- > 0; ){
+        chiffres[p] = (unsigned int)(indice % masque->tailles[p]);
+        indice /= masque->tailles[p];
+        candidat[p] = masque->jeux[p][chiffres[p]];
+    }
+}
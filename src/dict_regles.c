@@ -0,0 +1,392 @@
+/**
+ * dict_regles.c - Règles de transformation des mots du dictionnaire (-G --rules=<fichier>)
+ *  - Lit un fichier de règles au format hashcat (une règle par ligne, fonctions à la suite,
+ *    lignes vides et commentaires '#' ignorés) et le compile une fois
+ *  - Applique une règle à un mot dans un tampon de DICT_REGLES_MOT_MAX octets : les
+ *    candidats ne sont jamais écrits sur disque, ils partent directement au hachage
+ *  - Comme hashcat : une position hors du mot laisse le mot inchangé, un candidat vide ou
+ *    plus long que DICT_REGLES_MOT_MAX est rejeté ; la casse ne touche que l'ASCII
+ *  - L'expansion se fait dans les threads de hachage (control_dict.c), mot par mot
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dict_regles.h"
+
+static inline char minuscule(char c){
+    return (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c;
+}
+
+static inline char majuscule(char c){
+    return (c >= 'a' && c <= 'z') ? (char)(c - 32) : c;
+}
+
+static inline char basculer(char c){
+    return (c >= 'a' && c <= 'z') ? (char)(c - 32) : (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c;
+}
+
+// Position d'une fonction : 0-9 puis A-Z (10 à 35), -1 si invalide
+static int position(char c){
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/* Paramètres attendus par la fonction : 'N' position, 'X' caractère
+   - NULL si la fonction est inconnue
+*/
+static const char *parametres(char fonction){
+    switch (fonction){
+        case ':': case 'l': case 'u': case 'c': case 'C': case 't': case 'E': case 'r':
+        case 'd': case 'f': case 'q': case '{': case '}': case '[': case ']': case 'k': case 'K':
+            return "";
+        case 'T': case 'p': case 'D': case '\'': case 'z': case 'Z':
+            return "N";
+        case '$': case '^': case '@':
+            return "X";
+        case 'x': case 'O': case '*':
+            return "NN";
+        case 'i': case 'o':
+            return "NX";
+        case 's':
+            return "XX";
+        default:
+            return NULL;
+    }
+}
+
+static int ajouter_fonction(dict_regles *regles, dict_regle_fonction fonction){
+    if (regles->nbfonction == regles->capacite_fonctions){
+        size_t capacite = regles->capacite_fonctions ? regles->capacite_fonctions * 2 : 64;
+        dict_regle_fonction *plus = realloc(regles->fonctions, capacite * sizeof *plus);
+        if (!plus)
+            return -1;
+        regles->fonctions = plus;
+        regles->capacite_fonctions = capacite;
+    }
+    regles->fonctions[regles->nbfonction++] = fonction;
+    return 0;
+}
+
+static int ajouter_debut(dict_regles *regles, size_t debut){
+    if (regles->nbregle + 1 >= regles->capacite_debuts){
+        size_t capacite = regles->capacite_debuts ? regles->capacite_debuts * 2 : 64;
+        size_t *plus = realloc(regles->debuts, capacite * sizeof *plus);
+        if (!plus)
+            return -1;
+        regles->debuts = plus;
+        regles->capacite_debuts = capacite;
+    }
+    regles->debuts[regles->nbregle] = debut;
+    return 0;
+}
+
+/* Compile une ligne du fichier en règle (fonctions ajoutées à la suite)
+   - les espaces entre deux fonctions sont ignorés, pas ceux donnés en paramètre ($ ajoute un espace)
+   - Renvoie -1 avec un message si une fonction est inconnue ou incomplète
+*/
+static int compiler(dict_regles *regles, const char *ligne, size_t taille, size_t numero){
+    for (size_t i = 0; i < taille; ){
+        char fonction = ligne[i++];
+        if (fonction == ' ' || fonction == '\t')
+            continue;
+        const char *attendus = parametres(fonction);
+        if (attendus == NULL){
+            printf("dict_regles.c : ERREUR > Fonction inconnue '%c' à la ligne %zu des règles\n", fonction, numero);
+            return -1;
+        }
+        dict_regle_fonction f = { fonction, 0, 0 };
+        for (size_t p = 0; attendus[p]; ++p){
+            if (i >= taille){
+                printf("dict_regles.c : ERREUR > Fonction '%c' incomplète à la ligne %zu des règles\n", fonction, numero);
+                return -1;
+            }
+            int valeur = attendus[p] == 'N' ? position(ligne[i]) : (unsigned char)ligne[i];
+            if (valeur < 0){
+                printf("dict_regles.c : ERREUR > Position invalide '%c' de la fonction '%c' à la ligne %zu des règles\n", ligne[i], fonction, numero);
+                return -1;
+            }
+            if (p == 0)
+                f.p1 = (unsigned char)valeur;
+            else
+                f.p2 = (unsigned char)valeur;
+            i++;
+        }
+        if (ajouter_fonction(regles, f) != 0){
+            printf("dict_regles.c : ERREUR > malloc des règles\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Lit et compile le fichier de règles path
+   - Une règle par ligne, dans l'ordre du fichier ; ":" garde le mot tel quel
+   - Renvoie -1 si le fichier est illisible, sans règle ou si une ligne est invalide
+*/
+int dict_regles_lire(const char *path, dict_regles *regles){
+    memset(regles, 0, sizeof *regles);
+    FILE *fichier = fopen(path, "r");
+    if (!fichier){
+        printf("dict_regles.c : ERREUR > Le fichier de règles '%s' est illisible\n", path);
+        return -1;
+    }
+    char *ligne = NULL;
+    size_t taille_buf = 0;
+    ssize_t taille = 0;
+    size_t numero = 0;
+    int retour = 0;
+    while (retour == 0 && (taille = getline(&ligne, &taille_buf, fichier)) != -1){
+        numero++;
+        while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r'))
+            ligne[--taille] = '\0';
+        if (taille == 0 || ligne[0] == '#' || strspn(ligne, " \t") == (size_t)taille)
+            continue;
+        if (ajouter_debut(regles, regles->nbfonction) != 0){
+            printf("dict_regles.c : ERREUR > malloc des règles\n");
+            retour = -1;
+        }
+        else if (compiler(regles, ligne, (size_t)taille, numero) != 0)
+            retour = -1;
+        else
+            regles->nbregle++;
+    }
+    free(ligne);
+    fclose(fichier);
+    if (retour == 0 && regles->nbregle == 0){
+        printf("dict_regles.c : ERREUR > Le fichier de règles '%s' ne contient aucune règle\n", path);
+        retour = -1;
+    }
+    if (retour == 0 && ajouter_debut(regles, regles->nbfonction) != 0){
+        printf("dict_regles.c : ERREUR > malloc des règles\n");
+        retour = -1;
+    }
+    if (retour != 0)
+        dict_regles_free(regles);
+    return retour;
+}
+
+/* Applique la règle r au mot (taille octets) et écrit le candidat dans candidat
+   (DICT_REGLES_MOT_MAX octets, sans '\0' final)
+   - Renvoie la taille du candidat, 0 s'il est rejeté (vide ou trop long)
+*/
+size_t dict_regles_appliquer(const dict_regles *regles, size_t r, const char *mot, size_t taille, char *candidat){
+    if (taille == 0 || taille > DICT_REGLES_MOT_MAX)
+        return 0;
+    char *m = candidat;
+    size_t n = taille;
+    memcpy(m, mot, n);
+
+    for (size_t i = regles->debuts[r]; i < regles->debuts[r + 1]; ++i){
+        const dict_regle_fonction *f = &regles->fonctions[i];
+        size_t a = f->p1;
+        size_t b = f->p2;
+        char c;
+        switch (f->fonction){
+            case ':':
+                break;
+            case 'l':
+                for (size_t k = 0; k < n; ++k)
+                    m[k] = minuscule(m[k]);
+                break;
+            case 'u':
+                for (size_t k = 0; k < n; ++k)
+                    m[k] = majuscule(m[k]);
+                break;
+            case 'c':
+                for (size_t k = 1; k < n; ++k)
+                    m[k] = minuscule(m[k]);
+                if (n)
+                    m[0] = majuscule(m[0]);
+                break;
+            case 'C':
+                for (size_t k = 1; k < n; ++k)
+                    m[k] = majuscule(m[k]);
+                if (n)
+                    m[0] = minuscule(m[0]);
+                break;
+            case 't':
+                for (size_t k = 0; k < n; ++k)
+                    m[k] = basculer(m[k]);
+                break;
+            case 'T':
+                if (a < n)
+                    m[a] = basculer(m[a]);
+                break;
+            case 'E':
+                for (size_t k = 0; k < n; ++k)
+                    m[k] = (k == 0 || m[k - 1] == ' ') ? majuscule(m[k]) : minuscule(m[k]);
+                break;
+            case 'r':
+                for (size_t k = 0; k < n / 2; ++k){
+                    c = m[k];
+                    m[k] = m[n - 1 - k];
+                    m[n - 1 - k] = c;
+                }
+                break;
+            case 'd':
+                if (2 * n > DICT_REGLES_MOT_MAX)
+                    return 0;
+                memcpy(m + n, m, n);
+                n *= 2;
+                break;
+            case 'p':
+                if (n * (a + 1) > DICT_REGLES_MOT_MAX)
+                    return 0;
+                for (size_t k = 1; k <= a; ++k)
+                    memcpy(m + k * n, m, n);
+                n *= a + 1;
+                break;
+            case 'f':
+                if (2 * n > DICT_REGLES_MOT_MAX)
+                    return 0;
+                for (size_t k = 0; k < n; ++k)
+                    m[n + k] = m[n - 1 - k];
+                n *= 2;
+                break;
+            case 'q':
+                if (2 * n > DICT_REGLES_MOT_MAX)
+                    return 0;
+                for (size_t k = n; k-- > 0; )
+                    m[2 * k] = m[2 * k + 1] = m[k];
+                n *= 2;
+                break;
+            case '{':
+                if (n > 1){
+                    c = m[0];
+                    memmove(m, m + 1, n - 1);
+                    m[n - 1] = c;
+                }
+                break;
+            case '}':
+                if (n > 1){
+                    c = m[n - 1];
+                    memmove(m + 1, m, n - 1);
+                    m[0] = c;
+                }
+                break;
+            case '$':
+                if (n + 1 > DICT_REGLES_MOT_MAX)
+                    return 0;
+                m[n++] = (char)a;
+                break;
+            case '^':
+                if (n + 1 > DICT_REGLES_MOT_MAX)
+                    return 0;
+                memmove(m + 1, m, n);
+                m[0] = (char)a;
+                n++;
+                break;
+            case '[':
+                if (n){
+                    memmove(m, m + 1, n - 1);
+                    n--;
+                }
+                break;
+            case ']':
+                if (n)
+                    n--;
+                break;
+            case 'D':
+                if (a < n){
+                    memmove(m + a, m + a + 1, n - a - 1);
+                    n--;
+                }
+                break;
+            case 'x':
+                if (a + b <= n){
+                    memmove(m, m + a, b);
+                    n = b;
+                }
+                break;
+            case 'O':
+                if (a + b <= n){
+                    memmove(m + a, m + a + b, n - a - b);
+                    n -= b;
+                }
+                break;
+            case 'i':
+                if (a > n)
+                    break;
+                if (n + 1 > DICT_REGLES_MOT_MAX)
+                    return 0;
+                memmove(m + a + 1, m + a, n - a);
+                m[a] = (char)b;
+                n++;
+                break;
+            case 'o':
+                if (a < n)
+                    m[a] = (char)b;
+                break;
+            case '\'':
+                if (a < n)
+                    n = a;
+                break;
+            case 's':
+                for (size_t k = 0; k < n; ++k){
+                    if (m[k] == (char)a)
+                        m[k] = (char)b;
+                }
+                break;
+            case '@':{
+                size_t garde = 0;
+                for (size_t k = 0; k < n; ++k){
+                    if (m[k] != (char)a)
+                        m[garde++] = m[k];
+                }
+                n = garde;
+                break;
+            }
+            case 'z':
+                if (n == 0)
+                    break;
+                if (n + a > DICT_REGLES_MOT_MAX)
+                    return 0;
+                c = m[0];
+                memmove(m + a, m, n);
+                memset(m, c, a);
+                n += a;
+                break;
+            case 'Z':
+                if (n == 0)
+                    break;
+                if (n + a > DICT_REGLES_MOT_MAX)
+                    return 0;
+                memset(m + n, m[n - 1], a);
+                n += a;
+                break;
+            case 'k':
+                if (n >= 2){
+                    c = m[0];
+                    m[0] = m[1];
+                    m[1] = c;
+                }
+                break;
+            case 'K':
+                if (n >= 2){
+                    c = m[n - 2];
+                    m[n - 2] = m[n - 1];
+                    m[n - 1] = c;
+                }
+                break;
+            case '*':
+                if (a < n && b < n){
+                    c = m[a];
+                    m[a] = m[b];
+                    m[b] = c;
+                }
+                break;
+        }
+    }
+    return n;
+}
+
+void dict_regles_free(dict_regles *regles){
+    free(regles->fonctions);
+    free(regles->debuts);
+    memset(regles, 0, sizeof *regles);
+}
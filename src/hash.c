@@ -1,52 +1,139 @@
 /**
  * hash.c - Utilitaires de hachage
+ * - contexte de hachage réutilisable (hasher) : un par algo et par thread, sans
+ *   allocation ni recherche d'algorithme par message, avec une entrée par lots
+ * - les lots sha256 / sha512 passent par un noyau multi-buffer (hash_simd.c)
+ *   quand le processeur en dispose
  * - calcule le condensat d'une chaîne avec l'algo choisi
- * - convertit un digest binaire en hexadécimal
+ * - convertit un digest binaire en hexadécimal (et l'inverse)
  */
 
 #include <openssl/evp.h>
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "hash.h"
 
-// Calcule le hash algo_name de input dans digest et met sa longueur dans digest_taille
-int string_to_hash(char *input,char *algo_name,unsigned char digest[EVP_MAX_MD_SIZE],unsigned int *digest_taille)
-{
-    // Récupère le descripteur d'algorithme par son nom
-    const EVP_MD *md = EVP_get_digestbyname(algo_name);
-    if (!md){
+/* Crée un contexte de hachage pour algo_name
+   - L'algorithme est récupéré une seule fois auprès du fournisseur OpenSSL
+   - Renvoie NULL si l'algo est inconnu ou si une allocation échoue
+*/
+hasher *hasher_new(const char *algo_name){
+    hasher *h = calloc(1, sizeof *h);
+    if (!h){
+        printf("hash.c : ERREUR > malloc du hasher\n");
+        return NULL;
+    }
+    h->md = EVP_MD_fetch(NULL, algo_name, NULL);
+    if (!h->md){
         printf("hash.c : ERREUR > la variable EVP_MD est vide\n");
-        return -1;
+        hasher_free(h);
+        return NULL;
     }
-
-    // Alloue un contexte de calcul EVP
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    if (!ctx){
+    h->ctx = EVP_MD_CTX_new();
+    if (!h->ctx){
         printf("hash.c : ERREUR > la variable EVP_MD_CTX est vide\n");
-        return -1;
+        hasher_free(h);
+        return NULL;
     }
+    h->digest_taille = (unsigned int)EVP_MD_get_size(h->md);
+    // EVP_MD_is_a accepte tous les alias (sha256, SHA2-256, ...)
+    if (EVP_MD_is_a(h->md, "SHA2-256"))
+        h->simd = hash_simd_get("sha256");
+    else if (EVP_MD_is_a(h->md, "SHA2-512"))
+        h->simd = hash_simd_get("sha512");
+    return h;
+}
 
-    // Initialise le contexte avec l’algorithme choisi
-    if (!EVP_DigestInit_ex(ctx, md,NULL)){
-        printf("hash.c : ERREUR > la fonction EVP_DigestInit à échoué, les variables CTX et MD n'ont pas pus etre utilisé\n");
+// Libère le contexte et l'algorithme récupéré
+void hasher_free(hasher *h){
+    if (!h)
+        return;
+    EVP_MD_CTX_free(h->ctx);
+    EVP_MD_free(h->md);
+    free(h);
+}
+
+/* Calcule le condensat de taille octets de data dans digest (h->digest_taille octets)
+   - La taille est connue de l'appelant : aucun strlen
+*/
+int hasher_digest(hasher *h, const void *data, size_t taille, unsigned char *digest){
+    unsigned int digest_taille = 0;
+    if (!EVP_DigestInit_ex2(h->ctx, h->md, NULL) || !EVP_DigestUpdate(h->ctx, data, taille) || !EVP_DigestFinal_ex(h->ctx, digest, &digest_taille)){
+        printf("hash.c : ERREUR > le calcul du condensat à échoué\n");
         return -1;
     }
+    return 0;
+}
 
-    // Alimente le contexte avec les octets de input
-    if (!EVP_DigestUpdate(ctx, input, strlen(input))){
-        printf("hash.c : ERREUR > la fonction EVP_DigestUpdate à échoué, le calcul du hash à partir de l'entrée user à echoué\n");
-        return -1;
+/* Ajoute un message à un lot : taille sur 4 octets (ordre de la machine) suivie des octets
+   - Renvoie le nombre d'octets écrits dans lot
+*/
+size_t hasher_lot_ajouter(unsigned char *lot, const void *data, uint32_t taille){
+    memcpy(lot, &taille, sizeof taille);
+    memcpy(lot + sizeof taille, data, taille);
+    return sizeof taille + taille;
+}
+
+/* Hache nbmsg messages préfixés par leur taille (hasher_lot_ajouter)
+   - Les condensats sont écrits à la suite dans digests (nbmsg * h->digest_taille octets)
+   - Avec un noyau SIMD, les messages d'un seul bloc sont regroupés par h->simd->lanes ;
+     les messages plus longs passent par OpenSSL, le dernier groupe est complété
+     avec des voies factices dont le résultat est ignoré
+*/
+int hasher_batch(hasher *h, const unsigned char *lot, size_t nbmsg, unsigned char *digests){
+    const unsigned char *msgs[SIMD_LANES_MAX];
+    unsigned char *sorties[SIMD_LANES_MAX];
+    uint32_t tailles[SIMD_LANES_MAX];
+    unsigned int nbvoie = 0;
+
+    for (size_t i = 0; i < nbmsg; ++i){
+        uint32_t taille;
+        memcpy(&taille, lot, sizeof taille);
+        lot += sizeof taille;
+        if (h->simd && taille <= h->simd->taille_max){
+            msgs[nbvoie] = lot;
+            tailles[nbvoie] = taille;
+            sorties[nbvoie] = digests + i * h->digest_taille;
+            if (++nbvoie == h->simd->lanes){
+                h->simd->hacher(msgs, tailles, sorties);
+                nbvoie = 0;
+            }
+        }
+        else if (hasher_digest(h, lot, taille, digests + i * h->digest_taille) != 0)
+            return -1;
+        lot += taille;
     }
+    if (nbvoie > 0){
+        unsigned char poubelle[EVP_MAX_MD_SIZE];
+        for (unsigned int v = nbvoie; v < h->simd->lanes; ++v){
+            msgs[v] = msgs[0];
+            tailles[v] = tailles[0];
+            sorties[v] = poubelle;
+        }
+        h->simd->hacher(msgs, tailles, sorties);
+    }
+    return 0;
+}
 
-    // Termine le calcul et écrit le digest en binaire ainsi que sa taille 
-    if (!EVP_DigestFinal_ex(ctx, digest, digest_taille)){
-        printf("hash.c : ERREUR > la fonction EVP_DigestFinal à échoué, le Hash et la taille du Hash n'a pas pus etre attribué aux variables donnée\n");
+/* Calcule le hash algo_name de input dans digest et met sa longueur dans digest_taille
+   - Crée un hasher pour un seul message : à réserver aux appels isolés,
+     les boucles doivent garder un hasher
+*/
+int string_to_hash(char *input,char *algo_name,unsigned char digest[EVP_MAX_MD_SIZE],unsigned int *digest_taille)
+{
+    hasher *h = hasher_new(algo_name);
+    if (!h)
         return -1;
-    }
 
-    // Libere le contexte
-    EVP_MD_CTX_free(ctx);
-    return 0;
+    int retour = hasher_digest(h, input, strlen(input), digest);
+    if (retour == 0)
+        *digest_taille = h->digest_taille;
+
+    // Le contexte est libéré sur tous les chemins
+    hasher_free(h);
+    return retour;
 }
 
 // Convertit un digest binaire en chaîne hex minuscule dans digest_hex
@@ -59,3 +146,28 @@ void bin_to_hex(unsigned char *digest_bin, unsigned int digest_taille, char *dig
     }
     digest_hex[2 * digest_taille] = '\0';
 }
+
+// Valeur d'un caractère hexadécimal (majuscule ou minuscule), -1 si invalide
+static int hex_val(char c){
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Convertit une chaîne hex en digest binaire et met sa longueur dans digest_taille
+// Renvoie -1 si la chaîne est vide, de longueur impaire, trop longue ou contient un caractère non hex
+int hex_to_bin(char *digest_hex, unsigned char digest_bin[EVP_MAX_MD_SIZE], unsigned int *digest_taille){
+    size_t taille = strlen(digest_hex);
+    if (taille == 0 || (taille % 2) != 0 || taille / 2 > EVP_MAX_MD_SIZE)
+        return -1;
+    for (size_t i = 0; i < taille / 2; i++){
+        int haut = hex_val(digest_hex[2 * i]);
+        int bas  = hex_val(digest_hex[2 * i + 1]);
+        if (haut < 0 || bas < 0)
+            return -1;
+        digest_bin[i] = (unsigned char)((haut << 4) | bas);
+    }
+    *digest_taille = (unsigned int)(taille / 2);
+    return 0;
+}
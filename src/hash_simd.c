@@ -0,0 +1,453 @@
+/**
+ * hash_simd.c - Noyaux SHA-256 / SHA-512 multi-buffer
+ * - Les mots d'un dictionnaire tiennent presque toujours dans un seul bloc :
+ *   on hache plusieurs mots en parallèle, une voie SIMD par mot
+ * - sha256 : 16 voies AVX-512, 8 voies AVX2, ou instructions SHA-NI (une voie)
+ * - sha512 : 8 voies AVX-512, 4 voies AVX2
+ * - Le noyau est choisi à l'exécution selon le processeur et vérifié une fois
+ *   contre OpenSSL ; en cas d'écart, hash.c reste sur OpenSSL
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cpuid.h>
+#include <immintrin.h>
+#include <openssl/evp.h>
+
+#include "hash_simd.h"
+
+static const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t IV256[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint64_t K512[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const uint64_t IV512[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static inline uint32_t be32(const unsigned char *p){
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint64_t be64(const unsigned char *p){
+    return ((uint64_t)be32(p) << 32) | be32(p + 4);
+}
+
+static inline void put_be32(unsigned char *p, uint32_t v){
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static inline void put_be64(unsigned char *p, uint64_t v){
+    put_be32(p, (uint32_t)(v >> 32));
+    put_be32(p + 4, (uint32_t)v);
+}
+
+/* Construit l'unique bloc rembourré d'un message court (taille_bloc = 64 ou 128)
+   - message, octet 0x80, zéros, puis longueur en bits big endian en fin de bloc
+*/
+static void bloc_unique(const unsigned char *msg, uint32_t taille, unsigned char *bloc, size_t taille_bloc){
+    memset(bloc, 0, taille_bloc);
+    memcpy(bloc, msg, taille);
+    bloc[taille] = 0x80;
+    put_be64(bloc + taille_bloc - 8, (uint64_t)taille * 8);
+}
+
+/* Transpose les blocs des voies : w[t * lanes + i] = mot t du bloc de la voie i */
+static void transposer_256(const unsigned char *const *msgs, const uint32_t *tailles, unsigned int lanes, uint32_t *w){
+    unsigned char bloc[64];
+    for (unsigned int i = 0; i < lanes; ++i){
+        bloc_unique(msgs[i], tailles[i], bloc, sizeof bloc);
+        for (unsigned int t = 0; t < 16; ++t)
+            w[t * lanes + i] = be32(bloc + 4 * t);
+    }
+}
+
+static void transposer_512(const unsigned char *const *msgs, const uint32_t *tailles, unsigned int lanes, uint64_t *w){
+    unsigned char bloc[128];
+    for (unsigned int i = 0; i < lanes; ++i){
+        bloc_unique(msgs[i], tailles[i], bloc, sizeof bloc);
+        for (unsigned int t = 0; t < 16; ++t)
+            w[t * lanes + i] = be64(bloc + 8 * t);
+    }
+}
+
+/* ---------------------------------------------------------------- AVX2 */
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+#define ROR32_8(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define ROR64_4(x, n) _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+
+// sha256, 8 voies de 32 bits
+static void sha256_avx2(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests){
+    uint32_t w[16 * 8] __attribute__((aligned(32)));
+    uint32_t etat[8 * 8] __attribute__((aligned(32)));
+    __m256i W[16];
+    __m256i s[8];
+
+    transposer_256(msgs, tailles, 8, w);
+    for (int t = 0; t < 16; ++t)
+        W[t] = _mm256_load_si256((const __m256i*)(w + 8 * t));
+    for (int j = 0; j < 8; ++j)
+        s[j] = _mm256_set1_epi32((int)IV256[j]);
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; ++t){
+        if (t >= 16){
+            __m256i w15 = W[(t - 15) & 15], w2 = W[(t - 2) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROR32_8(w15, 7), ROR32_8(w15, 18)), _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROR32_8(w2, 17), ROR32_8(w2, 19)), _mm256_srli_epi32(w2, 10));
+            W[t & 15] = _mm256_add_epi32(_mm256_add_epi32(W[t & 15], s0), _mm256_add_epi32(W[(t - 7) & 15], s1));
+        }
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(ROR32_8(e, 6), ROR32_8(e, 11)), ROR32_8(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32((int)K256[t]), W[t & 15])));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(ROR32_8(a, 2), ROR32_8(a, 13)), ROR32_8(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(S0, maj);
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+    }
+    s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+
+    for (int j = 0; j < 8; ++j)
+        _mm256_store_si256((__m256i*)(etat + 8 * j), s[j]);
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 8; ++j)
+            put_be32(digests[i] + 4 * j, etat[8 * j + i]);
+}
+
+// sha512, 4 voies de 64 bits
+static void sha512_avx2(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests){
+    uint64_t w[16 * 4] __attribute__((aligned(32)));
+    uint64_t etat[8 * 4] __attribute__((aligned(32)));
+    __m256i W[16];
+    __m256i s[8];
+
+    transposer_512(msgs, tailles, 4, w);
+    for (int t = 0; t < 16; ++t)
+        W[t] = _mm256_load_si256((const __m256i*)(w + 4 * t));
+    for (int j = 0; j < 8; ++j)
+        s[j] = _mm256_set1_epi64x((long long)IV512[j]);
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 80; ++t){
+        if (t >= 16){
+            __m256i w15 = W[(t - 15) & 15], w2 = W[(t - 2) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROR64_4(w15, 1), ROR64_4(w15, 8)), _mm256_srli_epi64(w15, 7));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROR64_4(w2, 19), ROR64_4(w2, 61)), _mm256_srli_epi64(w2, 6));
+            W[t & 15] = _mm256_add_epi64(_mm256_add_epi64(W[t & 15], s0), _mm256_add_epi64(W[(t - 7) & 15], s1));
+        }
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(ROR64_4(e, 14), ROR64_4(e, 18)), ROR64_4(e, 41));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi64(_mm256_add_epi64(h, S1), _mm256_add_epi64(ch, _mm256_add_epi64(_mm256_set1_epi64x((long long)K512[t]), W[t & 15])));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(ROR64_4(a, 28), ROR64_4(a, 34)), ROR64_4(a, 39));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi64(S0, maj);
+        h = g; g = f; f = e; e = _mm256_add_epi64(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi64(t1, t2);
+    }
+    s[0] = _mm256_add_epi64(s[0], a); s[1] = _mm256_add_epi64(s[1], b);
+    s[2] = _mm256_add_epi64(s[2], c); s[3] = _mm256_add_epi64(s[3], d);
+    s[4] = _mm256_add_epi64(s[4], e); s[5] = _mm256_add_epi64(s[5], f);
+    s[6] = _mm256_add_epi64(s[6], g); s[7] = _mm256_add_epi64(s[7], h);
+
+    for (int j = 0; j < 8; ++j)
+        _mm256_store_si256((__m256i*)(etat + 4 * j), s[j]);
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            put_be64(digests[i] + 8 * j, etat[4 * j + i]);
+}
+
+#pragma GCC pop_options
+
+/* ------------------------------------------------------------- AVX-512 */
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+// Ch(e,f,g) = e ? f : g -> table 0xCA ; Maj(a,b,c) -> table 0xE8
+#define CH512_32(e, f, g)  _mm512_ternarylogic_epi32((e), (f), (g), 0xCA)
+#define MAJ512_32(a, b, c) _mm512_ternarylogic_epi32((a), (b), (c), 0xE8)
+#define XOR3_32(x, y, z)   _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+#define CH512_64(e, f, g)  _mm512_ternarylogic_epi64((e), (f), (g), 0xCA)
+#define MAJ512_64(a, b, c) _mm512_ternarylogic_epi64((a), (b), (c), 0xE8)
+#define XOR3_64(x, y, z)   _mm512_ternarylogic_epi64((x), (y), (z), 0x96)
+
+// sha256, 16 voies de 32 bits
+static void sha256_avx512(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests){
+    uint32_t w[16 * 16] __attribute__((aligned(64)));
+    uint32_t etat[8 * 16] __attribute__((aligned(64)));
+    __m512i W[16];
+    __m512i s[8];
+
+    transposer_256(msgs, tailles, 16, w);
+    for (int t = 0; t < 16; ++t)
+        W[t] = _mm512_load_si512((const void*)(w + 16 * t));
+    for (int j = 0; j < 8; ++j)
+        s[j] = _mm512_set1_epi32((int)IV256[j]);
+
+    __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; ++t){
+        if (t >= 16){
+            __m512i w15 = W[(t - 15) & 15], w2 = W[(t - 2) & 15];
+            __m512i s0 = XOR3_32(_mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18), _mm512_srli_epi32(w15, 3));
+            __m512i s1 = XOR3_32(_mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19), _mm512_srli_epi32(w2, 10));
+            W[t & 15] = _mm512_add_epi32(_mm512_add_epi32(W[t & 15], s0), _mm512_add_epi32(W[(t - 7) & 15], s1));
+        }
+        __m512i S1 = XOR3_32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25));
+        __m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, S1), _mm512_add_epi32(CH512_32(e, f, g), _mm512_add_epi32(_mm512_set1_epi32((int)K256[t]), W[t & 15])));
+        __m512i S0 = XOR3_32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22));
+        __m512i t2 = _mm512_add_epi32(S0, MAJ512_32(a, b, c));
+        h = g; g = f; f = e; e = _mm512_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+    }
+    s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+    s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+    s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+    s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+
+    for (int j = 0; j < 8; ++j)
+        _mm512_store_si512((void*)(etat + 16 * j), s[j]);
+    for (int i = 0; i < 16; ++i)
+        for (int j = 0; j < 8; ++j)
+            put_be32(digests[i] + 4 * j, etat[16 * j + i]);
+}
+
+// sha512, 8 voies de 64 bits
+static void sha512_avx512(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests){
+    uint64_t w[16 * 8] __attribute__((aligned(64)));
+    uint64_t etat[8 * 8] __attribute__((aligned(64)));
+    __m512i W[16];
+    __m512i s[8];
+
+    transposer_512(msgs, tailles, 8, w);
+    for (int t = 0; t < 16; ++t)
+        W[t] = _mm512_load_si512((const void*)(w + 8 * t));
+    for (int j = 0; j < 8; ++j)
+        s[j] = _mm512_set1_epi64((long long)IV512[j]);
+
+    __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 80; ++t){
+        if (t >= 16){
+            __m512i w15 = W[(t - 15) & 15], w2 = W[(t - 2) & 15];
+            __m512i s0 = XOR3_64(_mm512_ror_epi64(w15, 1), _mm512_ror_epi64(w15, 8), _mm512_srli_epi64(w15, 7));
+            __m512i s1 = XOR3_64(_mm512_ror_epi64(w2, 19), _mm512_ror_epi64(w2, 61), _mm512_srli_epi64(w2, 6));
+            W[t & 15] = _mm512_add_epi64(_mm512_add_epi64(W[t & 15], s0), _mm512_add_epi64(W[(t - 7) & 15], s1));
+        }
+        __m512i S1 = XOR3_64(_mm512_ror_epi64(e, 14), _mm512_ror_epi64(e, 18), _mm512_ror_epi64(e, 41));
+        __m512i t1 = _mm512_add_epi64(_mm512_add_epi64(h, S1), _mm512_add_epi64(CH512_64(e, f, g), _mm512_add_epi64(_mm512_set1_epi64((long long)K512[t]), W[t & 15])));
+        __m512i S0 = XOR3_64(_mm512_ror_epi64(a, 28), _mm512_ror_epi64(a, 34), _mm512_ror_epi64(a, 39));
+        __m512i t2 = _mm512_add_epi64(S0, MAJ512_64(a, b, c));
+        h = g; g = f; f = e; e = _mm512_add_epi64(d, t1);
+        d = c; c = b; b = a; a = _mm512_add_epi64(t1, t2);
+    }
+    s[0] = _mm512_add_epi64(s[0], a); s[1] = _mm512_add_epi64(s[1], b);
+    s[2] = _mm512_add_epi64(s[2], c); s[3] = _mm512_add_epi64(s[3], d);
+    s[4] = _mm512_add_epi64(s[4], e); s[5] = _mm512_add_epi64(s[5], f);
+    s[6] = _mm512_add_epi64(s[6], g); s[7] = _mm512_add_epi64(s[7], h);
+
+    for (int j = 0; j < 8; ++j)
+        _mm512_store_si512((void*)(etat + 8 * j), s[j]);
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 8; ++j)
+            put_be64(digests[i] + 8 * j, etat[8 * j + i]);
+}
+
+#pragma GCC pop_options
+
+/* -------------------------------------------------------------- SHA-NI */
+
+#pragma GCC push_options
+#pragma GCC target("sha,sse4.1")
+
+/* sha256 d'un bloc avec les instructions SHA-NI
+   - l'état est tenu dans l'ordre ABEF / CDGH attendu par sha256rnds2
+   - le planning des mots est calculé 4 par 4 avec sha256msg1 / sha256msg2
+*/
+static void sha256_shani_bloc(const unsigned char *bloc, unsigned char *digest){
+    const __m128i masque = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_loadu_si128((const __m128i*)&IV256[0]);
+    __m128i etat1 = _mm_loadu_si128((const __m128i*)&IV256[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+    etat1 = _mm_shuffle_epi32(etat1, 0x1B);             // EFGH
+    __m128i etat0 = _mm_alignr_epi8(tmp, etat1, 8);     // ABEF
+    etat1 = _mm_blend_epi16(etat1, tmp, 0xF0);          // CDGH
+    __m128i abef = etat0, cdgh = etat1;
+    __m128i m[4];
+
+    for (int i = 0; i < 16; ++i){
+        if (i < 4)
+            m[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bloc + 16 * i)), masque);
+        __m128i msg = _mm_add_epi32(m[i & 3], _mm_loadu_si128((const __m128i*)&K256[4 * i]));
+        etat1 = _mm_sha256rnds2_epu32(etat1, etat0, msg);
+        // Mots 4(i+1)..4(i+1)+3 : termine le planning commencé par sha256msg1
+        if (i >= 3 && i < 15){
+            __m128i t = _mm_alignr_epi8(m[i & 3], m[(i - 1) & 3], 4);
+            m[(i + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(m[(i + 1) & 3], t), m[i & 3]);
+        }
+        msg = _mm_shuffle_epi32(msg, 0x0E);
+        etat0 = _mm_sha256rnds2_epu32(etat0, etat1, msg);
+        if (i >= 1 && i < 13)
+            m[(i - 1) & 3] = _mm_sha256msg1_epu32(m[(i - 1) & 3], m[i & 3]);
+    }
+
+    etat0 = _mm_add_epi32(etat0, abef);
+    etat1 = _mm_add_epi32(etat1, cdgh);
+    tmp = _mm_shuffle_epi32(etat0, 0x1B);               // FEBA
+    etat1 = _mm_shuffle_epi32(etat1, 0xB1);             // DCHG
+    etat0 = _mm_blend_epi16(tmp, etat1, 0xF0);          // DCBA
+    etat1 = _mm_alignr_epi8(etat1, tmp, 8);             // HGFE
+
+    uint32_t etat[8];
+    _mm_storeu_si128((__m128i*)&etat[0], etat0);
+    _mm_storeu_si128((__m128i*)&etat[4], etat1);
+    for (int j = 0; j < 8; ++j)
+        put_be32(digest + 4 * j, etat[j]);
+}
+
+#pragma GCC pop_options
+
+// sha256 SHA-NI : une voie, le gain vient des instructions dédiées
+static void sha256_shani(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests){
+    unsigned char bloc[64];
+    bloc_unique(msgs[0], tailles[0], bloc, sizeof bloc);
+    sha256_shani_bloc(bloc, digests[0]);
+}
+
+/* ------------------------------------------------------------ Sélection */
+
+/* Noyaux par ordre de préférence pour chaque algo
+   - SHA-NI ne traite qu'une voie : 8 voies AVX2 restent plus rapides sur des mots courts
+*/
+static const hash_simd noyaux[] = {
+    { "avx512", "sha256", 16, 55,  sha256_avx512 },
+    { "avx2",   "sha256", 8,  55,  sha256_avx2 },
+    { "sha-ni", "sha256", 1,  55,  sha256_shani },
+    { "avx512", "sha512", 8,  111, sha512_avx512 },
+    { "avx2",   "sha512", 4,  111, sha512_avx2 },
+};
+
+// Le processeur et le système (registres sauvegardés) supportent-ils le jeu d'instructions ?
+static int cpu_supporte(const char *nom){
+    __builtin_cpu_init();
+    if (strcmp(nom, "avx512") == 0)
+        return __builtin_cpu_supports("avx512f");
+    if (strcmp(nom, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(nom, "sha-ni") == 0){
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return 0;
+        return (ebx & bit_SHA) != 0 && __builtin_cpu_supports("sse4.1");
+    }
+    return 0;
+}
+
+/* Vérifie un noyau contre OpenSSL sur toutes les tailles d'un bloc
+   - messages pseudo-aléatoires, chaque voie avec une taille différente
+*/
+static int noyau_valide(const hash_simd *noyau){
+    const EVP_MD *md = EVP_get_digestbyname(noyau->algo);
+    if (!md)
+        return 0;
+    unsigned char donnees[SIMD_LANES_MAX][128];
+    unsigned char sorties[SIMD_LANES_MAX][64];
+    const unsigned char *msgs[SIMD_LANES_MAX];
+    unsigned char *digests[SIMD_LANES_MAX];
+    uint32_t tailles[SIMD_LANES_MAX];
+    uint32_t graine = 0x2545F491u;
+
+    for (uint32_t depart = 0; depart <= noyau->taille_max; ++depart){
+        for (unsigned int i = 0; i < noyau->lanes; ++i){
+            tailles[i] = (depart + i * 7) % (noyau->taille_max + 1);
+            for (uint32_t k = 0; k < tailles[i]; ++k){
+                graine = graine * 1103515245u + 12345u;
+                donnees[i][k] = (unsigned char)(graine >> 16);
+            }
+            msgs[i] = donnees[i];
+            digests[i] = sorties[i];
+        }
+        noyau->hacher(msgs, tailles, digests);
+        for (unsigned int i = 0; i < noyau->lanes; ++i){
+            unsigned char attendu[EVP_MAX_MD_SIZE];
+            unsigned int taille = 0;
+            if (!EVP_Digest(msgs[i], tailles[i], attendu, &taille, md, NULL) || memcmp(attendu, sorties[i], taille) != 0)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* Renvoie le meilleur noyau multi-buffer disponible pour algo_name, ou NULL
+   - la détection et la vérification sont faites une fois par noyau (thread-safe :
+     le résultat est le même quel que soit le thread qui le calcule)
+*/
+const hash_simd *hash_simd_get(const char *algo_name){
+    static int etat[sizeof noyaux / sizeof noyaux[0]];   // 0 = inconnu, 1 = utilisable, -1 = non
+    for (size_t n = 0; n < sizeof noyaux / sizeof noyaux[0]; ++n){
+        if (strcmp(noyaux[n].algo, algo_name) != 0)
+            continue;
+        int e = __atomic_load_n(&etat[n], __ATOMIC_ACQUIRE);
+        if (e == 0){
+            e = (cpu_supporte(noyaux[n].nom) && noyau_valide(&noyaux[n])) ? 1 : -1;
+            __atomic_store_n(&etat[n], e, __ATOMIC_RELEASE);
+        }
+        if (e == 1)
+            return &noyaux[n];
+    }
+    return NULL;
+}
+
+/* Renvoie le noyau n de la liste (tous algos, par ordre de préférence), NULL après le dernier
+   - disponible : 1 si le processeur le supporte ; le noyau n'est pas vérifié contre OpenSSL,
+     ce qui permet à make check de forcer chacun d'eux (check/rainc_check.c)
+*/
+const hash_simd *hash_simd_noyau(size_t n, int *disponible){
+    if (n >= sizeof noyaux / sizeof noyaux[0])
+        return NULL;
+    *disponible = cpu_supporte(noyaux[n].nom);
+    return &noyaux[n];
+}
@@ -2,35 +2,80 @@
 #define CONTROL_T3C_H
 
 #include <stddef.h> 
+#include <stdint.h>
+#include <stdio.h>
 
+#include "t3c_ecrivain.h"
+
+#define T3C_ALGO_MAX   16   // taille max du nom d'algo (sha256, blake2b512, ...)
+#define T3C_SECTIONS_MAX 4  // sections d'une table : une par algo autorisé (sha256, sha512, blake2b512, sha3-256)
+
+#define T3C_FORMAT_TXT 0    // format texte hash<TAB>mdp
+#define T3C_FORMAT_BIN 1    // format binaire trié projeté avec mmap (t3c_bin.h)
+
+#define T3C_BLOB_INITIAL ((size_t)1 << 20)   // capacité initiale du blob des mdp, doublée quand il est plein
+
+/* Blob des mdp : chaînes terminées par '\0' rangées les unes derrière les autres
+   - les entrées le désignent par offset : il peut être ré-alloué sans casser la table
+*/
 typedef struct {
-    char *mdp;        
-    char *hash_hex;   
-} t3c_entry;
+    char *data;
+    size_t taille;
+    size_t capacite;
+} t3c_blob;
 
+/* Table T3C en mémoire, en colonnes :
+   - digests : nbobj condensats bruts de digest_taille octets, dans l'ordre d'insertion
+   - offsets : position du mdp de chaque entrée dans le blob
+   - aucun hex en mémoire : il n'est décodé / encodé qu'aux frontières (fichier texte, requêtes)
+   - une table d'un seul algo : un fichier multi-algo se charge en un tableau de tables (sections)
+*/
 typedef struct {
-    t3c_entry *items;
+    unsigned char *digests;
+    uint64_t *offsets;
+    t3c_blob blob;
     size_t nbobj;
     size_t maxSize;
+    unsigned int digest_taille;
+    char algo[T3C_ALGO_MAX];   // algo lu dans l'en-tête du fichier T3C
 } t3c_table;
 
-typedef struct t3c_node_ {
-    t3c_entry *items;
-    struct t3c_node_ *left;
-    struct t3c_node_ *right;
-} t3c_node;
+// Table ouverte pour la recherche : binaire projetée ou texte indexée, filtre de Bloom (control_T3C.c)
+typedef struct t3c_source t3c_source;
+
+// Condensat brut de l'entrée pos
+static inline const unsigned char *t3c_digest(const t3c_table *table, size_t pos){
+    return table->digests + pos * table->digest_taille;
+}
+
+// Mdp de l'entrée pos
+static inline const char *t3c_mdp(const t3c_table *table, size_t pos){
+    return table->blob.data + table->offsets[pos];
+}
+
+int  t3c_blob_ajouter(t3c_blob *blob, const char *mdp, size_t taille, uint64_t *offset);
+void t3c_blob_free(t3c_blob *blob);
 
 void t3c_init(t3c_table *table);
+int  t3c_alloc(t3c_table *table, size_t maxSize, unsigned int digest_taille);
 void t3c_free(t3c_table *table);
-int  t3c_add(t3c_table *table, char *mdp, char *hash_hex);
+int  t3c_add(t3c_table *table, const char *mdp, size_t taille_mdp, const unsigned char *digest, unsigned int digest_taille);
+int  t3c_set(t3c_table *table, t3c_blob *blob, size_t pos, const char *mdp, size_t taille_mdp, const unsigned char *digest);
+int  t3c_joindre(t3c_table *table, t3c_blob *blob, size_t debut, size_t nb);
+
+void progress_bar(size_t nbligneDone, size_t nbligneMax, char *printText);
 
-int create_t3c(const t3c_table *table, char *path, char *algo_name);
-int t3c_load(char *path, t3c_table *table);
+int count_lignes(FILE *fichier, t3c_table *tables, size_t *nbsection, size_t *nbligneMax);
+int  t3c_txt_entete(t3c_ecrivain *ecr, const char *algo_name);
+int create_t3c(const t3c_table *tables, size_t nbsection, char *path, int format);
+int t3c_load(char *path, t3c_table *tables, size_t *nbsection);
+int t3c_requete_decoder(char *texte, char **algo, unsigned char *digest, unsigned int *digest_taille);
 
-t3c_node *t3c_index_build(t3c_table *table);
-t3c_entry *t3c_lookup(t3c_node *node_root, char *hash_hex);
-void t3c_index_free(t3c_node *node_root);
+t3c_source *t3c_source_open(char *t3c_path, int index_type);
+const char *t3c_source_find(const t3c_source *source, const char *algo, const unsigned char *digest, unsigned int digest_taille);
+void t3c_source_close(t3c_source *source);
 
-int t3c_mode_lookup(char *t3c_path, char *single_hash);
+int t3c_mode_lookup(char *t3c_path, char *single_hash, int index_type);
+int t3c_mode_convert(char *in_path, char *out_path, int format);
 
 #endif
@@ -2,7 +2,20 @@
 #define CONTROL_DICT_H
 
 #include "control_T3C.h"
+#include "dict_regles.h"
+#include "dict_masque.h"
 
-int dict_to_Table(char *path,char *algo_name, t3c_table *table);
+#define DICT_PAQUET_MIN  ((size_t)4 << 10)      // --batch-size : octets lus par paquet du pipeline, au moins
+#define DICT_PAQUET_MAX  ((size_t)1 << 30)      // au plus
+#define DICT_PAQUETS_MAX 4096                   // --queue-depth : paquets en vol, au plus
+
+void dict_utiliser_regles(const dict_regles *regles);
+void dict_utiliser_masque(const dict_masque *masque, uint64_t premier, uint64_t nb);
+void dict_regler_pipeline(size_t octets, unsigned int profondeur);
+
+int dict_to_Table(char *path, char **algos, int nbalgo, t3c_table *tables, int nbthreads, int dedup, size_t *nbdoublons);
+int dict_to_t3c_flux(char *path, char **algos, int nbalgo, char *out_path, int nbthreads, int dedup, size_t *nbobj, size_t *nbdoublons);
+int dict_to_t3c_shards(char *path, char **algos, int nbalgo, char *out_path, unsigned int bits, int format, int shard_seul, int nbthreads, int dedup, size_t *nbobj, size_t *nbdoublons);
+int dict_to_t3c_tri(char *path, char *algo_name, char *out_path, int nbthreads, size_t mem_limit, char *tmp_dir, size_t *nbobj, size_t *nbdoublons);
 
 #endif
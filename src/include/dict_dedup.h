@@ -0,0 +1,59 @@
+#ifndef DICT_DEDUP_H
+#define DICT_DEDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "control_T3C.h"
+
+#define DICT_DEDUP_CAPACITE_MIN 1024                    // cases minimum de l'ensemble
+#define DICT_DEDUP_COPIE        ((uint64_t)1 << 62)     // mot recopié dans le blob : position = offset | COPIE
+#define DICT_DEDUP_PRISE        UINT64_MAX              // case en cours de remplissage par un thread
+#define DICT_DEDUP_AUCUNE       UINT32_MAX              // mot hors de l'ensemble (plus de 4 Gio), toujours gardé
+#define DICT_DEDUP_LOT          16                      // mots insérés par lot, leurs cases préchargées
+#define DICT_DEDUP_CASES_MAX    ((size_t)1 << 31)       // les cases sont désignées sur 32 bits
+
+/* Case de l'ensemble (16 octets)
+   - position : position + 1 de la première occurrence du mot dans le dictionnaire, 0 = case libre
+   - le mot n'est pas copié : il est relu dans le bloc en cours, ou dans le blob une fois recopié
+*/
+typedef struct {
+    _Atomic uint64_t position;
+    uint32_t taille;
+    uint32_t empreinte;         // 32 bits hauts du hachage du mot
+} dict_dedup_case;
+
+/* Ensemble concurrent des mots du dictionnaire (adressage ouvert, sondage linéaire)
+   - les threads insèrent sans verrou (CAS sur la position) ; pour un même mot, la plus petite
+     position l'emporte : le mot gardé est sa première occurrence, quel que soit le nombre de threads
+   - bloc / bloc_position : octets du dictionnaire en cours et position de leur premier octet
+   - copie : mode flux, les nouveaux mots sont recopiés dans blob avant que le bloc soit remplacé
+*/
+typedef struct {
+    dict_dedup_case *cases;
+    size_t capacite;            // puissance de 2, au moins le double des mots rangés
+    size_t nbmot;               // mots distincts rangés avant le bloc en cours
+    atomic_size_t nbnouveaux;   // mots distincts ajoutés par le bloc en cours
+    size_t *nouveaux;           // mode copie : cases des mots ajoutés par le bloc en cours
+    size_t capacite_nouveaux;
+    const char *bloc;
+    uint64_t bloc_position;
+    int copie;
+    t3c_blob blob;
+} dict_dedup;
+
+// Précharge la case c : les cases lues par dict_dedup_premier sont connues un lot à l'avance
+static inline void dict_dedup_precharger(const dict_dedup *ens, uint32_t c){
+    if (c != DICT_DEDUP_AUCUNE)
+        __builtin_prefetch(&ens->cases[c]);
+}
+
+void dict_dedup_init(dict_dedup *ens, int copie);
+int  dict_dedup_reserver(dict_dedup *ens, size_t nbmot, const char *bloc, uint64_t bloc_position);
+void dict_dedup_inserer(dict_dedup *ens, const char **mots, const size_t *tailles, size_t nb, uint32_t *cases);
+int  dict_dedup_premier(const dict_dedup *ens, uint32_t c, const char *mot);
+int  dict_dedup_copier(dict_dedup *ens);
+void dict_dedup_free(dict_dedup *ens);
+
+#endif
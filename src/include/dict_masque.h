@@ -0,0 +1,42 @@
+#ifndef DICT_MASQUE_H
+#define DICT_MASQUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DICT_MASQUE_POSITIONS 64    // longueur maximale des candidats d'un masque
+#define DICT_MASQUE_JEU_MAX   256   // caractères distincts d'une position, au plus
+#define DICT_MASQUE_PERSO     4     // jeux personnalisés ?1 .. ?4 (--charset1= .. --charset4=)
+
+/* Masque de génération (-M), à la hashcat : une position par caractère littéral ou par classe
+   - ?l minuscules, ?u majuscules, ?d chiffres, ?s spéciaux (espace compris), ?a = ?l?u?d?s,
+     ?h / ?H hexadécimal minuscule / majuscule, ?1 .. ?4 jeux personnalisés, ?? le caractère '?'
+   - les caractères en double d'un jeu sont retirés : deux indices ne donnent jamais le même candidat
+   - le candidat d'indice i est i écrit en base mixte, la dernière position variant le plus vite
+*/
+typedef struct {
+    char jeux[DICT_MASQUE_POSITIONS][DICT_MASQUE_JEU_MAX];
+    unsigned int tailles[DICT_MASQUE_POSITIONS];
+    unsigned int longueur;
+    uint64_t nbcandidat;        // produit des tailles : indices [0, nbcandidat)
+} dict_masque;
+
+/* Passe au candidat suivant comme un compteur kilométrique : seules les positions qui
+   changent sont réécrites ; après le dernier candidat, revient au premier
+*/
+static inline void dict_masque_suivant(const dict_masque *masque, unsigned int *chiffres, char *candidat){
+    unsigned int p = masque->longueur;
+    while (p-- > 0){
+        if (++chiffres[p] < masque->tailles[p]){
+            candidat[p] = masque->jeux[p][chiffres[p]];
+            return;
+        }
+        chiffres[p] = 0;
+        candidat[p] = masque->jeux[p][0];
+    }
+}
+
+int  dict_masque_lire(const char *texte, char *const *perso, dict_masque *masque);
+void dict_masque_placer(const dict_masque *masque, uint64_t indice, unsigned int *chiffres, char *candidat);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef DICT_REGLES_H
+#define DICT_REGLES_H
+
+#include <stddef.h>
+
+#define DICT_REGLES_MOT_MAX 256     // candidat plus long rejeté, comme un mot plus long en entrée
+
+/* Fonction d'une règle : lettre hashcat et ses deux paramètres (position 0-9 / A-Z ou caractère)
+   - fonctions reconnues :
+     :  l u c C t E r d f q { } [ ] k K        sans paramètre
+     TN pN DN 'N zN ZN                          position N
+     $X ^X @X                                   caractère X
+     xNM ONM *NM                                positions N et M
+     iNX oNX                                    position N, caractère X
+     sXY                                        caractères X et Y
+*/
+typedef struct {
+    char fonction;
+    unsigned char p1;
+    unsigned char p2;
+} dict_regle_fonction;
+
+/* Règles de transformation des mots (-G --rules=<fichier>), une par ligne du fichier
+   - la règle r est la suite fonctions[debuts[r] .. debuts[r + 1])
+   - chaque mot du dictionnaire donne un candidat par règle, dans l'ordre du fichier
+*/
+typedef struct {
+    dict_regle_fonction *fonctions;
+    size_t nbfonction;
+    size_t capacite_fonctions;
+    size_t *debuts;             // nbregle + 1 indices dans fonctions
+    size_t nbregle;
+    size_t capacite_debuts;
+} dict_regles;
+
+int    dict_regles_lire(const char *path, dict_regles *regles);
+size_t dict_regles_appliquer(const dict_regles *regles, size_t r, const char *mot, size_t taille, char *candidat);
+void   dict_regles_free(dict_regles *regles);
+
+#endif
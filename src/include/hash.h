@@ -2,8 +2,31 @@
 #define HASH_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <openssl/evp.h>
 
+#include "hash_simd.h"
+
+/* Contexte de hachage réutilisable, créé une fois par algo et par thread
+   - md est récupéré une seule fois (EVP_MD_fetch) au lieu d'une recherche par nom à chaque mot
+   - ctx est ré-initialisé entre deux messages sans nouvelle allocation
+   - simd est le noyau multi-buffer utilisé par hasher_batch pour les messages courts (NULL sinon)
+*/
+typedef struct {
+    EVP_MD *md;
+    EVP_MD_CTX *ctx;
+    unsigned int digest_taille;
+    const hash_simd *simd;
+} hasher;
+
+hasher *hasher_new(const char *algo_name);
+void hasher_free(hasher *h);
+int hasher_digest(hasher *h, const void *data, size_t taille, unsigned char *digest);
+int hasher_batch(hasher *h, const unsigned char *lot, size_t nbmsg, unsigned char *digests);
+size_t hasher_lot_ajouter(unsigned char *lot, const void *data, uint32_t taille);
+
 int string_to_hash(char *input,char *algo_name,unsigned char digest[EVP_MAX_MD_SIZE],unsigned int *digest_taille);
 void bin_to_hex(unsigned char *digest_bin, unsigned int digest_taille, char *digest_hex);
+int hex_to_bin(char *digest_hex, unsigned char digest_bin[EVP_MAX_MD_SIZE], unsigned int *digest_taille);
+
 #endif
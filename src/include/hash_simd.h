@@ -0,0 +1,26 @@
+#ifndef HASH_SIMD_H
+#define HASH_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIMD_LANES_MAX 16
+
+/* Noyau multi-buffer : hache lanes messages d'un seul bloc en parallèle
+   - msgs[i] / tailles[i] : message de la voie i (tailles[i] <= taille_max)
+   - digests[i] : sortie de la voie i (32 octets en sha256, 64 en sha512)
+*/
+typedef void (*simd_fn)(const unsigned char *const *msgs, const uint32_t *tailles, unsigned char *const *digests);
+
+typedef struct {
+    const char *nom;        // jeu d'instructions : avx512, avx2, sha-ni
+    const char *algo;       // sha256 | sha512
+    unsigned int lanes;     // messages hachés par appel
+    uint32_t taille_max;    // plus long message tenant dans un bloc (55 ou 111 octets)
+    simd_fn hacher;
+} hash_simd;
+
+const hash_simd *hash_simd_get(const char *algo_name);
+const hash_simd *hash_simd_noyau(size_t n, int *disponible);
+
+#endif
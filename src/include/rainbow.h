@@ -0,0 +1,64 @@
+#ifndef RAINBOW_H
+#define RAINBOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "control_T3C.h"
+
+#define RAINBOW_MAGIC        "T3CRBW\0"  // 8 octets avec le '\0' final
+#define RAINBOW_VERSION      1
+#define RAINBOW_CHARSET_MAX  256
+#define RAINBOW_LONGUEUR_MAX 32          // longueur max d'un mdp de l'espace des clés
+
+#define RAINBOW_REDUCE_ADD   0           // R_i(h) = (h + i + k * t) mod N, réduction classique
+#define RAINBOW_REDUCE_MIX   1           // R_i(h) = mélange splitmix64 de h, i et k ramené dans [0, N)
+
+/* En-tête d'une table rainbow (320 octets, little endian)
+   - suivi de nbchaine couples rainbow_chaine triés par fin de chaîne
+*/
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t reduction;             // famille RAINBOW_REDUCE_*
+    char     algo[T3C_ALGO_MAX];
+    uint32_t longueur_min;
+    uint32_t longueur_max;
+    uint32_t taille_charset;
+    uint32_t indice_table;          // k : sépare les fonctions de réduction de plusieurs tables
+    uint64_t longueur_chaine;       // t : étapes hachage + réduction par chaîne
+    uint64_t nbchaine;              // m : chaînes gardées (fins uniques)
+    char     charset[RAINBOW_CHARSET_MAX];
+} rainbow_header;
+
+// Une chaîne : seuls le début et la fin sont stockés (indices dans l'espace des clés)
+typedef struct {
+    uint64_t debut;
+    uint64_t fin;
+} rainbow_chaine;
+
+/* Espace des clés : tous les mdp de longueur_min à longueur_max sur charset
+   - un mdp est identifié par son indice dans [0, taille)
+*/
+typedef struct {
+    char charset[RAINBOW_CHARSET_MAX];
+    unsigned int taille_charset;
+    unsigned int longueur_min;
+    unsigned int longueur_max;
+    uint64_t taille;
+    uint64_t premier[RAINBOW_LONGUEUR_MAX + 2];  // premier indice des mdp de chaque longueur
+    uint32_t reduction;
+    uint32_t indice_table;
+    uint64_t longueur_chaine;
+} rainbow_espace;
+
+int      rainbow_espace_init(rainbow_espace *espace, const char *charset, size_t taille_charset, unsigned int longueur_min, unsigned int longueur_max,
+                             uint32_t reduction, uint32_t indice_table, uint64_t longueur_chaine);
+size_t   rainbow_mdp(const rainbow_espace *espace, uint64_t indice, char *mdp);
+uint64_t rainbow_reduire(const rainbow_espace *espace, const unsigned char *digest, uint64_t etape);
+
+int rainbow_is(char *path);
+int rainbow_generate(char *path, char *algo_name, const rainbow_espace *espace, uint64_t nbchaine, int nbthreads);
+int rainbow_mode_lookup(char *path, char *hash_search, int nbthreads);
+
+#endif
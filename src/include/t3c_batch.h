@@ -0,0 +1,24 @@
+#ifndef T3C_BATCH_H
+#define T3C_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define T3C_BATCH_BITS     8                          // bits de la clé triés par passe du tri radix
+#define T3C_BATCH_SEAUX    (1u << T3C_BATCH_BITS)
+#define T3C_BATCH_MIN_TRI  65536                      // requêtes minimum par thread de tri
+#define T3C_BATCH_TAMPON   (4u << 20)                 // tampons de stdout et du fichier des absents
+#define T3C_BATCH_PAGE     (1u << 20)                 // pages des mdp recopiés de --keep-order
+
+/* Requête d'un lot : clé de tri et rang de la ligne dans le fichier de requêtes
+   - cle : 8 premiers octets du condensat en big endian (t3c_cle64)
+*/
+typedef struct {
+    uint64_t cle;
+    uint64_t rang;
+} t3c_requete;
+
+t3c_requete *t3c_radix_sort(t3c_requete *requetes, t3c_requete *tampon, size_t nbobj, int nbthreads);
+int t3c_mode_batch(char *t3c_path, char *hash_path, char *miss_path, int keep_order, int nbthreads);
+
+#endif
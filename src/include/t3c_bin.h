@@ -0,0 +1,111 @@
+#ifndef T3C_BIN_H
+#define T3C_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "control_T3C.h"
+
+#define T3C_BIN_MAGIC   "T3CBIN\0"     // 8 octets avec le '\0' final
+#define T3C_BIN_VERSION 1
+#define T3C_BIN_VERSION_COMPRESSE 2     // au moins une section aux mdp compressés par blocs
+
+#define T3C_BIN_COMPRESSE  1u           // flags de section : mdp compressés par blocs (--compress)
+#define T3C_BIN_BLOC_MDP   128          // mdp par bloc compressé par défaut
+#define T3C_BIN_BLOC_MIN   8
+#define T3C_BIN_BLOC_MAX   65536
+#define T3C_BIN_DICO       4096         // dictionnaire préchargé du deflate, rechargé à chaque bloc lu
+
+/* En-tête d'un fichier T3C binaire (64 octets, little endian)
+   - suivi de nbsection descripteurs t3c_bin_section, une section par algo
+*/
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t nbsection;
+    uint64_t taille_fichier;
+    uint8_t  reserve[40];
+} t3c_bin_header;
+
+/* Descripteur d'une section (64 octets) :
+   - colonne des condensats bruts triés (nbobj * digest_taille octets)
+   - tableau de nbobj + 1 offsets uint64 dans le blob des mdp
+   - blob des mdp terminés par '\0'
+   - flags T3C_BIN_COMPRESSE : off_offsets désigne un t3c_bin_blocs et le blob
+     contient les blocs compressés
+*/
+typedef struct {
+    char     algo[T3C_ALGO_MAX];
+    uint32_t digest_taille;
+    uint32_t flags;
+    uint64_t nbobj;
+    uint64_t off_digests;
+    uint64_t off_offsets;
+    uint64_t off_blob;
+    uint64_t taille_blob;
+} t3c_bin_section;
+
+/* Mdp d'une section compressés par blocs (32 octets), rangé à off_offsets :
+   - le mdp de la ligne pos est dans le bloc pos / mdp_bloc : un seul bloc décompressé par mdp lu
+   - suivi de nbbloc + 1 offsets uint64 des blocs dans le blob (index creux : un par bloc),
+     puis des taille_dico octets du dictionnaire préchargé de chaque bloc
+   - bloc : deflate brut de ses mdp terminés par '\0' (bloc_max octets au plus une fois décompressé)
+*/
+typedef struct {
+    uint32_t mdp_bloc;
+    uint32_t taille_dico;
+    uint64_t nbbloc;
+    uint64_t bloc_max;
+    uint64_t taille_mdp;        // octets des mdp décompressés
+} t3c_bin_blocs;
+
+typedef struct t3c_bin_cache t3c_bin_cache;
+typedef struct t3c_bin_zip t3c_bin_zip;
+
+/* Table binaire projetée en mémoire avec mmap
+   - cache : dernier bloc décompressé, si une section est compressée
+*/
+typedef struct {
+    void *map;
+    size_t taille_map;
+    const t3c_bin_header *header;
+    const t3c_bin_section *sections;
+    t3c_bin_cache *cache;
+} t3c_bin;
+
+/* Écriture en flux d'une table binaire dont les entrées arrivent déjà triées et uniques
+   - les condensats vont directement dans le fichier final, les offsets et le blob dans
+     deux fichiers temporaires recopiés derrière la colonne à la fermeture
+   - zip : mdp compressés par blocs (t3c_bin_compression active à l'ouverture)
+*/
+typedef struct {
+    FILE *fichier;
+    FILE *offsets;
+    FILE *blob;
+    t3c_bin_zip *zip;
+    t3c_bin_section section;
+    uint64_t taille_blob;
+    char *path;
+    uint64_t debut;             // --stats : ouverture du flux, durée comptée en écriture
+} t3c_bin_flux;
+
+int  t3c_bin_is(char *path);
+void t3c_bin_compression(unsigned int mdp_bloc);
+int  t3c_bin_write(const t3c_table *tables, size_t nbsection, char *path);
+
+void t3c_dossier(const char *path, char *dossier, size_t taille);
+FILE *t3c_fichier_temp(const char *dossier);
+int  t3c_fichier_recopier(FILE *source, FILE *fichier, uint64_t *pos);
+int  t3c_bin_flux_open(t3c_bin_flux *flux, char *path, char *algo_name, const char *dossier_temp);
+int  t3c_bin_flux_add(t3c_bin_flux *flux, const unsigned char *digest, const char *mdp, size_t taille_mdp);
+int  t3c_bin_flux_close(t3c_bin_flux *flux, int abandon);
+
+int  t3c_bin_open(char *path, t3c_bin *bin);
+void t3c_bin_close(t3c_bin *bin);
+const char *t3c_bin_mdp(const t3c_bin *bin, size_t s, size_t pos);
+unsigned int t3c_bin_mdp_bloc(const t3c_bin *bin, size_t s);
+const char *t3c_bin_lookup(const t3c_bin *bin, size_t s, const unsigned char *digest, unsigned int digest_taille);
+int  t3c_bin_to_table(const t3c_bin *bin, size_t s, t3c_table *table);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef T3C_BLOOM_H
+#define T3C_BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "t3c_index.h"
+
+#define T3C_BLOOM_MAGIC    "T3CBLM\0"     // 8 octets avec le '\0' final
+#define T3C_BLOOM_VERSION  1
+#define T3C_BLOOM_BITS     10              // bits par clé par défaut (--bloom)
+#define T3C_BLOOM_BITS_MIN 4
+#define T3C_BLOOM_BITS_MAX 32
+#define T3C_BLOOM_K        7               // bits testés par clé, tous dans le même bloc
+#define T3C_BLOOM_MOTS     8               // mots de 64 bits par bloc : une ligne de cache
+#define T3C_BLOOM_SUFFIXE  ".bf"           // le filtre est rangé à côté de la table : <table>.bf
+
+/* En-tête du fichier filtre (64 octets, little endian)
+   - suivi de nbbloc blocs de 64 octets alignés sur une ligne de cache
+   - taille et date de la table : un filtre qui ne correspond plus à sa table est ignoré
+*/
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t bits_par_cle;
+    uint32_t digest_taille;          // 0 si les sections mélangent plusieurs tailles
+    uint32_t nbhash;
+    uint64_t nbbloc;
+    uint64_t nbcle;
+    uint64_t taille_table;
+    int64_t  mtime_sec;
+    int64_t  mtime_nsec;
+} t3c_bloom_header;
+
+// Filtre de Bloom par blocs projeté en mémoire avec mmap
+typedef struct {
+    void *map;
+    size_t taille_map;
+    const t3c_bloom_header *header;
+    const uint64_t *blocs;
+} t3c_bloom;
+
+/* Position du condensat dans le filtre, tirée de ses propres octets (déjà uniformes)
+   - octets 0..7 : bloc, ramené dans [0, nbbloc) par multiplication
+   - octets 8..15 : T3C_BLOOM_K positions de 9 bits dans les 512 bits du bloc
+*/
+static inline const uint64_t *t3c_bloom_bloc(const uint64_t *blocs, uint64_t nbbloc, const unsigned char *digest, size_t digest_taille, uint64_t *bits){
+    uint64_t h1 = t3c_cle64(digest, digest_taille);
+    *bits = digest_taille >= 16 ? t3c_cle64(digest + 8, digest_taille - 8) : h1 * 0x9E3779B97F4A7C15ULL;
+    return blocs + (uint64_t)(((unsigned __int128)h1 * nbbloc) >> 64) * T3C_BLOOM_MOTS;
+}
+
+/* Teste un condensat : 0 s'il est sûrement absent de la table, 1 s'il peut y être
+   - un seul bloc de 64 octets lu par requête
+   - digest_taille de l'en-tête à 0 : table multi-algo aux condensats de tailles mélangées
+*/
+static inline int t3c_bloom_test(const t3c_bloom *bloom, const unsigned char *digest, unsigned int digest_taille){
+    if (bloom->header->digest_taille != 0 && digest_taille != bloom->header->digest_taille)
+        return 0;
+    uint64_t bits = 0;
+    const uint64_t *bloc = t3c_bloom_bloc(bloom->blocs, bloom->header->nbbloc, digest, digest_taille, &bits);
+    for (unsigned int i = 0; i < T3C_BLOOM_K; ++i){
+        unsigned int bit = (unsigned int)(bits >> (9 * i)) & 511;
+        if (((bloc[bit >> 6] >> (bit & 63)) & 1) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+int  t3c_bloom_build(char *t3c_path, unsigned int bits_par_cle, size_t *nbcle);
+int  t3c_bloom_open(char *t3c_path, t3c_bloom *bloom);
+void t3c_bloom_close(t3c_bloom *bloom);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef T3C_ECRIVAIN_H
+#define T3C_ECRIVAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define T3C_ECRIVAIN_TAMPON     ((size_t)4 << 20)   // octets d'un tampon, écrit d'un seul appel
+#define T3C_ECRIVAIN_TAMPONS    4                   // tampons en vol avec io_uring (un seul avec write)
+#define T3C_ECRIVAIN_ALIGNEMENT 4096                // tampons alignés sur les pages
+
+// Anneau io_uring de l'écrivain (t3c_ecrivain.c), NULL quand le noyau ne le permet pas
+typedef struct t3c_anneau t3c_anneau;
+
+/* Écriture séquentielle d'un fichier de table par grands tampons alignés
+   - les lignes sont formatées directement dans le tampon courant (t3c_ecrivain_reserver)
+   - tampon plein : il part au noyau en une écriture et le suivant prend le relais ; avec
+     io_uring, T3C_ECRIVAIN_TAMPONS écritures sont en vol pendant le formatage des suivants,
+     sinon le tampon est écrit par write avant d'être réutilisé
+   - position : position dans le fichier du premier octet du tampon courant
+*/
+typedef struct {
+    int fd;
+    char *tampons[T3C_ECRIVAIN_TAMPONS];
+    size_t longueurs[T3C_ECRIVAIN_TAMPONS];     // octets soumis de chaque tampon en vol
+    uint64_t positions[T3C_ECRIVAIN_TAMPONS];
+    int en_vol[T3C_ECRIVAIN_TAMPONS];
+    int nbtampon;
+    int courant;
+    size_t remplissage;
+    uint64_t position;
+    uint64_t prevue;            // taille réservée par fallocate, rendue à la fermeture
+    t3c_anneau *anneau;
+    int erreur;
+} t3c_ecrivain;
+
+int  t3c_ecrivain_ouvrir(t3c_ecrivain *ecr, const char *path, uint64_t prevue);
+int  t3c_ecrivain_vider(t3c_ecrivain *ecr);
+int  t3c_ecrivain_ajouter(t3c_ecrivain *ecr, const void *data, size_t taille);
+int  t3c_ecrivain_recopier(t3c_ecrivain *ecr, FILE *source);
+int  t3c_ecrivain_fermer(t3c_ecrivain *ecr);
+
+/* Place pour taille octets à la suite du tampon courant (vidé d'abord s'il est trop plein),
+   validée ensuite par t3c_ecrivain_avancer ; NULL si taille dépasse un tampon ou en cas d'erreur
+*/
+static inline char *t3c_ecrivain_reserver(t3c_ecrivain *ecr, size_t taille){
+    if (taille > T3C_ECRIVAIN_TAMPON || ecr->erreur)
+        return NULL;
+    if (T3C_ECRIVAIN_TAMPON - ecr->remplissage < taille && t3c_ecrivain_vider(ecr) != 0)
+        return NULL;
+    return ecr->tampons[ecr->courant] + ecr->remplissage;
+}
+
+static inline void t3c_ecrivain_avancer(t3c_ecrivain *ecr, size_t taille){
+    ecr->remplissage += taille;
+}
+
+#endif
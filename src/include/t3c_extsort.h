@@ -0,0 +1,41 @@
+#ifndef T3C_EXTSORT_H
+#define T3C_EXTSORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "control_T3C.h"
+
+#define T3C_EXTSORT_BUDGET     ((size_t)512 << 20)  // --mem-limit par défaut
+#define T3C_EXTSORT_BUDGET_MIN ((size_t)1 << 20)
+#define T3C_EXTSORT_FUSION_MAX 64                   // runs fusionnées en une passe
+
+/* Tri externe des couples condensat / mdp pour les tables plus grandes que la mémoire
+   - les entrées sont rangées dans une zone de budget octets : enregistrements
+     [condensat][taille uint32][mdp] depuis le début, indices uint64 depuis la fin
+   - zone pleine : tri des indices, écriture d'une run triée sans doublon sur disque
+   - fin : fusion k-voies des runs vers la table binaire finale (t3c_bin_flux)
+*/
+typedef struct {
+    char algo[T3C_ALGO_MAX];
+    unsigned int digest_taille;
+    const char *dossier;        // dossier des runs temporaires
+    char *zone;
+    size_t budget;
+    size_t haut;                // octets d'enregistrements rangés au début de la zone
+    size_t nbobj;               // indices rangés à la fin de la zone
+    FILE **runs;
+    size_t *nbobj_runs;
+    size_t nbrun;
+    size_t capacite_runs;
+    size_t nbentrees;           // entrées reçues
+    size_t nbdoublons;          // condensats en double éliminés
+} t3c_extsort;
+
+int  t3c_extsort_init(t3c_extsort *tri, const char *algo_name, size_t budget, const char *dossier);
+int  t3c_extsort_add(t3c_extsort *tri, const unsigned char *digest, const char *mdp, size_t taille_mdp);
+int  t3c_extsort_write(t3c_extsort *tri, char *path);
+void t3c_extsort_free(t3c_extsort *tri);
+
+#endif
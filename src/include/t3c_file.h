@@ -0,0 +1,35 @@
+#ifndef T3C_FILE_H
+#define T3C_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+
+// Case de l'anneau : tour = indice de dépôt attendu (case libre) ou indice + 1 (case pleine)
+typedef struct {
+    _Atomic uint64_t tour;
+    void *element;
+} t3c_file_case;
+
+/* File bornée de pointeurs entre deux étages d'un pipeline (plusieurs producteurs et consommateurs)
+   - anneau sans verrou : producteurs et consommateurs prennent leur case par fetch_add
+     sur tete / queue, le tour de la case ordonne le dépôt et le retrait
+   - deux sémaphores comptent les places libres et les éléments : un étage qui attend dort
+     au lieu de tourner, et chaque attente est chronométrée dans une phase de --stats
+*/
+typedef struct {
+    t3c_file_case *cases;
+    size_t capacite;
+    _Atomic uint64_t tete;      // prochain dépôt
+    _Atomic uint64_t queue;     // prochain retrait
+    sem_t places;
+    sem_t elements;
+} t3c_file;
+
+int   t3c_file_init(t3c_file *file, size_t capacite);
+void  t3c_file_deposer(t3c_file *file, void *element, int phase);
+void *t3c_file_prendre(t3c_file *file, int phase);
+void  t3c_file_free(t3c_file *file);
+
+#endif
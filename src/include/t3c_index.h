@@ -0,0 +1,52 @@
+#ifndef T3C_INDEX_H
+#define T3C_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "control_T3C.h"
+
+#define T3C_INDEX_SORTED 0   // tableau trié en disposition Eytzinger (parcours en largeur)
+#define T3C_INDEX_INTERP 1   // tableau trié + recherche par interpolation bornée
+#define T3C_INDEX_HASH   2   // table à adressage ouvert indexée par les bits du condensat
+
+/* Index de recherche sur les condensats binaires, sans allocation par noeud :
+   - SORTED : cles64/digests/ids rangés en ordre Eytzinger (1-indexé, case 0 inutilisée)
+   - INTERP : digests/ids rangés en ordre croissant (cles64 non utilisé)
+   - HASH   : digests/ids dans l'ordre d'insertion, slots = étiquette 24 bits | position+1 sur 40 bits
+*/
+typedef struct {
+    int type;
+    size_t nbobj;             // nombre de condensats uniques indexés
+    size_t digest_taille;
+    uint64_t *cles64;         // 8 premiers octets de chaque condensat en big endian
+    unsigned char *digests;   // condensats complets de largeur fixe
+    uint64_t *ids;            // indice de l'entrée dans la table source
+    uint64_t *slots;          // cases de la table à adressage ouvert (0 = vide)
+    size_t capacite;          // nombre de cases (puissance de 2)
+    unsigned int decalage;    // 64 - log2(capacite) : les bits de poids fort donnent la case
+    const t3c_table *table;   // table source (NULL si index construit sur une colonne)
+} t3c_index;
+
+// 8 premiers octets d'un condensat en big endian : l'ordre des entiers suit celui de memcmp
+static inline uint64_t t3c_cle64(const unsigned char *digest, size_t digest_taille){
+    unsigned char tampon[8] = {0};
+    uint64_t cle;
+    memcpy(tampon, digest, digest_taille < 8 ? digest_taille : 8);
+    memcpy(&cle, tampon, 8);
+    return __builtin_bswap64(cle);
+}
+
+size_t t3c_sort_unique(const unsigned char *digests, size_t digest_taille, size_t nbobj, size_t *ordre);
+
+t3c_index *t3c_index_new(const unsigned char *digests, size_t digest_taille, size_t nbobj, int type);
+ssize_t t3c_index_find(const t3c_index *index, const unsigned char *digest, unsigned int digest_taille);
+void t3c_index_free(t3c_index *index);
+
+ssize_t t3c_search_sorted(const unsigned char *digests, size_t digest_taille, size_t nbobj, const unsigned char *digest);
+
+t3c_index *t3c_index_build(const t3c_table *table, int type);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef T3C_RUNS_H
+#define T3C_RUNS_H
+
+#include <stddef.h>
+
+#include "control_T3C.h"
+
+#define T3C_RUNS_SUFFIXE ".r"   // runs ajoutés par -G --append : <table>.r/000001, 000002, ...
+#define T3C_RUNS_MAX     64     // au-delà, --append demande une compaction (--compact)
+
+/* Runs d'une table T3C
+   - un run est une T3C binaire triée ordinaire, avec les mêmes sections que sa table
+   - numérotés à partir de 1 sans trou : le plus récent a le plus grand numéro
+   - une recherche interroge les runs du plus récent au plus ancien, puis la table
+*/
+int  t3c_run_chemin(const char *path, unsigned int run, char *chemin, size_t taille);
+unsigned int t3c_runs_nb(const char *path);
+int  t3c_runs_supprimer(const char *path);
+int  t3c_algos(char *path, char algos[][T3C_ALGO_MAX], size_t *nbsection);
+int  t3c_compact(char *path, size_t *nbobj, size_t *nbdoublons);
+
+#endif
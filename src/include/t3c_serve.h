@@ -0,0 +1,29 @@
+#ifndef T3C_SERVE_H
+#define T3C_SERVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define T3C_SERVE_EVENEMENTS 256                 // événements traités par réveil d'epoll
+#define T3C_SERVE_ENTREE_MAX ((size_t)1 << 20)   // requêtes reçues en attente par client avant de suspendre la lecture
+#define T3C_SERVE_SORTIE_MAX ((size_t)4 << 20)   // réponses en attente par client avant de suspendre le traitement
+#define T3C_SERVE_LIGNE_MAX  1024                // longueur max d'une requête texte
+#define T3C_SERVE_LOT        1024                // requêtes envoyées par le client avant de lire leurs réponses
+#define T3C_SERVE_TABLES_MAX 64                  // tables servies par un même serveur
+
+/* Protocole du serveur (--serve), une requête après l'autre sans attendre les réponses :
+   - texte : une ligne "[algo:]<condensat-hex>\n" par requête, réponse "OK <mdp>\n", "ABSENT\n"
+     ou "INVALIDE\n" ; utilisable directement avec socat / nc
+   - binaire : la connexion commence par l'octet T3C_SERVE_BINAIRE, puis chaque requête est
+     [taille uint8][algo][taille uint8][condensat brut] (algo vide : toutes les sections) et
+     chaque réponse [statut uint8] suivi, si trouvé, de [taille uint32 little endian][mdp]
+   - les réponses arrivent dans l'ordre des requêtes de la connexion
+*/
+#define T3C_SERVE_BINAIRE    0xB1
+#define T3C_SERVE_ABSENT     0
+#define T3C_SERVE_TROUVE     1
+
+int t3c_serve(char *socket_path, char **t3c_paths, int nbtable, int index_type);
+int t3c_client(char *socket_path);
+
+#endif
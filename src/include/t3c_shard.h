@@ -0,0 +1,44 @@
+#ifndef T3C_SHARD_H
+#define T3C_SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "control_T3C.h"
+
+#define T3C_SHARD_MAGIC    "# T3C-SHARDS"  // première ligne du manifeste
+#define T3C_SHARD_BITS_MAX 8               // --shards=<k> : 2^k shards au plus (noms XX)
+#define T3C_SHARD_MAX      (1u << T3C_SHARD_BITS_MAX)
+#define T3C_SHARD_SUFFIXE  ".d"            // les shards sont rangés dans <table>.d/XX
+
+/* Manifeste d'une table découpée par préfixe (fichier texte <table>)
+   - "# T3C-SHARDS<TAB>bits=k<TAB>format=txt|bin<TAB>algos=a1,a2" puis une ligne "XX<TAB>entrées"
+     par shard
+   - le shard XX contient les condensats dont les k premiers bits valent XX, avec les mêmes
+     sections (algos) que la table entière ; c'est une T3C ordinaire
+   - un shard vide (0 entrée) n'est jamais ouvert
+*/
+typedef struct {
+    unsigned int bits;
+    int format;
+    size_t nbsection;
+    char algos[T3C_SECTIONS_MAX][T3C_ALGO_MAX];
+    uint64_t nbobj[T3C_SHARD_MAX];
+} t3c_manifeste;
+
+// Nombre de shards de la table
+static inline unsigned int t3c_shard_nb(const t3c_manifeste *manifeste){
+    return 1u << manifeste->bits;
+}
+
+// Shard d'un condensat : ses k premiers bits
+static inline unsigned int t3c_shard_de(const t3c_manifeste *manifeste, const unsigned char *digest){
+    return (unsigned int)digest[0] >> (8 - manifeste->bits);
+}
+
+int t3c_shard_is(const char *path);
+int t3c_shard_chemin(const char *path, unsigned int shard, char *chemin, size_t taille);
+int t3c_manifeste_lire(const char *path, t3c_manifeste *manifeste);
+int t3c_manifeste_ecrire(const char *path, const t3c_manifeste *manifeste);
+
+#endif
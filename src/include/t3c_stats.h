@@ -0,0 +1,69 @@
+#ifndef T3C_STATS_H
+#define T3C_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define T3C_STATS_SEAUX        40                  // seaux de l'histogramme : latence < 2^b ns
+#define T3C_PROGRESSION_NS     100000000ULL        // 100 ms au moins entre deux rendus d'une barre
+
+// Phases chronométrées (durées murales cumulées, horloge monotone)
+enum {
+    T3C_STATS_LECTURE,          // lecture du dictionnaire
+    T3C_STATS_DEDOUBLONNAGE,    // ensemble des mots (--no-dedup : vide)
+    T3C_STATS_HACHAGE,          // hachage des mots par les threads
+    T3C_STATS_ECRITURE,         // sortie des tranches et écriture de la table
+    T3C_STATS_CHARGEMENT,       // t3c_load / t3c_bin_open
+    T3C_STATS_INDEX,            // construction des index de recherche
+    T3C_STATS_RECHERCHE,        // recherches unitaires et en lot
+    T3C_STATS_ATTENTE_LECTURE,          // pipeline de -G : lecteur en attente d'un paquet libre
+    T3C_STATS_ATTENTE_DEDOUBLONNAGE,    // étage de l'ensemble des mots en attente d'un paquet lu
+    T3C_STATS_ATTENTE_HACHAGE,          // threads de hachage en attente d'un paquet (cumul des threads)
+    T3C_STATS_ATTENTE_ECRITURE,         // écrivain en attente du paquet suivant dans l'ordre
+    T3C_STATS_PHASES
+};
+
+// Compteurs
+enum {
+    T3C_STATS_OCTETS_LUS,       // octets du dictionnaire lus
+    T3C_STATS_MOTS,             // mots hachés
+    T3C_STATS_DOUBLONS,         // mots en double ignorés
+    T3C_STATS_CONDENSATS,       // condensats calculés (mots * algos)
+    T3C_STATS_ENTREES_ECRITES,  // entrées écrites dans les tables
+    T3C_STATS_OCTETS_ECRITS,    // taille des tables écrites
+    T3C_STATS_ENTREES_CHARGEES, // entrées chargées ou projetées
+    T3C_STATS_LIGNES_INVALIDES, // lignes de table au condensat invalide ignorées
+    T3C_STATS_TROUVES,          // condensats trouvés
+    T3C_STATS_ABSENTS,          // condensats absents
+    T3C_STATS_COMPTEURS
+};
+
+/* Instrumentation du programme (--stats) et barres de progression
+   - désactivée, t3c_stats_debut renvoie 0 et les autres appels ne font rien : une lecture
+     de variable par mesure, pas d'appel à l'horloge
+   - les accumulateurs sont atomiques : les phases et compteurs peuvent être mis à jour par
+     plusieurs threads (serveur, fusion du lot)
+   - le bilan JSON est écrit une fois, à la fin du mode (t3c_stats_ecrire)
+*/
+extern int t3c_stats_actives;
+
+uint64_t t3c_stats_horloge(void);
+void     t3c_stats_activer(void);
+void     t3c_stats_phase(int phase, uint64_t debut);
+void     t3c_stats_compter(int compteur, uint64_t n);
+void     t3c_stats_recherche(uint64_t debut, int trouve);
+int      t3c_stats_ecrire(const char *path);
+
+// Début d'une mesure : horloge monotone en ns si l'instrumentation est active, sinon 0
+static inline uint64_t t3c_stats_debut(void){
+    return t3c_stats_actives ? t3c_stats_horloge() : 0;
+}
+
+/* Barres de progression sur stderr
+   - actif : 1 toujours affichées (--progress), 0 jamais (--no-progress),
+     -1 défaut : seulement si stderr est un terminal
+*/
+void t3c_progression(int actif);
+void t3c_progression_afficher(size_t fait, size_t total, const char *texte);
+
+#endif
@@ -1,9 +1,16 @@
 /**
  * menu.c - Interface CLI de RAIN-C
- * - Parse les arguments (-G/-L, -o, -a, -s) et affiche l’aide.
+ * - Parse les arguments (-G/-M/-L/-C/-R, -o, -a, -j, -s, -f, --misses, --keep-order, --format, --index,
+ *   --mem-limit, --tmp-dir, --bloom, --shards, --shard, --append, --no-dedup, --compress, --rules, --charset, --len, -t, -m, --reduce, --table-index,
+ *   --skip, --limit, --charset1..4, --batch-size, --queue-depth, --stats, --progress, --no-progress) et affiche l’aide.
  * - Mode -G : orchestre la génération de la T3C (dict → T3C).
- * - Mode -L : orchestre la recherche (chargement T3C + recherche via -s ou stdin).
- * - Délègue la logique métier à control_dict.c et control_T3C.c.
+ * - Mode -M : même génération, les candidats d'un masque remplaçant le dictionnaire.
+ * - Mode -L : orchestre la recherche (chargement T3C + recherche via -s ou stdin, ou en lot via -f).
+ * - Mode -C : convertit une T3C entre les formats texte et binaire.
+ * - Mode -R : génère une table rainbow (chaînes) sur un espace charset / longueurs ; -L la reconnaît.
+ * - Mode --serve : sert une ou plusieurs T3C sur une socket Unix ; --client l'interroge depuis stdin.
+ * - Mode --compact : fusionne dans la table les runs ajoutés par -G --append.
+ * - Délègue la logique métier à control_dict.c, control_T3C.c, rainbow.c, t3c_serve.c et t3c_runs.c.
  */
 
 #include <stddef.h>
@@ -11,17 +18,66 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include "control_dict.h"
 #include "control_T3C.h"
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "rainbow.h"
+#include "t3c_batch.h"
+#include "t3c_bloom.h"
+#include "t3c_serve.h"
+#include "t3c_shard.h"
+#include "t3c_runs.h"
+#include "t3c_stats.h"
 
 
 // Définition des variables globales
-static int mode = -1;                       // -1 = non défini, 0 = mode -G, 1 = mode -L
+static int mode = -1;                       // -1 = non défini, 0 = mode -G, 1 = mode -L, 2 = mode -C, 3 = mode -R, 4 = --serve, 5 = --client, 6 = --compact
 static char *dict_path = NULL;              // chemin du dictionnaire donné par le user
 static char *hash_search  = NULL;           // hash à chercher donné par le user
+static char *hash_file = NULL;              // fichier de condensats cherchés en lot (-f)
+static char *miss_path = NULL;              // fichier des condensats absents du lot (--misses)
+static int keep_order = 0;                  // 1 = résultats du lot dans l'ordre du fichier (--keep-order)
 static char *t3c_path = "lab/rainbowTAB.t3c";   // chemin par défaut du fichier T3C (sortie en -G, entrée en -L)
 static char *algo_choice = "sha256";        // algo par défaut (sha256)
+static char *algos[T3C_SECTIONS_MAX];       // algos de -G (-a répété), une section de la table par algo
+static int nb_algos = 0;                    // 0 = algo_choice seul
+static int nb_threads = 1;                  // threads de hachage en -G / -R, de recherche rainbow en -L (-j N)
+static int format_choice = -1;              // -1 = non défini (texte en -G, format opposé à la source en -C)
+static char *convert_path = NULL;           // table source du mode -C
+static int index_choice = -1;               // -1 = défaut (Eytzinger en texte, colonne projetée en binaire)
+static size_t mem_limit = 0;                // 0 = table binaire triée en mémoire, sinon budget du tri externe en -G
+static char *tmp_dir = NULL;                // dossier des runs du tri externe (défaut : dossier de la sortie)
+static unsigned int bloom_bits = 0;         // 0 = pas de filtre, sinon bits par clé du filtre <out>.bf en -G
+static unsigned int shard_bits = 0;         // 0 = table d'un seul fichier, sinon k bits de préfixe des shards en -G
+static int shard_seul = -1;                 // -1 = tous les shards, sinon seul shard reconstruit (--shard=XX)
+static int append = 0;                      // 1 = nouveaux mots écrits dans un run de la table existante (--append)
+static int dedup = 1;                       // 1 = mots en double du dictionnaire ignorés en -G (0 : --no-dedup)
+static unsigned int compress_bloc = 0;      // 0 = mdp non compressés, sinon mdp par bloc compressé (--compress) en -G / -C
+static dict_regles regles;                  // règles de --rules=<fichier> en -G (nbregle 0 : mots tels quels)
+static char *masque_texte = NULL;           // masque de -M (NULL : dictionnaire de -G)
+static char *charsets_perso[DICT_MASQUE_PERSO];  // jeux ?1 .. ?4 du masque (--charset1= .. --charset4=)
+static uint64_t skip = 0;                   // premier indice du masque généré (--skip)
+static uint64_t limit = 0;                  // 0 = jusqu'au dernier candidat, sinon candidats générés (--limit)
+static dict_masque masque;                  // masque compilé de -M
+static size_t batch_size = 0;               // 0 = défaut, sinon octets lus par paquet du pipeline de -G (--batch-size)
+static unsigned int queue_depth = 0;        // 0 = défaut, sinon paquets en vol dans le pipeline de -G (--queue-depth)
+static char algos_table[T3C_SECTIONS_MAX][T3C_ALGO_MAX];   // algos lus dans la table complétée par --append
+static char *charset_choice = NULL;         // charset de l'espace des clés en -R (nom prédéfini ou caractères)
+static unsigned int len_min = 0;            // longueurs des mdp de l'espace des clés en -R
+static unsigned int len_max = 0;
+static uint64_t chain_len = 1000;           // t : longueur des chaînes en -R
+static uint64_t chain_count = 100000;       // m : nombre de chaînes en -R
+static int reduce_choice = RAINBOW_REDUCE_MIX;  // famille de réduction en -R
+static uint64_t table_index = 0;            // k : indice de la table dans la famille de réduction
+static char *socket_path = NULL;            // socket Unix du serveur (--serve, --client)
+static char *serve_paths[T3C_SERVE_TABLES_MAX]; // tables servies par --serve
+static int nb_serve = 0;
+static char *stats_path = NULL;             // fichier du bilan --stats=<fichier> (NULL : stderr)
 
 // Help du programme
 void help(char *prog){
@@ -31,8 +87,15 @@ void help(char *prog){
         "|──────────────────────────────────────────────────────────────────────────────|\n"
         "| Usage                                                                        |\n"
         "|   %s -h -> Affiche l'aide                                        |\n"
-        "|   %s -G <dict.txt> [-o <out.t3c>] [-a <algo>]                    |\n"
-        "|   %s -L <table.t3c> [-s <condensat-hex>]                         |\n"
+        "|   %s -G <dict.txt> [-o <out.t3c>] [-a <algo>]... [-j <N>]        |\n"
+        "|   %s -M <masque> [--skip=<i>] [--limit=<n>] [options de -G]      |\n"
+        "|   %s -L <table> [-s <condensat-hex>] [--index=<type>] [-j <N>]   |\n"
+        "|   %s -L <table> -f <hashes.txt> [--misses=<f>] [--keep-order]    |\n"
+        "|   %s -C <table.t3c> -o <out.t3c> [--format=txt|bin]              |\n"
+        "|   %s -R --charset=<cs> --len=<min-max> [-t <t>] [-m <m>]         |\n"
+        "|   %s --serve <socket> <table> [<table> ...] [--index=<type>]     |\n"
+        "|   %s --client <socket>                                           |\n"
+        "|   %s --compact <table>                                           |\n"
         "|                                                                              |\n"
         "| Description :                                                                |\n"
         "|   -G : Génère une table T3C (hash -> mdp) à partir d'un dictionnaire de mdp  |\n"
@@ -40,9 +103,84 @@ void help(char *prog){
         "|                       [rainbowTAB.t3c] default                               |\n"
         "|        -a <algo> : algo de hachage (sha256 | sha512 | blake2b512 | sha3-256  |\n"
         "|                    [sha256] default                                          |\n"
+        "|        -a répété : chaque mot haché par tous les algos en une lecture,       |\n"
+        "|                     une section par algo dans la même table (4 au plus)      |\n"
+        "|        -j <N> : nombre de threads de hachage [1] default                     |\n"
+        "|        --format=txt|bin : texte hash<TAB>mdp ou binaire trié (mmap)          |\n"
+        "|                           [txt] default                                      |\n"
+        "|        --mem-limit=<taille>[K|M|G] : table binaire triée par runs sur        |\n"
+        "|                    disque puis fusionnée, sans dépasser ce budget mémoire    |\n"
+        "|        --tmp-dir=<dossier> : dossier des runs [dossier de la sortie]         |\n"
+        "|        --bloom[=<bits>] : filtre de Bloom <out>.bf des absents, lu par -L    |\n"
+        "|                           [10] bits par clé default                          |\n"
+        "|        --shards=<k> : table découpée par les k premiers bits du condensat    |\n"
+        "|                       (1 à 8) : manifeste <out>, shards <out>.d/XX ; -L      |\n"
+        "|                       n'ouvre que les shards touchés par les requêtes        |\n"
+        "|        --shard=<XX> : avec --shards, reconstruit seulement le shard XX       |\n"
+        "|        --append : ajoute seulement les nouveaux mots à la table -o           |\n"
+        "|                   existante, en run binaire trié <out>.r/NNNNNN              |\n"
+        "|        --no-dedup : garde les mots en double du dictionnaire (par défaut     |\n"
+        "|                     seule la première occurrence est hachée et écrite)       |\n"
+        "|        --compress[=<n>] : table binaire aux mdp compressés par blocs de n,   |\n"
+        "|                           -L ne décompresse que le bloc d'un mdp trouvé      |\n"
+        "|                           [128] mdp par bloc default (aussi en -C)           |\n"
+        "|        --rules=<fichier> : règles hashcat (l u c t T $ ^ s r d ...), un      |\n"
+        "|                    candidat par mot et par règle, haché sans fichier étendu  |\n"
+        "|        --batch-size=<taille>[K|M|G] : octets lus par paquet du pipeline      |\n"
+        "|                    lecture -> hachage -> écriture (4K à 1G) [1M] default     |\n"
+        "|        --queue-depth=<n> : paquets en vol dans le pipeline (1 à 4096)        |\n"
+        "|                    [2 x threads + 2] default                                 |\n"
+        "|                                                                              |\n"
+        "|   -M <masque> : Génère la table sur tout l'espace d'un masque, sans fichier  |\n"
+        "|        ?l ?u ?d ?s ?a ?h ?H ?1-?4 ou caractère (ex : ?l?l?l?d?d?d), options  |\n"
+        "|        de -G, indices répartis par intervalles entre les threads (-j)        |\n"
+        "|        --skip=<i> : premier indice généré, reprise d'une génération [0]      |\n"
+        "|        --limit=<n> : nombre de candidats générés [jusqu'au dernier]          |\n"
+        "|        --charset1=<cs> .. --charset4=<cs> : jeux ?1 .. ?4, noms de -R        |\n"
+        "|                    ou caractères, classes ?x permises (ex : ?l?d_)           |\n"
         "|                                                                              |\n"
         "|   -L <table.t3c> : Recherche dans une table T3C existante                    |\n"
         "|        -s <hash> : renvoie le mdp associée au condensat donnée               |\n"
+        "|        algo:<hash> : cherche seulement dans la section de cet algo           |\n"
+        "|                       (aussi en -f, --serve et --client)                     |\n"
+        "|        (le format texte ou binaire de la table est détecté automatiquement)  |\n"
+        "|        --index=sorted|interp|hash : Eytzinger, interpolation ou hachage      |\n"
+        "|             [sorted] default (table binaire : colonne du fichier)            |\n"
+        "|        -j <N> : table rainbow, positions réparties sur N threads [1] default |\n"
+        "|        -f <hashes.txt> : recherche en lot, requêtes triées puis fusionnées   |\n"
+        "|                          avec la table triée, sortie hash<TAB>mdp            |\n"
+        "|        --misses=<fichier> : condensats absents du lot                        |\n"
+        "|        --keep-order : résultats dans l'ordre du fichier [ordre trié] default |\n"
+        "|                                                                              |\n"
+        "|   -C <table.t3c> : Convertit une table T3C (import / export)                 |\n"
+        "|        -o <out.t3c> : fichier de sortie                                      |\n"
+        "|        --format=txt|bin : format de sortie [format opposé à la source]       |\n"
+        "|                                                                              |\n"
+        "|   -R : Génère une table rainbow (début, fin de chaîne) sur un espace de clés |\n"
+        "|        --charset=<cs> : digits | lower | upper | alpha | alnum | ascii       |\n"
+        "|                         ou directement les caractères                        |\n"
+        "|        --len=<min-max> : longueurs des mdp (ex : 1-6)                        |\n"
+        "|        -t <t> : longueur des chaînes [1000] default                          |\n"
+        "|        -m <m> : nombre de chaînes [100000] default                           |\n"
+        "|        --reduce=add|mix : famille de réduction [mix] default                 |\n"
+        "|        --table-index=<k> : indice de la table dans la famille [0] default    |\n"
+        "|        -o <out> [lab/rainbow.rbt]   -a <algo> [sha256]   -j <N> [1]          |\n"
+        "|                                                                              |\n"
+        "|   --serve <socket> <tables> : sert les tables T3C sur une socket Unix        |\n"
+        "|        tables ouvertes une seule fois, clients concurrents en pipeline       |\n"
+        "|        texte : ligne [algo:]<hash> -> OK <mdp> | ABSENT | INVALIDE           |\n"
+        "|        binaire : trames [taille][algo][taille][condensat] (voir --client)    |\n"
+        "|        --index=sorted|interp|hash : comme en -L ; arrêt par Ctrl-C           |\n"
+        "|   --client <socket> : envoie les condensats de stdin au serveur              |\n"
+        "|        réponses affichées comme en -L, dans l'ordre de stdin                 |\n"
+        "|   --compact <table> : fusionne les runs de --append dans la table,           |\n"
+        "|        condensats en double éliminés (le plus récent est gardé)              |\n"
+        "|                                                                              |\n"
+        "|   Options communes à tous les modes :                                        |\n"
+        "|        --stats[=<fichier>] : bilan JSON à la fin du mode (durée des phases,  |\n"
+        "|                  compteurs, latences des recherches) [stderr] default        |\n"
+        "|        --progress | --no-progress : barres de progression sur stderr         |\n"
+        "|                  [seulement si stderr est un terminal] default               |\n"
         "|                                                                              |\n"
         "|──────────────────────────────────────────────────────────────────────────────|\n"
         "| Exemples                                                                     |\n"
@@ -55,7 +193,7 @@ void help(char *prog){
         "|   Recherche (unique) :                                                       |\n"
         "|     %s -L rainbowTAB.t3c -s 7c4b7e570b75...                      |\n"
         "└──────────────────────────────────────────────────────────────────────────────┘\n",
-        prog, prog, prog, prog, prog, prog);
+        prog, prog, prog, prog, prog, prog, prog, prog, prog, prog, prog, prog, prog);
 }
 
 // Valide l’algorithme de hachage donné par -a
@@ -68,80 +206,468 @@ int algo_exist(char *algo_name){
     return -1;
 }
 
+// Valide l'option --format=txt|bin et la convertit en T3C_FORMAT_*
+int format_exist(char *arg){
+    if (strcmp(arg, "--format=txt") == 0)
+        return T3C_FORMAT_TXT;
+    if (strcmp(arg, "--format=bin") == 0)
+        return T3C_FORMAT_BIN;
+    return -1;
+}
+
+// Lit une taille <n>[K|M|G] (--mem-limit=, --batch-size=) et met la taille en octets dans taille
+int taille_exist(char *texte, size_t *taille){
+    char *fin = NULL;
+    unsigned long long valeur = strtoull(texte, &fin, 10);
+    if (fin == texte)
+        return -1;
+    unsigned int decalage = 0;
+    if (*fin == 'K' || *fin == 'k')
+        decalage = 10;
+    else if (*fin == 'M' || *fin == 'm')
+        decalage = 20;
+    else if (*fin == 'G' || *fin == 'g')
+        decalage = 30;
+    if (decalage)
+        fin++;
+    if (*fin != '\0' || valeur == 0 || valeur > (SIZE_MAX >> decalage))
+        return -1;
+    *taille = (size_t)valeur << decalage;
+    return 0;
+}
+
+// Convertit --charset=<cs> : nom d'un charset prédéfini, sinon les caractères eux-mêmes
+char *charset_exist(char *nom){
+    if (strcmp(nom, "digits") == 0) return "0123456789";
+    if (strcmp(nom, "lower") == 0)  return "abcdefghijklmnopqrstuvwxyz";
+    if (strcmp(nom, "upper") == 0)  return "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    if (strcmp(nom, "alpha") == 0)  return "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    if (strcmp(nom, "alnum") == 0)  return "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    if (strcmp(nom, "ascii") == 0)  return " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+    return nom;
+}
+
+// Lit un entier décimal de [min, max] dans valeur ; -1 si le texte n'en est pas un
+int nombre_exist(char *texte, uint64_t min, uint64_t max, uint64_t *valeur){
+    char *fin = NULL;
+    if (texte[0] < '0' || texte[0] > '9')
+        return -1;
+    unsigned long long nb = strtoull(texte, &fin, 10);
+    if (*fin != '\0' || nb < min || nb > max)
+        return -1;
+    *valeur = nb;
+    return 0;
+}
+
+// Valide l'option --index=<type> et la convertit en T3C_INDEX_*
+int index_exist(char *arg){
+    if (strcmp(arg, "--index=sorted") == 0)
+        return T3C_INDEX_SORTED;
+    if (strcmp(arg, "--index=interp") == 0)
+        return T3C_INDEX_INTERP;
+    if (strcmp(arg, "--index=hash") == 0)
+        return T3C_INDEX_HASH;
+    return -1;
+}
+
+/* Compile le masque de -M et le transmet à la génération avec ses candidats [--skip, --skip + --limit)
+   - sans --limit, jusqu'au dernier candidat du masque
+*/
+int masque_preparer(void){
+    if (dict_masque_lire(masque_texte, charsets_perso, &masque) != 0)
+        return -1;
+    if (skip >= masque.nbcandidat){
+        printf("menu.c : ERREUR > --skip=%llu dépasse les %llu candidats du masque '%s'\n", (unsigned long long)skip, (unsigned long long)masque.nbcandidat, masque_texte);
+        return -1;
+    }
+    uint64_t nb = masque.nbcandidat - skip;
+    if (limit > nb){
+        printf("menu.c : ERREUR > --limit=%llu dépasse les %llu candidats restants du masque '%s'\n", (unsigned long long)limit, (unsigned long long)nb, masque_texte);
+        return -1;
+    }
+    if (limit)
+        nb = limit;
+    dict_utiliser_masque(&masque, skip, nb);
+    printf("Masque '%s' : candidats %llu à %llu sur %llu", masque_texte, (unsigned long long)skip, (unsigned long long)(skip + nb - 1), (unsigned long long)masque.nbcandidat);
+    if (skip + nb < masque.nbcandidat)
+        printf(" (la suite commence à --skip=%llu)", (unsigned long long)(skip + nb));
+    printf("\n");
+    return 0;
+}
+
+// Écrit les noms des algos de -G séparés par des virgules dans texte
+void algos_texte(char *texte, size_t taille){
+    texte[0] = '\0';
+    for (int a = 0; a < nb_algos; ++a){
+        size_t longueur = strlen(texte);
+        snprintf(texte + longueur, taille - longueur, "%s%s", a ? ", " : "", algos[a]);
+    }
+}
+
+// Construit le filtre de Bloom de la table (ou du run) écrite en -G si --bloom est donné
+int bloom_generer(char *path){
+    if (bloom_bits == 0)
+        return 0;
+    size_t nbcle = 0;
+    if (t3c_bloom_build(path, bloom_bits, &nbcle) != 0){
+        printf("menu.c : ERREUR > La fonction t3c_bloom_build à échoué\n");
+        return -1;
+    }
+    printf("Filtre de Bloom écrit dans %s%s (%zu clés, %u bits par clé)\n", path, T3C_BLOOM_SUFFIXE, nbcle, bloom_bits);
+    return 0;
+}
+
+/* Prépare -G --append : le prochain run de la table t3c_path
+   - la table doit exister ; ses algos sont repris (-a, s'il est donné, doit les redonner dans
+     le même ordre) pour que les runs aient les sections de la table
+   - le run est une table binaire triée : --format=txt, --mem-limit et --shards ne s'appliquent pas
+   - run reçoit le chemin du run, son dossier <table>.r est créé
+*/
+int run_preparer(char *run, size_t taille){
+    if (format_choice == T3C_FORMAT_TXT || mem_limit || shard_bits){
+        printf("menu.c : ERREUR > --append écrit un run binaire trié : --format=txt, --mem-limit et --shards ne s'appliquent pas\n");
+        return -1;
+    }
+    if (access(t3c_path, R_OK) != 0 || rainbow_is(t3c_path) || t3c_shard_is(t3c_path)){
+        printf("menu.c : ERREUR > --append complète une table T3C existante d'un seul fichier (-o) : '%s'\n", t3c_path);
+        return -1;
+    }
+    size_t nbsection = 0;
+    if (t3c_algos(t3c_path, algos_table, &nbsection) != 0 || nbsection == 0){
+        printf("menu.c : ERREUR > Les algos de la table '%s' ne peuvent pas être lus\n", t3c_path);
+        return -1;
+    }
+    int identique = nb_algos == 0 || (size_t)nb_algos == nbsection;
+    for (int a = 0; identique && a < nb_algos; ++a)
+        identique = strcmp(algos[a], algos_table[a]) == 0;
+    if (!identique){
+        printf("menu.c : ERREUR > --append reprend les algos de la table, dans le même ordre (-a)\n");
+        return -1;
+    }
+    nb_algos = 0;
+    for (size_t s = 0; s < nbsection; ++s)
+        algos[nb_algos++] = algos_table[s];
+    format_choice = T3C_FORMAT_BIN;
+
+    unsigned int numero = t3c_runs_nb(t3c_path) + 1;
+    if (numero > T3C_RUNS_MAX){
+        printf("menu.c : ERREUR > La table '%s' a déjà %d runs : compactez-la d'abord (--compact)\n", t3c_path, T3C_RUNS_MAX);
+        return -1;
+    }
+    char dossier[4096];
+    if (snprintf(dossier, sizeof dossier, "%s%s", t3c_path, T3C_RUNS_SUFFIXE) >= (int)sizeof dossier || t3c_run_chemin(t3c_path, numero, run, taille) != 0)
+        return -1;
+    if (mkdir(dossier, 0755) != 0 && errno != EEXIST){
+        printf("menu.c : ERREUR > La création du dossier des runs '%s' à échoué\n", dossier);
+        return -1;
+    }
+    return 0;
+}
+
+/* Construit le filtre de Bloom de chaque shard non vide écrit en -G si --bloom est donné
+   - chaque shard est une T3C ordinaire : son filtre est rangé à côté, <out>.d/XX.bf
+*/
+int bloom_shards(void){
+    if (bloom_bits == 0)
+        return 0;
+    t3c_manifeste *manifeste = malloc(sizeof *manifeste);
+    if (manifeste == NULL || t3c_manifeste_lire(t3c_path, manifeste) != 0){
+        free(manifeste);
+        return -1;
+    }
+    size_t nbcle = 0;
+    int retour = 0;
+    for (unsigned int shard = 0; retour == 0 && shard < t3c_shard_nb(manifeste); ++shard){
+        char chemin[4096];
+        size_t nb = 0;
+        if (manifeste->nbobj[shard] == 0 || (shard_seul >= 0 && shard != (unsigned int)shard_seul))
+            continue;
+        if (t3c_shard_chemin(t3c_path, shard, chemin, sizeof chemin) != 0 || t3c_bloom_build(chemin, bloom_bits, &nb) != 0){
+            printf("menu.c : ERREUR > La fonction t3c_bloom_build à échoué sur le shard %02x\n", shard);
+            retour = -1;
+        }
+        nbcle += nb;
+    }
+    free(manifeste);
+    if (retour == 0)
+        printf("Filtres de Bloom écrits à côté des shards de %s (%zu clés, %u bits par clé)\n", t3c_path, nbcle, bloom_bits);
+    return retour;
+}
+
 // Exécute le mode choisi :
 // - mode == 0 : génération (-G) -> lit dictionnaire, calcule les hash de chaque mdp, remplit la table, et écrit dans un fichier T3C
 // - mode == 1 : Recherche (-L) -> charge un fichier T3C, construit l'index à partir du fichier, cherche le hash donnée avec -s ou stdin
+// - mode == 2 : Conversion (-C) -> relit une T3C et la réécrit dans l'autre format
+// - mode == 3 : Rainbow (-R) -> calcule les chaînes sur l'espace des clés et écrit leurs débuts / fins triés par fin
+// - mode == 4 : Serveur (--serve) -> ouvre les tables une fois et répond aux clients de la socket
+// - mode == 5 : Client (--client) -> envoie les condensats de stdin au serveur et affiche les réponses
+// - mode == 6 : Compaction (--compact) -> fusionne les runs de --append dans la table
 int exec_mode(void){
     if (mode == 0){
-        t3c_table tab; // table T3C utilisé pour le programme en mémoire
-        t3c_init(&tab); // initialise la structure à 0 pour commencer l'ecriture dans la table
-
-        // Remplit la table depuis le dictionnaire en appliquant l’algo choisi
-        if (dict_to_Table(dict_path, algo_choice, &tab) == -1){
-            printf("menu.c : ERREUR > La fonction dict_to_table à échoué\n");
-            t3c_free(&tab); // libère les allocations internes si une erreur est survenue
+        // --append : seuls les nouveaux mots, dans un run écrit à côté puis renommé
+        char run[4096];
+        char run_temp[4096 + 8];
+        if (append && run_preparer(run, sizeof run) != 0)
+            return -1;
+        snprintf(run_temp, sizeof run_temp, "%s.tmp", append ? run : "");
+        if (nb_algos == 0)
+            algos[nb_algos++] = algo_choice;
+        char noms[T3C_SECTIONS_MAX * T3C_ALGO_MAX];
+        algos_texte(noms, sizeof noms);
+        if (format_choice == -1)
+            format_choice = mem_limit ? T3C_FORMAT_BIN : T3C_FORMAT_TXT;
+        if (format_choice == T3C_FORMAT_TXT && mem_limit){
+            printf("menu.c : ERREUR > --mem-limit ne s'applique qu'aux tables binaires triées (--format=bin)\n");
+            return -1;
+        }
+        if (mem_limit && nb_algos > 1){
+            printf("menu.c : ERREUR > --mem-limit ne s'applique qu'à un seul algorithme (-a)\n");
+            return -1;
+        }
+        if (shard_seul >= 0 && shard_bits == 0){
+            printf("menu.c : ERREUR > --shard=<XX> s'applique à une table découpée (--shards=<k>)\n");
             return -1;
         }
+        if (mem_limit && shard_bits){
+            printf("menu.c : ERREUR > --mem-limit et --shards ne peuvent pas être combinées\n");
+            return -1;
+        }
+        if (compress_bloc && format_choice == T3C_FORMAT_TXT){
+            printf("menu.c : ERREUR > --compress ne s'applique qu'aux tables binaires (--format=bin)\n");
+            return -1;
+        }
+        t3c_bin_compression(compress_bloc);
+
+        // Table découpée : entrées réparties par préfixe, puis chaque shard écrit seul
+        if (shard_bits){
+            size_t nbobj = 0;
+            size_t nbdoublons = 0;
+            if (dict_to_t3c_shards(dict_path, algos, nb_algos, t3c_path, shard_bits, format_choice, shard_seul, nb_threads, dedup, &nbobj, &nbdoublons) != 0){
+                printf("menu.c : ERREUR > La fonction dict_to_t3c_shards à échoué\n");
+                return -1;
+            }
+            if (t3c_runs_supprimer(t3c_path) != 0)
+                return -1;
+            printf("Execution terminée avec brio ! %zu entrées écrites dans %s%s avec l'algorithme de Hachage %s (%zu lignes en double ignorées)\n", nbobj, t3c_path, T3C_SHARD_SUFFIXE, noms, nbdoublons);
+            return bloom_shards();
+        }
 
-        // Écrit la table dans un fichier T3C avec comme disposition hash<TAB>mdp
-        if (create_t3c(&tab, t3c_path, algo_choice) != 0){
+        // Table texte : lecture, hachage et écriture en une passe, sans table en mémoire
+        if (format_choice == T3C_FORMAT_TXT){
+            size_t nbobj = 0;
+            size_t nbdoublons = 0;
+            if (dict_to_t3c_flux(dict_path, algos, nb_algos, t3c_path, nb_threads, dedup, &nbobj, &nbdoublons) != 0){
+                printf("menu.c : ERREUR > La fonction dict_to_t3c_flux à échoué\n");
+                return -1;
+            }
+            if (t3c_runs_supprimer(t3c_path) != 0)
+                return -1;
+            printf("Execution terminée avec brio ! %zu entrées écrites dans %s avec l'algorithme de Hachage %s (%zu lignes en double ignorées)\n", nbobj * (size_t)nb_algos, t3c_path, noms, nbdoublons);
+            return bloom_generer(t3c_path);
+        }
+
+        // Table binaire avec budget mémoire : tri externe par runs puis fusion
+        if (mem_limit){
+            char dossier[4096];
+            if (tmp_dir == NULL){
+                t3c_dossier(t3c_path, dossier, sizeof dossier);
+                tmp_dir = dossier;
+            }
+            size_t nbobj = 0;
+            size_t nbdoublons = 0;
+            if (dict_to_t3c_tri(dict_path, algo_choice, t3c_path, nb_threads, mem_limit, tmp_dir, &nbobj, &nbdoublons) != 0){
+                printf("menu.c : ERREUR > La fonction dict_to_t3c_tri à échoué\n");
+                return -1;
+            }
+            if (t3c_runs_supprimer(t3c_path) != 0)
+                return -1;
+            printf("Execution terminée avec brio ! %zu entrées écrites dans %s avec l'algorithme de Hachage %s (%zu condensats en double éliminés)\n", nbobj, t3c_path, algo_choice, nbdoublons);
+            return bloom_generer(t3c_path);
+        }
+
+        t3c_table tabs[T3C_SECTIONS_MAX]; // une table T3C par algo utilisée pour le programme en mémoire
+        for (int a = 0; a < nb_algos; ++a)
+            t3c_init(&tabs[a]); // initialise les structures à 0 pour commencer l'ecriture dans les tables
+
+        // Remplit les tables depuis le dictionnaire en appliquant les algos choisis
+        size_t nbdoublons = 0;
+        int retour = dict_to_Table(dict_path, algos, nb_algos, tabs, nb_threads, dedup, &nbdoublons);
+        if (retour == -1)
+            printf("menu.c : ERREUR > La fonction dict_to_table à échoué\n");
+
+        // Table binaire : le tri impose la table complète avant l'écriture
+        if (retour == 0 && create_t3c(tabs, (size_t)nb_algos, append ? run_temp : t3c_path, format_choice) != 0){
             printf("menu.c : ERREUR > La fonction create_t3c à échoué\n");
-            t3c_free(&tab);
-            return -1;
+            retour = -1;
         }
+        if (retour == 0 && append && rename(run_temp, run) != 0){
+            printf("menu.c : ERREUR > Le run '%s' ne peut pas être mis en place\n", run);
+            unlink(run_temp);
+            retour = -1;
+        }
+        // Les runs d'une ancienne table ne sont supprimés qu'une fois la nouvelle écrite
+        if (retour == 0 && !append && t3c_runs_supprimer(t3c_path) != 0)
+            retour = -1;
 
-        // Message de succès donnant le nombre d'entrées, le chemin du T3C et le nom de l'algo utilisé
-        printf("Execution terminée avec brio ! %zu entrées écrites dans %s avec l'algorithme de Hachage %s\n", tab.nbobj, t3c_path, algo_choice);
-        t3c_free(&tab); // nettoyage de la table en mémoire
-        return 0;
+        // Message de succès donnant le nombre d'entrées, le chemin du T3C et le nom des algos utilisés
+        size_t nbobj = 0;
+        for (int a = 0; a < nb_algos; ++a){
+            nbobj += tabs[a].nbobj;
+            t3c_free(&tabs[a]); // nettoyage des tables en mémoire
+        }
+        if (retour != 0)
+            return -1;
+        if (append){
+            printf("Execution terminée avec brio ! %zu entrées ajoutées à %s dans le run %s avec l'algorithme de Hachage %s (%zu lignes en double ignorées)\n", nbobj, t3c_path, run, noms, nbdoublons);
+            return bloom_generer(run);
+        }
+        printf("Execution terminée avec brio ! %zu entrées écrites dans %s avec l'algorithme de Hachage %s (%zu lignes en double ignorées)\n", nbobj, t3c_path, noms, nbdoublons);
+        return bloom_generer(t3c_path);
 
     } else if (mode == 1){ // Mode recherche (-L)
+        // -f : toutes les requêtes du fichier en un tri + une fusion avec la table
+        if (hash_file != NULL){
+            if (rainbow_is(t3c_path)){
+                printf("menu.c : ERREUR > La recherche en lot -f s'applique aux tables T3C, pas aux tables rainbow\n");
+                return -1;
+            }
+            return t3c_mode_batch(t3c_path, hash_file, miss_path, keep_order, nb_threads);
+        }
+
         // Si -s absent : demander un condensat à l’utilisateur (1 seul lookup)
         if(hash_search == NULL){
             char buf[1025]; //tampon de stdin           
             printf("Ecrivez le Hash que vous recherchez : \n");
             scanf("%s",buf); // lit un mot
-            return t3c_mode_lookup(t3c_path,buf); 
+            if (rainbow_is(t3c_path))
+                return rainbow_mode_lookup(t3c_path, buf, nb_threads);
+            return t3c_mode_lookup(t3c_path, buf, index_choice); 
         }
 
         // Si -s est présent : on lance la recherche direct
-        return t3c_mode_lookup(t3c_path, hash_search);
+        if (rainbow_is(t3c_path))
+            return rainbow_mode_lookup(t3c_path, hash_search, nb_threads);
+        return t3c_mode_lookup(t3c_path, hash_search, index_choice);
+
+    } else if (mode == 2){ // Mode conversion (-C)
+        if (t3c_shard_is(convert_path)){
+            printf("menu.c : ERREUR > Une table découpée se convertit shard par shard (%s%s/XX)\n", convert_path, T3C_SHARD_SUFFIXE);
+            return -1;
+        }
+        if (t3c_runs_nb(convert_path) > 0){
+            printf("menu.c : ERREUR > La table '%s' a des runs (--append) : compactez-la d'abord (--compact)\n", convert_path);
+            return -1;
+        }
+        if (format_choice == -1)
+            format_choice = t3c_bin_is(convert_path) ? T3C_FORMAT_TXT : T3C_FORMAT_BIN;
+        if (compress_bloc && format_choice == T3C_FORMAT_TXT){
+            printf("menu.c : ERREUR > --compress ne s'applique qu'aux tables binaires (--format=bin)\n");
+            return -1;
+        }
+        t3c_bin_compression(compress_bloc);
+        return t3c_mode_convert(convert_path, t3c_path, format_choice);
+
+    } else if (mode == 3){ // Mode rainbow (-R)
+        rainbow_espace espace;
+        if (rainbow_espace_init(&espace, charset_choice, strlen(charset_choice), len_min, len_max, (uint32_t)reduce_choice, (uint32_t)table_index, chain_len) != 0)
+            return -1;
+        if (rainbow_generate(t3c_path, algo_choice, &espace, chain_count, nb_threads) != 0){
+            printf("menu.c : ERREUR > La fonction rainbow_generate à échoué\n");
+            return -1;
+        }
+        printf("Execution terminée avec brio ! Table rainbow écrite dans %s avec l'algorithme de Hachage %s\n", t3c_path, algo_choice);
+        return 0;
+
+    } else if (mode == 4){ // Mode serveur (--serve)
+        return t3c_serve(socket_path, serve_paths, nb_serve, index_choice);
+
+    } else if (mode == 5){ // Mode client (--client)
+        return t3c_client(socket_path);
+
+    } else if (mode == 6){ // Mode compaction (--compact)
+        if (t3c_runs_nb(t3c_path) == 0){
+            printf("La table %s n'a aucun run à compacter\n", t3c_path);
+            return 0;
+        }
+        size_t nbobj = 0;
+        size_t nbdoublons = 0;
+        if (t3c_compact(t3c_path, &nbobj, &nbdoublons) != 0){
+            printf("menu.c : ERREUR > La fonction t3c_compact à échoué\n");
+            return -1;
+        }
+        printf("Compaction terminée : %zu entrées dans %s (%zu doublons éliminés)\n", nbobj, t3c_path, nbdoublons);
+        return 0;
     }
     return -1;
 }
 
 // Analyse les arguments de la ligne de commande
+/* Retire de argv les options communes à tous les modes, avant l'analyse du mode
+   - --stats[=<fichier>] : active l'instrumentation, bilan JSON écrit à la fin du mode
+   - --progress / --no-progress : barres de progression forcées ou coupées
+*/
+static int options_communes(int *argc, char **argv){
+    int garde = 1;
+    for (int i = 1; i < *argc; ++i){
+        if (strcmp(argv[i], "--stats") == 0)
+            t3c_stats_activer();
+        else if (strncmp(argv[i], "--stats=", 8) == 0){
+            if (argv[i][8] == '\0'){
+                printf("menu.c : ERREUR > --stats= attend un fichier\n");
+                return -1;
+            }
+            stats_path = argv[i] + 8;
+            t3c_stats_activer();
+        }
+        else if (strcmp(argv[i], "--progress") == 0)
+            t3c_progression(1);
+        else if (strcmp(argv[i], "--no-progress") == 0)
+            t3c_progression(0);
+        else
+            argv[garde++] = argv[i];
+    }
+    *argc = garde;
+    argv[garde] = NULL;
+    return 0;
+}
+
 int start(int argc, char **argv){
+    if (options_communes(&argc, argv) != 0)
+        return -1;
     if (argc < 2){
         // Aucun argument -> afficher l'aide et signaler une erreur
         help(argv[0]);
         return -1;
     }
 
-    // mode G
-    if (strcoll(argv[1], "-G") == 0){
-        // Exige un fichier dictionnaire
+    // mode G, ou M : mêmes options, les candidats d'un masque remplacent le dictionnaire
+    if (strcoll(argv[1], "-G") == 0 || strcoll(argv[1], "-M") == 0){
+        // Exige un fichier dictionnaire ou un masque
         if (argc < 3 || argv[2][0] == '-'){ 
             help(argv[0]); 
             return -1; 
         }
-        dict_path = argv[2]; // mémorise le chemin du dictionnaire
-    
-        // vérifie que le fichier est lisible
-        if (access(dict_path, R_OK) != 0){ 
-            printf("menu.c : ERREUR > Le dictionnaire est illisible changé de fichier ou vérifier qu'il soit bien créée\n");
-            return -1; 
+        if (strcoll(argv[1], "-M") == 0)
+            masque_texte = argv[2]; // mémorise le masque, compilé après ses options
+        else {
+            dict_path = argv[2]; // mémorise le chemin du dictionnaire
+
+            // vérifie que le fichier est lisible
+            if (access(dict_path, R_OK) != 0){ 
+                printf("menu.c : ERREUR > Le dictionnaire est illisible changé de fichier ou vérifier qu'il soit bien créée\n");
+                return -1; 
+            }
         }
         mode = 0; // passe en mode génération
 
-        // Parcourt les options spécifiques à -G
+        // Parcourt les options spécifiques à -G / -M
         for (int i = 3; i < argc; ){
             // -o <out.t3c> : spécifie le chemin de sortie du T3C
             if (strcoll(argv[i], "-o") == 0 && i+1 < argc && argv[i+1][0] != '-'){
                 t3c_path = argv[i+1]; 
                 i += 2;
             }
-            // -a <algo> : spécifie l'algorithme de hachage
+            // -a <algo> : spécifie l'algorithme de hachage, répété pour plusieurs sections
             else if (strcoll(argv[i], "-a") == 0 && i+1 < argc && argv[i+1][0] != '-'){
                 algo_choice = argv[i+1];
                 if (algo_exist(algo_choice) != 0){
@@ -149,14 +675,162 @@ int start(int argc, char **argv){
                     printf("menu.c : ERREUR > L'algo choisi est invalide '%s' Algo authorisé : sha256 | sha512 | blake2b512 | sha3-256\n", algo_choice);
                     return -1;
                 }
+                for (int a = 0; a < nb_algos; ++a){
+                    if (strcmp(algos[a], algo_choice) == 0){
+                        printf("menu.c : ERREUR > L'algo '%s' est donné deux fois\n", algo_choice);
+                        return -1;
+                    }
+                }
+                if (nb_algos == T3C_SECTIONS_MAX){
+                    printf("menu.c : ERREUR > Trop d'algos (%d au plus)\n", T3C_SECTIONS_MAX);
+                    return -1;
+                }
+                algos[nb_algos++] = algo_choice;
+                i += 2;
+            }
+            // -j <N> : nombre de threads de hachage
+            else if (strcoll(argv[i], "-j") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                char *fin = NULL;
+                long nb = strtol(argv[i+1], &fin, 10);
+                if (*fin != '\0' || nb < 1 || nb > 1024){
+                    printf("menu.c : ERREUR > Le nombre de threads est invalide '%s' (1 à 1024)\n", argv[i+1]);
+                    return -1;
+                }
+                nb_threads = (int)nb;
                 i += 2;
             }
-            // Option inconnue après -G -> erreur
+            // --format=txt|bin : spécifie le format du fichier T3C
+            else if (strncmp(argv[i], "--format=", 9) == 0){
+                format_choice = format_exist(argv[i]);
+                if (format_choice == -1){
+                    printf("menu.c : ERREUR > Le format choisi est invalide '%s' Format authorisé : txt | bin\n", argv[i] + 9);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --mem-limit=<taille> : budget mémoire du tri externe
+            else if (strncmp(argv[i], "--mem-limit=", 12) == 0){
+                if (taille_exist(argv[i] + 12, &mem_limit) != 0){
+                    printf("menu.c : ERREUR > La limite mémoire est invalide '%s' (ex : 512M, 2G)\n", argv[i] + 12);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --tmp-dir=<dossier> : dossier des runs du tri externe
+            else if (strncmp(argv[i], "--tmp-dir=", 10) == 0 && argv[i][10] != '\0'){
+                tmp_dir = argv[i] + 10;
+                i += 1;
+            }
+            // --bloom[=<bits>] : filtre de Bloom <out>.bf construit après la table
+            else if (strcmp(argv[i], "--bloom") == 0 || strncmp(argv[i], "--bloom=", 8) == 0){
+                uint64_t bits = T3C_BLOOM_BITS;
+                if (argv[i][7] == '=' && nombre_exist(argv[i] + 8, T3C_BLOOM_BITS_MIN, T3C_BLOOM_BITS_MAX, &bits) != 0){
+                    printf("menu.c : ERREUR > Le nombre de bits par clé est invalide '%s' (%d à %d)\n", argv[i] + 8, T3C_BLOOM_BITS_MIN, T3C_BLOOM_BITS_MAX);
+                    return -1;
+                }
+                bloom_bits = (unsigned int)bits;
+                i += 1;
+            }
+            // --shards=<k> : table découpée en 2^k shards par préfixe du condensat
+            else if (strncmp(argv[i], "--shards=", 9) == 0){
+                uint64_t bits = 0;
+                if (nombre_exist(argv[i] + 9, 1, T3C_SHARD_BITS_MAX, &bits) != 0){
+                    printf("menu.c : ERREUR > Le nombre de bits des shards est invalide '%s' (1 à %d)\n", argv[i] + 9, T3C_SHARD_BITS_MAX);
+                    return -1;
+                }
+                shard_bits = (unsigned int)bits;
+                i += 1;
+            }
+            // --shard=<XX> : seul shard reconstruit, son numéro en hexadécimal
+            else if (strncmp(argv[i], "--shard=", 8) == 0){
+                char *fin = NULL;
+                long shard = strtol(argv[i] + 8, &fin, 16);
+                if (argv[i][8] == '\0' || *fin != '\0' || shard < 0 || shard >= (long)T3C_SHARD_MAX){
+                    printf("menu.c : ERREUR > Le shard est invalide '%s' (00 à %02x)\n", argv[i] + 8, T3C_SHARD_MAX - 1);
+                    return -1;
+                }
+                shard_seul = (int)shard;
+                i += 1;
+            }
+            // --append : nouveaux mots ajoutés en run à la table -o existante
+            else if (strcmp(argv[i], "--append") == 0){
+                append = 1;
+                i += 1;
+            }
+            // --no-dedup : les mots en double du dictionnaire sont tous hachés et écrits
+            else if (strcmp(argv[i], "--no-dedup") == 0){
+                dedup = 0;
+                i += 1;
+            }
+            // --rules=<fichier> : chaque mot est étendu par les règles du fichier avant le hachage
+            else if (strncmp(argv[i], "--rules=", 8) == 0){
+                if (regles.nbregle > 0){
+                    printf("menu.c : ERREUR > --rules est donnée deux fois\n");
+                    return -1;
+                }
+                if (dict_regles_lire(argv[i] + 8, &regles) != 0)
+                    return -1;
+                dict_utiliser_regles(&regles);
+                i += 1;
+            }
+            // --compress[=<n>] : mdp de la table binaire compressés par blocs de n mdp
+            else if (strcmp(argv[i], "--compress") == 0 || strncmp(argv[i], "--compress=", 11) == 0){
+                uint64_t bloc = T3C_BIN_BLOC_MDP;
+                if (argv[i][10] == '=' && nombre_exist(argv[i] + 11, T3C_BIN_BLOC_MIN, T3C_BIN_BLOC_MAX, &bloc) != 0){
+                    printf("menu.c : ERREUR > Le nombre de mdp par bloc est invalide '%s' (%d à %d)\n", argv[i] + 11, T3C_BIN_BLOC_MIN, T3C_BIN_BLOC_MAX);
+                    return -1;
+                }
+                compress_bloc = (unsigned int)bloc;
+                i += 1;
+            }
+            // --batch-size=<taille> : octets du dictionnaire lus par paquet du pipeline
+            else if (strncmp(argv[i], "--batch-size=", 13) == 0){
+                if (taille_exist(argv[i] + 13, &batch_size) != 0 || batch_size < DICT_PAQUET_MIN || batch_size > DICT_PAQUET_MAX){
+                    printf("menu.c : ERREUR > La taille des paquets est invalide '%s' (4K à 1G)\n", argv[i] + 13);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --queue-depth=<n> : paquets en vol dans le pipeline lecture -> hachage -> écriture
+            else if (strncmp(argv[i], "--queue-depth=", 14) == 0){
+                uint64_t profondeur = 0;
+                if (nombre_exist(argv[i] + 14, 1, DICT_PAQUETS_MAX, &profondeur) != 0){
+                    printf("menu.c : ERREUR > Le nombre de paquets en vol est invalide '%s' (1 à %d)\n", argv[i] + 14, DICT_PAQUETS_MAX);
+                    return -1;
+                }
+                queue_depth = (unsigned int)profondeur;
+                i += 1;
+            }
+            // --skip=<i> : -M, premier indice du masque généré (reprise d'une génération)
+            else if (masque_texte && strncmp(argv[i], "--skip=", 7) == 0){
+                if (nombre_exist(argv[i] + 7, 0, UINT64_MAX, &skip) != 0){
+                    printf("menu.c : ERREUR > L'indice de --skip est invalide '%s'\n", argv[i] + 7);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --limit=<n> : -M, nombre de candidats générés à partir de --skip
+            else if (masque_texte && strncmp(argv[i], "--limit=", 8) == 0){
+                if (nombre_exist(argv[i] + 8, 1, UINT64_MAX, &limit) != 0){
+                    printf("menu.c : ERREUR > Le nombre de candidats de --limit est invalide '%s'\n", argv[i] + 8);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --charset1=<cs> .. --charset4=<cs> : -M, jeux ?1 .. ?4 du masque
+            else if (masque_texte && strncmp(argv[i], "--charset", 9) == 0 && argv[i][9] >= '1' && argv[i][9] < '1' + DICT_MASQUE_PERSO && argv[i][10] == '=' && argv[i][11] != '\0'){
+                charsets_perso[argv[i][9] - '1'] = charset_exist(argv[i] + 11);
+                i += 1;
+            }
+            // Option inconnue après -G / -M -> erreur
             else {
-                printf("menu.c : ERREUR > Option inconnue en mode -G: %s\n", argv[i]);
+                printf("menu.c : ERREUR > Option inconnue en mode %s: %s\n", argv[1], argv[i]);
                 return -1;
             }
         }
+        if (masque_texte && masque_preparer() != 0)
+            return -1;
+        dict_regler_pipeline(batch_size, queue_depth);
     }
     // mode recherche L
     else if (strcoll(argv[1], "-L") == 0){
@@ -172,11 +846,285 @@ int start(int argc, char **argv){
         }
         mode = 1; // passe en mode Recherche
 
-        // -s <hash> on assigne le <hash> à hash_search
-        if(argc > 3 ){
-            if (strcoll(argv[3], "-s") == 0 && 4 < argc && argv[4][0] != '-')
-                hash_search = argv[4]; 
+        // Parcourt les options spécifiques à -L
+        for (int i = 3; i < argc; ){
+            // -s <hash> on assigne le <hash> à hash_search
+            if (strcoll(argv[i], "-s") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                hash_search = argv[i+1]; 
+                i += 2;
+            }
+            // --index=<type> : structure de recherche
+            else if (strncmp(argv[i], "--index=", 8) == 0){
+                index_choice = index_exist(argv[i]);
+                if (index_choice == -1){
+                    printf("menu.c : ERREUR > L'index choisi est invalide '%s' Index authorisé : sorted | interp | hash\n", argv[i] + 8);
+                    return -1;
+                }
+                i += 1;
+            }
+            // -f <hashes.txt> : fichier de condensats cherchés en lot
+            else if (strcoll(argv[i], "-f") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                hash_file = argv[i+1];
+                i += 2;
+            }
+            // --misses=<fichier> : condensats du lot absents de la table
+            else if (strncmp(argv[i], "--misses=", 9) == 0 && argv[i][9] != '\0'){
+                miss_path = argv[i] + 9;
+                i += 1;
+            }
+            // --keep-order : résultats du lot dans l'ordre du fichier
+            else if (strcmp(argv[i], "--keep-order") == 0){
+                keep_order = 1;
+                i += 1;
+            }
+            // -j <N> : threads de la recherche rainbow et du tri du lot
+            else if (strcoll(argv[i], "-j") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                uint64_t nb = 0;
+                if (nombre_exist(argv[i+1], 1, 1024, &nb) != 0){
+                    printf("menu.c : ERREUR > Le nombre de threads est invalide '%s' (1 à 1024)\n", argv[i+1]);
+                    return -1;
+                }
+                nb_threads = (int)nb;
+                i += 2;
+            }
+            // Option inconnue après -L -> erreur
+            else {
+                printf("menu.c : ERREUR > Option inconnue en mode -L: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        // -s cherche un condensat, -f un fichier : pas les deux
+        if (hash_file != NULL && hash_search != NULL){
+            printf("menu.c : ERREUR > Les options -s et -f ne peuvent pas être combinées\n");
+            return -1;
+        }
+        if (hash_file == NULL && (miss_path != NULL || keep_order)){
+            printf("menu.c : ERREUR > --misses et --keep-order s'appliquent à la recherche en lot -f\n");
+            return -1;
+        }
+
+    }
+    // mode conversion C
+    else if (strcoll(argv[1], "-C") == 0){
+        // Exige une table source lisible
+        if (argc < 3 || argv[2][0] == '-'){ 
+            help(argv[0]); 
+            return -1; 
+        }
+        convert_path = argv[2];
+        if (access(convert_path, R_OK) != 0){
+            printf("menu.c : ERREUR > Le fichier T3C est illisible changé de fichier ou vérifier qu'il soit bien créée\n");
+            return -1; 
+        }
+        mode = 2; // passe en mode Conversion
+        t3c_path = NULL;
+
+        for (int i = 3; i < argc; ){
+            // -o <out.t3c> : table de sortie
+            if (strcoll(argv[i], "-o") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                t3c_path = argv[i+1]; 
+                i += 2;
+            }
+            // --format=txt|bin : format de sortie
+            else if (strncmp(argv[i], "--format=", 9) == 0){
+                format_choice = format_exist(argv[i]);
+                if (format_choice == -1){
+                    printf("menu.c : ERREUR > Le format choisi est invalide '%s' Format authorisé : txt | bin\n", argv[i] + 9);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --compress[=<n>] : mdp de la table binaire compressés par blocs de n mdp
+            else if (strcmp(argv[i], "--compress") == 0 || strncmp(argv[i], "--compress=", 11) == 0){
+                uint64_t bloc = T3C_BIN_BLOC_MDP;
+                if (argv[i][10] == '=' && nombre_exist(argv[i] + 11, T3C_BIN_BLOC_MIN, T3C_BIN_BLOC_MAX, &bloc) != 0){
+                    printf("menu.c : ERREUR > Le nombre de mdp par bloc est invalide '%s' (%d à %d)\n", argv[i] + 11, T3C_BIN_BLOC_MIN, T3C_BIN_BLOC_MAX);
+                    return -1;
+                }
+                compress_bloc = (unsigned int)bloc;
+                i += 1;
+            }
+            else {
+                printf("menu.c : ERREUR > Option inconnue en mode -C: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        // La sortie doit être donnée et différente de la source
+        if (t3c_path == NULL || strcmp(t3c_path, convert_path) == 0){
+            printf("menu.c : ERREUR > Le mode -C exige un fichier de sortie -o différent de la source\n");
+            return -1;
+        }
+
+    }
+    // mode rainbow R
+    else if (strcoll(argv[1], "-R") == 0){
+        mode = 3; // passe en mode Rainbow
+        t3c_path = "lab/rainbow.rbt";
+
+        for (int i = 2; i < argc; ){
+            // -o <out> : table rainbow de sortie
+            if (strcoll(argv[i], "-o") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                t3c_path = argv[i+1];
+                i += 2;
+            }
+            // -a <algo> : algorithme de hachage des chaînes
+            else if (strcoll(argv[i], "-a") == 0 && i+1 < argc && argv[i+1][0] != '-'){
+                algo_choice = argv[i+1];
+                if (algo_exist(algo_choice) != 0){
+                    printf("menu.c : ERREUR > L'algo choisi est invalide '%s' Algo authorisé : sha256 | sha512 | blake2b512 | sha3-256\n", algo_choice);
+                    return -1;
+                }
+                i += 2;
+            }
+            // -j <N> : threads de calcul des chaînes
+            else if (strcoll(argv[i], "-j") == 0 && i+1 < argc){
+                uint64_t nb = 0;
+                if (nombre_exist(argv[i+1], 1, 1024, &nb) != 0){
+                    printf("menu.c : ERREUR > Le nombre de threads est invalide '%s' (1 à 1024)\n", argv[i+1]);
+                    return -1;
+                }
+                nb_threads = (int)nb;
+                i += 2;
+            }
+            // -t <t> : longueur des chaînes
+            else if (strcoll(argv[i], "-t") == 0 && i+1 < argc){
+                if (nombre_exist(argv[i+1], 1, UINT32_MAX, &chain_len) != 0){
+                    printf("menu.c : ERREUR > La longueur de chaîne est invalide '%s'\n", argv[i+1]);
+                    return -1;
+                }
+                i += 2;
+            }
+            // -m <m> : nombre de chaînes
+            else if (strcoll(argv[i], "-m") == 0 && i+1 < argc){
+                if (nombre_exist(argv[i+1], 1, UINT32_MAX * (uint64_t)64, &chain_count) != 0){
+                    printf("menu.c : ERREUR > Le nombre de chaînes est invalide '%s'\n", argv[i+1]);
+                    return -1;
+                }
+                i += 2;
+            }
+            // --charset=<cs> : caractères des mdp
+            else if (strncmp(argv[i], "--charset=", 10) == 0 && argv[i][10] != '\0'){
+                charset_choice = charset_exist(argv[i] + 10);
+                i += 1;
+            }
+            // --len=<min-max> ou --len=<n> : longueurs des mdp
+            else if (strncmp(argv[i], "--len=", 6) == 0){
+                char texte[64];
+                snprintf(texte, sizeof texte, "%s", argv[i] + 6);
+                char *tiret = strchr(texte, '-');
+                if (tiret)
+                    *tiret = '\0';
+                uint64_t min = 0, max = 0;
+                if (nombre_exist(texte, 1, RAINBOW_LONGUEUR_MAX, &min) != 0 || nombre_exist(tiret ? tiret + 1 : texte, min, RAINBOW_LONGUEUR_MAX, &max) != 0){
+                    printf("menu.c : ERREUR > Les longueurs sont invalides '%s' (ex : 1-6, au plus %d)\n", argv[i] + 6, RAINBOW_LONGUEUR_MAX);
+                    return -1;
+                }
+                len_min = (unsigned int)min;
+                len_max = (unsigned int)max;
+                i += 1;
+            }
+            // --reduce=add|mix : famille de fonctions de réduction
+            else if (strncmp(argv[i], "--reduce=", 9) == 0){
+                if (strcmp(argv[i] + 9, "add") == 0)
+                    reduce_choice = RAINBOW_REDUCE_ADD;
+                else if (strcmp(argv[i] + 9, "mix") == 0)
+                    reduce_choice = RAINBOW_REDUCE_MIX;
+                else {
+                    printf("menu.c : ERREUR > La réduction choisie est invalide '%s' Réduction authorisée : add | mix\n", argv[i] + 9);
+                    return -1;
+                }
+                i += 1;
+            }
+            // --table-index=<k> : table k de la famille de réduction
+            else if (strncmp(argv[i], "--table-index=", 14) == 0){
+                if (nombre_exist(argv[i] + 14, 0, UINT32_MAX, &table_index) != 0){
+                    printf("menu.c : ERREUR > L'indice de table est invalide '%s'\n", argv[i] + 14);
+                    return -1;
+                }
+                i += 1;
+            }
+            else {
+                printf("menu.c : ERREUR > Option inconnue en mode -R: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        // L'espace des clés doit être donné
+        if (charset_choice == NULL || len_min == 0){
+            printf("menu.c : ERREUR > Le mode -R exige --charset=<cs> et --len=<min-max>\n");
+            return -1;
+        }
+
+    }
+    // mode serveur --serve
+    else if (strcoll(argv[1], "--serve") == 0){
+        // Exige la socket puis au moins une table
+        if (argc < 4 || argv[2][0] == '-'){
+            help(argv[0]);
+            return -1;
+        }
+        socket_path = argv[2];
+        mode = 4; // passe en mode Serveur
+
+        for (int i = 3; i < argc; ){
+            // --index=<type> : structure de recherche de chaque table
+            if (strncmp(argv[i], "--index=", 8) == 0){
+                index_choice = index_exist(argv[i]);
+                if (index_choice == -1){
+                    printf("menu.c : ERREUR > L'index choisi est invalide '%s' Index authorisé : sorted | interp | hash\n", argv[i] + 8);
+                    return -1;
+                }
+                i += 1;
+            }
+            // <table> : table T3C servie, cherchée dans l'ordre donné
+            else if (argv[i][0] != '-'){
+                if (access(argv[i], R_OK) != 0){
+                    printf("menu.c : ERREUR > Le fichier T3C '%s' est illisible changé de fichier ou vérifier qu'il soit bien créée\n", argv[i]);
+                    return -1;
+                }
+                if (rainbow_is(argv[i])){
+                    printf("menu.c : ERREUR > Le serveur s'applique aux tables T3C, pas aux tables rainbow '%s'\n", argv[i]);
+                    return -1;
+                }
+                if (nb_serve == T3C_SERVE_TABLES_MAX){
+                    printf("menu.c : ERREUR > Le serveur accepte au plus %d tables\n", T3C_SERVE_TABLES_MAX);
+                    return -1;
+                }
+                serve_paths[nb_serve++] = argv[i];
+                i += 1;
+            }
+            else {
+                printf("menu.c : ERREUR > Option inconnue en mode --serve: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        if (nb_serve == 0){
+            printf("menu.c : ERREUR > Le mode --serve exige au moins une table T3C\n");
+            return -1;
+        }
+
+    }
+    // mode client --client
+    else if (strcoll(argv[1], "--client") == 0){
+        if (argc != 3 || argv[2][0] == '-'){
+            help(argv[0]);
+            return -1;
+        }
+        socket_path = argv[2];
+        mode = 5; // passe en mode Client
+
+    }
+    // mode compaction --compact
+    else if (strcoll(argv[1], "--compact") == 0){
+        if (argc != 3 || argv[2][0] == '-'){
+            help(argv[0]);
+            return -1;
+        }
+        t3c_path = argv[2];
+        if (access(t3c_path, R_OK) != 0 || rainbow_is(t3c_path) || t3c_shard_is(t3c_path)){
+            printf("menu.c : ERREUR > --compact s'applique à une table T3C d'un seul fichier lisible '%s'\n", t3c_path);
+            return -1;
         }
+        mode = 6; // passe en mode Compaction
 
     }else if(strcoll(argv[1], "-h") == 0){
         // -h -> afficher l'aide
@@ -188,6 +1136,13 @@ int start(int argc, char **argv){
         return -1;
     }
 
-    // Lance l'exécution du mode chois
-    return exec_mode();
+    // Lance l'exécution du mode chois, puis écrit le bilan de --stats même si le mode a échoué
+    int retour = exec_mode();
+    dict_utiliser_regles(NULL);
+    dict_utiliser_masque(NULL, 0, 0);
+    dict_regler_pipeline(0, 0);
+    dict_regles_free(&regles);
+    if (t3c_stats_ecrire(stats_path) != 0)
+        retour = -1;
+    return retour;
 }
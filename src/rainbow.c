@@ -0,0 +1,555 @@
+/**
+ * rainbow.c - Tables rainbow (chaînes hachage / réduction) : compromis temps / mémoire
+ * - Espace des clés : tous les mdp de longueur_min à longueur_max sur un charset,
+ *   chaque mdp étant identifié par un indice dans [0, N)
+ * - Génération : m chaînes de t étapes (mdp -> condensat -> réduction R_i -> mdp ...),
+ *   hachées par lots (hasher_batch) sur -j threads ; seuls (début, fin) sont gardés,
+ *   triés par fin, une seule chaîne par fin
+ * - Recherche : pour chaque position possible du condensat dans une chaîne, on calcule la
+ *   fin correspondante (positions réparties entre les threads), puis on rejoue depuis le
+ *   début les chaînes dont la fin est dans la table pour écarter les fausses alertes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rainbow.h"
+#include "hash.h"
+#include "t3c_index.h"
+
+#define RAINBOW_LOT 256     // chaînes avancées ensemble, hachées en un appel à hasher_batch
+
+static inline uint64_t splitmix64(uint64_t x){
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Ramène v dans [0, n) par une multiplication (sans division)
+static inline uint64_t ramener(uint64_t v, uint64_t n){
+    return (uint64_t)(((unsigned __int128)v * n) >> 64);
+}
+
+/* Prépare l'espace des clés et la famille de réduction
+   - Renvoie -1 si un paramètre est invalide ou si l'espace dépasse 2^64 mdp
+*/
+int rainbow_espace_init(rainbow_espace *espace, const char *charset, size_t taille_charset, unsigned int longueur_min, unsigned int longueur_max,
+                        uint32_t reduction, uint32_t indice_table, uint64_t longueur_chaine){
+    memset(espace, 0, sizeof *espace);
+    if (taille_charset == 0 || taille_charset > RAINBOW_CHARSET_MAX){
+        printf("rainbow.c : ERREUR > Le charset doit contenir de 1 à %d caractères\n", RAINBOW_CHARSET_MAX);
+        return -1;
+    }
+    if (longueur_min < 1 || longueur_min > longueur_max || longueur_max > RAINBOW_LONGUEUR_MAX){
+        printf("rainbow.c : ERREUR > Les longueurs de mdp doivent vérifier 1 <= min <= max <= %d\n", RAINBOW_LONGUEUR_MAX);
+        return -1;
+    }
+    if (reduction > RAINBOW_REDUCE_MIX || longueur_chaine == 0){
+        printf("rainbow.c : ERREUR > La réduction ou la longueur de chaîne est invalide\n");
+        return -1;
+    }
+    memcpy(espace->charset, charset, taille_charset);
+    espace->taille_charset = (unsigned int)taille_charset;
+    espace->longueur_min = longueur_min;
+    espace->longueur_max = longueur_max;
+    espace->reduction = reduction;
+    espace->indice_table = indice_table;
+    espace->longueur_chaine = longueur_chaine;
+
+    // Nombre de mdp de chaque longueur : taille_charset ^ longueur
+    uint64_t nombre = 1;
+    for (unsigned int l = 1; l < longueur_min; ++l){
+        if (__builtin_mul_overflow(nombre, (uint64_t)taille_charset, &nombre)){
+            printf("rainbow.c : ERREUR > L'espace des clés dépasse 2^64 mdp\n");
+            return -1;
+        }
+    }
+    for (unsigned int l = longueur_min; l <= longueur_max; ++l){
+        if (__builtin_mul_overflow(nombre, (uint64_t)taille_charset, &nombre)
+         || __builtin_add_overflow(espace->premier[l], nombre, &espace->premier[l + 1])){
+            printf("rainbow.c : ERREUR > L'espace des clés dépasse 2^64 mdp\n");
+            return -1;
+        }
+    }
+    espace->taille = espace->premier[longueur_max + 1];
+    return 0;
+}
+
+/* Écrit dans mdp (sans '\0') le mdp d'indice donné et renvoie sa longueur
+   - les indices sont rangés par longueur croissante puis en base taille_charset
+*/
+size_t rainbow_mdp(const rainbow_espace *espace, uint64_t indice, char *mdp){
+    unsigned int l = espace->longueur_min;
+    while (l < espace->longueur_max && indice >= espace->premier[l + 1])
+        l++;
+    uint64_t reste = indice - espace->premier[l];
+    for (unsigned int k = l; k-- > 0; ){
+        mdp[k] = espace->charset[reste % espace->taille_charset];
+        reste /= espace->taille_charset;
+    }
+    return l;
+}
+
+/* Fonction de réduction R_etape : condensat -> indice d'un mdp de l'espace
+   - utilise les 8 premiers octets du condensat (big endian)
+   - chaque étape a sa propre fonction, ce qui limite la fusion des chaînes
+*/
+uint64_t rainbow_reduire(const rainbow_espace *espace, const unsigned char *digest, uint64_t etape){
+    uint64_t h = t3c_cle64(digest, 8);
+    if (espace->reduction == RAINBOW_REDUCE_ADD)
+        return (h + etape + (uint64_t)espace->indice_table * espace->longueur_chaine) % espace->taille;
+    return ramener(splitmix64(h ^ splitmix64(etape ^ ((uint64_t)espace->indice_table << 40))), espace->taille);
+}
+
+// Indice du mdp de départ de la chaîne numéro j (pseudo-aléatoire, propre à la table)
+static uint64_t rainbow_depart(const rainbow_espace *espace, uint64_t j){
+    return ramener(splitmix64(j ^ ((uint64_t)espace->indice_table << 48)), espace->taille);
+}
+
+// Renvoie 1 si le fichier commence par la signature d'une table rainbow, 0 sinon
+int rainbow_is(char *path){
+    char magic[8];
+    FILE *fichier = fopen(path, "rb");
+    if (!fichier)
+        return 0;
+    size_t lu = fread(magic, 1, sizeof magic, fichier);
+    fclose(fichier);
+    return lu == sizeof magic && memcmp(magic, RAINBOW_MAGIC, sizeof magic) == 0;
+}
+
+/* Exécute fonction sur nb travaux de taille octets : les travaux 1..nb-1 dans des threads,
+   le travail 0 dans le thread appelant
+*/
+static void rainbow_lancer(void *(*fonction)(void *), void *travaux, size_t taille, int nb){
+    pthread_t *threads = malloc((size_t)nb * sizeof *threads);
+    int lances = 1;
+    for (int i = 1; threads && i < nb; ++i){
+        if (pthread_create(&threads[i], NULL, fonction, (char*)travaux + (size_t)i * taille) != 0)
+            break;
+        lances++;
+    }
+    // Sans thread disponible, les travaux restants sont faits par le thread appelant
+    for (int i = lances; i < nb; ++i)
+        fonction((char*)travaux + (size_t)i * taille);
+    fonction(travaux);
+    for (int i = 1; i < lances; ++i)
+        pthread_join(threads[i], NULL);
+    free(threads);
+}
+
+/* Avance n chaînes d'une étape : x[k] = R_etape(H(mdp(x[k])))
+   - les n mdp sont hachés en un appel (noyau SIMD quand il existe)
+*/
+static int rainbow_avancer(const rainbow_espace *espace, hasher *h, uint64_t *x, size_t n, uint64_t etape){
+    unsigned char lot[RAINBOW_LOT * (sizeof(uint32_t) + RAINBOW_LONGUEUR_MAX)];
+    unsigned char digests[RAINBOW_LOT * EVP_MAX_MD_SIZE];
+    size_t remplissage = 0;
+    for (size_t k = 0; k < n; ++k){
+        char mdp[RAINBOW_LONGUEUR_MAX];
+        size_t taille = rainbow_mdp(espace, x[k], mdp);
+        remplissage += hasher_lot_ajouter(lot + remplissage, mdp, (uint32_t)taille);
+    }
+    if (hasher_batch(h, lot, n, digests) != 0)
+        return -1;
+    for (size_t k = 0; k < n; ++k)
+        x[k] = rainbow_reduire(espace, digests + k * h->digest_taille, etape);
+    return 0;
+}
+
+// Chaînes [debut, fin) calculées par un thread de génération
+typedef struct {
+    const rainbow_espace *espace;
+    char *algo_name;
+    rainbow_chaine *chaines;
+    uint64_t debut;
+    uint64_t fin;
+    uint64_t nbchaine;
+    atomic_uint_least64_t *fait;
+    int afficher;
+    int retour;
+} rainbow_generation;
+
+static void *rainbow_generer(void *arg){
+    rainbow_generation *travail = arg;
+    const rainbow_espace *espace = travail->espace;
+    hasher *h = hasher_new(travail->algo_name);
+    if (!h){
+        travail->retour = -1;
+        return NULL;
+    }
+    uint64_t pourcentage = travail->nbchaine >= 100 ? travail->nbchaine / 100 : 1;
+    uint64_t prochain = pourcentage;
+
+    for (uint64_t g = travail->debut; g < travail->fin; g += RAINBOW_LOT){
+        size_t n = travail->fin - g < RAINBOW_LOT ? (size_t)(travail->fin - g) : RAINBOW_LOT;
+        uint64_t x[RAINBOW_LOT];
+        for (size_t k = 0; k < n; ++k){
+            x[k] = rainbow_depart(espace, g + k);
+            travail->chaines[g + k].debut = x[k];
+        }
+        for (uint64_t etape = 0; etape < espace->longueur_chaine; ++etape){
+            if (rainbow_avancer(espace, h, x, n, etape) != 0){
+                printf("rainbow.c : ERREUR > Le hachage d'une chaîne à échoué\n");
+                travail->retour = -1;
+                hasher_free(h);
+                return NULL;
+            }
+        }
+        for (size_t k = 0; k < n; ++k)
+            travail->chaines[g + k].fin = x[k];
+
+        uint64_t fait = atomic_fetch_add_explicit(travail->fait, n, memory_order_relaxed) + n;
+        if (travail->afficher && fait >= prochain && fait < travail->nbchaine){
+            progress_bar(fait, travail->nbchaine, "( Chaînes )");
+            prochain = fait - fait % pourcentage + pourcentage;
+        }
+    }
+    hasher_free(h);
+    return NULL;
+}
+
+// Ordre des chaînes dans la table : par fin, puis par début
+static int compare_chaine(const void *a, const void *b){
+    const rainbow_chaine *ca = a;
+    const rainbow_chaine *cb = b;
+    if (ca->fin != cb->fin)
+        return (ca->fin > cb->fin) - (ca->fin < cb->fin);
+    return (ca->debut > cb->debut) - (ca->debut < cb->debut);
+}
+
+/* Génère une table rainbow de nbchaine chaînes sur l'espace donné et l'écrit dans path
+   - les chaînes sont réparties entre nbthreads threads
+   - les chaînes de même fin ont fusionné : une seule est gardée
+*/
+int rainbow_generate(char *path, char *algo_name, const rainbow_espace *espace, uint64_t nbchaine, int nbthreads){
+    if (!EVP_get_digestbyname(algo_name)){
+        printf("rainbow.c : ERREUR > L'algorithme '%s' est inconnu\n", algo_name);
+        return -1;
+    }
+    if (nbchaine == 0 || nbchaine > SIZE_MAX / sizeof(rainbow_chaine)){
+        printf("rainbow.c : ERREUR > Le nombre de chaînes est invalide\n");
+        return -1;
+    }
+    if (nbthreads < 1)
+        nbthreads = 1;
+
+    rainbow_chaine *chaines = malloc(nbchaine * sizeof *chaines);
+    rainbow_generation *travaux = calloc((size_t)nbthreads, sizeof *travaux);
+    if (!chaines || !travaux){
+        printf("rainbow.c : ERREUR > malloc des chaînes (%llu)\n", (unsigned long long)nbchaine);
+        free(chaines);
+        free(travaux);
+        return -1;
+    }
+
+    atomic_uint_least64_t fait = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        travaux[i].espace = espace;
+        travaux[i].algo_name = algo_name;
+        travaux[i].chaines = chaines;
+        travaux[i].debut = nbchaine / (uint64_t)nbthreads * (uint64_t)i;
+        travaux[i].fin = (i == nbthreads - 1) ? nbchaine : nbchaine / (uint64_t)nbthreads * (uint64_t)(i + 1);
+        travaux[i].nbchaine = nbchaine;
+        travaux[i].fait = &fait;
+        travaux[i].afficher = (i == 0);
+    }
+    rainbow_lancer(rainbow_generer, travaux, sizeof *travaux, nbthreads);
+    int retour = 0;
+    for (int i = 0; i < nbthreads; ++i)
+        if (travaux[i].retour != 0)
+            retour = -1;
+    free(travaux);
+    if (retour != 0){
+        free(chaines);
+        return -1;
+    }
+    progress_bar(nbchaine, nbchaine, "( Chaînes )");
+
+    // Tri par fin et suppression des chaînes fusionnées
+    qsort(chaines, nbchaine, sizeof *chaines, compare_chaine);
+    uint64_t nbunique = 0;
+    for (uint64_t i = 0; i < nbchaine; ++i){
+        if (nbunique > 0 && chaines[nbunique - 1].fin == chaines[i].fin)
+            continue;
+        chaines[nbunique++] = chaines[i];
+    }
+
+    rainbow_header header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, RAINBOW_MAGIC, sizeof header.magic);
+    header.version = RAINBOW_VERSION;
+    header.reduction = espace->reduction;
+    snprintf(header.algo, sizeof header.algo, "%s", algo_name);
+    header.longueur_min = espace->longueur_min;
+    header.longueur_max = espace->longueur_max;
+    header.taille_charset = espace->taille_charset;
+    header.indice_table = espace->indice_table;
+    header.longueur_chaine = espace->longueur_chaine;
+    header.nbchaine = nbunique;
+    memcpy(header.charset, espace->charset, espace->taille_charset);
+
+    FILE *fichier = fopen(path, "wb");
+    if (!fichier){
+        printf("rainbow.c : ERREUR > L'ouverture du fichier '%s' à eu un probleme\n", path);
+        free(chaines);
+        return -1;
+    }
+    if (fwrite(&header, sizeof header, 1, fichier) != 1 || fwrite(chaines, sizeof *chaines, nbunique, fichier) != nbunique)
+        retour = -1;
+    if (fclose(fichier) != 0)
+        retour = -1;
+    if (retour != 0){
+        printf("rainbow.c : ERREUR > L'écriture de la table rainbow '%s' à échoué\n", path);
+        unlink(path);
+    }
+    else
+        printf("%llu chaînes gardées sur %llu (%llu fusionnées), %llu mdp dans l'espace des clés, %llu mdp parcourus\n",
+               (unsigned long long)nbunique, (unsigned long long)nbchaine, (unsigned long long)(nbchaine - nbunique),
+               (unsigned long long)espace->taille, (unsigned long long)(nbchaine * espace->longueur_chaine));
+    free(chaines);
+    return retour;
+}
+
+// Table rainbow projetée en mémoire pour la recherche
+typedef struct {
+    void *map;
+    size_t taille_map;
+    const rainbow_header *header;
+    const rainbow_chaine *chaines;
+    rainbow_espace espace;
+    unsigned int digest_taille;
+} rainbow_table;
+
+/* Projette la table rainbow path et vérifie son en-tête */
+static int rainbow_open(char *path, rainbow_table *table){
+    memset(table, 0, sizeof *table);
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(rainbow_header)){
+        printf("rainbow.c : ERREUR > La table rainbow '%s' est illisible ou tronquée\n", path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED){
+        printf("rainbow.c : ERREUR > mmap de la table rainbow '%s' à échoué\n", path);
+        return -1;
+    }
+    table->map = map;
+    table->taille_map = (size_t)st.st_size;
+    table->header = map;
+    table->chaines = (const rainbow_chaine*)((const char*)map + sizeof(rainbow_header));
+
+    const rainbow_header *header = table->header;
+    const EVP_MD *md = NULL;
+    int valide = memcmp(header->magic, RAINBOW_MAGIC, sizeof header->magic) == 0
+              && header->version == RAINBOW_VERSION
+              && memchr(header->algo, '\0', sizeof header->algo) != NULL
+              && (md = EVP_get_digestbyname(header->algo)) != NULL
+              && header->nbchaine == (table->taille_map - sizeof *header) / sizeof(rainbow_chaine)
+              && (table->taille_map - sizeof *header) % sizeof(rainbow_chaine) == 0;
+    if (valide)
+        valide = rainbow_espace_init(&table->espace, header->charset, header->taille_charset, header->longueur_min, header->longueur_max,
+                                     header->reduction, header->indice_table, header->longueur_chaine) == 0;
+    if (!valide){
+        printf("rainbow.c : ERREUR > La table rainbow '%s' est invalide ou d'une version non supportée\n", path);
+        munmap(map, table->taille_map);
+        return -1;
+    }
+    table->digest_taille = (unsigned int)EVP_MD_get_size(md);
+    madvise(map, table->taille_map, MADV_RANDOM);
+    return 0;
+}
+
+// Première chaîne dont la fin est >= fin (recherche dichotomique)
+static uint64_t rainbow_premiere_fin(const rainbow_table *table, uint64_t fin){
+    uint64_t bas = 0;
+    uint64_t haut = table->header->nbchaine;
+    while (bas < haut){
+        uint64_t milieu = bas + (haut - bas) / 2;
+        if (table->chaines[milieu].fin < fin)
+            bas = milieu + 1;
+        else
+            haut = milieu;
+    }
+    return bas;
+}
+
+// Positions premier, premier + pas, ... de la cible testées par un thread de recherche
+typedef struct {
+    const rainbow_table *table;
+    const unsigned char *cible;
+    uint64_t premier;
+    uint64_t pas;
+    atomic_int *trouve;
+    char *mdp;                  // résultat, écrit par le seul thread qui passe trouve à 1
+    int retour;
+} rainbow_recherche;
+
+/* Rejoue la chaîne depuis debut jusqu'à l'étape pos
+   - renvoie 1 et copie le mdp si l'un de ses condensats est la cible (sinon fausse alerte)
+*/
+static int rainbow_rejouer(rainbow_recherche *recherche, hasher *h, uint64_t debut, uint64_t pos){
+    const rainbow_espace *espace = &recherche->table->espace;
+    uint64_t x = debut;
+    for (uint64_t etape = 0; etape <= pos; ++etape){
+        char mdp[RAINBOW_LONGUEUR_MAX];
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        size_t taille = rainbow_mdp(espace, x, mdp);
+        if (hasher_digest(h, mdp, taille, digest) != 0)
+            return -1;
+        if (memcmp(digest, recherche->cible, h->digest_taille) == 0){
+            int attendu = 0;
+            if (atomic_compare_exchange_strong(recherche->trouve, &attendu, 1)){
+                memcpy(recherche->mdp, mdp, taille);
+                recherche->mdp[taille] = '\0';
+            }
+            return 1;
+        }
+        x = rainbow_reduire(espace, digest, etape);
+    }
+    return 0;
+}
+
+/* Pour chaque position pos du thread : fin = R_{t-1}(H(... R_pos(cible)))
+   - toutes les positions du thread avancent ensemble, une étape à la fois, pour hacher par lots
+   - puis les chaînes de même fin sont rejouées
+*/
+static void *rainbow_chercher(void *arg){
+    rainbow_recherche *recherche = arg;
+    const rainbow_table *table = recherche->table;
+    const rainbow_espace *espace = &table->espace;
+    uint64_t t = espace->longueur_chaine;
+    if (recherche->premier >= t)
+        return NULL;
+
+    uint64_t nbpos = (t - recherche->premier + recherche->pas - 1) / recherche->pas;
+    uint64_t *x = malloc(nbpos * sizeof *x);
+    hasher *h = hasher_new(table->header->algo);
+    if (!x || !h){
+        printf("rainbow.c : ERREUR > L'initialisation de la recherche à échoué\n");
+        free(x);
+        hasher_free(h);
+        recherche->retour = -1;
+        return NULL;
+    }
+    for (uint64_t j = 0; j < nbpos; ++j)
+        x[j] = rainbow_reduire(espace, recherche->cible, recherche->premier + j * recherche->pas);
+
+    // À l'étape i, seules les positions pos < i sont en cours : ce sont les premières
+    for (uint64_t i = recherche->premier + 1; i < t && !atomic_load_explicit(recherche->trouve, memory_order_relaxed); ++i){
+        uint64_t actifs = (i - recherche->premier + recherche->pas - 1) / recherche->pas;
+        for (uint64_t a = 0; a < actifs; a += RAINBOW_LOT){
+            size_t n = actifs - a < RAINBOW_LOT ? (size_t)(actifs - a) : RAINBOW_LOT;
+            if (rainbow_avancer(espace, h, x + a, n, i) != 0){
+                recherche->retour = -1;
+                break;
+            }
+        }
+        if (recherche->retour != 0)
+            break;
+    }
+
+    for (uint64_t j = 0; recherche->retour == 0 && j < nbpos && !atomic_load_explicit(recherche->trouve, memory_order_relaxed); ++j){
+        uint64_t pos = recherche->premier + j * recherche->pas;
+        for (uint64_t c = rainbow_premiere_fin(table, x[j]); c < table->header->nbchaine && table->chaines[c].fin == x[j]; ++c){
+            int rejoue = rainbow_rejouer(recherche, h, table->chaines[c].debut, pos);
+            if (rejoue < 0)
+                recherche->retour = -1;
+            if (rejoue != 0)
+                break;
+        }
+    }
+    free(x);
+    hasher_free(h);
+    return NULL;
+}
+
+/* Cherche le mdp d'un condensat hex dans la table sur nbthreads threads
+   - Renvoie 1 et écrit le mdp dans mdp s'il est trouvé, 0 sinon, -1 en cas d'erreur
+*/
+static int rainbow_lookup(const rainbow_table *table, char *hash_hex, int nbthreads, char *mdp){
+    unsigned char cible[EVP_MAX_MD_SIZE];
+    unsigned int taille = 0;
+    if (hex_to_bin(hash_hex, cible, &taille) != 0 || taille != table->digest_taille)
+        return 0;
+    if ((uint64_t)nbthreads > table->espace.longueur_chaine)
+        nbthreads = (int)table->espace.longueur_chaine;
+
+    rainbow_recherche *recherches = calloc((size_t)nbthreads, sizeof *recherches);
+    if (!recherches){
+        printf("rainbow.c : ERREUR > malloc des recherches (%d)\n", nbthreads);
+        return -1;
+    }
+    atomic_int trouve = 0;
+    for (int i = 0; i < nbthreads; ++i){
+        recherches[i].table = table;
+        recherches[i].cible = cible;
+        recherches[i].premier = (uint64_t)i;
+        recherches[i].pas = (uint64_t)nbthreads;
+        recherches[i].trouve = &trouve;
+        recherches[i].mdp = mdp;
+    }
+    rainbow_lancer(rainbow_chercher, recherches, sizeof *recherches, nbthreads);
+    int retour = atomic_load(&trouve);
+    for (int i = 0; i < nbthreads; ++i)
+        if (recherches[i].retour != 0 && !retour)
+            retour = -1;
+    free(recherches);
+    return retour;
+}
+
+static void rainbow_afficher(int trouve, const char *mdp){
+    if (trouve > 0)
+        puts(mdp);
+    else
+        printf("Le hash donnée est introuvable dans la table rainbow\n");
+}
+
+/* Mode recherche sur une table rainbow : -s <hash> ou un condensat par ligne sur stdin */
+int rainbow_mode_lookup(char *path, char *hash_search, int nbthreads){
+    rainbow_table table;
+    if (rainbow_open(path, &table) != 0)
+        return -1;
+    if (nbthreads < 1)
+        nbthreads = 1;
+
+    char mdp[RAINBOW_LONGUEUR_MAX + 1];
+    int retour = 0;
+    if (hash_search && hash_search[0]){
+        int trouve = rainbow_lookup(&table, hash_search, nbthreads, mdp);
+        if (trouve < 0)
+            retour = -1;
+        else
+            rainbow_afficher(trouve, mdp);
+    } else {
+        char *ligne = NULL;
+        size_t taille_buf = 0;
+        ssize_t taille = 0;
+        while ((taille = getline(&ligne, &taille_buf, stdin)) != -1){
+            while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r'))
+                ligne[--taille] = '\0';
+            if (!ligne[0])
+                continue;
+            int trouve = rainbow_lookup(&table, ligne, nbthreads, mdp);
+            if (trouve < 0){
+                retour = -1;
+                break;
+            }
+            rainbow_afficher(trouve, mdp);
+        }
+        free(ligne);
+    }
+    munmap(table.map, table.taille_map);
+    return retour;
+}
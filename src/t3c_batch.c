@@ -0,0 +1,717 @@
+/**
+ * t3c_batch.c - Recherche en lot d'une liste de condensats (-L <table> -f hashes.txt)
+ *  - Décode une seule fois toutes les requêtes en condensats binaires
+ *  - Trie les requêtes par tri radix LSD parallèle sur les 8 premiers octets du condensat,
+ *    les rares égalités de préfixe étant départagées par memcmp
+ *  - Fusionne les requêtes triées avec la colonne triée de la table en une seule passe
+ *    croissante (avance par galop) : la table n'est lue que vers l'avant
+ *  - Écrit hash<TAB>mdp pour les condensats trouvés sur stdout, les absents dans un fichier
+ *    optionnel, dans l'ordre des condensats ou dans l'ordre du fichier (--keep-order)
+ *  - Table multi-algo : une fusion par section, seulement avec les requêtes encore absentes
+ *    de la taille de la section (ou préfixées "algo:" par son nom)
+ *  - Table découpée (t3c_shard.h) : requêtes regroupées par shard, seuls les shards touchés
+ *    sont ouverts, l'un après l'autre dans l'ordre des préfixes
+ *  - Runs de --append (t3c_runs.h) : fusionnés du plus récent au plus ancien avant la table,
+ *    chacun avec les requêtes encore absentes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "t3c_batch.h"
+#include "control_T3C.h"
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "t3c_shard.h"
+#include "t3c_runs.h"
+#include "hash.h"
+#include "t3c_stats.h"
+
+// Travail partagé par les threads d'une passe du tri radix
+typedef struct {
+    const t3c_requete *source;
+    t3c_requete *dest;
+    size_t nbobj;
+    int nbthreads;
+    unsigned int decalage;                      // bits de la clé triés par la passe
+    size_t (*histogrammes)[T3C_BATCH_SEAUX];    // un histogramme par thread, puis ses positions d'écriture
+} radix_passe;
+
+typedef struct {
+    radix_passe *passe;
+    int id;
+    int phase;                                  // 0 = comptage, 1 = répartition
+} radix_travail;
+
+/* Colonne triée d'une section interrogée par la fusion
+   - table binaire : colonne projetée du fichier
+   - table texte : index trié (T3C_INDEX_INTERP) construit au chargement
+*/
+typedef struct {
+    const unsigned char *digests;
+    size_t nbobj;
+    unsigned int digest_taille;
+    const char *algo;
+    size_t section;
+    const t3c_bin *bin;
+    const t3c_index *index;
+} t3c_colonne;
+
+// Contexte transmis à qsort_r pour départager deux requêtes par leur condensat
+typedef struct {
+    const unsigned char *digests;
+    size_t pas;
+    size_t digest_taille;
+} requete_tri;
+
+// Table ouverte par le mode lot : colonnes triées de ses sections
+typedef struct {
+    int binaire;
+    t3c_bin bin;
+    t3c_table tables[T3C_SECTIONS_MAX];
+    t3c_index *index[T3C_SECTIONS_MAX];
+    t3c_colonne colonnes[T3C_SECTIONS_MAX];
+    size_t nbsection;
+} batch_table;
+
+/* Requêtes décodées dans l'ordre du fichier
+   - condensats rangés les uns derrière les autres, pas octets chacun (plus grande section)
+   - masques : bit s si la section s peut contenir la requête, TROUVEE | s une fois trouvée
+   - copies : mdp trouvés dans une colonne compressée avec --keep-order ; t3c_bin_mdp ne les
+     garde que jusqu'au bloc suivant, ils sont recopiés pour l'écriture finale
+*/
+#define TROUVEE 0x80
+typedef struct batch_page {
+    struct batch_page *suivante;
+    size_t taille;
+    size_t capacite;
+    char data[];
+} batch_page;
+
+typedef struct {
+    unsigned char *digests;
+    unsigned char *tailles;
+    unsigned char *masques;
+    size_t pas;
+    size_t nbobj;
+    size_t capacite;
+    size_t nbinvalides;
+    batch_page *copies;
+} t3c_lot;
+
+// Recopie le mdp dans les pages du lot, NULL si l'allocation échoue
+static const char *lot_copier(t3c_lot *lot, const char *mdp){
+    size_t taille = strlen(mdp) + 1;
+    batch_page *page = lot->copies;
+    if (page == NULL || page->capacite - page->taille < taille){
+        size_t capacite = taille > T3C_BATCH_PAGE ? taille : T3C_BATCH_PAGE;
+        page = malloc(sizeof *page + capacite);
+        if (page == NULL){
+            printf("t3c_batch.c : ERREUR > malloc des mdp trouvés (%zu)\n", capacite);
+            return NULL;
+        }
+        page->suivante = lot->copies;
+        page->taille = 0;
+        page->capacite = capacite;
+        lot->copies = page;
+    }
+    char *copie = page->data + page->taille;
+    memcpy(copie, mdp, taille);
+    page->taille += taille;
+    return copie;
+}
+
+/* Comptage ou répartition de la tranche d'un thread
+   - la tranche [debut, fin) est la même aux deux phases : la répartition reste stable
+*/
+static void *radix_trier(void *arg){
+    radix_travail *travail = arg;
+    radix_passe *passe = travail->passe;
+    size_t debut = passe->nbobj * (size_t)travail->id / (size_t)passe->nbthreads;
+    size_t fin = passe->nbobj * (size_t)(travail->id + 1) / (size_t)passe->nbthreads;
+    size_t *histogramme = passe->histogrammes[travail->id];
+
+    if (travail->phase == 0){
+        memset(histogramme, 0, T3C_BATCH_SEAUX * sizeof *histogramme);
+        for (size_t i = debut; i < fin; ++i)
+            histogramme[(passe->source[i].cle >> passe->decalage) & (T3C_BATCH_SEAUX - 1)]++;
+    } else {
+        for (size_t i = debut; i < fin; ++i)
+            passe->dest[histogramme[(passe->source[i].cle >> passe->decalage) & (T3C_BATCH_SEAUX - 1)]++] = passe->source[i];
+    }
+    return NULL;
+}
+
+/* Exécute une phase de la passe sur nb threads : les tranches 1..nb-1 dans des threads,
+   la tranche 0 dans le thread appelant
+*/
+static void radix_lancer(radix_travail *travaux, int nb, int phase){
+    pthread_t threads[nb];
+    int lances[nb];
+    for (int i = 0; i < nb; ++i){
+        travaux[i].phase = phase;
+        lances[i] = i > 0 && pthread_create(&threads[i], NULL, radix_trier, &travaux[i]) == 0;
+    }
+    // Sans thread disponible, la tranche est traitée par le thread appelant
+    for (int i = 0; i < nb; ++i){
+        if (!lances[i])
+            radix_trier(&travaux[i]);
+    }
+    for (int i = 1; i < nb; ++i){
+        if (lances[i])
+            pthread_join(threads[i], NULL);
+    }
+}
+
+/* Tri radix LSD parallèle des requêtes sur leur clé 64 bits, stable
+   - une passe par octet de la clé : comptage par thread, positions, répartition par thread
+   - une passe dont toutes les clés tombent dans le même seau est sautée
+   - renvoie le tableau trié (requetes ou tampon), NULL si une allocation échoue
+*/
+t3c_requete *t3c_radix_sort(t3c_requete *requetes, t3c_requete *tampon, size_t nbobj, int nbthreads){
+    int nb = nbthreads < 1 ? 1 : nbthreads;
+    if ((size_t)nb > nbobj / T3C_BATCH_MIN_TRI)
+        nb = nbobj / T3C_BATCH_MIN_TRI > 1 ? (int)(nbobj / T3C_BATCH_MIN_TRI) : 1;
+
+    size_t (*histogrammes)[T3C_BATCH_SEAUX] = malloc((size_t)nb * sizeof *histogrammes);
+    radix_travail *travaux = malloc((size_t)nb * sizeof *travaux);
+    if (histogrammes == NULL || travaux == NULL){
+        printf("t3c_batch.c : ERREUR > malloc du tri radix (%d threads)\n", nb);
+        free(histogrammes);
+        free(travaux);
+        return NULL;
+    }
+
+    radix_passe passe = { requetes, tampon, nbobj, nb, 0, histogrammes };
+    for (int i = 0; i < nb; ++i){
+        travaux[i].passe = &passe;
+        travaux[i].id = i;
+    }
+
+    for (unsigned int decalage = 0; decalage < 64; decalage += T3C_BATCH_BITS){
+        passe.decalage = decalage;
+        radix_lancer(travaux, nb, 0);
+
+        // Position d'écriture de chaque thread dans chaque seau : seaux croissants, puis threads
+        size_t position = 0;
+        int inutile = 0;
+        for (unsigned int s = 0; s < T3C_BATCH_SEAUX; ++s){
+            size_t debut_seau = position;
+            for (int t = 0; t < nb; ++t){
+                size_t compte = histogrammes[t][s];
+                histogrammes[t][s] = position;
+                position += compte;
+            }
+            if (position - debut_seau == nbobj)
+                inutile = 1;
+        }
+        if (inutile)
+            continue;
+
+        radix_lancer(travaux, nb, 1);
+        const t3c_requete *trie = passe.dest;
+        passe.dest = (t3c_requete*)passe.source;
+        passe.source = trie;
+    }
+
+    free(histogrammes);
+    free(travaux);
+    return (t3c_requete*)passe.source;
+}
+
+// Compare deux requêtes de même clé 64 bits par condensat complet, puis par rang
+static int compare_requete(const void *a, const void *b, void *arg){
+    const requete_tri *tri = arg;
+    const t3c_requete *ra = a;
+    const t3c_requete *rb = b;
+    int comp = memcmp(tri->digests + ra->rang * tri->pas, tri->digests + rb->rang * tri->pas, tri->digest_taille);
+    if (comp != 0)
+        return comp;
+    return (ra->rang > rb->rang) - (ra->rang < rb->rang);
+}
+
+/* Départage les requêtes de même préfixe 64 bits (condensats égaux ou rares collisions de préfixe)
+   - les suites de clés égales sont courtes : qsort_r sur chacune
+*/
+static void t3c_departager(t3c_requete *trie, size_t nbobj, const unsigned char *digests, size_t pas, unsigned int digest_taille){
+    requete_tri contexte = { digests, pas, digest_taille };
+    for (size_t i = 0; i < nbobj; ){
+        size_t j = i + 1;
+        while (j < nbobj && trie[j].cle == trie[i].cle)
+            j++;
+        if (j - i > 1)
+            qsort_r(trie + i, j - i, sizeof *trie, compare_requete, &contexte);
+        i = j;
+    }
+}
+
+/* Lit le fichier de requêtes : un condensat "[algo:]hex" par ligne, lignes vides ignorées
+   - chaque condensat valide est décodé une fois et rangé avec les sections qui peuvent le contenir
+   - une ligne invalide (hex incorrect, ou aucune section de cette taille ou de cet algo) est
+     écrite telle quelle dans le fichier des absents et comptée
+*/
+static int t3c_lot_lire(char *hash_path, const t3c_colonne *colonnes, size_t nbsection, FILE *absents, t3c_lot *lot){
+    FILE *fichier = fopen(hash_path, "r");
+    if (fichier == NULL){
+        printf("t3c_batch.c : ERREUR > Impossible d'ouvrir le fichier de condensats '%s'\n", hash_path);
+        return -1;
+    }
+    for (size_t s = 0; s < nbsection; ++s){
+        if (colonnes[s].digest_taille > lot->pas)
+            lot->pas = colonnes[s].digest_taille;
+    }
+
+    char *ligne = NULL;
+    size_t taille_buf = 0;
+    ssize_t taille = 0;
+    int retour = 0;
+    while ((taille = getline(&ligne, &taille_buf, fichier)) != -1){
+        while (taille > 0 && (ligne[taille - 1] == '\n' || ligne[taille - 1] == '\r'))
+            ligne[--taille] = '\0';
+        if (!ligne[0])
+            continue;
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int taille_digest = 0;
+        char *algo = NULL;
+        unsigned char masque = 0;
+        if (t3c_requete_decoder(ligne, &algo, digest, &taille_digest) == 0){
+            for (size_t s = 0; s < nbsection; ++s){
+                if (taille_digest == colonnes[s].digest_taille && (algo == NULL || strcmp(algo, colonnes[s].algo) == 0))
+                    masque |= (unsigned char)(1u << s);
+            }
+        }
+        if (masque == 0){
+            if (algo)
+                algo[strlen(algo)] = ':';
+            lot->nbinvalides++;
+            if (absents)
+                fprintf(absents, "%s\n", ligne);
+            continue;
+        }
+
+        if (lot->nbobj == lot->capacite){
+            size_t capacite = lot->capacite ? lot->capacite * 2 : 4096;
+            unsigned char *digests = realloc(lot->digests, capacite * lot->pas);
+            if (digests)
+                lot->digests = digests;
+            unsigned char *tailles = digests ? realloc(lot->tailles, capacite) : NULL;
+            if (tailles)
+                lot->tailles = tailles;
+            unsigned char *masques = tailles ? realloc(lot->masques, capacite) : NULL;
+            if (masques == NULL){
+                printf("t3c_batch.c : ERREUR > realloc des requêtes (%zu)\n", capacite);
+                retour = -1;
+                break;
+            }
+            lot->masques = masques;
+            lot->capacite = capacite;
+        }
+        memcpy(lot->digests + lot->nbobj * lot->pas, digest, taille_digest);
+        lot->tailles[lot->nbobj] = (unsigned char)taille_digest;
+        lot->masques[lot->nbobj] = masque;
+        lot->nbobj++;
+    }
+
+    free(ligne);
+    fclose(fichier);
+    return retour;
+}
+
+// Mdp de la ligne pos de la colonne triée
+static const char *colonne_mdp(const t3c_colonne *colonne, size_t pos){
+    if (colonne->bin)
+        return t3c_bin_mdp(colonne->bin, colonne->section, pos);
+    return t3c_mdp(colonne->index->table, colonne->index->ids[pos]);
+}
+
+/* Première ligne de la colonne >= digest, en partant de pos (colonne[pos - 1] < digest)
+   - avance par galop (pas doublés) puis dichotomie dans le dernier pas :
+     des requêtes proches coûtent quelques comparaisons, la colonne n'est lue que vers l'avant
+*/
+static size_t colonne_avancer(const t3c_colonne *colonne, size_t pos, const unsigned char *digest){
+    size_t dt = colonne->digest_taille;
+    if (pos >= colonne->nbobj || memcmp(colonne->digests + pos * dt, digest, dt) >= 0)
+        return pos;
+
+    size_t bas = pos, pas = 1;     // colonne[bas] < digest
+    while (bas + pas < colonne->nbobj && memcmp(colonne->digests + (bas + pas) * dt, digest, dt) < 0){
+        bas += pas;
+        pas <<= 1;
+    }
+    size_t haut = bas + pas < colonne->nbobj ? bas + pas : colonne->nbobj;   // colonne[haut] >= digest ou fin
+    while (haut - bas > 1){
+        size_t milieu = bas + (haut - bas) / 2;
+        if (memcmp(colonne->digests + milieu * dt, digest, dt) < 0)
+            bas = milieu;
+        else
+            haut = milieu;
+    }
+    return haut;
+}
+
+/* Écrit une requête trouvée (hash<TAB>mdp) ou absente (hash) dans sa sortie
+   - algo non NULL : le condensat trouvé est préfixé par le nom de sa section
+*/
+static void t3c_batch_ecrire(const char *algo, const unsigned char *digest, unsigned int digest_taille, const char *mdp, FILE *absents){
+    char hex[EVP_MAX_MD_SIZE * 2 + 1];
+    if (mdp == NULL && absents == NULL)
+        return;
+    bin_to_hex((unsigned char*)digest, digest_taille, hex);
+    if (mdp && algo)
+        printf("%s:%s\t%s\n", algo, hex, mdp);
+    else if (mdp)
+        printf("%s\t%s\n", hex, mdp);
+    else
+        fprintf(absents, "%s\n", hex);
+}
+
+/* Trie les requêtes de chaque section puis les fusionne avec sa colonne
+   - seules les requêtes des rangs donnés sont traitées (toutes si rangs == NULL)
+   - une section ne reçoit que les requêtes encore absentes qui peuvent y être
+   - sans resultats : trouvés écrits pendant la fusion, dans l'ordre des condensats ; un absent
+     est écrit dès qu'aucune section suivante ne peut plus le contenir, dans la dernière table
+     interrogée (derniere, les runs passent avant la table)
+   - avec resultats (keep_order) : mdp rangés par rang, écrits ensuite dans l'ordre du fichier
+     (recopiés si la colonne est compressée)
+*/
+static int t3c_batch_fusion(const t3c_colonne *colonnes, size_t nbsection, t3c_lot *lot, const size_t *rangs, size_t nbrang, FILE *absents, const char **resultats, int derniere, int nbthreads, size_t *nbtrouves){
+    size_t capacite = nbrang ? nbrang : 1;
+    t3c_requete *requetes = malloc(capacite * sizeof *requetes);
+    t3c_requete *tampon = malloc(capacite * sizeof *tampon);
+    if (requetes == NULL || tampon == NULL){
+        printf("t3c_batch.c : ERREUR > malloc du tri des requêtes (%zu)\n", nbrang);
+        free(requetes);
+        free(tampon);
+        return -1;
+    }
+
+    int retour = 0;
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        const t3c_colonne *colonne = &colonnes[s];
+        unsigned int dt = colonne->digest_taille;
+        const char *algo = nbsection > 1 ? colonne->algo : NULL;
+        int compressee = colonne->bin && t3c_bin_mdp_bloc(colonne->bin, colonne->section);
+        unsigned char suivantes = (unsigned char)~((2u << s) - 1);
+
+        size_t nbobj = 0;
+        for (size_t i = 0; i < nbrang; ++i){
+            size_t rang = rangs ? rangs[i] : i;
+            if ((lot->masques[rang] & TROUVEE) == 0 && (lot->masques[rang] & (1u << s))){
+                requetes[nbobj].cle = t3c_cle64(lot->digests + rang * lot->pas, dt);
+                requetes[nbobj].rang = rang;
+                nbobj++;
+            }
+        }
+        if (nbobj == 0)
+            continue;
+
+        t3c_requete *trie = t3c_radix_sort(requetes, tampon, nbobj, nbthreads);
+        if (trie == NULL){
+            retour = -1;
+            break;
+        }
+        t3c_departager(trie, nbobj, lot->digests, lot->pas, dt);
+
+        size_t pos = 0;
+        for (size_t i = 0; retour == 0 && i < nbobj; ++i){
+            size_t rang = trie[i].rang;
+            const unsigned char *digest = lot->digests + rang * lot->pas;
+            pos = colonne_avancer(colonne, pos, digest);
+            const char *mdp = NULL;
+            if (pos < colonne->nbobj && memcmp(colonne->digests + pos * dt, digest, dt) == 0)
+                mdp = colonne_mdp(colonne, pos);
+            if (mdp){
+                (*nbtrouves)++;
+                lot->masques[rang] = (unsigned char)(TROUVEE | s);
+            }
+            if (resultats && mdp && compressee && (mdp = lot_copier(lot, mdp)) == NULL)
+                retour = -1;
+            if (resultats)
+                resultats[rang] = mdp;
+            else if (mdp || (derniere && (lot->masques[rang] & suivantes) == 0))
+                t3c_batch_ecrire(algo, digest, dt, mdp, absents);
+        }
+    }
+
+    free(requetes);
+    free(tampon);
+    return retour;
+}
+
+/* Ouvre une table pour le mode lot
+   - binaire : projetée, les colonnes triées de ses sections sont lues directement
+   - texte : chargée puis chaque section indexée en tableau trié (T3C_INDEX_INTERP)
+*/
+static int batch_ouvrir(char *t3c_path, batch_table *table){
+    memset(table, 0, sizeof *table);
+    table->binaire = t3c_bin_is(t3c_path);
+
+    if (table->binaire){
+        if (t3c_bin_open(t3c_path, &table->bin) != 0){
+            printf("t3c_batch.c : ERREUR > La fonction t3c_bin_open a échoué\n");
+            return -1;
+        }
+        table->nbsection = table->bin.header->nbsection;
+        for (size_t s = 0; s < table->nbsection; ++s){
+            const t3c_bin_section *section = &table->bin.sections[s];
+            t3c_colonne *colonne = &table->colonnes[s];
+            colonne->digests = (const unsigned char*)table->bin.map + section->off_digests;
+            colonne->nbobj = section->nbobj;
+            colonne->digest_taille = section->digest_taille;
+            colonne->algo = section->algo;
+            colonne->section = s;
+            colonne->bin = &table->bin;
+        }
+        madvise(table->bin.map, table->bin.taille_map, MADV_SEQUENTIAL);
+        return 0;
+    }
+
+    if (t3c_load(t3c_path, table->tables, &table->nbsection) != 0){
+        printf("t3c_batch.c : ERREUR > La fonction t3c_load a échoué\n");
+        return -1;
+    }
+    for (size_t s = 0; s < table->nbsection; ++s){
+        table->index[s] = t3c_index_build(&table->tables[s], T3C_INDEX_INTERP);
+        if (table->index[s] == NULL){
+            printf("t3c_batch.c : ERREUR > La fonction t3c_index_build a échoué\n");
+            return -1;
+        }
+        t3c_colonne *colonne = &table->colonnes[s];
+        colonne->digests = table->index[s]->digests;
+        colonne->nbobj = table->index[s]->nbobj;
+        colonne->digest_taille = table->tables[s].digest_taille;
+        colonne->algo = table->tables[s].algo;
+        colonne->section = s;
+        colonne->index = table->index[s];
+        // La fusion lit la copie triée de l'index : la colonne d'origine n'est plus lue
+        free(table->tables[s].digests);
+        table->tables[s].digests = NULL;
+    }
+    return 0;
+}
+
+// Libère la projection ou les sections et leurs index
+static void batch_fermer(batch_table *table){
+    if (table->binaire){
+        t3c_bin_close(&table->bin);
+        return;
+    }
+    for (size_t s = 0; s < T3C_SECTIONS_MAX; ++s){
+        t3c_index_free(table->index[s]);
+        t3c_free(&table->tables[s]);
+    }
+}
+
+// Vérifie que la table a les sections attendues (runs, shards), dans le même ordre
+static int batch_sections(const batch_table *table, const t3c_colonne *colonnes, size_t nbsection, const char *t3c_path){
+    int identique = table->nbsection == nbsection;
+    for (size_t s = 0; identique && s < nbsection; ++s){
+        const char *algo = colonnes[s].algo[0] ? colonnes[s].algo : "sha256";   // anciennes tables sans en-tête
+        identique = strcmp(table->colonnes[s].algo, algo) == 0;
+    }
+    if (!identique)
+        printf("t3c_batch.c : ERREUR > Les sections de '%s' ne correspondent pas à celles de la table\n", t3c_path);
+    return identique ? 0 : -1;
+}
+
+/* Recherche en lot dans une table découpée
+   - les rangs des requêtes sont regroupés par shard (tri par comptage sur le préfixe)
+   - chaque shard touché est ouvert, fusionné avec ses requêtes puis refermé, dans l'ordre des
+     préfixes : la sortie garde l'ordre croissant des condensats
+   - avec resultats (keep_order) les shards restent ouverts jusqu'à l'écriture finale
+   - un shard vide est fusionné avec des colonnes vides (toutes ses requêtes sont absentes)
+*/
+static int batch_shards(const t3c_manifeste *manifeste, char *t3c_path, const t3c_colonne *vides, t3c_lot *lot, FILE *absents, const char **resultats, batch_table **ouvertes, int nbthreads, size_t *nbtrouves){
+    size_t debuts[T3C_SHARD_MAX + 1] = {0};
+    size_t *rangs = malloc((lot->nbobj ? lot->nbobj : 1) * sizeof *rangs);
+    if (rangs == NULL){
+        printf("t3c_batch.c : ERREUR > malloc des rangs (%zu)\n", lot->nbobj);
+        return -1;
+    }
+    for (size_t rang = 0; rang < lot->nbobj; ++rang)
+        debuts[t3c_shard_de(manifeste, lot->digests + rang * lot->pas) + 1]++;
+    for (unsigned int shard = 0; shard < T3C_SHARD_MAX; ++shard)
+        debuts[shard + 1] += debuts[shard];
+    size_t positions[T3C_SHARD_MAX];
+    memcpy(positions, debuts, sizeof positions);
+    for (size_t rang = 0; rang < lot->nbobj; ++rang)
+        rangs[positions[t3c_shard_de(manifeste, lot->digests + rang * lot->pas)]++] = rang;
+
+    int retour = 0;
+    for (unsigned int shard = 0; retour == 0 && shard < t3c_shard_nb(manifeste); ++shard){
+        size_t nbrang = debuts[shard + 1] - debuts[shard];
+        if (nbrang == 0)
+            continue;
+        const t3c_colonne *colonnes = vides;
+        batch_table *table = NULL;
+        char chemin[4096];
+        if (manifeste->nbobj[shard] > 0){
+            table = malloc(sizeof *table);
+            if (table == NULL || t3c_shard_chemin(t3c_path, shard, chemin, sizeof chemin) != 0 || batch_ouvrir(chemin, table) != 0){
+                printf("t3c_batch.c : ERREUR > Le shard %02x de '%s' ne peut pas être ouvert\n", shard, t3c_path);
+                if (table)
+                    batch_fermer(table);
+                free(table);
+                retour = -1;
+                break;
+            }
+            retour = batch_sections(table, vides, manifeste->nbsection, chemin);
+            colonnes = table->colonnes;
+        }
+        if (retour == 0)
+            retour = t3c_batch_fusion(colonnes, manifeste->nbsection, lot, rangs + debuts[shard], nbrang, absents, resultats, 1, nbthreads, nbtrouves);
+        if (table && resultats && retour == 0){
+            ouvertes[shard] = table;
+        } else if (table){
+            batch_fermer(table);
+            free(table);
+        }
+    }
+    free(rangs);
+    return retour;
+}
+
+/* Mode -L -f :
+   - Une table binaire est projetée et les colonnes triées de ses sections sont lues directement
+   - Une table texte est chargée puis chaque section est indexée en tableau trié (T3C_INDEX_INTERP)
+   - Une table découpée n'ouvre que les shards touchés par les requêtes
+   - Les runs de --append sont fusionnés avant la table, du plus récent au plus ancien
+   - Les requêtes sont décodées, triées et fusionnées avec chaque colonne en une passe
+   - Les trouvés vont sur stdout, les absents dans miss_path si donné, le bilan sur stderr
+*/
+int t3c_mode_batch(char *t3c_path, char *hash_path, char *miss_path, int keep_order, int nbthreads){
+    batch_table table;
+    batch_table *runs = NULL;
+    unsigned int nbrun = 0;
+    t3c_manifeste *manifeste = NULL;
+    t3c_colonne vides[T3C_SECTIONS_MAX];
+    const t3c_colonne *colonnes = table.colonnes;
+    size_t nbsection = 0;
+    int retour = 0;
+    memset(vides, 0, sizeof vides);
+    memset(&table, 0, sizeof table);
+
+    if (t3c_shard_is(t3c_path)){
+        // Colonnes vides aux tailles et algos du manifeste : routage des requêtes et shards vides
+        manifeste = malloc(sizeof *manifeste);
+        if (manifeste == NULL || t3c_manifeste_lire(t3c_path, manifeste) != 0){
+            free(manifeste);
+            return -1;
+        }
+        nbsection = manifeste->nbsection;
+        for (size_t s = 0; s < nbsection; ++s){
+            vides[s].digest_taille = (unsigned int)EVP_MD_get_size(EVP_get_digestbyname(manifeste->algos[s]));
+            vides[s].algo = manifeste->algos[s];
+            vides[s].section = s;
+        }
+        colonnes = vides;
+    } else {
+        if (batch_ouvrir(t3c_path, &table) != 0){
+            batch_fermer(&table);
+            return -1;
+        }
+        nbsection = table.nbsection;
+
+        // Runs : mêmes sections que la table, sinon le routage des requêtes ne s'applique pas
+        unsigned int nbrun_max = t3c_runs_nb(t3c_path);
+        runs = nbrun_max ? calloc(nbrun_max, sizeof *runs) : NULL;
+        if (nbrun_max && runs == NULL){
+            printf("t3c_batch.c : ERREUR > calloc des runs (%u)\n", nbrun_max);
+            retour = -1;
+        }
+        for (unsigned int run = 0; retour == 0 && run < nbrun_max; ++run){
+            char chemin[4096];
+            if (t3c_run_chemin(t3c_path, run + 1, chemin, sizeof chemin) != 0 || batch_ouvrir(chemin, &runs[run]) != 0){
+                batch_fermer(&runs[run]);
+                retour = -1;
+                break;
+            }
+            nbrun++;
+            retour = batch_sections(&runs[run], table.colonnes, nbsection, chemin);
+        }
+    }
+
+    FILE *absents = NULL;
+    if (miss_path){
+        absents = fopen(miss_path, "w");
+        if (absents == NULL){
+            printf("t3c_batch.c : ERREUR > Impossible de créer le fichier des absents '%s'\n", miss_path);
+            retour = -1;
+        } else {
+            setvbuf(absents, NULL, _IOFBF, T3C_BATCH_TAMPON);
+        }
+    }
+
+    t3c_lot lot = {0};
+    size_t nbtrouves = 0;
+    const char **resultats = NULL;
+    batch_table **ouvertes = NULL;
+    uint64_t debut = t3c_stats_debut();
+    if (retour == 0 && t3c_lot_lire(hash_path, colonnes, nbsection, absents, &lot) != 0)
+        retour = -1;
+    if (retour == 0 && keep_order){
+        resultats = calloc(lot.nbobj ? lot.nbobj : 1, sizeof *resultats);
+        ouvertes = manifeste ? calloc(T3C_SHARD_MAX, sizeof *ouvertes) : NULL;
+        if (resultats == NULL || (manifeste && ouvertes == NULL)){
+            printf("t3c_batch.c : ERREUR > malloc des résultats (%zu)\n", lot.nbobj);
+            retour = -1;
+        }
+    }
+    if (retour == 0){
+        setvbuf(stdout, NULL, _IOFBF, T3C_BATCH_TAMPON);
+        if (manifeste)
+            retour = batch_shards(manifeste, t3c_path, vides, &lot, absents, resultats, ouvertes, nbthreads, &nbtrouves);
+        for (unsigned int run = nbrun; !manifeste && retour == 0 && run-- > 0; )
+            retour = t3c_batch_fusion(runs[run].colonnes, nbsection, &lot, NULL, lot.nbobj, absents, resultats, 0, nbthreads, &nbtrouves);
+        if (!manifeste && retour == 0)
+            retour = t3c_batch_fusion(colonnes, nbsection, &lot, NULL, lot.nbobj, absents, resultats, 1, nbthreads, &nbtrouves);
+    }
+    if (retour == 0 && keep_order){
+        for (size_t rang = 0; rang < lot.nbobj; ++rang){
+            const char *algo = nbsection > 1 && resultats[rang] ? colonnes[lot.masques[rang] & ~TROUVEE].algo : NULL;
+            t3c_batch_ecrire(algo, lot.digests + rang * lot.pas, lot.tailles[rang], resultats[rang], absents);
+        }
+    }
+    fflush(stdout);
+    if (absents && fclose(absents) != 0 && retour == 0){
+        printf("t3c_batch.c : ERREUR > Écriture du fichier des absents '%s'\n", miss_path);
+        retour = -1;
+    }
+    if (retour == 0){
+        fprintf(stderr, "%zu condensats trouvés sur %zu (%zu lignes invalides)\n", nbtrouves, lot.nbobj + lot.nbinvalides, lot.nbinvalides);
+        // --stats : lecture, tri et fusion du lot en une mesure, sans latence par requête
+        t3c_stats_phase(T3C_STATS_RECHERCHE, debut);
+        t3c_stats_compter(T3C_STATS_TROUVES, nbtrouves);
+        t3c_stats_compter(T3C_STATS_ABSENTS, lot.nbobj - nbtrouves);
+    }
+
+    free(resultats);
+    while (lot.copies){
+        batch_page *page = lot.copies;
+        lot.copies = page->suivante;
+        free(page);
+    }
+    free(lot.digests);
+    free(lot.tailles);
+    free(lot.masques);
+    if (ouvertes){
+        for (unsigned int shard = 0; shard < T3C_SHARD_MAX; ++shard){
+            if (ouvertes[shard])
+                batch_fermer(ouvertes[shard]);
+            free(ouvertes[shard]);
+        }
+        free(ouvertes);
+    }
+    for (unsigned int run = 0; run < nbrun; ++run)
+        batch_fermer(&runs[run]);
+    free(runs);
+    if (manifeste)
+        free(manifeste);
+    else
+        batch_fermer(&table);
+    return retour;
+}
@@ -0,0 +1,911 @@
+/**
+ * t3c_bin.c - Format T3C binaire projeté en mémoire
+ *  - Écrit une table triée par condensat binaire : en-tête, puis par section (une par algo)
+ *    colonne de condensats de largeur fixe, tableau d'offsets et blob des mdp
+ *  - Ouvre la table avec mmap et répond aux recherches directement depuis les pages
+ *    projetées, sans analyse du fichier ni allocation par entrée
+ *  - Reconvertit une table binaire en t3c_table pour l'export texte
+ *  - Écrit en flux une table déjà triée (fusion du tri externe) sans la garder en mémoire
+ *  - --compress : mdp compressés par blocs de taille fixe (deflate brut, dictionnaire préchargé),
+ *    un index creux donne le bloc de chaque ligne ; une recherche ne décompresse que le bloc
+ *    du mdp trouvé
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "hash.h"
+#include "t3c_stats.h"
+
+#define T3C_BIN_ALIGN 64
+#define T3C_BIN_TAMPON (4u << 20)   // tampons des écritures et recopies séquentielles
+#define T3C_BIN_NIVEAU 9            // niveau du deflate : la table est écrite une fois, lue souvent
+#define T3C_BIN_AUCUN  UINT64_MAX   // cache sans bloc décompressé
+
+static unsigned int bin_mdp_bloc = 0;       // 0 = mdp non compressés, sinon mdp par bloc des tables écrites
+
+/* Compresseur des mdp d'une section
+   - les mdp s'accumulent dans attente, puis chaque groupe de mdp_bloc mdp est compressé en un
+     bloc (deflate brut) dans le fichier temporaire blob, son offset dans le fichier index
+   - dictionnaire : les T3C_BIN_DICO premiers octets de mdp de la section ; rangés par condensat,
+     ce sont des mdp pris au hasard, qui ressemblent à ceux des autres blocs
+   - les blocs attendent que le dictionnaire soit complet avant d'être compressés
+*/
+struct t3c_bin_zip {
+    z_stream z;
+    t3c_bin_blocs entete;
+    unsigned char dico[T3C_BIN_DICO];
+    int dico_pret;
+    t3c_blob attente;
+    size_t nbattente;           // mdp dans attente
+    unsigned char *sortie;
+    size_t capacite_sortie;
+    FILE *index;
+    FILE *blob;
+    uint64_t taille_blob;
+};
+
+/* Dernier bloc décompressé d'une table ouverte
+   - debuts : début de chaque mdp du bloc dans data
+   - le mdp renvoyé par t3c_bin_mdp reste valide jusqu'à l'appel suivant sur la même table
+*/
+struct t3c_bin_cache {
+    z_stream z;
+    size_t section;
+    uint64_t bloc;
+    char *data;
+    uint32_t *debuts;
+};
+
+static uint64_t aligne(uint64_t pos){
+    return (pos + T3C_BIN_ALIGN - 1) & ~(uint64_t)(T3C_BIN_ALIGN - 1);
+}
+
+// Complète le fichier avec des zéros jusqu'à la position cible
+static int ecrire_padding(FILE *fichier, uint64_t *pos, uint64_t cible){
+    static const unsigned char zero[T3C_BIN_ALIGN] = {0};
+    while (*pos < cible){
+        size_t taille = (size_t)(cible - *pos);
+        if (taille > sizeof zero)
+            taille = sizeof zero;
+        if (fwrite(zero, 1, taille, fichier) != taille)
+            return -1;
+        *pos += taille;
+    }
+    return 0;
+}
+
+// Renvoie 1 si le fichier commence par la signature T3C binaire, 0 sinon
+int t3c_bin_is(char *path){
+    char magic[8];
+    FILE *fichier = fopen(path, "rb");
+    if (!fichier)
+        return 0;
+    size_t lu = fread(magic, 1, sizeof magic, fichier);
+    fclose(fichier);
+    return lu == sizeof magic && memcmp(magic, T3C_BIN_MAGIC, sizeof magic) == 0;
+}
+
+/* Active la compression des mdp des tables binaires écrites ensuite (t3c_bin_write, t3c_bin_flux)
+   - mdp_bloc : mdp par bloc (T3C_BIN_BLOC_MIN à T3C_BIN_BLOC_MAX), 0 = mdp non compressés
+*/
+void t3c_bin_compression(unsigned int mdp_bloc){
+    bin_mdp_bloc = mdp_bloc;
+}
+
+// Libère le compresseur et ferme ses fichiers temporaires
+static void zip_liberer(t3c_bin_zip *zip){
+    if (!zip)
+        return;
+    deflateEnd(&zip->z);
+    t3c_blob_free(&zip->attente);
+    free(zip->sortie);
+    if (zip->index)
+        fclose(zip->index);
+    if (zip->blob)
+        fclose(zip->blob);
+    free(zip);
+}
+
+// Ouvre un compresseur de blocs de mdp_bloc mdp, ses fichiers temporaires dans dossier
+static t3c_bin_zip *zip_ouvrir(const char *dossier, unsigned int mdp_bloc){
+    t3c_bin_zip *zip = calloc(1, sizeof *zip);
+    if (!zip){
+        printf("t3c_bin.c : ERREUR > calloc du compresseur des mdp\n");
+        return NULL;
+    }
+    zip->entete.mdp_bloc = mdp_bloc;
+    if (deflateInit2(&zip->z, T3C_BIN_NIVEAU, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK){
+        printf("t3c_bin.c : ERREUR > L'initialisation du deflate à échoué\n");
+        free(zip);
+        return NULL;
+    }
+    zip->index = t3c_fichier_temp(dossier);
+    zip->blob = zip->index ? t3c_fichier_temp(dossier) : NULL;
+    if (!zip->blob){
+        zip_liberer(zip);
+        return NULL;
+    }
+    setvbuf(zip->index, NULL, _IOFBF, 1 << 16);
+    setvbuf(zip->blob, NULL, _IOFBF, T3C_BIN_TAMPON);
+    return zip;
+}
+
+// Compresse un bloc de taille octets (mdp terminés par '\0') et range son offset dans l'index
+static int zip_bloc(t3c_bin_zip *zip, const char *data, size_t taille){
+    if (taille > UINT32_MAX){
+        printf("t3c_bin.c : ERREUR > Bloc de mdp trop grand (%zu octets), réduire --compress\n", taille);
+        return -1;
+    }
+    size_t borne = deflateBound(&zip->z, (uLong)taille);
+    if (borne > zip->capacite_sortie){
+        unsigned char *sortie = realloc(zip->sortie, borne);
+        if (!sortie){
+            printf("t3c_bin.c : ERREUR > realloc du bloc compressé (%zu)\n", borne);
+            return -1;
+        }
+        zip->sortie = sortie;
+        zip->capacite_sortie = borne;
+    }
+    if (deflateReset(&zip->z) != Z_OK
+     || (zip->entete.taille_dico && deflateSetDictionary(&zip->z, zip->dico, zip->entete.taille_dico) != Z_OK))
+        return -1;
+    zip->z.next_in = (Bytef*)data;
+    zip->z.avail_in = (uInt)taille;
+    zip->z.next_out = zip->sortie;
+    zip->z.avail_out = (uInt)borne;
+    if (deflate(&zip->z, Z_FINISH) != Z_STREAM_END)
+        return -1;
+
+    size_t taille_z = borne - zip->z.avail_out;
+    if (fwrite(&zip->taille_blob, sizeof zip->taille_blob, 1, zip->index) != 1
+     || fwrite(zip->sortie, 1, taille_z, zip->blob) != taille_z)
+        return -1;
+    zip->taille_blob += taille_z;
+    zip->entete.nbbloc++;
+    if (taille > zip->entete.bloc_max)
+        zip->entete.bloc_max = taille;
+    return 0;
+}
+
+/* Compresse les blocs complets de attente, et le dernier bloc incomplet si fin
+   - les mdp restants sont ramenés au début de attente
+*/
+static int zip_vider(t3c_bin_zip *zip, int fin){
+    const char *data = zip->attente.data;
+    size_t taille = zip->attente.taille;
+    size_t debut = 0, pos = 0, nb = 0;
+    while (pos < taille){
+        pos += strlen(data + pos) + 1;
+        if (++nb == zip->entete.mdp_bloc){
+            if (zip_bloc(zip, data + debut, pos - debut) != 0)
+                return -1;
+            debut = pos;
+            nb = 0;
+        }
+    }
+    if (fin && debut < taille){
+        if (zip_bloc(zip, data + debut, taille - debut) != 0)
+            return -1;
+        debut = taille;
+        nb = 0;
+    }
+    memmove(zip->attente.data, data + debut, taille - debut);
+    zip->attente.taille = taille - debut;
+    zip->nbattente = nb;
+    return 0;
+}
+
+// Fige le dictionnaire : les premiers octets de mdp de la section
+static void zip_dico(t3c_bin_zip *zip){
+    size_t taille = zip->attente.taille < T3C_BIN_DICO ? zip->attente.taille : T3C_BIN_DICO;
+    if (taille)
+        memcpy(zip->dico, zip->attente.data, taille);
+    zip->entete.taille_dico = (uint32_t)taille;
+    zip->dico_pret = 1;
+}
+
+// Ajoute le mdp de la ligne suivante (tronqué à son premier '\0', comme à la lecture)
+static int zip_ajouter(t3c_bin_zip *zip, const char *mdp, size_t taille_mdp){
+    uint64_t offset = 0;
+    taille_mdp = strnlen(mdp, taille_mdp);
+    if (t3c_blob_ajouter(&zip->attente, mdp, taille_mdp, &offset) != 0)
+        return -1;
+    zip->entete.taille_mdp += taille_mdp + 1;
+    zip->nbattente++;
+    if (!zip->dico_pret && zip->attente.taille >= T3C_BIN_DICO)
+        zip_dico(zip);
+    if (zip->dico_pret && zip->nbattente >= zip->entete.mdp_bloc)
+        return zip_vider(zip, 0);
+    return 0;
+}
+
+// Compresse les derniers mdp et termine l'index (dernier offset : taille du blob compressé)
+static int zip_fermer(t3c_bin_zip *zip){
+    if (!zip->dico_pret)
+        zip_dico(zip);
+    if (zip_vider(zip, 1) != 0
+     || fwrite(&zip->taille_blob, sizeof zip->taille_blob, 1, zip->index) != 1)
+        return -1;
+    return 0;
+}
+
+// Place les blocs compressés dans la section : en-tête, index et dictionnaire à off_offsets, puis le blob
+static void zip_disposer(const t3c_bin_zip *zip, t3c_bin_section *section){
+    section->flags      |= T3C_BIN_COMPRESSE;
+    section->off_blob    = aligne(section->off_offsets + sizeof zip->entete + (zip->entete.nbbloc + 1) * sizeof(uint64_t) + zip->entete.taille_dico);
+    section->taille_blob = zip->taille_blob;
+}
+
+// Écrit l'en-tête, l'index, le dictionnaire et les blocs compressés à leur place dans le fichier
+static int zip_ecrire(t3c_bin_zip *zip, const t3c_bin_section *section, FILE *fichier, uint64_t *pos){
+    if (ecrire_padding(fichier, pos, section->off_offsets) != 0
+     || fwrite(&zip->entete, sizeof zip->entete, 1, fichier) != 1)
+        return -1;
+    *pos += sizeof zip->entete;
+    if (t3c_fichier_recopier(zip->index, fichier, pos) != 0
+     || fwrite(zip->dico, 1, zip->entete.taille_dico, fichier) != zip->entete.taille_dico)
+        return -1;
+    *pos += zip->entete.taille_dico;
+    if (ecrire_padding(fichier, pos, section->off_blob) != 0
+     || t3c_fichier_recopier(zip->blob, fichier, pos) != 0)
+        return -1;
+    return 0;
+}
+
+/* Écrit les sections de la table au format T3C binaire (une par algo) :
+   - La colonne des condensats bruts de chaque section est triée telle quelle
+   - Trie les entrées par condensat et élimine les doublons de la section (la première occurrence est gardée)
+   - Écrit l'en-tête et les descripteurs, puis pour chaque section la colonne des condensats,
+     les offsets et le blob des mdp
+   - Compression active : les mdp de chaque section sont d'abord compressés dans des fichiers
+     temporaires (leur taille fixe la disposition), puis recopiés à la place des offsets et du blob
+*/
+int t3c_bin_write(const t3c_table *tables, size_t nbsection, char *path){
+    if (nbsection == 0 || nbsection > T3C_SECTIONS_MAX){
+        printf("t3c_bin.c : ERREUR > Nombre de sections invalide (%zu, 1 à %d)\n", nbsection, T3C_SECTIONS_MAX);
+        return -1;
+    }
+
+    // Disposition du fichier : chaque colonne commence sur une frontière de 64 octets
+    t3c_bin_header header;
+    t3c_bin_section sections[T3C_SECTIONS_MAX];
+    size_t *ordres[T3C_SECTIONS_MAX] = {0};
+    size_t nbuniques[T3C_SECTIONS_MAX] = {0};
+    t3c_bin_zip *zips[T3C_SECTIONS_MAX] = {0};
+    memset(&header, 0, sizeof header);
+    memset(sections, 0, sizeof sections);
+
+    int retour = 0;
+    size_t nbLigneMax = 0;
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        const t3c_table *table = &tables[s];
+        const EVP_MD *md = EVP_get_digestbyname(table->algo);
+        if (!md){
+            printf("t3c_bin.c : ERREUR > L'algorithme '%s' est inconnu\n", table->algo);
+            retour = -1;
+            break;
+        }
+        size_t digest_taille = (size_t)EVP_MD_get_size(md);
+        if (table->nbobj > 0 && table->digest_taille != digest_taille){
+            printf("t3c_bin.c : ERREUR > Les condensats de %u octets de la table ne sont pas des %s valides\n", table->digest_taille, table->algo);
+            retour = -1;
+            break;
+        }
+        ordres[s] = malloc(table->nbobj ? table->nbobj * sizeof *ordres[s] : 1);
+        if (!ordres[s]){
+            printf("t3c_bin.c : ERREUR > malloc des condensats (%zu)\n", table->nbobj);
+            retour = -1;
+            break;
+        }
+
+        // Tri par condensat puis élimination des doublons
+        nbuniques[s] = t3c_sort_unique(table->digests, digest_taille, table->nbobj, ordres[s]);
+        sections[s].digest_taille = (uint32_t)digest_taille;
+        nbLigneMax += nbuniques[s];
+    }
+
+    char dossier[4096];
+    t3c_dossier(path, dossier, sizeof dossier);
+    int pourcentage = nbLigneMax >= 100 ? (int)(nbLigneMax / 100) : 1;
+    size_t nbLigneDone = 0;
+    uint64_t pos = aligne(sizeof header + nbsection * sizeof *sections);
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        const t3c_table *table = &tables[s];
+        size_t nbunique = nbuniques[s];
+        t3c_bin_section *section = &sections[s];
+        snprintf(section->algo, sizeof section->algo, "%s", table->algo);
+        section->nbobj       = nbunique;
+        section->off_digests = pos;
+        section->off_offsets = aligne(section->off_digests + nbunique * section->digest_taille);
+
+        if (bin_mdp_bloc){
+            zips[s] = zip_ouvrir(dossier, bin_mdp_bloc);
+            if (!zips[s]){
+                retour = -1;
+                break;
+            }
+            for (size_t i = 0; retour == 0 && i < nbunique; ++i){
+                const char *mdp = t3c_mdp(table, ordres[s][i]);
+                retour = zip_ajouter(zips[s], mdp, strlen(mdp));
+                nbLigneDone++;
+                if ((nbLigneDone % (size_t)pourcentage) == 0 || nbLigneDone == nbLigneMax)
+                    progress_bar(nbLigneDone, nbLigneMax, "( Compression )");
+            }
+            if (retour != 0 || zip_fermer(zips[s]) != 0){
+                printf("t3c_bin.c : ERREUR > La compression des mdp de la section %s à échoué\n", table->algo);
+                retour = -1;
+                break;
+            }
+            zip_disposer(zips[s], section);
+        } else {
+            uint64_t taille_blob = 0;
+            for (size_t i = 0; i < nbunique; ++i)
+                taille_blob += strlen(t3c_mdp(table, ordres[s][i])) + 1;
+            section->off_blob    = aligne(section->off_offsets + (nbunique + 1) * sizeof(uint64_t));
+            section->taille_blob = taille_blob;
+        }
+        header.taille_fichier = section->off_blob + section->taille_blob;
+        pos = aligne(header.taille_fichier);
+    }
+
+    memcpy(header.magic, T3C_BIN_MAGIC, sizeof header.magic);
+    header.version        = bin_mdp_bloc ? T3C_BIN_VERSION_COMPRESSE : T3C_BIN_VERSION;
+    header.nbsection      = (uint32_t)nbsection;
+
+    FILE *fichier = retour == 0 ? fopen(path, "wb") : NULL;
+    if (retour == 0 && !fichier){
+        printf("t3c_bin.c : ERREUR > L'ouverture du fichier '%s' à eu un probleme\n", path);
+        retour = -1;
+    }
+    if (retour != 0){
+        for (size_t s = 0; s < nbsection; ++s){
+            free(ordres[s]);
+            zip_liberer(zips[s]);
+        }
+        return -1;
+    }
+    setvbuf(fichier, NULL, _IOFBF, 1 << 20);
+
+    if (fwrite(&header, sizeof header, 1, fichier) != 1 || fwrite(sections, sizeof *sections, nbsection, fichier) != nbsection)
+        retour = -1;
+    pos = sizeof header + nbsection * sizeof *sections;
+
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        const t3c_table *table = &tables[s];
+        const t3c_bin_section *section = &sections[s];
+        const size_t *ordre = ordres[s];
+        size_t digest_taille = section->digest_taille;
+
+        // Colonne des condensats triés
+        if (ecrire_padding(fichier, &pos, section->off_digests) != 0)
+            retour = -1;
+        for (size_t i = 0; retour == 0 && i < section->nbobj; ++i){
+            if (fwrite(table->digests + ordre[i] * digest_taille, 1, digest_taille, fichier) != digest_taille)
+                retour = -1;
+            pos += digest_taille;
+        }
+
+        // Mdp compressés : en-tête, index, dictionnaire et blocs recopiés des fichiers temporaires
+        if (zips[s]){
+            if (retour == 0 && zip_ecrire(zips[s], section, fichier, &pos) != 0)
+                retour = -1;
+            continue;
+        }
+
+        // Offsets des mdp dans le blob (nbobj + 1 pour connaître la taille du dernier)
+        if (retour == 0 && ecrire_padding(fichier, &pos, section->off_offsets) != 0)
+            retour = -1;
+        uint64_t offset = 0;
+        for (size_t i = 0; retour == 0 && i <= section->nbobj; ++i){
+            if (fwrite(&offset, sizeof offset, 1, fichier) != 1)
+                retour = -1;
+            pos += sizeof offset;
+            if (i < section->nbobj)
+                offset += strlen(t3c_mdp(table, ordre[i])) + 1;
+        }
+
+        // Blob des mdp terminés par '\0'
+        if (retour == 0 && ecrire_padding(fichier, &pos, section->off_blob) != 0)
+            retour = -1;
+        for (size_t i = 0; retour == 0 && i < section->nbobj; ++i){
+            const char *mdp = t3c_mdp(table, ordre[i]);
+            size_t taille = strlen(mdp) + 1;
+            if (fwrite(mdp, 1, taille, fichier) != taille)
+                retour = -1;
+            pos += taille;
+
+            nbLigneDone++;
+            if ((nbLigneDone % (size_t)pourcentage) == 0 || nbLigneDone == nbLigneMax)
+                progress_bar(nbLigneDone, nbLigneMax, "( Ecriture Table )");
+        }
+    }
+
+    if (fclose(fichier) != 0)
+        retour = -1;
+    if (retour != 0)
+        printf("t3c_bin.c : ERREUR > L'écriture de la table binaire '%s' à échoué\n", path);
+
+    for (size_t s = 0; s < nbsection; ++s){
+        free(ordres[s]);
+        zip_liberer(zips[s]);
+    }
+    return retour;
+}
+
+/* Dossier du fichier path, dans dossier (taille octets) : dossier par défaut des fichiers temporaires */
+void t3c_dossier(const char *path, char *dossier, size_t taille){
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+        snprintf(dossier, taille, ".");
+    else
+        snprintf(dossier, taille, "%.*s", slash == path ? 1 : (int)(slash - path), path);
+}
+
+/* Ouvre un fichier temporaire anonyme dans dossier
+   - Le fichier est supprimé du répertoire dès sa création : il disparaît à la fermeture,
+     même si le programme s'arrête en cours de route
+*/
+FILE *t3c_fichier_temp(const char *dossier){
+    char modele[4096];
+    if (snprintf(modele, sizeof modele, "%s/rainc-XXXXXX", dossier) >= (int)sizeof modele){
+        printf("t3c_bin.c : ERREUR > Le dossier temporaire '%s' est trop long\n", dossier);
+        return NULL;
+    }
+    int fd = mkstemp(modele);
+    if (fd < 0){
+        printf("t3c_bin.c : ERREUR > La création d'un fichier temporaire dans '%s' à échoué\n", dossier);
+        return NULL;
+    }
+    unlink(modele);
+    FILE *fichier = fdopen(fd, "w+b");
+    if (!fichier){
+        close(fd);
+        return NULL;
+    }
+    return fichier;
+}
+
+/* Prépare l'écriture en flux de la table binaire path
+   - La place de l'en-tête et du descripteur est réservée, la colonne des condensats suit
+   - Compression active : les mdp passent par un compresseur au lieu des offsets et du blob
+*/
+int t3c_bin_flux_open(t3c_bin_flux *flux, char *path, char *algo_name, const char *dossier_temp){
+    memset(flux, 0, sizeof *flux);
+    flux->debut = t3c_stats_debut();
+    const EVP_MD *md = EVP_get_digestbyname(algo_name);
+    if (!md){
+        printf("t3c_bin.c : ERREUR > L'algorithme '%s' est inconnu\n", algo_name);
+        return -1;
+    }
+    snprintf(flux->section.algo, sizeof flux->section.algo, "%s", algo_name);
+    flux->section.digest_taille = (uint32_t)EVP_MD_get_size(md);
+    flux->section.off_digests = aligne(sizeof(t3c_bin_header) + sizeof(t3c_bin_section));
+    flux->path = path;
+
+    flux->fichier = fopen(path, "wb");
+    if (bin_mdp_bloc)
+        flux->zip = zip_ouvrir(dossier_temp, bin_mdp_bloc);
+    else {
+        flux->offsets = t3c_fichier_temp(dossier_temp);
+        flux->blob = t3c_fichier_temp(dossier_temp);
+    }
+    if (!flux->fichier || (!flux->zip && (!flux->offsets || !flux->blob))){
+        printf("t3c_bin.c : ERREUR > L'ouverture du fichier '%s' à eu un probleme\n", path);
+        t3c_bin_flux_close(flux, 1);
+        return -1;
+    }
+    setvbuf(flux->fichier, NULL, _IOFBF, T3C_BIN_TAMPON);
+    if (!flux->zip){
+        setvbuf(flux->offsets, NULL, _IOFBF, T3C_BIN_TAMPON);
+        setvbuf(flux->blob, NULL, _IOFBF, T3C_BIN_TAMPON);
+    }
+
+    uint64_t pos = 0;
+    if (ecrire_padding(flux->fichier, &pos, flux->section.off_digests) != 0){
+        printf("t3c_bin.c : ERREUR > L'écriture de la table binaire '%s' à échoué\n", path);
+        t3c_bin_flux_close(flux, 1);
+        return -1;
+    }
+    return 0;
+}
+
+// Ajoute l'entrée suivante (condensat supérieur au précédent) à la table en cours d'écriture
+int t3c_bin_flux_add(t3c_bin_flux *flux, const unsigned char *digest, const char *mdp, size_t taille_mdp){
+    if (fwrite(digest, 1, flux->section.digest_taille, flux->fichier) != flux->section.digest_taille
+     || (flux->zip ? zip_ajouter(flux->zip, mdp, taille_mdp) != 0
+                   : fwrite(&flux->taille_blob, sizeof flux->taille_blob, 1, flux->offsets) != 1
+                  || fwrite(mdp, 1, taille_mdp, flux->blob) != taille_mdp
+                  || fputc('\0', flux->blob) == EOF)){
+        printf("t3c_bin.c : ERREUR > L'écriture de la table binaire '%s' à échoué\n", flux->path);
+        return -1;
+    }
+    flux->taille_blob += taille_mdp + 1;
+    flux->section.nbobj++;
+    return 0;
+}
+
+// Recopie le fichier temporaire source à la suite du fichier final par grands blocs
+int t3c_fichier_recopier(FILE *source, FILE *fichier, uint64_t *pos){
+    char *tampon = malloc(T3C_BIN_TAMPON);
+    if (!tampon || fflush(source) != 0 || fseeko(source, 0, SEEK_SET) != 0){
+        free(tampon);
+        return -1;
+    }
+    int retour = 0;
+    size_t lu;
+    while ((lu = fread(tampon, 1, T3C_BIN_TAMPON, source)) > 0){
+        if (fwrite(tampon, 1, lu, fichier) != lu){
+            retour = -1;
+            break;
+        }
+        *pos += lu;
+    }
+    if (ferror(source))
+        retour = -1;
+    free(tampon);
+    return retour;
+}
+
+/* Termine la table : offsets puis blob recopiés derrière la colonne, en-tête écrit en dernier
+   - compression : derniers mdp compressés, puis index, dictionnaire et blocs recopiés
+   - abandon != 0 : ferme tout et supprime la table partielle
+*/
+int t3c_bin_flux_close(t3c_bin_flux *flux, int abandon){
+    int retour = abandon ? -1 : 0;
+    if (retour == 0){
+        t3c_bin_section *section = &flux->section;
+        uint64_t pos = section->off_digests + section->nbobj * section->digest_taille;
+        section->off_offsets = aligne(pos);
+        if (flux->zip){
+            if (zip_fermer(flux->zip) != 0)
+                retour = -1;
+            zip_disposer(flux->zip, section);
+        } else {
+            section->off_blob    = aligne(section->off_offsets + (section->nbobj + 1) * sizeof(uint64_t));
+            section->taille_blob = flux->taille_blob;
+        }
+
+        t3c_bin_header header;
+        memset(&header, 0, sizeof header);
+        memcpy(header.magic, T3C_BIN_MAGIC, sizeof header.magic);
+        header.version        = flux->zip ? T3C_BIN_VERSION_COMPRESSE : T3C_BIN_VERSION;
+        header.nbsection      = 1;
+        header.taille_fichier = section->off_blob + section->taille_blob;
+
+        // Dernier offset : taille du blob, pour connaître la taille du dernier mdp
+        if (retour == 0 && flux->zip)
+            retour = zip_ecrire(flux->zip, section, flux->fichier, &pos);
+        else if (retour == 0
+              && (fwrite(&flux->taille_blob, sizeof flux->taille_blob, 1, flux->offsets) != 1
+               || ecrire_padding(flux->fichier, &pos, section->off_offsets) != 0
+               || t3c_fichier_recopier(flux->offsets, flux->fichier, &pos) != 0
+               || ecrire_padding(flux->fichier, &pos, section->off_blob) != 0
+               || t3c_fichier_recopier(flux->blob, flux->fichier, &pos) != 0))
+            retour = -1;
+        if (retour == 0
+         && (fseeko(flux->fichier, 0, SEEK_SET) != 0
+          || fwrite(&header, sizeof header, 1, flux->fichier) != 1
+          || fwrite(section, sizeof *section, 1, flux->fichier) != 1))
+            retour = -1;
+        if (retour == 0){
+            t3c_stats_phase(T3C_STATS_ECRITURE, flux->debut);
+            t3c_stats_compter(T3C_STATS_ENTREES_ECRITES, section->nbobj);
+            t3c_stats_compter(T3C_STATS_OCTETS_ECRITS, header.taille_fichier);
+        }
+    }
+    if (flux->offsets)
+        fclose(flux->offsets);
+    if (flux->blob)
+        fclose(flux->blob);
+    zip_liberer(flux->zip);
+    flux->zip = NULL;
+    if (flux->fichier && fclose(flux->fichier) != 0)
+        retour = -1;
+    if (retour != 0 && !abandon)
+        printf("t3c_bin.c : ERREUR > L'écriture de la table binaire '%s' à échoué\n", flux->path);
+    if (retour != 0 && flux->fichier)
+        unlink(flux->path);
+    flux->fichier = flux->offsets = flux->blob = NULL;
+    return retour;
+}
+
+// En-tête des mdp compressés de la section
+static const t3c_bin_blocs *bin_compression(const t3c_bin *bin, const t3c_bin_section *section){
+    return (const t3c_bin_blocs*)((const char*)bin->map + section->off_offsets);
+}
+
+/* Vérifie que la section tient dans le fichier
+   - mdp compressés : en-tête, index et dictionnaire dans le fichier, un bloc par groupe de
+     mdp_bloc lignes, dernier offset de l'index égal à la taille du blob ; les autres offsets
+     sont vérifiés à la décompression de leur bloc
+   - Bornes comparées à la place restante (soustraction, division) : un en-tête forgé ne peut
+     pas faire déborder une addition ou une multiplication sur 64 bits
+*/
+static int section_valide(const t3c_bin *bin, const t3c_bin_section *section){
+    uint64_t taille = bin->taille_map;
+    int valide = section->digest_taille > 0 && section->digest_taille <= EVP_MAX_MD_SIZE
+              && (section->flags & ~T3C_BIN_COMPRESSE) == 0
+              && section->off_digests <= taille
+              && section->nbobj <= (taille - section->off_digests) / section->digest_taille
+              && section->off_offsets % sizeof(uint64_t) == 0
+              && section->off_blob <= taille && section->taille_blob <= taille - section->off_blob;
+    if (!valide)
+        return 0;
+
+    if ((section->flags & T3C_BIN_COMPRESSE) == 0){
+        const char *blob = (const char*)bin->map + section->off_blob;
+        return section->off_offsets <= taille
+            && section->nbobj < (taille - section->off_offsets) / sizeof(uint64_t)
+            && (section->taille_blob == 0 || blob[section->taille_blob - 1] == '\0');
+    }
+
+    if (bin->header->version < T3C_BIN_VERSION_COMPRESSE || section->off_offsets > taille
+        || taille - section->off_offsets < sizeof(t3c_bin_blocs))
+        return 0;
+    const t3c_bin_blocs *c = bin_compression(bin, section);
+    uint64_t reste = taille - section->off_offsets - sizeof *c;    // place pour l'index et le dictionnaire
+    valide = c->mdp_bloc >= T3C_BIN_BLOC_MIN && c->mdp_bloc <= T3C_BIN_BLOC_MAX
+          && c->taille_dico <= T3C_BIN_DICO
+          && c->bloc_max <= UINT32_MAX
+          && c->nbbloc == section->nbobj / c->mdp_bloc + (section->nbobj % c->mdp_bloc != 0)
+          && c->taille_dico <= reste
+          && c->nbbloc < (reste - c->taille_dico) / sizeof(uint64_t);
+    return valide && ((const uint64_t*)(c + 1))[c->nbbloc] == section->taille_blob;
+}
+
+// Prépare le cache des blocs décompressés, à la taille du plus grand bloc des sections compressées
+static int bin_cache_ouvrir(t3c_bin *bin){
+    uint64_t bloc_max = 0, mdp_bloc = 0;
+    for (uint32_t s = 0; s < bin->header->nbsection; ++s){
+        const t3c_bin_section *section = &bin->sections[s];
+        if ((section->flags & T3C_BIN_COMPRESSE) == 0)
+            continue;
+        const t3c_bin_blocs *c = bin_compression(bin, section);
+        if (c->bloc_max > bloc_max)
+            bloc_max = c->bloc_max;
+        if (c->mdp_bloc > mdp_bloc)
+            mdp_bloc = c->mdp_bloc;
+    }
+    if (mdp_bloc == 0)
+        return 0;
+
+    t3c_bin_cache *cache = calloc(1, sizeof *cache);
+    if (!cache){
+        printf("t3c_bin.c : ERREUR > calloc du cache des blocs\n");
+        return -1;
+    }
+    cache->bloc = T3C_BIN_AUCUN;
+    cache->data = malloc((size_t)bloc_max + 1);
+    cache->debuts = malloc((size_t)mdp_bloc * sizeof *cache->debuts);
+    if (!cache->data || !cache->debuts || inflateInit2(&cache->z, -15) != Z_OK){
+        printf("t3c_bin.c : ERREUR > malloc du cache des blocs (%llu octets)\n", (unsigned long long)bloc_max);
+        free(cache->data);
+        free(cache->debuts);
+        free(cache);
+        return -1;
+    }
+    bin->cache = cache;
+    return 0;
+}
+
+/* Projette une table binaire en mémoire :
+   - Vérifie la signature, la version et que chaque section tient dans le fichier
+   - Aucune donnée n'est copiée : les recherches lisent directement les pages projetées
+   - Une section aux mdp compressés reçoit un cache du dernier bloc décompressé
+*/
+int t3c_bin_open(char *path, t3c_bin *bin){
+    uint64_t debut = t3c_stats_debut();
+    memset(bin, 0, sizeof *bin);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        printf("t3c_bin.c : ERREUR > L'ouverture de la table binaire '%s' à eu un probleme\n", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(t3c_bin_header)){
+        printf("t3c_bin.c : ERREUR > La table binaire '%s' est tronquée\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED){
+        printf("t3c_bin.c : ERREUR > mmap de la table binaire '%s' à échoué\n", path);
+        return -1;
+    }
+    // Les recherches sautent d'une page à l'autre : la lecture anticipée serait perdue
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+
+    bin->map = map;
+    bin->taille_map = (size_t)st.st_size;
+    bin->header = map;
+    bin->sections = (const t3c_bin_section*)((const char*)map + sizeof(t3c_bin_header));
+
+    const t3c_bin_header *header = bin->header;
+    uint64_t taille = bin->taille_map;
+    int valide = memcmp(header->magic, T3C_BIN_MAGIC, sizeof header->magic) == 0
+              && (header->version == T3C_BIN_VERSION || header->version == T3C_BIN_VERSION_COMPRESSE)
+              && header->nbsection > 0 && header->nbsection <= T3C_SECTIONS_MAX
+              && sizeof *header + (uint64_t)header->nbsection * sizeof(t3c_bin_section) <= taille;
+
+    for (uint32_t s = 0; valide && s < header->nbsection; ++s)
+        valide = section_valide(bin, &bin->sections[s]);
+    if (!valide){
+        printf("t3c_bin.c : ERREUR > La table binaire '%s' est invalide ou d'une version non supportée\n", path);
+        t3c_bin_close(bin);
+        return -1;
+    }
+    if (bin_cache_ouvrir(bin) != 0){
+        t3c_bin_close(bin);
+        return -1;
+    }
+    t3c_stats_phase(T3C_STATS_CHARGEMENT, debut);
+    for (uint32_t s = 0; t3c_stats_actives && s < header->nbsection; ++s)
+        t3c_stats_compter(T3C_STATS_ENTREES_CHARGEES, bin->sections[s].nbobj);
+    return 0;
+}
+
+// Libère la projection mémoire et le cache des blocs
+void t3c_bin_close(t3c_bin *bin){
+    if (bin->map)
+        munmap(bin->map, bin->taille_map);
+    if (bin->cache){
+        inflateEnd(&bin->cache->z);
+        free(bin->cache->data);
+        free(bin->cache->debuts);
+        free(bin->cache);
+    }
+    memset(bin, 0, sizeof *bin);
+}
+
+/* Décompresse le bloc de la section s dans le cache, sauf s'il y est déjà
+   - vérifie l'offset du bloc dans l'index, sa taille et son nombre de mdp
+*/
+static int bin_bloc(const t3c_bin *bin, size_t s, uint64_t bloc){
+    t3c_bin_cache *cache = bin->cache;
+    if (cache->section == s && cache->bloc == bloc)
+        return 0;
+
+    const t3c_bin_section *section = &bin->sections[s];
+    const t3c_bin_blocs *c = bin_compression(bin, section);
+    const uint64_t *index = (const uint64_t*)(c + 1);
+    const unsigned char *dico = (const unsigned char*)(index + c->nbbloc + 1);
+    uint64_t attendus = section->nbobj - bloc * c->mdp_bloc;
+    if (attendus > c->mdp_bloc)
+        attendus = c->mdp_bloc;
+
+    cache->bloc = T3C_BIN_AUCUN;
+    int valide = index[bloc] <= index[bloc + 1] && index[bloc + 1] <= section->taille_blob
+              && index[bloc + 1] - index[bloc] <= UINT32_MAX
+              && inflateReset(&cache->z) == Z_OK
+              && (c->taille_dico == 0 || inflateSetDictionary(&cache->z, dico, c->taille_dico) == Z_OK);
+    size_t taille = 0;
+    if (valide){
+        cache->z.next_in = (Bytef*)bin->map + section->off_blob + index[bloc];
+        cache->z.avail_in = (uInt)(index[bloc + 1] - index[bloc]);
+        cache->z.next_out = (Bytef*)cache->data;
+        cache->z.avail_out = (uInt)c->bloc_max;
+        valide = inflate(&cache->z, Z_FINISH) == Z_STREAM_END;
+        taille = (size_t)c->bloc_max - cache->z.avail_out;
+    }
+
+    // Début de chaque mdp : exactement attendus mdp terminés par '\0'
+    size_t pos = 0;
+    uint64_t nb = 0;
+    for (; valide && pos < taille && nb < attendus; ++nb){
+        cache->debuts[nb] = (uint32_t)pos;
+        pos += strnlen(cache->data + pos, taille - pos) + 1;
+    }
+    if (!valide || nb != attendus || pos != taille || (taille && cache->data[taille - 1] != '\0')){
+        printf("t3c_bin.c : ERREUR > Le bloc %llu de la section %s est invalide\n", (unsigned long long)bloc, section->algo);
+        return -1;
+    }
+    cache->section = s;
+    cache->bloc = bloc;
+    return 0;
+}
+
+/* Renvoie le mdp de la ligne pos de la section s, lu dans les pages projetées
+   - section compressée : seul le bloc de la ligne est décompressé ; le mdp renvoyé reste
+     valide jusqu'à l'appel suivant sur la même table
+*/
+const char *t3c_bin_mdp(const t3c_bin *bin, size_t s, size_t pos){
+    const t3c_bin_section *section = &bin->sections[s];
+    if (pos >= section->nbobj)
+        return NULL;
+    if (section->flags & T3C_BIN_COMPRESSE){
+        uint32_t mdp_bloc = bin_compression(bin, section)->mdp_bloc;
+        if (bin_bloc(bin, s, pos / mdp_bloc) != 0)
+            return NULL;
+        return bin->cache->data + bin->cache->debuts[pos % mdp_bloc];
+    }
+    const uint64_t *offsets = (const uint64_t*)((const char*)bin->map + section->off_offsets);
+    if (offsets[pos] >= section->taille_blob)
+        return NULL;
+    return (const char*)bin->map + section->off_blob + offsets[pos];
+}
+
+// Mdp par bloc de la section s, 0 si ses mdp ne sont pas compressés
+unsigned int t3c_bin_mdp_bloc(const t3c_bin *bin, size_t s){
+    const t3c_bin_section *section = &bin->sections[s];
+    return (section->flags & T3C_BIN_COMPRESSE) ? bin_compression(bin, section)->mdp_bloc : 0;
+}
+
+/* Recherche d'un condensat binaire dans la colonne triée de la section s
+   - Recherche par interpolation directement dans les pages projetées (t3c_search_sorted)
+   - Renvoie le mdp trouvé, sinon NULL
+*/
+const char *t3c_bin_lookup(const t3c_bin *bin, size_t s, const unsigned char *digest, unsigned int digest_taille){
+    const t3c_bin_section *section = &bin->sections[s];
+    if (digest_taille != section->digest_taille)
+        return NULL;
+
+    const unsigned char *digests = (const unsigned char*)bin->map + section->off_digests;
+    ssize_t pos = t3c_search_sorted(digests, digest_taille, section->nbobj, digest);
+    return pos < 0 ? NULL : t3c_bin_mdp(bin, s, (size_t)pos);
+}
+
+/* Reconstruit une t3c_table à partir de la section s d'une table binaire
+   - Sert à l'export vers le format texte
+   - La colonne des condensats et le blob sont recopiés d'un bloc, les offsets vérifiés
+   - Section compressée : les blocs sont décompressés l'un après l'autre dans le blob
+*/
+int t3c_bin_to_table(const t3c_bin *bin, size_t s, t3c_table *table){
+    const t3c_bin_section *section = &bin->sections[s];
+    const unsigned char *digests = (const unsigned char*)bin->map + section->off_digests;
+    const uint64_t *offsets = (const uint64_t*)((const char*)bin->map + section->off_offsets);
+    const char *blob = (const char*)bin->map + section->off_blob;
+
+    t3c_init(table);
+    snprintf(table->algo, sizeof table->algo, "%s", section->algo);
+    if (section->nbobj == 0)
+        return 0;
+
+    madvise(bin->map, bin->taille_map, MADV_SEQUENTIAL);
+    if (t3c_alloc(table, section->nbobj, section->digest_taille) != 0)
+        return -1;
+    if (section->flags & T3C_BIN_COMPRESSE){
+        for (size_t i = 0; i < section->nbobj; ++i){
+            const char *mdp = t3c_bin_mdp(bin, s, i);
+            if (mdp == NULL || t3c_blob_ajouter(&table->blob, mdp, strlen(mdp), &table->offsets[i]) != 0){
+                t3c_free(table);
+                return -1;
+            }
+        }
+        memcpy(table->digests, digests, section->nbobj * section->digest_taille);
+        table->nbobj = section->nbobj;
+        return 0;
+    }
+    for (size_t i = 0; i < section->nbobj; ++i){
+        if (offsets[i] >= section->taille_blob){
+            printf("t3c_bin.c : ERREUR > L'entrée %zu de la table binaire est invalide\n", i);
+            t3c_free(table);
+            return -1;
+        }
+    }
+
+    table->blob.data = (char*)malloc(section->taille_blob);
+    if (table->blob.data == NULL){
+        printf("t3c_bin.c : ERREUR > malloc du blob (%zu)\n", (size_t)section->taille_blob);
+        t3c_free(table);
+        return -1;
+    }
+    memcpy(table->blob.data, blob, section->taille_blob);
+    table->blob.taille = section->taille_blob;
+    table->blob.capacite = section->taille_blob;
+    memcpy(table->digests, digests, section->nbobj * section->digest_taille);
+    memcpy(table->offsets, offsets, section->nbobj * sizeof *offsets);
+    table->nbobj = section->nbobj;
+    return 0;
+}
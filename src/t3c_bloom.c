@@ -0,0 +1,236 @@
+/**
+ * t3c_bloom.c - Filtre de Bloom par blocs rangé à côté d'une table T3C (<table>.bf)
+ *  - Construit après la table (-G --bloom) à partir de ses condensats, texte ou binaire
+ *  - Chaque clé met T3C_BLOOM_K bits dans un seul bloc de 64 octets : une requête absente
+ *    coûte une ligne de cache au lieu d'une descente dans l'index ou la colonne
+ *  - Vers 10 bits par clé, moins de 1% des absents passent le filtre
+ *  - Le filtre garde la taille et la date de sa table : s'il ne correspond plus, il est ignoré
+ *  - Toutes les sections d'une table multi-algo partagent le même filtre
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "t3c_bloom.h"
+#include "t3c_bin.h"
+#include "hash.h"
+
+// Chemin du filtre : chemin de la table suivi de T3C_BLOOM_SUFFIXE
+static char *bloom_chemin(const char *t3c_path){
+    size_t taille = strlen(t3c_path) + sizeof T3C_BLOOM_SUFFIXE;
+    char *chemin = malloc(taille);
+    if (chemin)
+        snprintf(chemin, taille, "%s%s", t3c_path, T3C_BLOOM_SUFFIXE);
+    return chemin;
+}
+
+// Met les T3C_BLOOM_K bits du condensat dans son bloc
+static void bloom_inserer(uint64_t *blocs, uint64_t nbbloc, const unsigned char *digest, unsigned int digest_taille){
+    uint64_t bits = 0;
+    uint64_t *bloc = (uint64_t*)t3c_bloom_bloc(blocs, nbbloc, digest, digest_taille, &bits);
+    for (unsigned int i = 0; i < T3C_BLOOM_K; ++i){
+        unsigned int bit = (unsigned int)(bits >> (9 * i)) & 511;
+        bloc[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+}
+
+// Alloue les blocs pour nbcle clés à bits_par_cle bits (au moins un bloc)
+static uint64_t *bloom_allouer(size_t nbcle, unsigned int bits_par_cle, uint64_t *nbbloc){
+    *nbbloc = ((uint64_t)nbcle * bits_par_cle + 511) / 512;
+    if (*nbbloc == 0)
+        *nbbloc = 1;
+    uint64_t *blocs = calloc(*nbbloc, T3C_BLOOM_MOTS * sizeof *blocs);
+    if (blocs == NULL)
+        printf("t3c_bloom.c : ERREUR > calloc du filtre (%llu blocs)\n", (unsigned long long)*nbbloc);
+    return blocs;
+}
+
+// Taille commune des condensats du filtre : 0 dès que les sections de la table en mélangent plusieurs
+static void bloom_taille(t3c_bloom_header *header, unsigned int digest_taille){
+    if (header->nbcle == 0)
+        header->digest_taille = digest_taille;
+    else if (header->digest_taille != digest_taille)
+        header->digest_taille = 0;
+}
+
+/* Remplit le filtre depuis une table binaire : les colonnes projetées de toutes les sections
+   sont lues dans l'ordre
+*/
+static uint64_t *bloom_depuis_bin(char *t3c_path, unsigned int bits_par_cle, t3c_bloom_header *header){
+    t3c_bin bin;
+    if (t3c_bin_open(t3c_path, &bin) != 0)
+        return NULL;
+    madvise(bin.map, bin.taille_map, MADV_SEQUENTIAL);
+
+    size_t nbcle = 0;
+    for (uint32_t s = 0; s < bin.header->nbsection; ++s)
+        nbcle += bin.sections[s].nbobj;
+
+    uint64_t *blocs = bloom_allouer(nbcle, bits_par_cle, &header->nbbloc);
+    for (uint32_t s = 0; blocs && s < bin.header->nbsection; ++s){
+        const t3c_bin_section *section = &bin.sections[s];
+        const unsigned char *digests = (const unsigned char*)bin.map + section->off_digests;
+        if (section->nbobj == 0)
+            continue;
+        bloom_taille(header, section->digest_taille);
+        for (size_t i = 0; i < section->nbobj; ++i)
+            bloom_inserer(blocs, header->nbbloc, digests + i * section->digest_taille, section->digest_taille);
+        header->nbcle += section->nbobj;
+    }
+    t3c_bin_close(&bin);
+    return blocs;
+}
+
+/* Remplit le filtre depuis une table texte
+   - une première passe compte les lignes pour dimensionner le filtre
+   - la seconde décode le condensat de chaque ligne ; les lignes invalides sont ignorées
+     comme au chargement (elles ne peuvent pas être trouvées)
+*/
+static uint64_t *bloom_depuis_txt(char *t3c_path, unsigned int bits_par_cle, t3c_bloom_header *header){
+    FILE *fichier = fopen(t3c_path, "r");
+    if (fichier == NULL){
+        printf("t3c_bloom.c : ERREUR > L'ouverture de la table '%s' à eu un probleme\n", t3c_path);
+        return NULL;
+    }
+
+    char *ligne = NULL;
+    size_t taille_buf = 0;
+    size_t nblignes = 0;
+    while (getline(&ligne, &taille_buf, fichier) != -1){
+        if (ligne[0] != '#' && strchr(ligne, '\t'))
+            nblignes++;
+    }
+    rewind(fichier);
+
+    uint64_t *blocs = bloom_allouer(nblignes, bits_par_cle, &header->nbbloc);
+    while (blocs && getline(&ligne, &taille_buf, fichier) != -1){
+        char *tab = strchr(ligne, '\t');
+        if (ligne[0] == '#' || tab == NULL)
+            continue;
+        *tab = '\0';
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_taille = 0;
+        if (hex_to_bin(ligne, digest, &digest_taille) != 0)
+            continue;
+        bloom_taille(header, digest_taille);
+        bloom_inserer(blocs, header->nbbloc, digest, digest_taille);
+        header->nbcle++;
+    }
+
+    free(ligne);
+    fclose(fichier);
+    return blocs;
+}
+
+/* Construit le filtre de la table t3c_path et l'écrit dans <t3c_path>.bf
+   - à appeler une fois la table entièrement écrite : sa taille et sa date sont gardées
+   - nbcle reçoit le nombre de condensats insérés
+*/
+int t3c_bloom_build(char *t3c_path, unsigned int bits_par_cle, size_t *nbcle){
+    struct stat st;
+    if (stat(t3c_path, &st) != 0){
+        printf("t3c_bloom.c : ERREUR > La table '%s' est introuvable\n", t3c_path);
+        return -1;
+    }
+
+    t3c_bloom_header header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, T3C_BLOOM_MAGIC, sizeof header.magic);
+    header.version = T3C_BLOOM_VERSION;
+    header.bits_par_cle = bits_par_cle;
+    header.nbhash = T3C_BLOOM_K;
+    header.taille_table = (uint64_t)st.st_size;
+    header.mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    header.mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+
+    uint64_t *blocs = t3c_bin_is(t3c_path) ? bloom_depuis_bin(t3c_path, bits_par_cle, &header)
+                                           : bloom_depuis_txt(t3c_path, bits_par_cle, &header);
+    if (blocs == NULL)
+        return -1;
+
+    char *chemin = bloom_chemin(t3c_path);
+    FILE *fichier = chemin ? fopen(chemin, "wb") : NULL;
+    if (fichier == NULL){
+        printf("t3c_bloom.c : ERREUR > Impossible de créer le filtre '%s'\n", chemin ? chemin : t3c_path);
+        free(chemin);
+        free(blocs);
+        return -1;
+    }
+
+    int retour = 0;
+    if (fwrite(&header, sizeof header, 1, fichier) != 1
+        || fwrite(blocs, T3C_BLOOM_MOTS * sizeof *blocs, header.nbbloc, fichier) != header.nbbloc)
+        retour = -1;
+    if (fclose(fichier) != 0)
+        retour = -1;
+    if (retour != 0){
+        printf("t3c_bloom.c : ERREUR > Écriture du filtre '%s'\n", chemin);
+        unlink(chemin);
+    }
+
+    *nbcle = header.nbcle;
+    free(chemin);
+    free(blocs);
+    return retour;
+}
+
+/* Projette le filtre de la table t3c_path
+   - renvoie -1 sans message si le filtre n'existe pas, est invalide ou ne correspond plus
+     à la table (taille ou date différente) : la recherche se fait alors sans filtre
+*/
+int t3c_bloom_open(char *t3c_path, t3c_bloom *bloom){
+    memset(bloom, 0, sizeof *bloom);
+    struct stat table;
+    if (stat(t3c_path, &table) != 0)
+        return -1;
+
+    char *chemin = bloom_chemin(t3c_path);
+    int fd = chemin ? open(chemin, O_RDONLY) : -1;
+    free(chemin);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(t3c_bloom_header)){
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+
+    bloom->map = map;
+    bloom->taille_map = (size_t)st.st_size;
+    bloom->header = map;
+    bloom->blocs = (const uint64_t*)((const char*)map + sizeof(t3c_bloom_header));
+
+    const t3c_bloom_header *header = bloom->header;
+    int valide = memcmp(header->magic, T3C_BLOOM_MAGIC, sizeof header->magic) == 0
+              && header->version == T3C_BLOOM_VERSION
+              && header->nbhash == T3C_BLOOM_K
+              && header->nbbloc > 0
+              && header->nbbloc <= (bloom->taille_map - sizeof *header) / (T3C_BLOOM_MOTS * sizeof(uint64_t))
+              && sizeof *header + header->nbbloc * T3C_BLOOM_MOTS * sizeof(uint64_t) == bloom->taille_map
+              && header->taille_table == (uint64_t)table.st_size
+              && header->mtime_sec == (int64_t)table.st_mtim.tv_sec
+              && header->mtime_nsec == (int64_t)table.st_mtim.tv_nsec;
+    if (!valide){
+        t3c_bloom_close(bloom);
+        return -1;
+    }
+    return 0;
+}
+
+// Libère la projection mémoire
+void t3c_bloom_close(t3c_bloom *bloom){
+    if (bloom->map)
+        munmap(bloom->map, bloom->taille_map);
+    memset(bloom, 0, sizeof *bloom);
+}
@@ -0,0 +1,328 @@
+/**
+ * t3c_ecrivain.c - Écriture à haut débit des tables T3C texte
+ *  - Les lignes sont formatées à la main dans des tampons de T3C_ECRIVAIN_TAMPON octets
+ *    alignés sur les pages : ni fprintf ni verrou de stdio par ligne
+ *  - Un tampon plein est écrit d'un seul appel ; avec io_uring (appels système bruts, sans
+ *    liburing), plusieurs tampons sont en vol pendant que les suivants se remplissent
+ *  - io_uring refusé par le noyau (ou -DT3C_SANS_IO_URING) : repli sur write, tampon par tampon
+ *  - La taille prévue est réservée d'avance par fallocate, la part inutilisée rendue à la fin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "t3c_ecrivain.h"
+
+#if defined(__linux__) && !defined(T3C_SANS_IO_URING) && __has_include(<linux/io_uring.h>)
+#define T3C_IO_URING 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+// Écrit taille octets de data à la position donnée, en reprenant les écritures partielles
+static int t3c_ecrire_tout(int fd, const char *data, size_t taille, uint64_t position){
+    while (taille > 0){
+        ssize_t n = pwrite(fd, data, taille, (off_t)position);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        data += n;
+        taille -= (size_t)n;
+        position += (uint64_t)n;
+    }
+    return 0;
+}
+
+#ifdef T3C_IO_URING
+
+/* Anneau io_uring projeté : file de soumission (sq) et de complétion (cq)
+   - un seul thread l'utilise : seules les têtes / queues partagées avec le noyau sont atomiques
+*/
+struct t3c_anneau {
+    int fd;
+    unsigned int *sq_tete;
+    unsigned int *sq_queue;
+    unsigned int *sq_masque;
+    unsigned int *sq_tableau;
+    struct io_uring_sqe *sqes;
+    unsigned int *cq_tete;
+    unsigned int *cq_queue;
+    unsigned int *cq_masque;
+    struct io_uring_cqe *cqes;
+    void *sq;
+    size_t taille_sq;
+    void *cq;                   // == sq avec IORING_FEAT_SINGLE_MMAP
+    size_t taille_cq;
+    size_t taille_sqes;
+};
+
+static void t3c_anneau_fermer(t3c_anneau *anneau){
+    if (!anneau)
+        return;
+    if (anneau->sqes && anneau->sqes != MAP_FAILED)
+        munmap(anneau->sqes, anneau->taille_sqes);
+    if (anneau->cq && anneau->cq != MAP_FAILED && anneau->cq != anneau->sq)
+        munmap(anneau->cq, anneau->taille_cq);
+    if (anneau->sq && anneau->sq != MAP_FAILED)
+        munmap(anneau->sq, anneau->taille_sq);
+    if (anneau->fd >= 0)
+        close(anneau->fd);
+    free(anneau);
+}
+
+// Crée un anneau de T3C_ECRIVAIN_TAMPONS entrées, NULL si le noyau le refuse (repli sur write)
+static t3c_anneau *t3c_anneau_ouvrir(void){
+    struct io_uring_params params;
+    memset(&params, 0, sizeof params);
+    t3c_anneau *anneau = calloc(1, sizeof *anneau);
+    if (!anneau)
+        return NULL;
+    anneau->fd = (int)syscall(__NR_io_uring_setup, T3C_ECRIVAIN_TAMPONS, &params);
+    if (anneau->fd < 0){
+        t3c_anneau_fermer(anneau);
+        return NULL;
+    }
+    anneau->taille_sq = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    anneau->taille_cq = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP){
+        if (anneau->taille_cq > anneau->taille_sq)
+            anneau->taille_sq = anneau->taille_cq;
+        anneau->taille_cq = anneau->taille_sq;
+    }
+    anneau->sq = mmap(NULL, anneau->taille_sq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, anneau->fd, IORING_OFF_SQ_RING);
+    if (anneau->sq == MAP_FAILED){
+        t3c_anneau_fermer(anneau);
+        return NULL;
+    }
+    anneau->cq = (params.features & IORING_FEAT_SINGLE_MMAP) ? anneau->sq
+               : mmap(NULL, anneau->taille_cq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, anneau->fd, IORING_OFF_CQ_RING);
+    anneau->taille_sqes = params.sq_entries * sizeof(struct io_uring_sqe);
+    anneau->sqes = anneau->cq == MAP_FAILED ? MAP_FAILED
+                 : mmap(NULL, anneau->taille_sqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, anneau->fd, IORING_OFF_SQES);
+    if (anneau->sqes == MAP_FAILED){
+        t3c_anneau_fermer(anneau);
+        return NULL;
+    }
+    char *sq = anneau->sq;
+    char *cq = anneau->cq;
+    anneau->sq_tete = (unsigned int*)(sq + params.sq_off.head);
+    anneau->sq_queue = (unsigned int*)(sq + params.sq_off.tail);
+    anneau->sq_masque = (unsigned int*)(sq + params.sq_off.ring_mask);
+    anneau->sq_tableau = (unsigned int*)(sq + params.sq_off.array);
+    anneau->cq_tete = (unsigned int*)(cq + params.cq_off.head);
+    anneau->cq_queue = (unsigned int*)(cq + params.cq_off.tail);
+    anneau->cq_masque = (unsigned int*)(cq + params.cq_off.ring_mask);
+    anneau->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return anneau;
+}
+
+// Soumet l'écriture du tampon t (au plus T3C_ECRIVAIN_TAMPONS en vol : la file a toujours une place)
+static int t3c_anneau_soumettre(t3c_ecrivain *ecr, int t){
+    t3c_anneau *anneau = ecr->anneau;
+    unsigned int queue = *anneau->sq_queue;
+    unsigned int indice = queue & *anneau->sq_masque;
+    struct io_uring_sqe *sqe = &anneau->sqes[indice];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = ecr->fd;
+    sqe->addr = (uint64_t)(uintptr_t)ecr->tampons[t];
+    sqe->len = (uint32_t)ecr->longueurs[t];
+    sqe->off = ecr->positions[t];
+    sqe->user_data = (uint64_t)t;
+    anneau->sq_tableau[indice] = indice;
+    __atomic_store_n(anneau->sq_queue, queue + 1, __ATOMIC_RELEASE);
+    for (;;){
+        int n = (int)syscall(__NR_io_uring_enter, anneau->fd, 1, 0, 0, NULL, 0);
+        if (n >= 0)
+            return 0;
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            return -1;
+    }
+}
+
+/* Récolte les écritures terminées jusqu'à ce que le tampon t soit libre
+   - écriture partielle ou refusée (noyau sans IORING_OP_WRITE...) : le reste est écrit par pwrite
+*/
+static int t3c_anneau_attendre(t3c_ecrivain *ecr, int t){
+    t3c_anneau *anneau = ecr->anneau;
+    while (ecr->en_vol[t]){
+        unsigned int tete = *anneau->cq_tete;
+        unsigned int queue = __atomic_load_n(anneau->cq_queue, __ATOMIC_ACQUIRE);
+        if (tete == queue){
+            int n = (int)syscall(__NR_io_uring_enter, anneau->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (n < 0 && errno != EINTR)
+                return -1;
+            continue;
+        }
+        for (; tete != queue; ++tete){
+            struct io_uring_cqe *cqe = &anneau->cqes[tete & *anneau->cq_masque];
+            int fini = (int)cqe->user_data;
+            size_t ecrit = cqe->res > 0 ? (size_t)cqe->res : 0;
+            if (ecrit < ecr->longueurs[fini]
+             && t3c_ecrire_tout(ecr->fd, ecr->tampons[fini] + ecrit, ecr->longueurs[fini] - ecrit, ecr->positions[fini] + ecrit) != 0)
+                ecr->erreur = 1;
+            ecr->en_vol[fini] = 0;
+        }
+        __atomic_store_n(anneau->cq_tete, tete, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+#else
+
+static t3c_anneau *t3c_anneau_ouvrir(void){
+    return NULL;
+}
+
+static void t3c_anneau_fermer(t3c_anneau *anneau){
+    (void)anneau;
+}
+
+static int t3c_anneau_soumettre(t3c_ecrivain *ecr, int t){
+    (void)ecr;
+    (void)t;
+    return -1;
+}
+
+static int t3c_anneau_attendre(t3c_ecrivain *ecr, int t){
+    (void)ecr;
+    (void)t;
+    return 0;
+}
+
+#endif
+
+/* Crée (ou vide) le fichier path pour l'écrire par tampons
+   - prevue : taille attendue (0 si inconnue), réservée d'avance sans changer la taille du
+     fichier ; un système de fichiers qui ne le permet pas est simplement écrit sans réserve
+*/
+int t3c_ecrivain_ouvrir(t3c_ecrivain *ecr, const char *path, uint64_t prevue){
+    memset(ecr, 0, sizeof *ecr);
+    ecr->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (ecr->fd < 0){
+        printf("t3c_ecrivain.c : ERREUR > L'ouverture du fichier '%s' à échoué\n", path);
+        return -1;
+    }
+    ecr->prevue = prevue;
+    if (prevue > 0)
+        fallocate(ecr->fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)prevue);
+    ecr->anneau = t3c_anneau_ouvrir();
+    ecr->nbtampon = ecr->anneau ? T3C_ECRIVAIN_TAMPONS : 1;
+    for (int t = 0; t < ecr->nbtampon; ++t){
+        void *tampon = NULL;
+        if (posix_memalign(&tampon, T3C_ECRIVAIN_ALIGNEMENT, T3C_ECRIVAIN_TAMPON) != 0){
+            printf("t3c_ecrivain.c : ERREUR > malloc des tampons d'écriture (%d x %zu)\n", ecr->nbtampon, T3C_ECRIVAIN_TAMPON);
+            ecr->erreur = 1;
+            t3c_ecrivain_fermer(ecr);
+            return -1;
+        }
+        ecr->tampons[t] = tampon;
+    }
+    return 0;
+}
+
+/* Envoie le tampon courant au noyau et passe au suivant, en attendant qu'il soit libre
+   - io_uring : l'écriture part en arrière-plan ; sinon elle est faite ici par write
+*/
+int t3c_ecrivain_vider(t3c_ecrivain *ecr){
+    if (ecr->erreur)
+        return -1;
+    if (ecr->remplissage == 0)
+        return 0;
+    int t = ecr->courant;
+    ecr->longueurs[t] = ecr->remplissage;
+    ecr->positions[t] = ecr->position;
+    if (ecr->anneau){
+        ecr->en_vol[t] = 1;
+        if (t3c_anneau_soumettre(ecr, t) != 0){
+            ecr->en_vol[t] = 0;
+            if (t3c_ecrire_tout(ecr->fd, ecr->tampons[t], ecr->longueurs[t], ecr->positions[t]) != 0)
+                ecr->erreur = 1;
+        }
+    }
+    else if (t3c_ecrire_tout(ecr->fd, ecr->tampons[t], ecr->longueurs[t], ecr->positions[t]) != 0)
+        ecr->erreur = 1;
+    ecr->position += ecr->remplissage;
+    ecr->remplissage = 0;
+    ecr->courant = (t + 1) % ecr->nbtampon;
+    if (ecr->anneau && t3c_anneau_attendre(ecr, ecr->courant) != 0)
+        ecr->erreur = 1;
+    if (ecr->erreur){
+        printf("t3c_ecrivain.c : ERREUR > L'écriture de la table t3c à échoué\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Recopie taille octets de data à la suite du fichier (morceau par morceau s'ils dépassent un tampon)
+int t3c_ecrivain_ajouter(t3c_ecrivain *ecr, const void *data, size_t taille){
+    if (ecr->erreur)
+        return -1;
+    const char *octets = data;
+    while (taille > 0){
+        if (ecr->remplissage == T3C_ECRIVAIN_TAMPON && t3c_ecrivain_vider(ecr) != 0)
+            return -1;
+        size_t morceau = T3C_ECRIVAIN_TAMPON - ecr->remplissage;
+        if (morceau > taille)
+            morceau = taille;
+        memcpy(ecr->tampons[ecr->courant] + ecr->remplissage, octets, morceau);
+        ecr->remplissage += morceau;
+        octets += morceau;
+        taille -= morceau;
+    }
+    return ecr->erreur ? -1 : 0;
+}
+
+// Recopie tout le fichier temporaire source à la suite du fichier, lu directement dans les tampons
+int t3c_ecrivain_recopier(t3c_ecrivain *ecr, FILE *source){
+    if (ecr->erreur || fflush(source) != 0 || fseeko(source, 0, SEEK_SET) != 0)
+        return -1;
+    for (;;){
+        if (ecr->remplissage == T3C_ECRIVAIN_TAMPON && t3c_ecrivain_vider(ecr) != 0)
+            return -1;
+        size_t lu = fread(ecr->tampons[ecr->courant] + ecr->remplissage, 1, T3C_ECRIVAIN_TAMPON - ecr->remplissage, source);
+        ecr->remplissage += lu;
+        if (lu == 0)
+            break;
+    }
+    return ferror(source) || ecr->erreur ? -1 : 0;
+}
+
+/* Écrit le dernier tampon, attend les écritures en vol, rend la réserve inutilisée et ferme
+   - Anneau qui ne rend plus ses complétions : les tampons encore en vol sont réécrits par
+     pwrite (même contenu, même position) et jamais libérés, le noyau pouvant encore les lire
+   - Renvoie -1 si une écriture a échoué depuis l'ouverture
+*/
+int t3c_ecrivain_fermer(t3c_ecrivain *ecr){
+    if (ecr->fd < 0)
+        return -1;
+    t3c_ecrivain_vider(ecr);
+    for (int t = 0; ecr->anneau && t < ecr->nbtampon; ++t){
+        if (t3c_anneau_attendre(ecr, t) != 0)
+            break;
+    }
+    for (int t = 0; t < ecr->nbtampon; ++t){
+        if (ecr->en_vol[t] && t3c_ecrire_tout(ecr->fd, ecr->tampons[t], ecr->longueurs[t], ecr->positions[t]) != 0)
+            ecr->erreur = 1;
+    }
+    if (ecr->prevue > ecr->position && ftruncate(ecr->fd, (off_t)ecr->position) != 0)
+        ecr->erreur = 1;
+    if (close(ecr->fd) != 0)
+        ecr->erreur = 1;
+    ecr->fd = -1;
+    t3c_anneau_fermer(ecr->anneau);
+    ecr->anneau = NULL;
+    for (int t = 0; t < ecr->nbtampon; ++t){
+        if (!ecr->en_vol[t])
+            free(ecr->tampons[t]);
+        ecr->tampons[t] = NULL;
+        ecr->en_vol[t] = 0;
+    }
+    return ecr->erreur ? -1 : 0;
+}
@@ -0,0 +1,430 @@
+/**
+ * t3c_extsort.c - Tri externe pour les tables binaires plus grandes que la mémoire
+ * - Range les couples condensat / mdp dans une zone de taille fixe (--mem-limit)
+ * - Zone pleine : trie par condensat et écrit une run triée sans doublon dans un
+ *   fichier temporaire (--tmp-dir)
+ * - Fusionne les runs (k-voies, tas binaire) par grandes lectures séquentielles vers la
+ *   table binaire finale, en éliminant les condensats en double
+ * - À condensat égal, la première occurrence du dictionnaire est gardée, comme t3c_bin_write
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+
+#include "t3c_extsort.h"
+#include "t3c_bin.h"
+
+#define EXTSORT_TAMPON_MIN ((size_t)64 << 10)   // tampon de lecture minimal d'une run
+#define EXTSORT_TAMPON_MAX ((size_t)16 << 20)
+
+// Run en cours de fusion : entrée courante et fichier d'où vient la suivante
+typedef struct {
+    FILE *fichier;
+    size_t restant;             // entrées pas encore lues
+    size_t rang;                // ancienneté de la run : départage les condensats égaux
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    char *mdp;
+    uint32_t taille;
+    uint32_t capacite;
+} extsort_source;
+
+/* Prépare le tri externe pour algo_name
+   - budget : octets de la zone en mémoire (au moins T3C_EXTSORT_BUDGET_MIN)
+   - dossier : où écrire les runs temporaires
+*/
+int t3c_extsort_init(t3c_extsort *tri, const char *algo_name, size_t budget, const char *dossier){
+    memset(tri, 0, sizeof *tri);
+    const EVP_MD *md = EVP_get_digestbyname(algo_name);
+    if (!md){
+        printf("t3c_extsort.c : ERREUR > L'algorithme '%s' est inconnu\n", algo_name);
+        return -1;
+    }
+    if (budget < T3C_EXTSORT_BUDGET_MIN)
+        budget = T3C_EXTSORT_BUDGET_MIN;
+    budget &= ~(size_t)(sizeof(uint64_t) - 1);
+
+    snprintf(tri->algo, sizeof tri->algo, "%s", algo_name);
+    tri->digest_taille = (unsigned int)EVP_MD_get_size(md);
+    tri->dossier = dossier;
+    tri->budget = budget;
+    tri->zone = malloc(budget);
+    if (!tri->zone){
+        printf("t3c_extsort.c : ERREUR > malloc de la zone de tri (%zu)\n", budget);
+        return -1;
+    }
+    return 0;
+}
+
+// Libère la zone et ferme les runs restantes (les fichiers temporaires disparaissent)
+void t3c_extsort_free(t3c_extsort *tri){
+    for (size_t i = 0; i < tri->nbrun; ++i)
+        if (tri->runs[i])
+            fclose(tri->runs[i]);
+    free(tri->runs);
+    free(tri->nbobj_runs);
+    free(tri->zone);
+    memset(tri, 0, sizeof *tri);
+}
+
+// Indices des enregistrements, rangés à la fin de la zone
+static uint64_t *extsort_indices(const t3c_extsort *tri){
+    return (uint64_t*)(tri->zone + tri->budget) - tri->nbobj;
+}
+
+/* Compare deux enregistrements de la zone par condensat
+   - à condensat égal, le premier rangé (offset le plus petit) passe devant
+*/
+static int compare_enregistrement(const void *a, const void *b, void *arg){
+    const t3c_extsort *tri = arg;
+    uint64_t ia = *(const uint64_t*)a;
+    uint64_t ib = *(const uint64_t*)b;
+    int comp = memcmp(tri->zone + ia, tri->zone + ib, tri->digest_taille);
+    if (comp != 0)
+        return comp;
+    return (ia > ib) - (ia < ib);
+}
+
+// Trie les indices de la zone par condensat
+static uint64_t *extsort_trier(t3c_extsort *tri){
+    uint64_t *indices = extsort_indices(tri);
+    qsort_r(indices, tri->nbobj, sizeof *indices, compare_enregistrement, tri);
+    return indices;
+}
+
+// Écrit un enregistrement [condensat][taille][mdp] dans une run
+static int extsort_ecrire(FILE *run, const unsigned char *digest, unsigned int digest_taille, const char *mdp, uint32_t taille){
+    if (fwrite(digest, 1, digest_taille, run) != digest_taille
+     || fwrite(&taille, sizeof taille, 1, run) != 1
+     || fwrite(mdp, 1, taille, run) != taille)
+        return -1;
+    return 0;
+}
+
+// Ajoute une run ouverte (et son nombre d'entrées) à la liste des runs
+static int extsort_ajouter_run(t3c_extsort *tri, FILE *run, size_t nbobj){
+    if (tri->nbrun == tri->capacite_runs){
+        size_t capacite = tri->capacite_runs ? tri->capacite_runs * 2 : 16;
+        FILE **runs = realloc(tri->runs, capacite * sizeof *runs);
+        if (runs)
+            tri->runs = runs;
+        size_t *nbobj_runs = realloc(tri->nbobj_runs, capacite * sizeof *nbobj_runs);
+        if (nbobj_runs)
+            tri->nbobj_runs = nbobj_runs;
+        if (!runs || !nbobj_runs){
+            printf("t3c_extsort.c : ERREUR > realloc de la liste des runs (%zu)\n", capacite);
+            return -1;
+        }
+        tri->capacite_runs = capacite;
+    }
+    tri->runs[tri->nbrun] = run;
+    tri->nbobj_runs[tri->nbrun] = nbobj;
+    tri->nbrun++;
+    return 0;
+}
+
+/* Vide la zone : tri, puis écriture d'une run sans doublon dans un fichier temporaire */
+static int extsort_vider(t3c_extsort *tri){
+    if (tri->nbobj == 0)
+        return 0;
+    uint64_t *indices = extsort_trier(tri);
+    FILE *run = t3c_fichier_temp(tri->dossier);
+    if (!run)
+        return -1;
+    setvbuf(run, NULL, _IOFBF, EXTSORT_TAMPON_MAX);
+
+    size_t nbecrit = 0;
+    const unsigned char *precedent = NULL;
+    for (size_t i = 0; i < tri->nbobj; ++i){
+        const unsigned char *digest = (const unsigned char*)tri->zone + indices[i];
+        if (precedent && memcmp(precedent, digest, tri->digest_taille) == 0){
+            tri->nbdoublons++;
+            continue;
+        }
+        uint32_t taille;
+        memcpy(&taille, digest + tri->digest_taille, sizeof taille);
+        if (extsort_ecrire(run, digest, tri->digest_taille, (const char*)digest + tri->digest_taille + sizeof taille, taille) != 0){
+            printf("t3c_extsort.c : ERREUR > L'écriture d'une run dans '%s' à échoué\n", tri->dossier);
+            fclose(run);
+            return -1;
+        }
+        precedent = digest;
+        nbecrit++;
+    }
+    if (fflush(run) != 0 || extsort_ajouter_run(tri, run, nbecrit) != 0){
+        printf("t3c_extsort.c : ERREUR > L'écriture d'une run dans '%s' à échoué\n", tri->dossier);
+        fclose(run);
+        return -1;
+    }
+    tri->haut = 0;
+    tri->nbobj = 0;
+    return 0;
+}
+
+/* Ajoute un couple condensat / mdp, en vidant la zone sur disque si elle est pleine */
+int t3c_extsort_add(t3c_extsort *tri, const unsigned char *digest, const char *mdp, size_t taille_mdp){
+    size_t besoin = tri->digest_taille + sizeof(uint32_t) + taille_mdp;
+    if (tri->haut + besoin + (tri->nbobj + 1) * sizeof(uint64_t) > tri->budget){
+        if (tri->nbobj == 0 || besoin + sizeof(uint64_t) > tri->budget){
+            printf("t3c_extsort.c : ERREUR > Un mot de %zu octets dépasse la limite mémoire (%zu)\n", taille_mdp, tri->budget);
+            return -1;
+        }
+        if (extsort_vider(tri) != 0)
+            return -1;
+    }
+    uint32_t taille = (uint32_t)taille_mdp;
+    char *enregistrement = tri->zone + tri->haut;
+    memcpy(enregistrement, digest, tri->digest_taille);
+    memcpy(enregistrement + tri->digest_taille, &taille, sizeof taille);
+    memcpy(enregistrement + tri->digest_taille + sizeof taille, mdp, taille_mdp);
+    tri->nbobj++;
+    extsort_indices(tri)[0] = tri->haut;
+    tri->haut += besoin;
+    tri->nbentrees++;
+    return 0;
+}
+
+/* Lit l'entrée suivante d'une run dans source
+   - Renvoie 1 si une entrée a été lue, 0 si la run est épuisée, -1 en cas d'erreur
+*/
+static int source_suivante(extsort_source *source, unsigned int digest_taille){
+    if (source->restant == 0)
+        return 0;
+    uint32_t taille;
+    if (fread(source->digest, 1, digest_taille, source->fichier) != digest_taille
+     || fread(&taille, sizeof taille, 1, source->fichier) != 1)
+        return -1;
+    if (taille + 1 > source->capacite){
+        uint32_t capacite = source->capacite ? source->capacite : 64;
+        while (capacite < taille + 1)
+            capacite *= 2;
+        char *mdp = realloc(source->mdp, capacite);
+        if (!mdp)
+            return -1;
+        source->mdp = mdp;
+        source->capacite = capacite;
+    }
+    if (fread(source->mdp, 1, taille, source->fichier) != taille)
+        return -1;
+    source->taille = taille;
+    source->restant--;
+    return 1;
+}
+
+// a passe-t-il avant b dans la fusion ? (condensat puis ancienneté de la run)
+static int source_avant(const extsort_source *a, const extsort_source *b, unsigned int digest_taille){
+    int comp = memcmp(a->digest, b->digest, digest_taille);
+    return comp < 0 || (comp == 0 && a->rang < b->rang);
+}
+
+// Rétablit le tas minimum à partir de la position i
+static void tas_descendre(extsort_source **tas, size_t n, size_t i, unsigned int digest_taille){
+    for (;;){
+        size_t min = i;
+        size_t g = 2 * i + 1;
+        size_t d = g + 1;
+        if (g < n && source_avant(tas[g], tas[min], digest_taille))
+            min = g;
+        if (d < n && source_avant(tas[d], tas[min], digest_taille))
+            min = d;
+        if (min == i)
+            return;
+        extsort_source *tmp = tas[i];
+        tas[i] = tas[min];
+        tas[min] = tmp;
+        i = min;
+    }
+}
+
+/* Rouvre une run écrite pour la relire depuis le début avec un tampon de taille_tampon octets
+   - Le descripteur est dupliqué : le fichier anonyme reste accessible après la fermeture
+     du flux d'écriture
+*/
+static FILE *run_relire(FILE *run, size_t taille_tampon){
+    int vide = fflush(run);
+    int fd = dup(fileno(run));
+    fclose(run);
+    if (vide != 0 || fd < 0 || lseek(fd, 0, SEEK_SET) != 0){
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+    FILE *lecture = fdopen(fd, "rb");
+    if (!lecture){
+        close(fd);
+        return NULL;
+    }
+    setvbuf(lecture, NULL, _IOFBF, taille_tampon);
+    return lecture;
+}
+
+/* Fusionne les runs [premiere, premiere + k) par un tas binaire
+   - vers la run sortie si elle est donnée, sinon vers la table binaire flux
+   - les condensats en double ne sont écrits qu'une fois (run la plus ancienne)
+   - Met le nombre d'entrées écrites dans nbsortie
+*/
+static int extsort_fusionner(t3c_extsort *tri, size_t premiere, size_t k, FILE *sortie, t3c_bin_flux *flux, size_t *nbsortie){
+    extsort_source *sources = calloc(k, sizeof *sources);
+    extsort_source **tas = malloc(k * sizeof *tas);
+    if (!sources || !tas){
+        printf("t3c_extsort.c : ERREUR > malloc de la fusion (%zu runs)\n", k);
+        free(sources);
+        free(tas);
+        return -1;
+    }
+
+    // Les tampons de lecture se partagent le budget mémoire
+    size_t taille_tampon = tri->budget / (k + 1);
+    if (taille_tampon < EXTSORT_TAMPON_MIN)
+        taille_tampon = EXTSORT_TAMPON_MIN;
+    if (taille_tampon > EXTSORT_TAMPON_MAX)
+        taille_tampon = EXTSORT_TAMPON_MAX;
+
+    int retour = 0;
+    size_t total = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < k; ++i){
+        extsort_source *source = &sources[i];
+        source->fichier = run_relire(tri->runs[premiere + i], taille_tampon);
+        tri->runs[premiere + i] = source->fichier;
+        source->restant = tri->nbobj_runs[premiere + i];
+        source->rang = i;
+        total += source->restant;
+        if (!source->fichier){
+            retour = -1;
+            continue;
+        }
+        int lu = source_suivante(source, tri->digest_taille);
+        if (lu < 0)
+            retour = -1;
+        else if (lu > 0)
+            tas[n++] = source;
+    }
+    for (size_t i = n; retour == 0 && i-- > 0; )
+        tas_descendre(tas, n, i, tri->digest_taille);
+
+    unsigned char precedent[EVP_MAX_MD_SIZE];
+    size_t nbecrit = 0;
+    size_t fait = 0;
+    size_t pourcentage = total >= 100 ? total / 100 : 1;
+    while (retour == 0 && n > 0){
+        extsort_source *source = tas[0];
+        if (nbecrit > 0 && memcmp(precedent, source->digest, tri->digest_taille) == 0)
+            tri->nbdoublons++;
+        else {
+            int ecrit = sortie ? extsort_ecrire(sortie, source->digest, tri->digest_taille, source->mdp, source->taille)
+                               : t3c_bin_flux_add(flux, source->digest, source->mdp, source->taille);
+            if (ecrit != 0){
+                retour = -1;
+                break;
+            }
+            memcpy(precedent, source->digest, tri->digest_taille);
+            nbecrit++;
+        }
+
+        int lu = source_suivante(source, tri->digest_taille);
+        if (lu < 0){
+            retour = -1;
+            break;
+        }
+        if (lu == 0)
+            tas[0] = tas[--n];
+        tas_descendre(tas, n, 0, tri->digest_taille);
+
+        ++fait;
+        if (!sortie && ((fait % pourcentage) == 0 || fait == total))
+            progress_bar(fait, total, "( Fusion des runs )");
+    }
+    if (retour != 0)
+        printf("t3c_extsort.c : ERREUR > La fusion des runs à échoué\n");
+
+    // Les runs fusionnées ne servent plus : leurs fichiers anonymes sont libérés
+    for (size_t i = 0; i < k; ++i){
+        if (tri->runs[premiere + i])
+            fclose(tri->runs[premiere + i]);
+        tri->runs[premiere + i] = NULL;
+        free(sources[i].mdp);
+    }
+    free(sources);
+    free(tas);
+    *nbsortie = nbecrit;
+    return retour;
+}
+
+/* Réduit le nombre de runs à T3C_EXTSORT_FUSION_MAX au plus
+   - fusionne les runs par groupes consécutifs : l'ordre d'ancienneté est conservé
+*/
+static int extsort_reduire(t3c_extsort *tri){
+    while (tri->nbrun > T3C_EXTSORT_FUSION_MAX){
+        size_t nbrun = 0;
+        for (size_t premiere = 0; premiere < tri->nbrun; premiere += T3C_EXTSORT_FUSION_MAX){
+            size_t k = tri->nbrun - premiere;
+            if (k > T3C_EXTSORT_FUSION_MAX)
+                k = T3C_EXTSORT_FUSION_MAX;
+            FILE *sortie = t3c_fichier_temp(tri->dossier);
+            if (!sortie)
+                return -1;
+            setvbuf(sortie, NULL, _IOFBF, EXTSORT_TAMPON_MAX);
+            size_t nbsortie = 0;
+            if (extsort_fusionner(tri, premiere, k, sortie, NULL, &nbsortie) != 0){
+                fclose(sortie);
+                return -1;
+            }
+            tri->runs[nbrun] = sortie;
+            tri->nbobj_runs[nbrun] = nbsortie;
+            nbrun++;
+        }
+        // Les runs au-delà de nbrun ont été fermées par la fusion
+        tri->nbrun = nbrun;
+    }
+    return 0;
+}
+
+/* Écrit la table binaire triée et sans doublon path
+   - Tout tient dans la zone : tri en mémoire et écriture directe
+   - Sinon la dernière run est vidée, la zone libérée pour les tampons de lecture,
+     puis les runs sont fusionnées (en plusieurs passes au-delà de T3C_EXTSORT_FUSION_MAX)
+*/
+int t3c_extsort_write(t3c_extsort *tri, char *path){
+    t3c_bin_flux flux;
+    if (tri->nbrun == 0){
+        uint64_t *indices = extsort_trier(tri);
+        if (t3c_bin_flux_open(&flux, path, tri->algo, tri->dossier) != 0)
+            return -1;
+        const unsigned char *precedent = NULL;
+        size_t pourcentage = tri->nbobj >= 100 ? tri->nbobj / 100 : 1;
+        for (size_t i = 0; i < tri->nbobj; ++i){
+            const unsigned char *digest = (const unsigned char*)tri->zone + indices[i];
+            if (precedent && memcmp(precedent, digest, tri->digest_taille) == 0)
+                tri->nbdoublons++;
+            else {
+                uint32_t taille;
+                memcpy(&taille, digest + tri->digest_taille, sizeof taille);
+                if (t3c_bin_flux_add(&flux, digest, (const char*)digest + tri->digest_taille + sizeof taille, taille) != 0){
+                    t3c_bin_flux_close(&flux, 1);
+                    return -1;
+                }
+                precedent = digest;
+            }
+            if (((i + 1) % pourcentage) == 0 || i + 1 == tri->nbobj)
+                progress_bar(i + 1, tri->nbobj, "( Ecriture Table )");
+        }
+        return t3c_bin_flux_close(&flux, 0);
+    }
+
+    if (extsort_vider(tri) != 0)
+        return -1;
+    free(tri->zone);
+    tri->zone = NULL;
+    if (extsort_reduire(tri) != 0)
+        return -1;
+
+    if (t3c_bin_flux_open(&flux, path, tri->algo, tri->dossier) != 0)
+        return -1;
+    size_t nbsortie = 0;
+    int retour = extsort_fusionner(tri, 0, tri->nbrun, NULL, &flux, &nbsortie);
+    tri->nbrun = 0;
+    return t3c_bin_flux_close(&flux, retour != 0) != 0 ? -1 : retour;
+}
@@ -0,0 +1,88 @@
+/**
+ * t3c_file.c - Files bornées entre les étages d'un pipeline (lecture, hachage, écriture)
+ *  - Anneau de pointeurs sans verrou, plusieurs producteurs et plusieurs consommateurs
+ *  - Les sémaphores ne servent qu'à dormir quand la file est vide ou pleine : sans attente,
+ *    un dépôt ou un retrait ne coûte que des opérations atomiques
+ *  - Chaque attente est comptée dans la phase --stats donnée par l'étage (t3c_stats.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+
+#include "t3c_file.h"
+#include "t3c_stats.h"
+
+// Initialise une file vide de capacite éléments
+int t3c_file_init(t3c_file *file, size_t capacite){
+    file->cases = malloc((capacite ? capacite : 1) * sizeof *file->cases);
+    if (!file->cases || sem_init(&file->places, 0, (unsigned int)capacite) != 0){
+        printf("t3c_file.c : ERREUR > L'initialisation de la file (%zu) à échoué\n", capacite);
+        free(file->cases);
+        file->cases = NULL;
+        return -1;
+    }
+    if (sem_init(&file->elements, 0, 0) != 0){
+        printf("t3c_file.c : ERREUR > L'initialisation de la file (%zu) à échoué\n", capacite);
+        sem_destroy(&file->places);
+        free(file->cases);
+        file->cases = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < capacite; ++i)
+        atomic_init(&file->cases[i].tour, i);
+    file->capacite = capacite;
+    atomic_init(&file->tete, 0);
+    atomic_init(&file->queue, 0);
+    return 0;
+}
+
+// Prend un jeton du sémaphore ; s'il faut attendre, la durée de l'attente est comptée dans phase
+static void t3c_file_attendre(sem_t *sem, int phase){
+    if (sem_trywait(sem) == 0)
+        return;
+    uint64_t debut = t3c_stats_debut();
+    while (sem_wait(sem) != 0 && errno == EINTR)
+        ;
+    t3c_stats_phase(phase, debut);
+}
+
+/* Dépose element à la suite de la file, en attendant une place si elle est pleine
+   - la case reçue peut encore être vidée par un consommateur en retard : on attend son tour
+*/
+void t3c_file_deposer(t3c_file *file, void *element, int phase){
+    t3c_file_attendre(&file->places, phase);
+    uint64_t indice = atomic_fetch_add_explicit(&file->tete, 1, memory_order_relaxed);
+    t3c_file_case *c = &file->cases[indice % file->capacite];
+    while (atomic_load_explicit(&c->tour, memory_order_acquire) != indice)
+        sched_yield();
+    c->element = element;
+    atomic_store_explicit(&c->tour, indice + 1, memory_order_release);
+    sem_post(&file->elements);
+}
+
+/* Retire le plus ancien élément de la file, en attendant qu'il y en ait un
+   - la case reçue peut encore être remplie par un producteur en retard : on attend son tour
+*/
+void *t3c_file_prendre(t3c_file *file, int phase){
+    t3c_file_attendre(&file->elements, phase);
+    uint64_t indice = atomic_fetch_add_explicit(&file->queue, 1, memory_order_relaxed);
+    t3c_file_case *c = &file->cases[indice % file->capacite];
+    while (atomic_load_explicit(&c->tour, memory_order_acquire) != indice + 1)
+        sched_yield();
+    void *element = c->element;
+    atomic_store_explicit(&c->tour, indice + file->capacite, memory_order_release);
+    sem_post(&file->places);
+    return element;
+}
+
+// Libère la file (aucun étage ne doit plus l'utiliser)
+void t3c_file_free(t3c_file *file){
+    if (!file->cases)
+        return;
+    sem_destroy(&file->places);
+    sem_destroy(&file->elements);
+    free(file->cases);
+    file->cases = NULL;
+}
@@ -0,0 +1,326 @@
+/**
+ * t3c_index.c - Index de recherche sur les condensats binaires
+ *  - Trie les condensats de largeur fixe et élimine les doublons
+ *  - Disposition Eytzinger (parcours en largeur) : la descente ne lit que des entiers
+ *    64 bits contigus, les premiers niveaux restent dans quelques lignes de cache
+ *  - Recherche par interpolation sur un tableau trié (les condensats sont uniformes),
+ *    bornée par une étape de dichotomie quand l'intervalle ne diminue pas assez
+ *  - Table à adressage ouvert (sondage linéaire) indexée directement par les bits du
+ *    condensat, déjà uniformes : une ligne de cache par recherche en général
+ *  - Aucune allocation par noeud : quelques tableaux alloués une fois
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "t3c_index.h"
+#include "hash.h"
+#include "t3c_stats.h"
+
+// Contexte transmis à qsort_r pour comparer deux indices par leur condensat
+typedef struct {
+    const unsigned char *digests;
+    size_t digest_taille;
+} t3c_tri;
+
+/* Compare deux entrées par condensat binaire
+   - à condensat égal, l'indice le plus petit passe devant : la première occurrence
+     est celle qui est conservée lors de l'élimination des doublons
+*/
+static int compare_digest(const void *a, const void *b, void *arg){
+    const t3c_tri *tri = arg;
+    size_t ia = *(const size_t*)a;
+    size_t ib = *(const size_t*)b;
+    int comp = memcmp(tri->digests + ia * tri->digest_taille, tri->digests + ib * tri->digest_taille, tri->digest_taille);
+    if (comp != 0)
+        return comp;
+    return (ia > ib) - (ia < ib);
+}
+
+/* Range dans ordre les indices des condensats triés sans doublon
+   - Si la colonne est déjà triée (table binaire) le tri est évité
+   - Renvoie le nombre d'indices uniques
+*/
+size_t t3c_sort_unique(const unsigned char *digests, size_t digest_taille, size_t nbobj, size_t *ordre){
+    int deja_trie = 1;
+    for (size_t i = 0; i < nbobj; ++i){
+        ordre[i] = i;
+        if (i > 0 && deja_trie && memcmp(digests + (i - 1) * digest_taille, digests + i * digest_taille, digest_taille) > 0)
+            deja_trie = 0;
+    }
+    if (!deja_trie){
+        t3c_tri tri = { digests, digest_taille };
+        qsort_r(ordre, nbobj, sizeof *ordre, compare_digest, &tri);
+    }
+
+    size_t nbunique = 0;
+    for (size_t i = 0; i < nbobj; ++i){
+        if (nbunique > 0 && memcmp(digests + ordre[i] * digest_taille, digests + ordre[nbunique - 1] * digest_taille, digest_taille) == 0)
+            continue;
+        ordre[nbunique++] = ordre[i];
+    }
+    return nbunique;
+}
+
+/* Remplit la disposition Eytzinger par un parcours infixe de l'arbre implicite
+   - le noeud k a pour fils 2k et 2k+1, le parcours infixe visite les clés dans l'ordre trié
+   - renvoie la position suivante dans ordre
+*/
+static size_t eytzinger_remplir(t3c_index *index, const unsigned char *digests, const size_t *ordre, size_t i, size_t k){
+    if (k > index->nbobj)
+        return i;
+    i = eytzinger_remplir(index, digests, ordre, i, 2 * k);
+
+    const unsigned char *digest = digests + ordre[i] * index->digest_taille;
+    index->cles64[k] = t3c_cle64(digest, index->digest_taille);
+    memcpy(index->digests + k * index->digest_taille, digest, index->digest_taille);
+    index->ids[k] = ordre[i];
+    i++;
+
+    return eytzinger_remplir(index, digests, ordre, i, 2 * k + 1);
+}
+
+#define T3C_SLOT_TAG_BITS 24
+#define T3C_SLOT_POS_BITS 40
+#define T3C_SLOT_POS_MASK ((UINT64_C(1) << T3C_SLOT_POS_BITS) - 1)
+
+// Étiquette courte stockée dans la case : bits de poids faible, indépendants de ceux de la position
+static inline uint64_t slot_tag(uint64_t cle){
+    return cle & ((UINT64_C(1) << T3C_SLOT_TAG_BITS) - 1);
+}
+
+/* Construit la table à adressage ouvert sur la colonne
+   - pas de tri : la case initiale est donnée par les bits de poids fort des 8 premiers octets
+   - une étiquette égale déclenche la comparaison du condensat complet ; un doublon est ignoré
+     (la première occurrence est gardée)
+   - taux de remplissage maintenu sous 2/3 pour des sondages courts
+*/
+static int hash_remplir(t3c_index *index, const unsigned char *digests, size_t nbobj){
+    size_t capacite = 16;
+    unsigned int bits = 4;
+    while (capacite < nbobj + nbobj / 2){
+        capacite <<= 1;
+        bits++;
+    }
+    if (nbobj > T3C_SLOT_POS_MASK || bits > T3C_SLOT_POS_BITS)
+        return -1;
+
+    index->slots = calloc(capacite, sizeof *index->slots);
+    if (index->slots == NULL)
+        return -1;
+    index->capacite = capacite;
+    index->decalage = 64 - bits;
+
+    size_t digest_taille = index->digest_taille;
+    size_t nbunique = 0;
+    for (size_t i = 0; i < nbobj; ++i){
+        const unsigned char *digest = digests + i * digest_taille;
+        uint64_t cle = t3c_cle64(digest, digest_taille);
+        uint64_t tag = slot_tag(cle);
+        size_t pos = (size_t)(cle >> index->decalage);
+        int doublon = 0;
+
+        while (index->slots[pos] != 0){
+            uint64_t slot = index->slots[pos];
+            if ((slot >> T3C_SLOT_POS_BITS) == tag && memcmp(index->digests + ((slot & T3C_SLOT_POS_MASK) - 1) * digest_taille, digest, digest_taille) == 0){
+                doublon = 1;
+                break;
+            }
+            pos = (pos + 1) & (capacite - 1);
+        }
+        if (doublon)
+            continue;
+
+        memcpy(index->digests + nbunique * digest_taille, digest, digest_taille);
+        index->ids[nbunique] = i;
+        nbunique++;
+        index->slots[pos] = (tag << T3C_SLOT_POS_BITS) | nbunique;
+    }
+    index->nbobj = nbunique;
+    return 0;
+}
+
+/* Construit un index sur une colonne de nbobj condensats de digest_taille octets
+   - ids renvoyés par t3c_index_find = position de l'entrée dans la colonne
+   - Renvoie NULL si une allocation échoue
+*/
+t3c_index *t3c_index_new(const unsigned char *digests, size_t digest_taille, size_t nbobj, int type){
+    uint64_t debut = t3c_stats_debut();
+    t3c_index *index = calloc(1, sizeof *index);
+    size_t *ordre = malloc((nbobj ? nbobj : 1) * sizeof *ordre);
+    if (!index || !ordre){
+        free(index);
+        free(ordre);
+        return NULL;
+    }
+    index->type = type;
+    index->digest_taille = digest_taille;
+
+    // La table de hachage n'a pas besoin du tri : les doublons sont écartés à l'insertion
+    if (type == T3C_INDEX_HASH){
+        free(ordre);
+        index->digests = malloc((nbobj ? nbobj : 1) * digest_taille);
+        index->ids = malloc((nbobj ? nbobj : 1) * sizeof *index->ids);
+        if (!index->digests || !index->ids || hash_remplir(index, digests, nbobj) != 0){
+            t3c_index_free(index);
+            return NULL;
+        }
+        t3c_stats_phase(T3C_STATS_INDEX, debut);
+        return index;
+    }
+
+    index->nbobj = t3c_sort_unique(digests, digest_taille, nbobj, ordre);
+
+    // Eytzinger est 1-indexé : la case 0 sert de sentinelle à la fin de la descente
+    size_t cases = index->nbobj + (type == T3C_INDEX_SORTED ? 1 : 0);
+    index->digests = malloc((cases ? cases : 1) * digest_taille);
+    index->ids = malloc((cases ? cases : 1) * sizeof *index->ids);
+    if (type == T3C_INDEX_SORTED)
+        index->cles64 = malloc(cases * sizeof *index->cles64);
+    if (!index->digests || !index->ids || (type == T3C_INDEX_SORTED && !index->cles64)){
+        free(ordre);
+        t3c_index_free(index);
+        return NULL;
+    }
+
+    if (type == T3C_INDEX_SORTED){
+        eytzinger_remplir(index, digests, ordre, 0, 1);
+    } else {
+        for (size_t i = 0; i < index->nbobj; ++i){
+            memcpy(index->digests + i * digest_taille, digests + ordre[i] * digest_taille, digest_taille);
+            index->ids[i] = ordre[i];
+        }
+    }
+
+    free(ordre);
+    t3c_stats_phase(T3C_STATS_INDEX, debut);
+    return index;
+}
+
+/* Recherche par interpolation dans une colonne triée de condensats
+   - la position est estimée d'après les 8 premiers octets (condensats uniformes)
+   - si une sonde ne divise pas l'intervalle par deux, une étape de dichotomie suit :
+     au plus 2*log2(n) sondes dans le pire cas, O(log log n) en moyenne
+   - Renvoie la position du condensat ou -1
+*/
+ssize_t t3c_search_sorted(const unsigned char *digests, size_t digest_taille, size_t nbobj, const unsigned char *digest){
+    uint64_t cle = t3c_cle64(digest, digest_taille);
+    size_t bas = 0;
+    size_t haut = nbobj;   // intervalle [bas, haut)
+
+    while (haut - bas > 16){
+        size_t taille = haut - bas;
+        uint64_t cle_bas  = t3c_cle64(digests + bas * digest_taille, digest_taille);
+        uint64_t cle_haut = t3c_cle64(digests + (haut - 1) * digest_taille, digest_taille);
+        if (cle < cle_bas || cle > cle_haut)
+            return -1;
+
+        size_t pos = bas + taille / 2;
+        if (cle_haut > cle_bas)
+            pos = bas + (size_t)((unsigned __int128)(cle - cle_bas) * (taille - 1) / (cle_haut - cle_bas));
+
+        int comp = memcmp(digests + pos * digest_taille, digest, digest_taille);
+        if (comp == 0)
+            return (ssize_t)pos;
+        if (comp < 0)
+            bas = pos + 1;
+        else
+            haut = pos;
+
+        // Garantie du pire cas : l'intervalle doit au moins être divisé par deux
+        if (haut - bas > taille / 2){
+            size_t milieu = bas + (haut - bas) / 2;
+            comp = memcmp(digests + milieu * digest_taille, digest, digest_taille);
+            if (comp == 0)
+                return (ssize_t)milieu;
+            if (comp < 0)
+                bas = milieu + 1;
+            else
+                haut = milieu;
+        }
+    }
+
+    // Fin par dichotomie sur quelques lignes de cache
+    while (bas < haut){
+        size_t milieu = bas + (haut - bas) / 2;
+        int comp = memcmp(digests + milieu * digest_taille, digest, digest_taille);
+        if (comp == 0)
+            return (ssize_t)milieu;
+        if (comp < 0)
+            bas = milieu + 1;
+        else
+            haut = milieu;
+    }
+    return -1;
+}
+
+/* Recherche d'un condensat binaire dans l'index
+   - SORTED : descente sans branchement dans l'arbre implicite, comparaison sur 64 bits
+     puis sur le condensat complet seulement si les 8 premiers octets sont égaux
+   - HASH : sondage linéaire à partir de la case donnée par les bits de poids fort,
+     le condensat complet n'est comparé que si l'étiquette correspond
+   - Renvoie l'id de l'entrée trouvée, sinon -1
+*/
+ssize_t t3c_index_find(const t3c_index *index, const unsigned char *digest, unsigned int digest_taille){
+    if (index == NULL || digest_taille != index->digest_taille || index->nbobj == 0)
+        return -1;
+
+    if (index->type == T3C_INDEX_INTERP){
+        ssize_t pos = t3c_search_sorted(index->digests, index->digest_taille, index->nbobj, digest);
+        return pos < 0 ? -1 : (ssize_t)index->ids[pos];
+    }
+
+    uint64_t cle = t3c_cle64(digest, digest_taille);
+    if (index->type == T3C_INDEX_HASH){
+        uint64_t tag = slot_tag(cle);
+        size_t pos = (size_t)(cle >> index->decalage);
+        uint64_t slot;
+        while ((slot = index->slots[pos]) != 0){
+            if ((slot >> T3C_SLOT_POS_BITS) == tag){
+                size_t p = (size_t)(slot & T3C_SLOT_POS_MASK) - 1;
+                if (memcmp(index->digests + p * digest_taille, digest, digest_taille) == 0)
+                    return (ssize_t)index->ids[p];
+            }
+            pos = (pos + 1) & (index->capacite - 1);
+        }
+        return -1;
+    }
+
+    size_t k = 1;
+    while (k <= index->nbobj){
+        // Les 16 descendants de k à 4 niveaux sont contigus : on les précharge
+        __builtin_prefetch(index->cles64 + 16 * k);
+        uint64_t cle_k = index->cles64[k];
+        int plus_petit = cle_k < cle || (cle_k == cle && memcmp(index->digests + k * digest_taille, digest, digest_taille) < 0);
+        k = 2 * k + (size_t)plus_petit;
+    }
+    // Remonte jusqu'au dernier noeud où la descente est partie à gauche : premier élément >= digest
+    k >>= __builtin_ffsll((long long)~k);
+    if (k == 0 || memcmp(index->digests + k * digest_taille, digest, digest_taille) != 0)
+        return -1;
+    return (ssize_t)index->ids[k];
+}
+
+// Libère les tableaux de l'index puis l'index lui-même
+void t3c_index_free(t3c_index *index){
+    if (index == NULL)
+        return;
+    free(index->cles64);
+    free(index->digests);
+    free(index->ids);
+    free(index->slots);
+    free(index);
+}
+
+/* Construit l'index à partir d'une table T3C en mémoire :
+   - Les condensats sont déjà bruts et de largeur fixe dans la colonne de la table
+   - Les ids renvoyés par t3c_index_find sont les positions dans la table
+   - Si une allocation échoue renvoie NULL
+*/
+t3c_index *t3c_index_build(const t3c_table *table, int type){
+    t3c_index *index = t3c_index_new(table->digests ? table->digests : (const unsigned char*)"", table->digest_taille, table->nbobj, type);
+    if (index)
+        index->table = table;
+    return index;
+}
@@ -0,0 +1,362 @@
+/**
+ * t3c_runs.c - Mises à jour incrémentales d'une table T3C (-G --append) et leur compaction (--compact)
+ *  - --append ne hache que les nouveaux mots et les écrit dans un run : une T3C binaire triée
+ *    rangée à côté de la table, <table>.r/000001, 000002, ... ; la table n'est pas réécrite
+ *  - La recherche (t3c_source, mode lot, serveur) interroge les runs du plus récent au plus
+ *    ancien puis la table : un mdp ajouté plus tard l'emporte
+ *  - --compact fusionne les runs dans la table, élimine les condensats en double (le plus récent
+ *    est gardé) puis supprime les runs ; une table aux mdp compressés le reste
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "t3c_runs.h"
+#include "t3c_bin.h"
+#include "t3c_index.h"
+#include "t3c_bloom.h"
+#include "hash.h"
+
+// Chemin du run : <path>.r/NNNNNN (à partir de 1)
+int t3c_run_chemin(const char *path, unsigned int run, char *chemin, size_t taille){
+    if (snprintf(chemin, taille, "%s%s/%06u", path, T3C_RUNS_SUFFIXE, run) >= (int)taille){
+        printf("t3c_runs.c : ERREUR > Le chemin des runs de '%s' est trop long\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Nombre de runs de la table : numéros consécutifs présents à partir de 1
+unsigned int t3c_runs_nb(const char *path){
+    unsigned int nbrun = 0;
+    char chemin[4096];
+    while (nbrun < T3C_RUNS_MAX && t3c_run_chemin(path, nbrun + 1, chemin, sizeof chemin) == 0 && access(chemin, F_OK) == 0)
+        nbrun++;
+    return nbrun;
+}
+
+/* Supprime les runs de la table, leurs filtres et leur dossier
+   - appelé après une compaction, et par -G sans --append : les runs d'une ancienne table
+     ne doivent pas s'attacher à la nouvelle
+*/
+int t3c_runs_supprimer(const char *path){
+    char chemin[4096];
+    int retour = 0;
+    for (unsigned int run = t3c_runs_nb(path); run > 0; --run){
+        if (t3c_run_chemin(path, run, chemin, sizeof chemin) != 0 || unlink(chemin) != 0){
+            printf("t3c_runs.c : ERREUR > La suppression du run '%s' à échoué\n", chemin);
+            retour = -1;
+            continue;
+        }
+        size_t longueur = strlen(chemin);
+        snprintf(chemin + longueur, sizeof chemin - longueur, "%s", T3C_BLOOM_SUFFIXE);
+        unlink(chemin);
+    }
+    if (snprintf(chemin, sizeof chemin, "%s%s", path, T3C_RUNS_SUFFIXE) < (int)sizeof chemin && rmdir(chemin) != 0 && errno != ENOENT && errno != ENOTEMPTY){
+        printf("t3c_runs.c : ERREUR > La suppression du dossier des runs '%s' à échoué\n", chemin);
+        retour = -1;
+    }
+    return retour;
+}
+
+/* Lit les algos des sections de la table path, dans l'ordre
+   - binaire : descripteurs de l'en-tête, sans lire les colonnes
+   - texte : en-têtes des sections (une lecture du fichier) ; une section sans en-tête est sha256
+*/
+int t3c_algos(char *path, char algos[][T3C_ALGO_MAX], size_t *nbsection){
+    *nbsection = 0;
+    if (t3c_bin_is(path)){
+        t3c_bin bin;
+        if (t3c_bin_open(path, &bin) != 0)
+            return -1;
+        *nbsection = bin.header->nbsection;
+        for (size_t s = 0; s < *nbsection; ++s)
+            snprintf(algos[s], T3C_ALGO_MAX, "%s", bin.sections[s].algo);
+        t3c_bin_close(&bin);
+        return 0;
+    }
+
+    FILE *fichier = fopen(path, "r");
+    if (fichier == NULL){
+        printf("t3c_runs.c : ERREUR > L'ouverture de la table '%s' à eu un probleme\n", path);
+        return -1;
+    }
+    t3c_table tables[T3C_SECTIONS_MAX];
+    size_t nblignes = 0;
+    int retour = count_lignes(fichier, tables, nbsection, &nblignes);
+    fclose(fichier);
+    for (size_t s = 0; s < *nbsection; ++s)
+        snprintf(algos[s], T3C_ALGO_MAX, "%s", tables[s].algo[0] ? tables[s].algo : "sha256");   // anciennes tables sans en-tête
+    return retour;
+}
+
+// Vérifie que le run a les sections de la table, dans le même ordre
+static int compact_sections(const t3c_bin *run, char algos[][T3C_ALGO_MAX], size_t nbsection, const char *chemin){
+    int identique = run->header->nbsection == nbsection;
+    for (size_t s = 0; identique && s < nbsection; ++s)
+        identique = strcmp(run->sections[s].algo, algos[s]) == 0;
+    if (!identique)
+        printf("t3c_runs.c : ERREUR > Les sections du run '%s' ne correspondent pas à celles de la table\n", chemin);
+    return identique ? 0 : -1;
+}
+
+/* Compaction en flux d'une table binaire d'une seule section : fusion k-voies des colonnes triées
+   - sources[0] est le run le plus récent, la table vient en dernier : à condensat égal la source
+     la plus récente est gardée, les autres entrées sont des doublons éliminés
+   - la mémoire ne dépend pas de la taille de la table (t3c_bin_flux)
+*/
+static int compact_flux(const t3c_bin *sources, size_t nbsource, char *sortie, const char *dossier, size_t *nbobj, size_t *nbdoublons){
+    char algo[T3C_ALGO_MAX];
+    size_t digest_taille = sources[0].sections[0].digest_taille;
+    snprintf(algo, sizeof algo, "%s", sources[0].sections[0].algo);
+
+    size_t *positions = calloc(nbsource, sizeof *positions);
+    if (positions == NULL){
+        printf("t3c_runs.c : ERREUR > calloc des positions (%zu)\n", nbsource);
+        return -1;
+    }
+    size_t nbLigneMax = 0;
+    for (size_t k = 0; k < nbsource; ++k){
+        nbLigneMax += sources[k].sections[0].nbobj;
+        madvise(sources[k].map, sources[k].taille_map, MADV_SEQUENTIAL);
+    }
+
+    t3c_bin_flux flux;
+    if (t3c_bin_flux_open(&flux, sortie, algo, dossier) != 0){
+        free(positions);
+        return -1;
+    }
+
+    int retour = 0;
+    size_t pourcentage = nbLigneMax >= 100 ? nbLigneMax / 100 : 1;
+    size_t nbLigneDone = 0;
+    size_t prochain = pourcentage;
+    while (retour == 0){
+        // Plus petit condensat en tête des sources, la plus récente à égalité
+        size_t min = nbsource;
+        const unsigned char *digest_min = NULL;
+        for (size_t k = 0; k < nbsource; ++k){
+            const t3c_bin_section *section = &sources[k].sections[0];
+            if (positions[k] == section->nbobj)
+                continue;
+            const unsigned char *digest = (const unsigned char*)sources[k].map + section->off_digests + positions[k] * digest_taille;
+            if (digest_min == NULL || memcmp(digest, digest_min, digest_taille) < 0){
+                min = k;
+                digest_min = digest;
+            }
+        }
+        if (digest_min == NULL)
+            break;
+
+        const char *mdp = t3c_bin_mdp(&sources[min], 0, positions[min]);
+        if (mdp == NULL || t3c_bin_flux_add(&flux, digest_min, mdp, strlen(mdp)) != 0){
+            retour = -1;
+            break;
+        }
+        (*nbobj)++;
+
+        // Avance toutes les sources qui ont ce condensat en tête
+        for (size_t k = 0; k < nbsource; ++k){
+            const t3c_bin_section *section = &sources[k].sections[0];
+            const unsigned char *digests = (const unsigned char*)sources[k].map + section->off_digests;
+            if (k != min && positions[k] < section->nbobj && memcmp(digests + positions[k] * digest_taille, digest_min, digest_taille) == 0){
+                positions[k]++;
+                (*nbdoublons)++;
+                nbLigneDone++;
+            }
+        }
+        positions[min]++;
+        nbLigneDone++;
+        if (nbLigneDone >= prochain || nbLigneDone == nbLigneMax){
+            progress_bar(nbLigneDone, nbLigneMax, "( Compaction )");
+            prochain = nbLigneDone + pourcentage;
+        }
+    }
+
+    free(positions);
+    return t3c_bin_flux_close(&flux, retour != 0) == 0 ? retour : -1;
+}
+
+/* Compaction en mémoire (table texte ou multi-sections)
+   - chaque section réunit les entrées des runs, du plus récent au plus ancien, puis celles de
+     la table ; t3c_sort_unique garde la première occurrence : le mdp le plus récent
+   - la table compactée est écrite triée, dans le format de la table d'origine (mdp compressés
+     par blocs de la même taille si ceux de sa première section l'étaient)
+*/
+static int compact_memoire(char *path, const t3c_bin *runs, size_t nbrun, char algos[][T3C_ALGO_MAX], size_t nbsection, char *sortie, size_t *nbobj, size_t *nbdoublons){
+    int binaire = t3c_bin_is(path);
+    t3c_bin bin;
+    t3c_table base[T3C_SECTIONS_MAX];
+    t3c_table tables[T3C_SECTIONS_MAX];
+    size_t nbbase = 0;
+    memset(&bin, 0, sizeof bin);
+    for (size_t s = 0; s < T3C_SECTIONS_MAX; ++s){
+        t3c_init(&base[s]);
+        t3c_init(&tables[s]);
+    }
+
+    // Entrées de la table : colonnes projetées si binaire, chargées si texte
+    int retour = binaire ? t3c_bin_open(path, &bin) : t3c_load(path, base, &nbbase);
+    if (retour == 0 && !binaire && nbbase != nbsection){
+        printf("t3c_runs.c : ERREUR > Les sections de la table '%s' ont changé pendant la compaction\n", path);
+        retour = -1;
+    }
+    if (retour == 0)
+        t3c_bin_compression(binaire ? t3c_bin_mdp_bloc(&bin, 0) : 0);
+
+    for (size_t s = 0; retour == 0 && s < nbsection; ++s){
+        unsigned int digest_taille = (unsigned int)EVP_MD_get_size(EVP_get_digestbyname(algos[s]));
+        size_t total = binaire ? bin.sections[s].nbobj : base[s].nbobj;
+        for (size_t r = 0; r < nbrun; ++r)
+            total += runs[r].sections[s].nbobj;
+
+        t3c_table reunie;
+        t3c_init(&reunie);
+        if (t3c_alloc(&reunie, total, digest_taille) != 0){
+            retour = -1;
+            break;
+        }
+        for (size_t r = nbrun; retour == 0 && r-- > 0; ){
+            const t3c_bin_section *section = &runs[r].sections[s];
+            const unsigned char *digests = (const unsigned char*)runs[r].map + section->off_digests;
+            for (size_t i = 0; retour == 0 && i < section->nbobj; ++i){
+                const char *mdp = t3c_bin_mdp(&runs[r], s, i);
+                retour = mdp ? t3c_add(&reunie, mdp, strlen(mdp), digests + i * digest_taille, digest_taille) : -1;
+            }
+        }
+        if (binaire){
+            const unsigned char *digests = (const unsigned char*)bin.map + bin.sections[s].off_digests;
+            for (size_t i = 0; retour == 0 && i < bin.sections[s].nbobj; ++i){
+                const char *mdp = t3c_bin_mdp(&bin, s, i);
+                retour = mdp ? t3c_add(&reunie, mdp, strlen(mdp), digests + i * digest_taille, digest_taille) : -1;
+            }
+        } else {
+            for (size_t i = 0; retour == 0 && i < base[s].nbobj; ++i){
+                const char *mdp = t3c_mdp(&base[s], i);
+                retour = t3c_add(&reunie, mdp, strlen(mdp), t3c_digest(&base[s], i), digest_taille);
+            }
+            t3c_free(&base[s]);
+        }
+
+        // Tri et élimination des doublons : la première occurrence est la plus récente
+        size_t *ordre = retour == 0 ? malloc((total ? total : 1) * sizeof *ordre) : NULL;
+        if (retour == 0 && ordre == NULL){
+            printf("t3c_runs.c : ERREUR > malloc du tri (%zu)\n", total);
+            retour = -1;
+        }
+        size_t nbunique = retour == 0 ? t3c_sort_unique(reunie.digests, digest_taille, reunie.nbobj, ordre) : 0;
+        if (retour == 0 && t3c_alloc(&tables[s], nbunique, digest_taille) != 0)
+            retour = -1;
+        for (size_t i = 0; retour == 0 && i < nbunique; ++i){
+            const char *mdp = t3c_mdp(&reunie, ordre[i]);
+            retour = t3c_add(&tables[s], mdp, strlen(mdp), t3c_digest(&reunie, ordre[i]), digest_taille);
+        }
+        snprintf(tables[s].algo, sizeof tables[s].algo, "%s", algos[s]);
+        *nbobj += nbunique;
+        *nbdoublons += reunie.nbobj - nbunique;
+        free(ordre);
+        t3c_free(&reunie);
+    }
+    if (binaire)
+        t3c_bin_close(&bin);
+
+    if (retour == 0 && create_t3c(tables, nbsection, sortie, binaire ? T3C_FORMAT_BIN : T3C_FORMAT_TXT) != 0){
+        printf("t3c_runs.c : ERREUR > La fonction create_t3c a échoué\n");
+        retour = -1;
+    }
+    for (size_t s = 0; s < T3C_SECTIONS_MAX; ++s){
+        t3c_free(&base[s]);
+        t3c_free(&tables[s]);
+    }
+    return retour;
+}
+
+/* Mode --compact : fusionne les runs dans la table
+   - table binaire d'une seule section : fusion k-voies en flux, mémoire bornée
+   - sinon : fusion en mémoire (compact_memoire)
+   - la table compactée est écrite dans <path>.tmp puis renommée : la table et ses runs restent
+     valides jusqu'au renommage ; les runs sont supprimés ensuite
+   - un filtre <path>.bf valide est reconstruit avec le même nombre de bits par clé
+*/
+int t3c_compact(char *path, size_t *nbobj, size_t *nbdoublons){
+    *nbobj = 0;
+    *nbdoublons = 0;
+    unsigned int nbrun = t3c_runs_nb(path);
+    if (nbrun == 0){
+        printf("La table %s n'a aucun run à compacter\n", path);
+        return 0;
+    }
+
+    char algos[T3C_SECTIONS_MAX][T3C_ALGO_MAX];
+    size_t nbsection = 0;
+    if (t3c_algos(path, algos, &nbsection) != 0)
+        return -1;
+
+    unsigned int bloom_bits = 0;
+    t3c_bloom filtre;
+    if (t3c_bloom_open(path, &filtre) == 0){
+        bloom_bits = filtre.header->bits_par_cle;
+        t3c_bloom_close(&filtre);
+    }
+
+    // runs[0] : le plus récent ; la table binaire suit en dernière source de la fusion en flux
+    t3c_bin *sources = calloc(nbrun + 1, sizeof *sources);
+    if (sources == NULL){
+        printf("t3c_runs.c : ERREUR > calloc des runs (%u)\n", nbrun);
+        return -1;
+    }
+    int retour = 0;
+    size_t nbouvert = 0;
+    for (unsigned int run = nbrun; retour == 0 && run > 0; --run){
+        char chemin[4096];
+        if (t3c_run_chemin(path, run, chemin, sizeof chemin) != 0 || t3c_bin_open(chemin, &sources[nbouvert]) != 0){
+            retour = -1;
+            break;
+        }
+        nbouvert++;
+        retour = compact_sections(&sources[nbouvert - 1], algos, nbsection, chemin);
+    }
+
+    char sortie[4096];
+    if (retour == 0 && snprintf(sortie, sizeof sortie, "%s.tmp", path) >= (int)sizeof sortie){
+        printf("t3c_runs.c : ERREUR > Le chemin de la table '%s' est trop long\n", path);
+        retour = -1;
+    }
+    if (retour == 0 && t3c_bin_is(path) && nbsection == 1){
+        char dossier[4096];
+        t3c_dossier(path, dossier, sizeof dossier);
+        retour = t3c_bin_open(path, &sources[nbouvert]);
+        if (retour == 0){
+            t3c_bin_compression(t3c_bin_mdp_bloc(&sources[nbouvert], 0));
+            nbouvert++;
+            retour = compact_flux(sources, nbouvert, sortie, dossier, nbobj, nbdoublons);
+        }
+    } else if (retour == 0){
+        retour = compact_memoire(path, sources, nbouvert, algos, nbsection, sortie, nbobj, nbdoublons);
+    }
+    for (size_t k = 0; k < nbouvert; ++k)
+        t3c_bin_close(&sources[k]);
+    free(sources);
+
+    if (retour == 0 && rename(sortie, path) != 0){
+        printf("t3c_runs.c : ERREUR > Le remplacement de la table '%s' à échoué\n", path);
+        retour = -1;
+    }
+    if (retour != 0){
+        unlink(sortie);
+        return -1;
+    }
+    if (t3c_runs_supprimer(path) != 0)
+        return -1;
+
+    size_t nbcle = 0;
+    if (bloom_bits && t3c_bloom_build(path, bloom_bits, &nbcle) != 0){
+        printf("t3c_runs.c : ERREUR > La reconstruction du filtre de '%s' à échoué\n", path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,654 @@
+/**
+ * t3c_serve.c - Serveur de recherche persistant sur une socket Unix (--serve) et son client (--client)
+ *  - Les tables sont ouvertes une seule fois (t3c_source_open) puis interrogées par tous les clients :
+ *    plus de chargement ni d'indexation à chaque recherche
+ *  - Boucle epoll sur un seul thread, sockets non bloquantes
+ *  - À chaque réveil : lecture de tous les clients prêts, traitement en lot de toutes leurs
+ *    requêtes complètes, puis une seule écriture des réponses par client
+ *  - Les clients envoient leurs requêtes à la suite sans attendre (pipeline), les réponses
+ *    reviennent dans l'ordre ; protocole texte ou binaire (t3c_serve.h)
+ *  - Plusieurs tables : chaque condensat est cherché dans l'ordre des tables, la première qui le
+ *    contient répond (une table d'un autre algo est écartée par la taille du condensat)
+ *  - Une requête peut nommer son algo ("algo:hex") : seules les sections de cet algo répondent
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "t3c_serve.h"
+#include "control_T3C.h"
+#include "hash.h"
+#include "t3c_stats.h"
+
+// Tampon d'une connexion : octets [debut, taille) encore à traiter ou à envoyer
+typedef struct {
+    char *data;
+    size_t debut;
+    size_t taille;
+    size_t capacite;
+} serve_tampon;
+
+// Connexion d'un client au serveur
+typedef struct {
+    int fd;
+    int protocole;          // -1 = pas encore connu (premier octet), 0 = texte, 1 = binaire
+    serve_tampon entree;    // requêtes reçues
+    serve_tampon sortie;    // réponses à envoyer
+    uint32_t evenements;    // événements epoll surveillés
+    int fin;                // le client a fermé son sens d'écriture : fermer une fois tout répondu
+    int erreur;             // erreur de socket ou de protocole : fermer sans attendre
+} serve_client;
+
+// Tables ouvertes et compteurs du serveur
+typedef struct {
+    t3c_source **sources;
+    int nbtable;
+    uint64_t nbrequete;
+    uint64_t nbtrouve;
+    uint64_t nbconnexion;
+    uint64_t nbreveil;
+} serve_etat;
+
+static volatile sig_atomic_t serve_arret = 0;
+
+static void serve_signal(int signal){
+    (void)signal;
+    serve_arret = 1;
+}
+
+/* Réserve taille octets libres à la fin du tampon
+   - les octets déjà consommés sont d'abord retirés du début
+   - la capacité double ensuite si nécessaire
+*/
+static int tampon_reserver(serve_tampon *tampon, size_t taille){
+    if (tampon->debut > 0 && tampon->capacite - tampon->taille < taille){
+        memmove(tampon->data, tampon->data + tampon->debut, tampon->taille - tampon->debut);
+        tampon->taille -= tampon->debut;
+        tampon->debut = 0;
+    }
+    if (tampon->capacite - tampon->taille >= taille)
+        return 0;
+    size_t capacite = tampon->capacite ? tampon->capacite : 65536;
+    while (capacite - tampon->taille < taille)
+        capacite *= 2;
+    char *data = realloc(tampon->data, capacite);
+    if (data == NULL){
+        printf("t3c_serve.c : ERREUR > realloc d'un tampon client (%zu)\n", capacite);
+        return -1;
+    }
+    tampon->data = data;
+    tampon->capacite = capacite;
+    return 0;
+}
+
+static int tampon_ajouter(serve_tampon *tampon, const void *data, size_t taille){
+    if (tampon_reserver(tampon, taille) != 0)
+        return -1;
+    memcpy(tampon->data + tampon->taille, data, taille);
+    tampon->taille += taille;
+    return 0;
+}
+
+/* Cherche le condensat dans les tables, dans l'ordre : la première qui le contient répond
+   - algo non NULL : seules les sections de cet algo sont interrogées
+*/
+static const char *serve_chercher(serve_etat *etat, const char *algo, const unsigned char *digest, unsigned int digest_taille){
+    uint64_t debut = t3c_stats_debut();
+    etat->nbrequete++;
+    for (int i = 0; i < etat->nbtable; ++i){
+        const char *mdp = t3c_source_find(etat->sources[i], algo, digest, digest_taille);
+        if (mdp){
+            etat->nbtrouve++;
+            t3c_stats_recherche(debut, 1);
+            return mdp;
+        }
+    }
+    t3c_stats_recherche(debut, 0);
+    return NULL;
+}
+
+/* Répond à une requête texte (ligne sans '\n')
+   - les lignes vides sont ignorées, sans réponse
+*/
+static int serve_ligne(serve_etat *etat, serve_client *client, const char *ligne, size_t taille){
+    while (taille > 0 && ligne[taille - 1] == '\r')
+        taille--;
+    if (taille == 0)
+        return 0;
+
+    char requete[T3C_SERVE_LIGNE_MAX + 1];
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_taille = 0;
+    char *algo = NULL;
+    memcpy(requete, ligne, taille);
+    requete[taille] = '\0';
+    if (t3c_requete_decoder(requete, &algo, digest, &digest_taille) != 0)
+        return tampon_ajouter(&client->sortie, "INVALIDE\n", 9);
+
+    const char *mdp = serve_chercher(etat, algo, digest, digest_taille);
+    if (mdp == NULL)
+        return tampon_ajouter(&client->sortie, "ABSENT\n", 7);
+    if (tampon_ajouter(&client->sortie, "OK ", 3) != 0 || tampon_ajouter(&client->sortie, mdp, strlen(mdp)) != 0)
+        return -1;
+    return tampon_ajouter(&client->sortie, "\n", 1);
+}
+
+// Répond à une requête binaire : [statut] puis, si trouvé, [taille uint32 LE][mdp]
+static int serve_binaire(serve_etat *etat, serve_client *client, const char *algo, const unsigned char *digest, unsigned int digest_taille){
+    const char *mdp = serve_chercher(etat, algo, digest, digest_taille);
+    unsigned char entete[5] = {mdp ? T3C_SERVE_TROUVE : T3C_SERVE_ABSENT};
+    if (mdp == NULL)
+        return tampon_ajouter(&client->sortie, entete, 1);
+    uint32_t taille = (uint32_t)strlen(mdp);
+    for (int i = 0; i < 4; ++i)
+        entete[1 + i] = (unsigned char)(taille >> (8 * i));
+    if (tampon_ajouter(&client->sortie, entete, sizeof entete) != 0)
+        return -1;
+    return tampon_ajouter(&client->sortie, mdp, taille);
+}
+
+/* Traite toutes les requêtes complètes reçues par le client
+   - s'arrête quand les réponses en attente dépassent T3C_SERVE_SORTIE_MAX : le reste sera traité
+     quand le client les aura lues
+   - une requête incomplète reste dans le tampon jusqu'à la lecture suivante
+*/
+static void serve_traiter(serve_etat *etat, serve_client *client){
+    serve_tampon *entree = &client->entree;
+    while (!client->erreur && entree->debut < entree->taille && client->sortie.taille - client->sortie.debut < T3C_SERVE_SORTIE_MAX){
+        const char *debut = entree->data + entree->debut;
+        size_t reste = entree->taille - entree->debut;
+
+        // Le premier octet de la connexion choisit le protocole
+        if (client->protocole == -1){
+            client->protocole = (unsigned char)debut[0] == T3C_SERVE_BINAIRE;
+            if (client->protocole == 1)
+                entree->debut++;
+            continue;
+        }
+
+        if (client->protocole == 0){
+            const char *fin = memchr(debut, '\n', reste);
+            size_t taille = fin ? (size_t)(fin - debut) : reste;
+            if (taille > T3C_SERVE_LIGNE_MAX){
+                tampon_ajouter(&client->sortie, "INVALIDE\n", 9);
+                client->fin = 1;    // ligne trop longue : on répond puis on ferme
+                entree->debut = entree->taille;
+                break;
+            }
+            if (fin == NULL && !client->fin)
+                break;              // ligne incomplète, sauf la dernière d'un client qui a fini d'écrire
+            if (serve_ligne(etat, client, debut, taille) != 0)
+                client->erreur = 1;
+            entree->debut += fin ? taille + 1 : taille;
+
+        } else {
+            // Trame [taille algo][algo][taille condensat][condensat]
+            size_t taille_algo = (unsigned char)debut[0];
+            if (taille_algo >= T3C_ALGO_MAX){
+                client->erreur = 1;     // trame invalide : le flux ne peut plus être resynchronisé
+                break;
+            }
+            if (reste < 2 + taille_algo)
+                break;
+            unsigned int digest_taille = (unsigned char)debut[1 + taille_algo];
+            if (digest_taille == 0 || digest_taille > EVP_MAX_MD_SIZE){
+                client->erreur = 1;
+                break;
+            }
+            if (reste < 2 + taille_algo + digest_taille)
+                break;
+            char algo[T3C_ALGO_MAX];
+            memcpy(algo, debut + 1, taille_algo);
+            algo[taille_algo] = '\0';
+            if (serve_binaire(etat, client, taille_algo ? algo : NULL, (const unsigned char*)debut + 2 + taille_algo, digest_taille) != 0)
+                client->erreur = 1;
+            entree->debut += 2 + taille_algo + digest_taille;
+        }
+    }
+    if (entree->debut == entree->taille)
+        entree->debut = entree->taille = 0;
+}
+
+/* Lit tout ce que le client a envoyé, jusqu'à EAGAIN ou T3C_SERVE_ENTREE_MAX octets en attente */
+static void serve_lire(serve_client *client){
+    serve_tampon *entree = &client->entree;
+    while (!client->fin && !client->erreur && entree->taille - entree->debut < T3C_SERVE_ENTREE_MAX){
+        if (tampon_reserver(entree, 65536) != 0){
+            client->erreur = 1;
+            return;
+        }
+        ssize_t lu = read(client->fd, entree->data + entree->taille, entree->capacite - entree->taille);
+        if (lu > 0)
+            entree->taille += (size_t)lu;
+        else if (lu == 0)
+            client->fin = 1;
+        else if (errno == EINTR)
+            continue;
+        else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                client->erreur = 1;
+            return;
+        }
+    }
+}
+
+/* Envoie les réponses en attente jusqu'à ce que la socket soit pleine */
+static void serve_ecrire(serve_client *client){
+    serve_tampon *sortie = &client->sortie;
+    while (!client->erreur && sortie->debut < sortie->taille){
+        ssize_t ecrit = send(client->fd, sortie->data + sortie->debut, sortie->taille - sortie->debut, MSG_NOSIGNAL);
+        if (ecrit > 0)
+            sortie->debut += (size_t)ecrit;
+        else if (ecrit < 0 && errno == EINTR)
+            continue;
+        else {
+            if (ecrit == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+                client->erreur = 1;
+            return;
+        }
+    }
+    if (sortie->debut == sortie->taille)
+        sortie->debut = sortie->taille = 0;
+}
+
+static void serve_fermer(int epoll_fd, serve_client *client){
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->entree.data);
+    free(client->sortie.data);
+    free(client);
+}
+
+/* Met à jour les événements surveillés du client, ou le ferme
+   - EPOLLIN tant que le client écrit et que ses requêtes en attente ne dépassent pas la limite
+   - EPOLLOUT tant que des réponses attendent que la socket se vide
+   - fermé sur erreur, ou quand il a fini d'écrire et que tout lui a été répondu
+     (une requête restée incomplète ne sera jamais terminée)
+   - renvoie 1 si le client a été fermé
+*/
+static int serve_surveiller(int epoll_fd, serve_client *client){
+    int attente_sortie = client->sortie.debut < client->sortie.taille;
+    if (client->erreur || (client->fin && !attente_sortie)){
+        serve_fermer(epoll_fd, client);
+        return 1;
+    }
+
+    uint32_t evenements = 0;
+    if (!client->fin && client->entree.taille - client->entree.debut < T3C_SERVE_ENTREE_MAX)
+        evenements |= EPOLLIN;
+    if (attente_sortie)
+        evenements |= EPOLLOUT;
+    if (evenements != client->evenements){
+        struct epoll_event evenement = {.events = evenements, .data.ptr = client};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &evenement) != 0){
+            serve_fermer(epoll_fd, client);
+            return 1;
+        }
+        client->evenements = evenements;
+    }
+    return 0;
+}
+
+// Accepte toutes les connexions en attente sur la socket d'écoute
+static void serve_accepter(serve_etat *etat, int epoll_fd, int ecoute_fd){
+    for (;;){
+        int fd = accept4(ecoute_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0){
+            if (errno == EINTR)
+                continue;
+            return;     // EAGAIN : plus de connexion en attente (ou erreur passagère du client)
+        }
+        serve_client *client = calloc(1, sizeof *client);
+        if (client == NULL){
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->protocole = -1;
+        client->evenements = EPOLLIN;
+        struct epoll_event evenement = {.events = EPOLLIN, .data.ptr = client};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &evenement) != 0){
+            close(fd);
+            free(client);
+            continue;
+        }
+        etat->nbconnexion++;
+    }
+}
+
+/* Crée la socket d'écoute non bloquante sur socket_path
+   - une socket restée d'un serveur arrêté est remplacée
+   - une socket encore servie par un autre processus est une erreur
+*/
+static int serve_ecouter(char *socket_path){
+    struct sockaddr_un adresse = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof adresse.sun_path){
+        printf("t3c_serve.c : ERREUR > Le chemin de la socket '%s' est trop long (%zu caractères max)\n", socket_path, sizeof adresse.sun_path - 1);
+        return -1;
+    }
+    memcpy(adresse.sun_path, socket_path, strlen(socket_path) + 1);
+
+    struct stat st;
+    if (lstat(socket_path, &st) == 0){
+        if (!S_ISSOCK(st.st_mode)){
+            printf("t3c_serve.c : ERREUR > '%s' existe et n'est pas une socket\n", socket_path);
+            return -1;
+        }
+        int test_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int occupe = test_fd >= 0 && connect(test_fd, (struct sockaddr*)&adresse, sizeof adresse) == 0;
+        if (test_fd >= 0)
+            close(test_fd);
+        if (occupe){
+            printf("t3c_serve.c : ERREUR > La socket '%s' est déjà servie par un autre processus\n", socket_path);
+            return -1;
+        }
+        unlink(socket_path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr*)&adresse, sizeof adresse) != 0 || listen(fd, SOMAXCONN) != 0){
+        printf("t3c_serve.c : ERREUR > Impossible d'écouter sur la socket '%s' (%s)\n", socket_path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Mode --serve :
+   - Ouvre chaque table une fois (projetée si binaire, chargée et indexée si texte, filtre de Bloom)
+   - Écoute ensuite sur la socket et répond jusqu'à SIGINT / SIGTERM
+   - Chaque réveil d'epoll lit tous les clients prêts, traite toutes leurs requêtes en lot
+     puis écrit les réponses de chaque client en une fois
+   - À l'arrêt : socket supprimée, bilan affiché
+*/
+int t3c_serve(char *socket_path, char **t3c_paths, int nbtable, int index_type){
+    serve_etat etat = {.nbtable = nbtable};
+    etat.sources = calloc((size_t)nbtable, sizeof *etat.sources);
+    if (etat.sources == NULL){
+        printf("t3c_serve.c : ERREUR > calloc des tables (%d)\n", nbtable);
+        return -1;
+    }
+
+    int retour = 0;
+    for (int i = 0; i < nbtable && retour == 0; ++i){
+        etat.sources[i] = t3c_source_open(t3c_paths[i], index_type);
+        if (etat.sources[i] == NULL){
+            printf("t3c_serve.c : ERREUR > L'ouverture de la table '%s' a échoué\n", t3c_paths[i]);
+            retour = -1;
+        }
+    }
+
+    int ecoute_fd = -1;
+    int epoll_fd = -1;
+    if (retour == 0 && (ecoute_fd = serve_ecouter(socket_path)) < 0)
+        retour = -1;
+    if (retour == 0){
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event evenement = {.events = EPOLLIN, .data.ptr = NULL};
+        if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ecoute_fd, &evenement) != 0){
+            printf("t3c_serve.c : ERREUR > La création de la boucle epoll a échoué (%s)\n", strerror(errno));
+            retour = -1;
+        }
+    }
+
+    if (retour == 0){
+        // Pas de SA_RESTART : epoll_wait est interrompu et la boucle s'arrête
+        struct sigaction action = {.sa_handler = serve_signal};
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        signal(SIGPIPE, SIG_IGN);
+
+        printf("Serveur prêt sur %s : %d table(s) ouverte(s)\n", socket_path, nbtable);
+        fflush(stdout);
+
+        struct epoll_event evenements[T3C_SERVE_EVENEMENTS];
+        while (!serve_arret){
+            int nb = epoll_wait(epoll_fd, evenements, T3C_SERVE_EVENEMENTS, -1);
+            if (nb < 0){
+                if (errno == EINTR)
+                    continue;
+                printf("t3c_serve.c : ERREUR > epoll_wait a échoué (%s)\n", strerror(errno));
+                retour = -1;
+                break;
+            }
+            etat.nbreveil++;
+
+            // 1. Nouvelles connexions et lecture de tous les clients prêts
+            for (int i = 0; i < nb; ++i){
+                if (evenements[i].data.ptr == NULL)
+                    serve_accepter(&etat, epoll_fd, ecoute_fd);
+                else if (evenements[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    serve_lire(evenements[i].data.ptr);
+            }
+            // 2. Toutes les requêtes complètes du réveil, client par client dans l'ordre reçu
+            for (int i = 0; i < nb; ++i){
+                if (evenements[i].data.ptr)
+                    serve_traiter(&etat, evenements[i].data.ptr);
+            }
+            // 3. Une écriture des réponses par client, puis mise à jour de la surveillance
+            for (int i = 0; i < nb; ++i){
+                serve_client *client = evenements[i].data.ptr;
+                if (client == NULL)
+                    continue;
+                serve_ecrire(client);
+                // Tout est parti alors que des requêtes attendent (traitement suspendu par la limite)
+                while (!client->erreur && client->sortie.taille == 0 && client->entree.debut < client->entree.taille){
+                    size_t reste = client->entree.taille - client->entree.debut;
+                    serve_traiter(&etat, client);
+                    if (client->entree.taille - client->entree.debut == reste)
+                        break;      // requête incomplète
+                    serve_ecrire(client);
+                }
+                serve_surveiller(epoll_fd, client);
+            }
+        }
+        printf("Serveur arrêté : %llu requêtes (%llu trouvées) sur %llu connexions, %.1f requêtes par réveil\n",
+               (unsigned long long)etat.nbrequete, (unsigned long long)etat.nbtrouve, (unsigned long long)etat.nbconnexion,
+               etat.nbreveil ? (double)etat.nbrequete / (double)etat.nbreveil : 0.0);
+    }
+
+    // Les clients encore connectés sont coupés avec le processus
+    if (epoll_fd >= 0)
+        close(epoll_fd);
+    if (ecoute_fd >= 0){
+        close(ecoute_fd);
+        unlink(socket_path);
+    }
+    for (int i = 0; i < nbtable; ++i)
+        t3c_source_close(etat.sources[i]);
+    free(etat.sources);
+    return retour;
+}
+
+// Écrit taille octets sur la socket du client (bloquante)
+static int client_envoyer(int fd, const void *data, size_t taille){
+    const char *p = data;
+    while (taille > 0){
+        ssize_t ecrit = send(fd, p, taille, MSG_NOSIGNAL);
+        if (ecrit < 0 && errno == EINTR)
+            continue;
+        if (ecrit <= 0)
+            return -1;
+        p += ecrit;
+        taille -= (size_t)ecrit;
+    }
+    return 0;
+}
+
+// Lit exactement taille octets de réponse (bloquante)
+static int client_recevoir(int fd, void *data, size_t taille){
+    char *p = data;
+    while (taille > 0){
+        ssize_t lu = read(fd, p, taille);
+        if (lu < 0 && errno == EINTR)
+            continue;
+        if (lu <= 0)
+            return -1;
+        p += lu;
+        taille -= (size_t)lu;
+    }
+    return 0;
+}
+
+/* Envoie les requêtes d'un lot de lignes puis affiche leurs réponses dans l'ordre
+   - les condensats sont décodés ici : le serveur reçoit des trames binaires
+   - une ligne invalide n'est pas envoyée et s'affiche introuvable, comme en -L
+*/
+static int client_lot(int fd, char **lignes, size_t nblignes, serve_tampon *trames, char **mdp, size_t *taille_mdp){
+    unsigned char valide[T3C_SERVE_LOT];
+    trames->taille = 0;
+    for (size_t i = 0; i < nblignes; ++i){
+        unsigned char trame[2 + T3C_ALGO_MAX + EVP_MAX_MD_SIZE];
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_taille = 0;
+        char *algo = NULL;
+        valide[i] = t3c_requete_decoder(lignes[i], &algo, digest, &digest_taille) == 0
+                 && (algo == NULL || strlen(algo) < T3C_ALGO_MAX);
+        if (!valide[i])
+            continue;
+        size_t taille_algo = algo ? strlen(algo) : 0;
+        trame[0] = (unsigned char)taille_algo;
+        if (taille_algo > 0)
+            memcpy(trame + 1, algo, taille_algo);     // sans algo, algo vaut NULL
+        trame[1 + taille_algo] = (unsigned char)digest_taille;
+        memcpy(trame + 2 + taille_algo, digest, digest_taille);
+        if (tampon_ajouter(trames, trame, 2 + taille_algo + digest_taille) != 0)
+            return -1;
+    }
+    if (client_envoyer(fd, trames->data, trames->taille) != 0){
+        printf("t3c_serve.c : ERREUR > L'envoi des requêtes au serveur a échoué\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < nblignes; ++i){
+        unsigned char entete[4];
+        unsigned char statut = T3C_SERVE_ABSENT;
+        if (valide[i] && client_recevoir(fd, &statut, 1) != 0){
+            printf("t3c_serve.c : ERREUR > Le serveur a fermé la connexion\n");
+            return -1;
+        }
+        if (statut != T3C_SERVE_TROUVE){
+            printf("Le hash donnée est introuvable dans la table T3C\n");
+            continue;
+        }
+        if (client_recevoir(fd, entete, sizeof entete) != 0){
+            printf("t3c_serve.c : ERREUR > Le serveur a fermé la connexion\n");
+            return -1;
+        }
+        size_t taille = (size_t)entete[0] | (size_t)entete[1] << 8 | (size_t)entete[2] << 16 | (size_t)entete[3] << 24;
+        if (taille + 1 > *taille_mdp){
+            char *nouveau = realloc(*mdp, taille + 1);
+            if (nouveau == NULL){
+                printf("t3c_serve.c : ERREUR > realloc d'une réponse (%zu)\n", taille + 1);
+                return -1;
+            }
+            *mdp = nouveau;
+            *taille_mdp = taille + 1;
+        }
+        if (client_recevoir(fd, *mdp, taille) != 0){
+            printf("t3c_serve.c : ERREUR > Le serveur a fermé la connexion\n");
+            return -1;
+        }
+        (*mdp)[taille] = '\0';
+        puts(*mdp);
+    }
+    return 0;
+}
+
+/* Mode --client :
+   - Envoie les condensats lus sur stdin (un par ligne) au serveur de la socket
+   - Les lignes disponibles sont envoyées d'un bloc (T3C_SERVE_LOT au plus) avant de lire
+     leurs réponses : un aller-retour par lot et non par condensat
+   - Affiche les réponses comme -L : le mdp, ou le message d'absence
+*/
+int t3c_client(char *socket_path){
+    struct sockaddr_un adresse = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof adresse.sun_path){
+        printf("t3c_serve.c : ERREUR > Le chemin de la socket '%s' est trop long (%zu caractères max)\n", socket_path, sizeof adresse.sun_path - 1);
+        return -1;
+    }
+    memcpy(adresse.sun_path, socket_path, strlen(socket_path) + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&adresse, sizeof adresse) != 0){
+        printf("t3c_serve.c : ERREUR > Le serveur de la socket '%s' est injoignable (%s)\n", socket_path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    unsigned char protocole = T3C_SERVE_BINAIRE;
+    if (client_envoyer(fd, &protocole, 1) != 0){
+        printf("t3c_serve.c : ERREUR > L'envoi au serveur a échoué\n");
+        close(fd);
+        return -1;
+    }
+
+    serve_tampon entree = {0};
+    serve_tampon trames = {0};
+    char *lignes[T3C_SERVE_LOT];
+    char *mdp = NULL;
+    size_t taille_mdp = 0;
+    int retour = 0;
+    int fin = 0;
+
+    // Chaque read de stdin rend les lignes disponibles : elles partent ensemble
+    while (!fin && retour == 0){
+        if (tampon_reserver(&entree, 65536) != 0){
+            retour = -1;
+            break;
+        }
+        ssize_t lu = read(STDIN_FILENO, entree.data + entree.taille, entree.capacite - entree.taille);
+        if (lu < 0 && errno == EINTR)
+            continue;
+        if (lu < 0){
+            printf("t3c_serve.c : ERREUR > La lecture de stdin a échoué\n");
+            retour = -1;
+            break;
+        }
+        if (lu == 0){
+            fin = 1;
+            if (entree.taille > entree.debut && entree.data[entree.taille - 1] != '\n')
+                entree.data[entree.taille++] = '\n';     // dernière ligne sans '\n' (place réservée)
+        }
+        entree.taille += (size_t)(lu > 0 ? lu : 0);
+
+        size_t nblignes = 0;
+        char *debut = entree.data + entree.debut;
+        char *fin_ligne;
+        while (retour == 0 && (fin_ligne = memchr(debut, '\n', (size_t)(entree.data + entree.taille - debut))) != NULL){
+            size_t taille = (size_t)(fin_ligne - debut);
+            while (taille > 0 && debut[taille - 1] == '\r')
+                taille--;
+            debut[taille] = '\0';
+            if (taille > 0)
+                lignes[nblignes++] = debut;
+            debut = fin_ligne + 1;
+            if (nblignes == T3C_SERVE_LOT){
+                retour = client_lot(fd, lignes, nblignes, &trames, &mdp, &taille_mdp);
+                nblignes = 0;
+            }
+        }
+        if (retour == 0 && nblignes > 0)
+            retour = client_lot(fd, lignes, nblignes, &trames, &mdp, &taille_mdp);
+        entree.debut = (size_t)(debut - entree.data);
+        if (entree.debut == entree.taille)
+            entree.debut = entree.taille = 0;
+        fflush(stdout);
+    }
+
+    free(entree.data);
+    free(trames.data);
+    free(mdp);
+    close(fd);
+    return retour;
+}
@@ -0,0 +1,130 @@
+/**
+ * t3c_shard.c - Table T3C découpée par préfixe du condensat (-G --shards=<k>)
+ *  - La table <table> devient un manifeste texte, les entrées sont rangées dans 2^k shards
+ *    <table>.d/XX selon les k premiers bits de leur condensat
+ *  - Chaque shard est une T3C ordinaire (texte ou binaire, mêmes sections) : une recherche
+ *    n'ouvre que les shards touchés par ses requêtes, et un shard se reconstruit seul (--shard=XX)
+ *  - Ce fichier lit et écrit le manifeste ; la génération est dans control_dict.c, la recherche
+ *    dans control_T3C.c (t3c_source) et t3c_batch.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "t3c_shard.h"
+#include "hash.h"
+
+// Vérifie si path est le manifeste d'une table découpée (première ligne T3C_SHARD_MAGIC)
+int t3c_shard_is(const char *path){
+    char ligne[sizeof T3C_SHARD_MAGIC];
+    FILE *fichier = fopen(path, "r");
+    if (fichier == NULL)
+        return 0;
+    size_t lu = fread(ligne, 1, sizeof ligne - 1, fichier);
+    fclose(fichier);
+    return lu == sizeof ligne - 1 && memcmp(ligne, T3C_SHARD_MAGIC, sizeof ligne - 1) == 0;
+}
+
+// Chemin du shard : <path>.d/XX
+int t3c_shard_chemin(const char *path, unsigned int shard, char *chemin, size_t taille){
+    if (snprintf(chemin, taille, "%s%s/%02x", path, T3C_SHARD_SUFFIXE, shard) >= (int)taille){
+        printf("t3c_shard.c : ERREUR > Le chemin des shards de '%s' est trop long\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* Lit le manifeste path
+   - vérifie le nombre de bits, le format, les algos et la présence d'une ligne par shard
+*/
+int t3c_manifeste_lire(const char *path, t3c_manifeste *manifeste){
+    memset(manifeste, 0, sizeof *manifeste);
+    FILE *fichier = fopen(path, "r");
+    if (fichier == NULL){
+        printf("t3c_shard.c : ERREUR > L'ouverture du manifeste '%s' à eu un probleme\n", path);
+        return -1;
+    }
+
+    char *ligne = NULL;
+    size_t taille_buf = 0;
+    ssize_t taille = getline(&ligne, &taille_buf, fichier);
+    int valide = taille > 0 && strncmp(ligne, T3C_SHARD_MAGIC, strlen(T3C_SHARD_MAGIC)) == 0;
+    manifeste->format = -1;
+
+    // En-tête : champs cle=valeur séparés par des tabulations
+    char *sauvegarde = NULL;
+    for (char *champ = valide ? strtok_r(ligne, "\t\r\n", &sauvegarde) : NULL; champ; champ = strtok_r(NULL, "\t\r\n", &sauvegarde)){
+        if (strncmp(champ, "bits=", 5) == 0)
+            manifeste->bits = (unsigned int)strtoul(champ + 5, NULL, 10);
+        else if (strcmp(champ, "format=txt") == 0)
+            manifeste->format = T3C_FORMAT_TXT;
+        else if (strcmp(champ, "format=bin") == 0)
+            manifeste->format = T3C_FORMAT_BIN;
+        else if (strncmp(champ, "algos=", 6) == 0){
+            char *sauve_algo = NULL;
+            for (char *algo = strtok_r(champ + 6, ",", &sauve_algo); algo && valide; algo = strtok_r(NULL, ",", &sauve_algo)){
+                if (manifeste->nbsection == T3C_SECTIONS_MAX || strlen(algo) >= T3C_ALGO_MAX || !EVP_get_digestbyname(algo))
+                    valide = 0;
+                else
+                    snprintf(manifeste->algos[manifeste->nbsection++], T3C_ALGO_MAX, "%s", algo);
+            }
+        }
+    }
+    valide = valide && manifeste->bits >= 1 && manifeste->bits <= T3C_SHARD_BITS_MAX
+          && manifeste->format != -1 && manifeste->nbsection > 0;
+
+    // Une ligne "XX<TAB>entrées" par shard
+    unsigned int nblignes = 0;
+    while (valide && (taille = getline(&ligne, &taille_buf, fichier)) != -1){
+        unsigned int shard = 0;
+        unsigned long long nbobj = 0;
+        if (sscanf(ligne, "%x\t%llu", &shard, &nbobj) != 2 || shard >= t3c_shard_nb(manifeste)){
+            valide = 0;
+            break;
+        }
+        manifeste->nbobj[shard] = nbobj;
+        nblignes++;
+    }
+    valide = valide && nblignes == t3c_shard_nb(manifeste);
+
+    free(ligne);
+    fclose(fichier);
+    if (!valide){
+        printf("t3c_shard.c : ERREUR > Le manifeste '%s' est invalide\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Écrit le manifeste path (remplace l'ancien d'un bloc : fichier temporaire puis rename)
+int t3c_manifeste_ecrire(const char *path, const t3c_manifeste *manifeste){
+    size_t taille = strlen(path) + 5;
+    char *temp = malloc(taille);
+    FILE *fichier = NULL;
+    if (temp){
+        snprintf(temp, taille, "%s.tmp", path);
+        fichier = fopen(temp, "w");
+    }
+    if (fichier == NULL){
+        printf("t3c_shard.c : ERREUR > L'ouverture du manifeste '%s' à eu un probleme\n", path);
+        free(temp);
+        return -1;
+    }
+
+    fprintf(fichier, "%s\tbits=%u\tformat=%s\talgos=", T3C_SHARD_MAGIC, manifeste->bits, manifeste->format == T3C_FORMAT_BIN ? "bin" : "txt");
+    for (size_t s = 0; s < manifeste->nbsection; ++s)
+        fprintf(fichier, "%s%s", s ? "," : "", manifeste->algos[s]);
+    fprintf(fichier, "\n");
+    for (unsigned int shard = 0; shard < t3c_shard_nb(manifeste); ++shard)
+        fprintf(fichier, "%02x\t%llu\n", shard, (unsigned long long)manifeste->nbobj[shard]);
+
+    int retour = 0;
+    if (fclose(fichier) != 0 || rename(temp, path) != 0){
+        printf("t3c_shard.c : ERREUR > L'écriture du manifeste '%s' à échoué\n", path);
+        remove(temp);
+        retour = -1;
+    }
+    free(temp);
+    return retour;
+}
@@ -0,0 +1,204 @@
+/**
+ * t3c_stats.c - Instrumentation de Rain-C (--stats) et barres de progression
+ *  - Chronomètre les phases (lecture, dédoublonnage, hachage, écriture, chargement, index,
+ *    recherche) et tient les compteurs du mode exécuté ; les phases attente_* comptent le
+ *    temps passé par chaque étage du pipeline de -G à attendre un paquet (t3c_file.h)
+ *  - Les recherches unitaires (-L -s / stdin, --serve) alimentent un histogramme de latence
+ *    en seaux log2 ; le lot (-f) n'ajoute que ses trouvés / absents et sa durée
+ *  - Le bilan est écrit en JSON sur stderr ou dans le fichier de --stats=<fichier>
+ *  - Les barres de progression sont rendues d'un seul write sur stderr, au plus toutes les
+ *    T3C_PROGRESSION_NS, et coupées par défaut quand stderr n'est pas un terminal
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include "t3c_stats.h"
+
+int t3c_stats_actives = 0;
+
+static const char *noms_phases[T3C_STATS_PHASES] = {
+    "lecture", "dedoublonnage", "hachage", "ecriture", "chargement", "index", "recherche",
+    "attente_lecture", "attente_dedoublonnage", "attente_hachage", "attente_ecriture"
+};
+static const char *noms_compteurs[T3C_STATS_COMPTEURS] = {
+    "octets_lus", "mots", "doublons", "condensats", "entrees_ecrites", "octets_ecrits",
+    "entrees_chargees", "lignes_invalides", "trouves", "absents"
+};
+
+static uint64_t debut_programme;
+static _Atomic uint64_t phases_ns[T3C_STATS_PHASES];
+static _Atomic uint64_t phases_appels[T3C_STATS_PHASES];
+static _Atomic uint64_t compteurs[T3C_STATS_COMPTEURS];
+static _Atomic uint64_t seaux[T3C_STATS_SEAUX];     // recherches unitaires par seau de latence
+static _Atomic uint64_t latence_totale;
+static _Atomic uint64_t latence_max;
+static _Atomic uint64_t latence_min = UINT64_MAX;
+
+static int progression = -1;                         // voir t3c_progression
+static _Atomic uint64_t dernier_rendu;
+
+// Horloge monotone en nanosecondes
+uint64_t t3c_stats_horloge(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Active l'instrumentation, avant le lancement du mode
+void t3c_stats_activer(void){
+    debut_programme = t3c_stats_horloge();
+    t3c_stats_actives = 1;
+}
+
+// Ajoute à la phase la durée écoulée depuis debut (t3c_stats_debut)
+void t3c_stats_phase(int phase, uint64_t debut){
+    if (!t3c_stats_actives)
+        return;
+    atomic_fetch_add_explicit(&phases_ns[phase], t3c_stats_horloge() - debut, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phases_appels[phase], 1, memory_order_relaxed);
+}
+
+void t3c_stats_compter(int compteur, uint64_t n){
+    if (t3c_stats_actives)
+        atomic_fetch_add_explicit(&compteurs[compteur], n, memory_order_relaxed);
+}
+
+/* Termine une recherche unitaire commencée à debut
+   - compte le trouvé ou l'absent, ajoute la durée à la phase recherche
+   - range la latence dans le seau b : 2^(b-1) <= ns < 2^b (seau 0 : 0 ns)
+*/
+void t3c_stats_recherche(uint64_t debut, int trouve){
+    if (!t3c_stats_actives)
+        return;
+    uint64_t ns = t3c_stats_horloge() - debut;
+    unsigned int b = ns ? 64 - (unsigned int)__builtin_clzll(ns) : 0;
+    if (b >= T3C_STATS_SEAUX)
+        b = T3C_STATS_SEAUX - 1;
+    atomic_fetch_add_explicit(&seaux[b], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&latence_totale, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phases_ns[T3C_STATS_RECHERCHE], ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phases_appels[T3C_STATS_RECHERCHE], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&compteurs[trouve ? T3C_STATS_TROUVES : T3C_STATS_ABSENTS], 1, memory_order_relaxed);
+
+    uint64_t vu = atomic_load_explicit(&latence_max, memory_order_relaxed);
+    while (ns > vu && !atomic_compare_exchange_weak_explicit(&latence_max, &vu, ns, memory_order_relaxed, memory_order_relaxed))
+        ;
+    vu = atomic_load_explicit(&latence_min, memory_order_relaxed);
+    while (ns < vu && !atomic_compare_exchange_weak_explicit(&latence_min, &vu, ns, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+/* Quantile q (en millièmes) des latences : borne haute du seau qui le contient,
+   ramenée au maximum observé
+*/
+static uint64_t quantile(const uint64_t *nb, uint64_t total, unsigned int q, uint64_t max){
+    uint64_t rang = (total * q + 999) / 1000;
+    uint64_t cumul = 0;
+    for (unsigned int b = 0; b < T3C_STATS_SEAUX; ++b){
+        cumul += nb[b];
+        if (cumul >= rang && cumul > 0){
+            uint64_t borne = b ? ((uint64_t)1 << b) - 1 : 0;
+            return borne < max ? borne : max;
+        }
+    }
+    return max;
+}
+
+/* Écrit le bilan JSON dans path (NULL ou "-" : stderr)
+   - phases : durée cumulée en ns et nombre de mesures
+   - recherches : latences des recherches unitaires (quantiles bornés par leur seau)
+*/
+int t3c_stats_ecrire(const char *path){
+    if (!t3c_stats_actives)
+        return 0;
+    FILE *fichier = (path == NULL || strcmp(path, "-") == 0) ? stderr : fopen(path, "w");
+    if (!fichier){
+        printf("t3c_stats.c : ERREUR > L'ouverture du fichier de statistiques '%s' à échoué\n", path);
+        return -1;
+    }
+
+    fprintf(fichier, "{\n  \"duree_ns\": %llu,\n  \"phases\": {\n", (unsigned long long)(t3c_stats_horloge() - debut_programme));
+    for (int p = 0; p < T3C_STATS_PHASES; ++p)
+        fprintf(fichier, "    \"%s\": {\"ns\": %llu, \"mesures\": %llu}%s\n", noms_phases[p],
+                (unsigned long long)atomic_load(&phases_ns[p]), (unsigned long long)atomic_load(&phases_appels[p]),
+                p + 1 < T3C_STATS_PHASES ? "," : "");
+    fprintf(fichier, "  },\n  \"compteurs\": {\n");
+    for (int c = 0; c < T3C_STATS_COMPTEURS; ++c)
+        fprintf(fichier, "    \"%s\": %llu%s\n", noms_compteurs[c], (unsigned long long)atomic_load(&compteurs[c]), c + 1 < T3C_STATS_COMPTEURS ? "," : "");
+
+    uint64_t nb[T3C_STATS_SEAUX];
+    uint64_t total = 0;
+    for (unsigned int b = 0; b < T3C_STATS_SEAUX; ++b){
+        nb[b] = atomic_load(&seaux[b]);
+        total += nb[b];
+    }
+    uint64_t max = atomic_load(&latence_max);
+    fprintf(fichier, "  },\n  \"recherches\": {\n    \"nb\": %llu,\n", (unsigned long long)total);
+    if (total > 0){
+        fprintf(fichier, "    \"latence_ns\": {\"min\": %llu, \"moyenne\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu},\n",
+                (unsigned long long)atomic_load(&latence_min), (unsigned long long)(atomic_load(&latence_totale) / total),
+                (unsigned long long)quantile(nb, total, 500, max), (unsigned long long)quantile(nb, total, 900, max),
+                (unsigned long long)quantile(nb, total, 990, max), (unsigned long long)quantile(nb, total, 999, max),
+                (unsigned long long)max);
+    }
+    fprintf(fichier, "    \"histogramme\": [");
+    int premier = 1;
+    for (unsigned int b = 0; b < T3C_STATS_SEAUX; ++b){
+        if (nb[b] == 0)
+            continue;
+        fprintf(fichier, "%s\n      {\"moins_de_ns\": %llu, \"nb\": %llu}", premier ? "" : ",", (unsigned long long)((uint64_t)1 << b), (unsigned long long)nb[b]);
+        premier = 0;
+    }
+    fprintf(fichier, "%s]\n  }\n}\n", premier ? "" : "\n    ");
+
+    int retour = ferror(fichier) ? -1 : 0;
+    if (fichier != stderr && fclose(fichier) != 0)
+        retour = -1;
+    if (retour != 0)
+        printf("t3c_stats.c : ERREUR > L'écriture des statistiques a échoué\n");
+    return retour;
+}
+
+void t3c_progression(int actif){
+    progression = actif;
+}
+
+/* Rend la barre "{====----} pct% [fait / total] texte" sur stderr
+   - ligne construite dans un tampon puis écrite d'un seul write
+   - barre intermédiaire ignorée si la précédente date de moins de T3C_PROGRESSION_NS ;
+     la barre complète (fait >= total) est toujours rendue et termine la ligne
+*/
+void t3c_progression_afficher(size_t fait, size_t total, const char *texte){
+    if (progression == -1)
+        progression = isatty(STDERR_FILENO) ? 1 : 0;
+    if (!progression || total == 0)
+        return;
+    int fin = fait >= total;
+    uint64_t maintenant = t3c_stats_horloge();
+    uint64_t dernier = atomic_load_explicit(&dernier_rendu, memory_order_relaxed);
+    if (!fin && (maintenant - dernier < T3C_PROGRESSION_NS
+              || !atomic_compare_exchange_strong_explicit(&dernier_rendu, &dernier, maintenant, memory_order_relaxed, memory_order_relaxed)))
+        return;
+    if (fin)
+        atomic_store_explicit(&dernier_rendu, 0, memory_order_relaxed);
+
+    unsigned int larg = 50;
+    unsigned int loading = fin ? larg : (unsigned int)(fait * larg / total);
+    char ligne[512];
+    size_t n = 0;
+    ligne[n++] = '\r';
+    ligne[n++] = '{';
+    for (unsigned int i = 0; i < larg; ++i)
+        ligne[n++] = i < loading ? '=' : '-';
+    int ecrit = snprintf(ligne + n, sizeof ligne - n, "} %3d%% [%zu / %zu]%s%s%s", fin ? 100 : (int)(fait * 100 / total),
+                         fait, total, texte && texte[0] ? " " : "", texte ? texte : "", fin ? "\n" : "");
+    if (ecrit > 0)
+        n += (size_t)ecrit < sizeof ligne - n ? (size_t)ecrit : sizeof ligne - n - 1;
+    ssize_t ignore = write(STDERR_FILENO, ligne, n);
+    (void)ignore;
+}